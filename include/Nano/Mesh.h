@@ -1,11 +1,14 @@
 #pragma once
 #include <rpp/vec.h>
 #include <rpp/collections.h>
+#include <functional>
 #include <memory>
 #include <stdexcept>
 
 /**
- * Enables FBX mesh loader for platforms that support it
+ * Enables the Autodesk FBX SDK for platforms that support it,
+ * which is needed for ASCII FBX files and SaveAsFBX.
+ * Without the SDK, binary FBX 7.x files are loaded with the built-in reader.
  */
 #if !NANOMESH_NO_FBX && !defined(ENABLE_FBX_MESH_LOADER)
 #  define ENABLE_FBX_MESH_LOADER (_WIN32)
@@ -146,6 +149,129 @@ namespace Nano
     };
 
 
+    // Storage format of octahedral encoded normals in QuantizedVertexData
+    enum class NormalQuantization
+    {
+        Snorm16, // 2x snorm16, 4 bytes, ~0.003 degree precision
+        Snorm8,  // 2x snorm8,  2 bytes, ~0.7 degree precision, good enough for most lighting
+    };
+
+    // Storage format of texture coordinates in QuantizedVertexData
+    enum class CoordQuantization
+    {
+        Half,    // 2x half float, works for any UV range
+        Unorm16, // 2x unorm16 relative to the UV bounds of the group, uniform precision
+    };
+
+    struct QuantizeOptions
+    {
+        NormalQuantization Normals = NormalQuantization::Snorm16;
+        CoordQuantization  Coords  = CoordQuantization::Half;
+    };
+
+    /**
+     * Compact vertex data for games, 12-20 bytes per vertex instead of the 32 bytes of BasicVertex.
+     * Every vertex starts with its position and the other attributes follow in this order:
+     *
+     *   pos     3x unorm16, relative to the bounding box of the group, see PosOffset/PosScale
+     *   norm    2x snorm8 packed right after pos, or 2x snorm16 after a 2 byte pad,
+     *           as an octahedral encoded unit vector
+     *   uv      2x half or 2x unorm16, see CoordOffset/CoordScale
+     *   color   RGBA8, only if the group has Colors
+     *
+     * Use the attribute byte offsets to set up the vertex layout.
+     * The GPU converts normalized formats to [0,1] or [-1,1], so the shader can dequantize with:
+     * `pos = PosOffset + PosScale * unorm_pos;  uv = CoordOffset + CoordScale * unorm_uv;`
+     * and decode octahedral normals with:
+     * `n = vec3(e.x, e.y, 1 - abs(e.x) - abs(e.y)); if (n.z < 0) n.xy = (1 - abs(n.yx)) * sign(n.xy); n = normalize(n);`
+     */
+    struct NANOMESH_API QuantizedVertexData
+    {
+        std::vector<uint8_t> Vertices; // NumVertices * Stride bytes
+        std::vector<int>     Indices;
+        int NumVertices = 0;
+        int Stride = 0;       // bytes per vertex, always a multiple of 4
+        int NormalByteOffset = 0;  // offset of the normal in a vertex
+        int CoordByteOffset  = 0;  // offset of the UV in a vertex
+        int ColorByteOffset  = -1; // offset of the RGBA8 color in a vertex, -1 if there are no colors
+        NormalQuantization NormalFormat = NormalQuantization::Snorm16;
+        CoordQuantization  CoordFormat  = CoordQuantization::Half;
+
+        // dequantization transform
+        rpp::Vector3 PosOffset   = rpp::Vector3::Zero();
+        rpp::Vector3 PosScale    = rpp::Vector3::Zero();
+        rpp::Vector2 CoordOffset = rpp::Vector2::Zero(); // always Zero for CoordQuantization::Half
+        rpp::Vector2 CoordScale  = rpp::Vector2::One();  // always One for CoordQuantization::Half
+
+        // maximum errors of the dequantized data
+        float MaxPosError    = 0.0f; // absolute error of any position component
+        float MaxNormalError = 0.0f; // angle between the original and decoded normal, in DEGREES
+        float MaxCoordError  = 0.0f; // absolute error of any UV component
+        float MaxColorError  = 0.0f; // absolute error of any color component
+    };
+
+
+    /**
+     * Per-layer tolerances for MeshGroup::WeldVertices().
+     * Two elements are merged if all of their components differ by at most the epsilon,
+     * with an epsilon of 0 elements must be exactly identical.
+     */
+    struct WeldOptions
+    {
+        float PositionEpsilon = 0.0f;
+        float CoordEpsilon    = 0.0f;
+        float NormalEpsilon   = 0.0f;
+        float ColorEpsilon    = 0.0f;
+    };
+
+
+    /**
+     * Post-transform vertex cache efficiency of a triangle order,
+     * simulated with a FIFO cache like the GPU uses
+     */
+    struct VertexCacheStats
+    {
+        float ACMR = 0.0f; // Average Cache Miss Ratio: transformed vertices per triangle, 0.5 is ideal, 3 is the worst
+        float ATVR = 0.0f; // Average Transformed Vertex Ratio: transformed vertices per unique vertex, 1 is ideal
+    };
+
+    struct VertexCacheReport
+    {
+        VertexCacheStats Before;
+        VertexCacheStats After;
+    };
+
+
+    /**
+     * Overdraw of a triangle order, estimated by rasterizing the group from
+     * the 6 axis directions with back face culling and an early depth test
+     */
+    struct OverdrawStats
+    {
+        float Overdraw = 0.0f; // shaded pixels per covered pixel, 1 is ideal
+        int PixelsCovered = 0;
+        int PixelsShaded  = 0;
+    };
+
+
+    struct SimplifyOptions
+    {
+        // stop once this fraction of the triangles is left, 0 to only stop at MaxError
+        float TargetRatio = 0.5f;
+        // stop once this many triangles are left, overrides TargetRatio if > 0
+        int TargetTris = 0;
+        // error budget, relative to the largest side of the group bounding box: 0.01 is 1%
+        float MaxError = 0.01f;
+    };
+
+    // One level of detail of a MeshGroup, indexing the layers of the group it was created from
+    struct MeshLod
+    {
+        std::vector<Triangle> Tris;
+        float Error = 0.0f; // relative error, same units as SimplifyOptions::MaxError
+    };
+
+
     enum class FaceWinding
     {
         CW, // ClockWise face winding
@@ -310,10 +436,22 @@ namespace Nano
 
         // Recalculates all normals by find shared and non-shared vertices on the same pos
         // Currently does not respect smoothing groups
-        // @param checkDuplicateVerts Will perform an O(n^2) search for duplicate vertices to
-        //                            correctly calculate normals for mesh surfaces with unwelded verts
+        // @param checkDuplicateVerts Will smooth normals across duplicate vertices to correctly
+        //                            calculate normals for mesh surfaces with unwelded verts,
+        //                            same as RecalculateWeldedNormals()
         void RecalculateNormals(const bool checkDuplicateVerts = false) noexcept;
 
+        // Recalculates all normals so that every vertex on the same position gets the same
+        // smoothed normal, even if the mesh has unwelded duplicate vertices.
+        // Positions are hashed into weld classes, so this runs in linear time.
+        // @param weldEpsilon Positions in the same weldEpsilon sized grid cell are welded, 0 for exact matches only
+        void RecalculateWeldedNormals(float weldEpsilon = 0.0f) noexcept;
+
+        // Equivalent to RecalculateNormals(false) within float rounding, but face normals are
+        // calculated and accumulated on multiple threads. The result is identical for any number of threads.
+        // @param numThreads Max number of threads, 0 uses GetMaxThreads()
+        void RecalculateNormalsParallel(int numThreads = 0) noexcept;
+
         // Retrieves surface normals from selection
         // @note The mesh must have PerVertex normals!
         rpp::Vector3 GetNormalForSelection(const std::vector<WeightId>& selection) const noexcept;
@@ -341,15 +479,74 @@ namespace Nano
         // @note If you called FlattenMeshData() before this, then optimal vertex sharing is not possible
         void CreateGameVertexData(std::vector<BasicVertex>& vertices, std::vector<int>& indices) const noexcept;
 
+        // Same as CreateGameVertexData(), but the vertex attributes are quantized into a
+        // compact GPU vertex format, which roughly halves vertex memory and bandwidth
+        // @see QuantizedVertexData for the vertex layout and how to dequantize it
+        void CreateQuantizedVertexData(QuantizedVertexData& out, const QuantizeOptions& options = {}) const noexcept;
+
         // splits vertices that share an UV seam - this is required for non-contiguos UV support
-        void SplitSeamVertices() noexcept;
+        // new vertices are created in first use order, so the result is the same for any numThreads
+        // @param numThreads Max number of threads, large groups are split on up to this many threads
+        void SplitSeamVertices(int numThreads = 1) noexcept;
 
         // converts coords, normals, colors to MapPerVertex
         void PerVertexFlatten() noexcept;
 
+        // Merges duplicate positions, UVs, normals and colors within the WeldOptions tolerances.
+        // A spatial hash grid finds the duplicates, so this runs in near-linear time.
+        // Vertices are only merged if their PerVertex layers (Colors, Weights, BlendIndices,
+        // BlendWeights and PerVertex Coords/Normals) also match, other layers are merged on their own.
+        // The remaining elements keep their original order and Tris are remapped.
+        void WeldVertices(const WeldOptions& opt = {}) noexcept;
+
+        // Simulates a FIFO post-transform vertex cache with `cacheSize` entries over Tris.
+        // Every unique VertexDescr is one GPU vertex, which is vd.v after OptimizedFlatten()
+        VertexCacheStats AnalyzeVertexCache(int cacheSize = 16) const noexcept;
+
+        // Reorders Tris for the post-transform vertex cache with the linear time Tipsify algorithm.
+        // Vertex data and face winding are not changed. If the new order doesn't lower the ACMR,
+        // the original order is kept.
+        // @return Vertex cache efficiency before and after
+        VertexCacheReport OptimizeVertexCache(int cacheSize = 16) noexcept;
+
+        // Estimates the overdraw of Tris in their current order, offline with a small software
+        // rasterizer which renders the group from the 6 axis directions at `resolution`^2 pixels
+        OverdrawStats AnalyzeOverdraw(int resolution = 256) const noexcept;
+
+        // Reorders Tris to reduce overdraw, run this after OptimizeVertexCache().
+        // The vertex cache ordered stream is split into clusters, which are sorted so that
+        // clusters on the outside of the group facing away from its center are drawn first.
+        // @param threshold Max allowed ACMR regression, 1.05 allows a 5% worse ACMR. Higher
+        //                  values give smaller clusters, so more freedom to reduce overdraw.
+        //                  If the ACMR would regress more, the original order is kept.
+        // @return Vertex cache efficiency before and after
+        VertexCacheReport OptimizeOverdraw(float threshold = 1.05f, int cacheSize = 16) noexcept;
+
+        // Reorders Verts and every PerVertex layer into the first use order of Tris, so vertex
+        // fetch and passes over Tris access memory mostly sequentially. Run this after
+        // OptimizeVertexCache() and OptimizeOverdraw(), because it depends on the triangle order.
+        // Independently indexed layers get their own first use order, unused elements go last.
+        // @return Remap table from old to new vertexId, for fixing up external per vertex data
+        std::vector<int> OptimizeVertexFetch() noexcept;
+
+        // Reduces the number of Tris with quadric error metric edge collapses, until the target
+        // triangle count is reached or no edge can be collapsed within the error budget.
+        // Edges collapse onto one of their vertices, so Verts and the other layers are left
+        // untouched and removed vertices simply become unused.
+        // UV seams, hard normal edges, color borders and open group borders are kept exactly.
+        // @return Relative error of the result, 0 if nothing was collapsed
+        float Simplify(const SimplifyOptions& opt = {}) noexcept;
+
+        // Creates `numLevels` levels of detail in one call, level 0 is the current Tris and every
+        // following level targets `reduction` times the triangles of the previous one.
+        // All levels index the vertex data of this group, so one vertex buffer serves every level.
+        // Fewer levels are returned if the error budget doesn't allow further reduction.
+        std::vector<MeshLod> CreateLodChain(int numLevels, float reduction = 0.5f,
+                                            float maxError = 0.01f) const noexcept;
+
         // Optimally flattens this mesh by using:
         // SplitSeamVertices() && PerVertexFlatten()
-        void OptimizedFlatten() noexcept;
+        void OptimizedFlatten(int numThreads = 1) noexcept;
 
         void CreateIndexArray(std::vector<int>& indices) const noexcept;
         void CreateIndexArray(std::vector<short>& indices) const noexcept;
@@ -450,6 +647,51 @@ namespace Nano
          * + CoordSys::Unity
          */
         Unity = (1 << 8),
+
+        /**
+         * LOAD:
+         * Parse the mesh file, decode compressed .nmesh sections and split seam vertices
+         * on multiple worker threads.
+         * The loaded mesh is identical to the single-threaded result.
+         * SAVE:
+         * Format the OBJ text or encode compressed .nmesh sections on multiple worker threads,
+         * the saved file is identical to the single-threaded result.
+         * @see Nano::SetMaxThreads()
+         */
+        Parallel = (1 << 9),
+
+        /**
+         * LOAD:
+         * Memory map text mesh and material files instead of reading them into
+         * a heap buffer, so the parsers work directly on the OS page cache.
+         * Files over 2GB are mapped as well, the OBJ parser reads them in windows.
+         * Falls back to buffered reads if the file can't be mapped.
+         */
+        MemoryMap = (1 << 10),
+
+        /**
+         * SAVE:
+         * Compress the vertex and triangle layers of .nmesh files with the
+         * lossless mesh codec, typically to 20-40% of their raw size.
+         * Compressed files are detected automatically during LOAD.
+         * @see Nano/MeshCodec.h
+         */
+        Compress = (1 << 11),
+
+        /**
+         * LOAD:
+         * STL: Merge triangle corners with bitwise identical positions into shared
+         * vertices with a hash table, instead of 3 unique vertices per triangle.
+         */
+        WeldPositions = (1 << 12),
+
+        /**
+         * LOAD:
+         * Reorder the triangles of every group for the post-transform vertex cache,
+         * after SplitSeams and Flatten. Cached and saved meshes keep the optimized order.
+         * @see MeshGroup::OptimizeVertexCache()
+         */
+        OptimizeVertexCache = (1 << 13),
     };
 
     inline Options operator|(Options a, Options b)
@@ -469,6 +711,41 @@ namespace Nano
 
     NANOMESH_API std::string to_string(Options o);
 
+    /**
+     * Sets the maximum number of threads used by parallel mesh operations,
+     * such as Options::Parallel loading.
+     * @param maxThreads Max number of threads, 0 resets to std::thread::hardware_concurrency()
+     */
+    NANOMESH_API void SetMaxThreads(int maxThreads) noexcept;
+
+    // @return Maximum number of threads used by parallel mesh operations, always >= 1
+    NANOMESH_API int GetMaxThreads() noexcept;
+
+    /**
+     * OBJ loaders share parsed .mtl files through a process-wide cache, keyed by
+     * the full path of the .mtl file. A cached library is reloaded if the file
+     * modification time or size changes.
+     * Meshes loaded from the same .mtl share the same Material instances,
+     * use Mesh::Clone(true) to get private copies before modifying them.
+     * This releases all cached libraries, materials in use by meshes stay alive.
+     */
+    NANOMESH_API void ClearMaterialCache() noexcept;
+
+    /**
+     * Enables the on-disk derived data cache of Mesh::Load().
+     * Every loaded and post-processed mesh is stored as a .nmesh file in `cacheDir`,
+     * keyed by a content hash of the source file and its .mtl libraries, the load options
+     * which change the result and the cache version. A cache hit skips parsing and all
+     * load options, stale entries are detected by their hash and rebuilt automatically.
+     * Cache failures never fail a load, the mesh is just loaded from its source instead.
+     * @note Cached meshes don't share Material instances through ClearMaterialCache()'s cache
+     * @param cacheDir Cache directory, created on demand. Empty disables the cache (default)
+     */
+    NANOMESH_API void SetMeshCacheDir(rpp::strview cacheDir);
+
+    // @return Directory of the derived data cache, empty if the cache is disabled
+    NANOMESH_API std::string GetMeshCacheDir();
+
     /**
      * Load/Save errors
      */
@@ -480,6 +757,51 @@ namespace Nano
     //////////////////////////////////////////////////////////////////////
 
 
+    class MeshLoadHandle;
+    class MeshLoadPool;
+
+    /**
+     * Reusable scratch memory for loading many meshes in a row.
+     * Keeps the file read buffer, parser buffers and group remap tables
+     * alive between loads, so steady-state loading makes very few heap allocations.
+     * Usage:
+     *     Nano::MeshLoadContext ctx;
+     *     for (const std::string& path : paths)
+     *         if (mesh.Load(path, Options::None, ctx)) { ... }
+     * @note Only OBJ loading uses the context, other formats ignore it.
+     * @note A context must not be used by multiple loads at the same time.
+     */
+    class NANOMESH_API MeshLoadContext
+    {
+    public:
+        /**
+         * If TRUE, the MeshGroups of the target Mesh are recycled on the next load,
+         * so their vectors and names keep their capacity instead of being freed.
+         */
+        bool ReuseMeshCapacity = true;
+
+        MeshLoadContext();
+        ~MeshLoadContext();
+
+        MeshLoadContext(MeshLoadContext&&) noexcept;
+        MeshLoadContext& operator=(MeshLoadContext&&) noexcept;
+        MeshLoadContext(const MeshLoadContext&) = delete;
+        MeshLoadContext& operator=(const MeshLoadContext&) = delete;
+
+        // Frees all scratch memory retained by this context
+        void Release() noexcept;
+
+        // @return Number of bytes of scratch memory currently retained
+        size_t CapacityBytes() const noexcept;
+
+        struct Impl; // internal scratch buffers
+        Impl* GetImpl() const noexcept { return impl.get(); }
+
+    private:
+        std::unique_ptr<Impl> impl;
+    };
+
+
     /**
      * Mesh coordinate system is the OPENGL coordinate system
      * +X is Right on the screen, +Y is Up, +Z is INTO the screen
@@ -569,17 +891,45 @@ namespace Nano
          * @return If !NoExceptions, returns TRUE on SUCCESS
          */
         bool Load(rpp::strview meshPath, Options opt = {});
+
+        /**
+         * Loads this mesh, reusing the scratch memory and mesh groups from `ctx`
+         * @see MeshLoadContext
+         */
+        bool Load(rpp::strview meshPath, Options opt, MeshLoadContext& ctx);
+
+        /**
+         * Queues this mesh for loading on a worker pool and returns immediately.
+         * @param pool [optional] Pool to load on, default is MeshLoadPool::Default()
+         * @see MeshLoadHandle
+         */
+        static MeshLoadHandle LoadAsync(rpp::strview meshPath, Options opt = {}, MeshLoadPool* pool = nullptr);
         
     private:
         void ApplyLoadOptions(Options opt);
+        bool Load(rpp::strview meshPath, Options opt, MeshLoadContext* ctx);
+        bool LoadSource(rpp::strview meshPath, Options opt, MeshLoadContext* ctx);
+        bool LoadOBJ(rpp::strview meshPath, Options opt, MeshLoadContext* ctx);
+        bool LoadBinaryFBX(rpp::strview meshPath, Options opt);
 
     public:
         bool SaveAs(rpp::strview meshPath, Options opt = {}) const;
 
-        // Is FBX supported on this platform?
+        // Is FBX loading supported on this platform? SaveAsFBX also needs ENABLE_FBX_MESH_LOADER
         static bool IsFBXSupported() noexcept;
+
+        /**
+         * With ENABLE_FBX_MESH_LOADER all FBX files are loaded with the FBX SDK.
+         * Otherwise binary FBX 7.x files are loaded with a built-in reader which
+         * can load any number of files concurrently. Compressed arrays are
+         * decompressed in parallel with Options::Parallel.
+         * Every mesh model becomes a group named after the model, LimbNodes become Bones.
+         * The built-in reader only applies the local transform of each model,
+         * and ASCII FBX files always need the SDK.
+         */
         bool LoadFBX(rpp::strview meshPath, Options opt = {});
         bool LoadOBJ(rpp::strview meshPath, Options opt = {});
+        bool LoadOBJ(rpp::strview meshPath, Options opt, MeshLoadContext& ctx);
         
         /**
          * A simple custom mesh text format, which is similar to OBJ
@@ -588,16 +938,55 @@ namespace Nano
          */
         bool LoadTXT(rpp::strview meshPath, Options opt = {});
 
+        /**
+         * Native binary format, which stores the mesh data exactly as it is in memory.
+         * Loading it is a bulk copy of each layer from a memory mapped file.
+         * Load options such as SplitSeams or Flatten are applied after loading.
+         */
+        bool LoadNMESH(rpp::strview meshPath, Options opt = {});
+
+        /**
+         * glTF 2.0 binary (.glb), every mesh primitive becomes a group named after its node.
+         * Vertex layers are copied straight out of the memory mapped binary chunk
+         * where the accessor layout matches the MeshGroup layer.
+         * Skins and animations are loaded into Bones, SkinnedBones and AnimationClips.
+         * Load options such as SplitSeams or Flatten are applied after loading.
+         */
+        bool LoadGLB(rpp::strview meshPath, Options opt = {});
+
+        /**
+         * Binary PLY (little or big endian), as written by 3D scanners.
+         * Vertex records are decoded in bulk from big file blocks, so files over 2GB work.
+         * All elements go into a single group, polygons are triangulated as fans.
+         */
+        bool LoadPLY(rpp::strview meshPath, Options opt = {});
+
+        /**
+         * Binary STL triangle soup, where every triangle has 3 vertices of its own.
+         * Use Options::WeldPositions to merge the identical corner positions.
+         */
+        bool LoadSTL(rpp::strview meshPath, Options opt = {});
+
         bool SaveAsFBX(rpp::strview meshPath, Options opt = {}) const;
         bool SaveAsOBJ(rpp::strview meshPath, Options opt = {}) const;
+        bool SaveAsNMESH(rpp::strview meshPath, Options opt = {}) const;
+        bool SaveAsGLB(rpp::strview meshPath, Options opt = {}) const;
+        bool SaveAsPLY(rpp::strview meshPath, Options opt = {}) const;
+        bool SaveAsSTL(rpp::strview meshPath, Options opt = {}) const;
         // bool SaveAsTxt(strview meshPath, Options opt = {}) const;
 
         // Recalculates all normals by find shared and non-shared vertices on the same pos
         // Currently does not respect smoothing groups
-        // @param checkDuplicateVerts Will perform an O(n^2) search for duplicate vertices to
-        //                            correctly calculate normals for mesh surfaces with unwelded verts
+        // @param checkDuplicateVerts Will smooth normals across duplicate vertices to correctly
+        //                            calculate normals for mesh surfaces with unwelded verts
         void RecalculateNormals(bool checkDuplicateVerts = false) noexcept;
 
+        // @see MeshGroup::RecalculateWeldedNormals()
+        void RecalculateWeldedNormals(float weldEpsilon = 0.0f) noexcept;
+
+        // @see MeshGroup::RecalculateNormalsParallel()
+        void RecalculateNormalsParallel(int numThreads = 0) noexcept;
+
         // normal = -normal;
         void InvertNormals() noexcept;
 
@@ -607,7 +996,23 @@ namespace Nano
         // Optionally appends an extra offset to position vertices
         void AddMeshData(const Mesh& mesh, rpp::Vector3 offset = rpp::Vector3::Zero()) noexcept;
 
-        void SplitSeamVertices() noexcept;
+        // @see MeshGroup::SplitSeamVertices()
+        void SplitSeamVertices(int numThreads = 1) noexcept;
+
+        // @see MeshGroup::WeldVertices()
+        void WeldVertices(const WeldOptions& opt = {}) noexcept;
+
+        // @see MeshGroup::OptimizeVertexCache()
+        void OptimizeVertexCache(int cacheSize = 16) noexcept;
+
+        // @see MeshGroup::OptimizeOverdraw()
+        void OptimizeOverdraw(float threshold = 1.05f, int cacheSize = 16) noexcept;
+
+        // @see MeshGroup::OptimizeVertexFetch()
+        void OptimizeVertexFetch() noexcept;
+
+        // @see MeshGroup::Simplify()
+        void Simplify(const SimplifyOptions& opt = {}) noexcept;
 
         // Flattens all mesh data, so MapMode is MapPerFaceVertex
         // This will make the mesh data compatible with any 3D graphics engine out there
@@ -622,7 +1027,7 @@ namespace Nano
         // Optimized flatten is:
         // + g.SplitSeamVertices()
         // + g.PerVertexFlatten()
-        void OptimizedFlatten() noexcept;
+        void OptimizedFlatten(int numThreads = 1) noexcept;
 
         // Sets the face winding to all groups
         void SetFaceWinding(FaceWinding winding) noexcept;
@@ -641,6 +1046,169 @@ namespace Nano
     };
 
     //////////////////////////////////////////////////////////////////////
+
+    /**
+     * Working memory limits for Nano::StreamOBJ()
+     */
+    struct NANOMESH_API ObjStreamOptions
+    {
+        // File is read in windows of this many bytes.
+        // A single line longer than this will grow the window.
+        int WindowSize = 4 * 1024 * 1024;
+
+        // The window never grows past this many bytes,
+        // a longer line fails the stream.
+        int MaxWindowSize = 64 * 1024 * 1024;
+
+        // Max number of triangles buffered before a partial group is emitted,
+        // 0 buffers each group until it is complete.
+        int MaxBatchTris = 256 * 1024;
+    };
+
+    /**
+     * Receives each completed mesh group or triangle batch from Nano::StreamOBJ().
+     * The group data can be moved out of `group`.
+     * @return FALSE to stop streaming
+     */
+    using MeshGroupCallback = std::function<bool(MeshGroup& group)>;
+
+    /**
+     * Streams an OBJ file through a fixed size window and emits each mesh group
+     * to `onGroup` as soon as it is complete, without building the whole Mesh.
+     * Each emitted group is built the same way as in Mesh::LoadOBJ(),
+     * and load options such as SplitSeams, Flatten, ClockWise and Unity are applied per group.
+     *
+     * @note OBJ face indices are global, so all v/vt/vn elements parsed so far are kept
+     *       until the end of the file and memory grows with the element count.
+     *       Only the file text window and the buffered triangles are capped,
+     *       and each group's triangles are released as soon as it is emitted.
+     * @note A group is emitted in several parts with the same GroupId and Name
+     *       if it is split by usemtl, repeated later in the file, or exceeds MaxBatchTris.
+     * @return TRUE if the file was streamed, even if `onGroup` stopped early.
+     *         On failure, throws MeshIOError unless Options::NoThrow is set.
+     */
+    NANOMESH_API bool StreamOBJ(rpp::strview meshPath, const MeshGroupCallback& onGroup,
+                                const ObjStreamOptions& streamOpt = {}, Options opt = {});
+
+    //////////////////////////////////////////////////////////////////////
+
+    enum class MeshLoadStatus
+    {
+        Queued,    // waiting for a free slot in the pool
+        Loading,   // currently being loaded
+        Loaded,    // finished successfully
+        Failed,    // finished with an error, see MeshLoadHandle::Error()
+        Cancelled, // cancelled before it was started
+    };
+
+    /**
+     * Handle to an asynchronous mesh load, returned by Mesh::LoadAsync() or MeshLoadPool::Load()
+     * Copies of a handle refer to the same load.
+     */
+    class NANOMESH_API MeshLoadHandle
+    {
+    public:
+        struct State;
+
+        MeshLoadHandle() noexcept = default;
+        explicit MeshLoadHandle(std::shared_ptr<State> state) noexcept;
+
+        // @return TRUE if this handle refers to a load
+        explicit operator bool() const noexcept { return state != nullptr; }
+
+        MeshLoadStatus Status() const noexcept;
+
+        // @return TRUE if the load is Loaded, Failed or Cancelled
+        bool IsReady() const noexcept;
+
+        /**
+         * Blocks until the load is ready
+         * @return TRUE if the mesh was loaded successfully
+         */
+        bool Wait() const;
+
+        /**
+         * Blocks until the load is ready or until the timeout expires
+         * @return TRUE if the load is ready
+         */
+        bool WaitFor(double seconds) const;
+
+        /**
+         * Cancels the load if it hasn't started yet, a running load can't be cancelled.
+         * @return TRUE if the load was cancelled
+         */
+        bool Cancel() noexcept;
+
+        // @return Error message if the load Failed or was Cancelled
+        std::string Error() const;
+
+        /**
+         * Blocks until the load is ready and returns the loaded mesh.
+         * On failure, throws MeshIOError unless Options::NoThrow was set,
+         * in which case an empty mesh is returned.
+         */
+        Mesh& Get();
+
+    private:
+        std::shared_ptr<State> state;
+    };
+
+    /**
+     * Loads meshes on background threads, with at most MaxInFlight loads running at a time.
+     * The rest are queued and started in the order they were requested.
+     *
+     * By default the pool runs its own worker threads, but loads can also be
+     * handed to a user-supplied executor, e.g. the job system of an engine.
+     */
+    class NANOMESH_API MeshLoadPool
+    {
+    public:
+        using Task = std::function<void()>;
+        using Executor = std::function<void(Task task)>;
+
+        /**
+         * Creates a pool with its own worker threads, started on demand
+         * @param maxInFlight Max number of concurrent loads, 0 uses GetMaxThreads()
+         */
+        explicit MeshLoadPool(int maxInFlight = 0);
+
+        /**
+         * Creates a pool that runs each load as a task on `executor`,
+         * with at most `maxInFlight` tasks submitted at a time
+         */
+        MeshLoadPool(Executor executor, int maxInFlight);
+
+        // Cancels all queued loads and waits for the running ones to finish
+        ~MeshLoadPool();
+
+        MeshLoadPool(const MeshLoadPool&) = delete;
+        MeshLoadPool& operator=(const MeshLoadPool&) = delete;
+
+        // Queues a new load
+        MeshLoadHandle Load(rpp::strview meshPath, Options opt = {});
+
+        // Changes the max number of concurrent loads, running loads are not interrupted
+        void SetMaxInFlight(int maxInFlight);
+        int GetMaxInFlight() const noexcept;
+
+        // @return Number of loads waiting to be started
+        int NumQueued() const noexcept;
+
+        // @return Number of loads currently running
+        int NumInFlight() const noexcept;
+
+        // Blocks until there are no queued or running loads
+        void WaitAll();
+
+        // Shared pool used by Mesh::LoadAsync(), with its own worker threads
+        static MeshLoadPool& Default();
+
+        struct Impl;
+    private:
+        std::unique_ptr<Impl> impl;
+    };
+
+    //////////////////////////////////////////////////////////////////////
 }
 
 #if _MSC_VER
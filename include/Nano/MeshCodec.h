@@ -0,0 +1,55 @@
+#pragma once
+/**
+ * Lossless codec for the vertex and index layers of a MeshGroup,
+ * used by compressed .nmesh files (Options::Compress).
+ *
+ * Vertex layers store each float component as the zig-zag delta of its order preserving
+ * integer bits, as varints in the Stream VByte layout. Triangles are predicted from the
+ * edges of recently coded triangles and a small FIFO of recent corners, so a typical
+ * triangle takes 2-6 bytes instead of 48. Both can add an order-0 rANS entropy stage.
+ * Decoding is scalar: the Stream VByte layout would allow a SIMD shuffle decoder,
+ * but each value is a delta of the previous element, so values are decoded one by one.
+ * The entropy stage is a few times slower than the plain stages.
+ * @note Encoded data is little endian, like .nmesh files
+ */
+#include "Mesh.h"
+#include <cstdint>
+
+namespace Nano
+{
+    //////////////////////////////////////////////////////////////////////
+
+    /**
+     * Encodes a layer of float vectors, such as MeshGroup::Verts or Normals
+     * @param values numElements * numComponents floats
+     * @param numComponents Number of floats per element, 1..4
+     * @param out Receives the encoded layer
+     * @param entropy Try the entropy stage, it's only kept if it makes the layer 1/8 smaller
+     */
+    NANOMESH_API void EncodeVertexLayer(const float* values, size_t numElements, int numComponents,
+                                        std::vector<uint8_t>& out, bool entropy = false);
+
+    /**
+     * Decodes a layer written by EncodeVertexLayer()
+     * @return FALSE if the data is corrupted or doesn't hold numElements * numComponents floats
+     */
+    NANOMESH_API bool DecodeVertexLayer(const uint8_t* data, size_t size, float* values,
+                                        size_t numElements, int numComponents);
+
+    /**
+     * Encodes triangle face descriptors, such as MeshGroup::Tris.
+     * Triangles sharing edges with their predecessors compress best, which is
+     * the natural order of most meshes.
+     * @param entropy Try the entropy stage, it's only kept if it makes the data 1/8 smaller
+     */
+    NANOMESH_API void EncodeTriangles(const Triangle* tris, size_t numTris,
+                                      std::vector<uint8_t>& out, bool entropy = false);
+
+    /**
+     * Decodes triangles written by EncodeTriangles()
+     * @return FALSE if the data is corrupted or doesn't hold numTris triangles
+     */
+    NANOMESH_API bool DecodeTriangles(const uint8_t* data, size_t size, Triangle* tris, size_t numTris);
+
+    //////////////////////////////////////////////////////////////////////
+}
@@ -91,6 +91,37 @@ struct NANOMESH_API NanoMeshGroup
     void InitVerts();
 };
 
+/**
+ * Quantized game vertex data of a mesh group
+ * @see Nano::QuantizedVertexData for the vertex layout
+ */
+struct NANOMESH_API NanoQuantizedVertices
+{
+    // publicly visible in C#
+    NanoArrayView<uint8_t> Vertices; // NumVertices * Stride bytes
+    NanoArrayView<int>     Indices;
+    int NumVertices = 0;
+    int Stride = 0;
+    int NormalByteOffset = 0;
+    int CoordByteOffset  = 0;
+    int ColorByteOffset  = -1;
+    Nano::NormalQuantization NormalFormat = Nano::NormalQuantization::Snorm16;
+    Nano::CoordQuantization  CoordFormat  = Nano::CoordQuantization::Half;
+    rpp::Vector3 PosOffset   = rpp::Vector3::Zero();
+    rpp::Vector3 PosScale    = rpp::Vector3::Zero();
+    rpp::Vector2 CoordOffset = rpp::Vector2::Zero();
+    rpp::Vector2 CoordScale  = rpp::Vector2::One();
+    float MaxPosError    = 0.0f;
+    float MaxNormalError = 0.0f; // DEGREES
+    float MaxCoordError  = 0.0f;
+    float MaxColorError  = 0.0f;
+
+    // not mapped to C#
+    Nano::QuantizedVertexData Data;
+
+    explicit NanoQuantizedVertices(const Nano::MeshGroup& group, const Nano::QuantizeOptions& options);
+};
+
 struct NANOMESH_API NanoMesh
 {
     // publicly visible in C#
@@ -120,6 +151,11 @@ NANOMESH_CAPI NanoMesh*      NanoMeshCreateEmpty(const char* meshname);
 NANOMESH_CAPI bool           NanoMeshSave(NanoMesh* mesh, const char* filename);
 NANOMESH_CAPI NanoMeshGroup* NanoMeshNewGroup(NanoMesh* mesh, const char* groupname);
 
+NANOMESH_CAPI NanoQuantizedVertices* NanoMeshGroupQuantize(NanoMeshGroup* group,
+                                                           Nano::NormalQuantization normals,
+                                                           Nano::CoordQuantization coords);
+NANOMESH_CAPI void NanoQuantizedVerticesClose(NanoQuantizedVertices* vertices);
+
 NANOMESH_CAPI void NanoMeshGroupSetMaterial(
                 NanoMeshGroup* group,
                 const char* name,
@@ -0,0 +1,119 @@
+#include "BinaryFile.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    BinaryFileReader::BinaryFileReader(rpp::strview path)
+        : file{ path, rpp::file::READONLY }
+    {
+        if (file)
+        {
+            fileSize = file.sizel();
+            buffer.resize(BlockSize);
+        }
+    }
+
+    bool BinaryFileReader::Fill(size_t n)
+    {
+        if (!file || n > BlockSize)
+            return false;
+        // keep the unread tail, then top up the buffer with the next block
+        size_t remaining = end - pos;
+        if (pos != 0 && remaining != 0)
+            memmove(buffer.data(), buffer.data() + pos, remaining);
+        pos = 0;
+        end = remaining;
+        while (end < n)
+        {
+            int bytesRead = file.read(buffer.data() + end, int(BlockSize - end));
+            if (bytesRead <= 0)
+                return false;
+            end += (size_t)bytesRead;
+        }
+        return true;
+    }
+
+    size_t BinaryFileReader::ReadRecords(size_t recordSize, size_t maxRecords, const uint8_t*& records)
+    {
+        // Fill() tops up the whole block, not just one record
+        if (end - pos < recordSize && !Fill(recordSize))
+            return 0;
+        size_t count = std::min((end - pos) / recordSize, maxRecords);
+        records = buffer.data() + pos;
+        pos += count * recordSize;
+        return count;
+    }
+
+    bool BinaryFileReader::Skip(uint64_t n)
+    {
+        while (n > 0)
+        {
+            if (pos == end && !Fill(1))
+                return false;
+            size_t step = (size_t)std::min<uint64_t>(n, end - pos);
+            pos += step;
+            n -= step;
+        }
+        return true;
+    }
+
+    bool BinaryFileReader::ReadLine(std::string& line, size_t maxLength)
+    {
+        line.clear();
+        for (;;)
+        {
+            const uint8_t* c = Read(1);
+            if (!c)
+                return !line.empty();
+            if (*c == '\n')
+                break;
+            if (line.size() >= maxLength)
+                return false;
+            line += (char)*c;
+        }
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    BinaryFileWriter::BinaryFileWriter(rpp::strview path)
+        : file{ path, rpp::file::CREATENEW }
+    {
+        buffer.reserve(BlockSize);
+    }
+
+    void BinaryFileWriter::Write(const void* data, size_t n)
+    {
+        if (buffer.size() + n > BlockSize)
+            Flush();
+        if (n > BlockSize) // too big to buffer
+        {
+            const uint8_t* p = (const uint8_t*)data;
+            while (n > 0 && !failed)
+            {
+                int chunk = (int)std::min<size_t>(n, INT_MAX / 2);
+                failed |= file.write(p, chunk) != chunk;
+                p += chunk;
+                n -= (size_t)chunk;
+            }
+            return;
+        }
+        buffer.insert(buffer.end(), (const uint8_t*)data, (const uint8_t*)data + n);
+    }
+
+    bool BinaryFileWriter::Flush() noexcept
+    {
+        if (!buffer.empty() && file && !failed)
+            failed |= file.write(buffer.data(), (int)buffer.size()) != (int)buffer.size();
+        buffer.clear();
+        return file && !failed;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <rpp/file_io.h>
+#include <rpp/strview.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Sequential reader for large binary mesh files (PLY, STL).
+     * The file is read in big blocks, so fixed-size records are decoded straight
+     * out of the block buffer and files larger than 2GB are not a problem,
+     * without mapping or buffering the whole file like FileSource.
+     */
+    class BinaryFileReader
+    {
+        rpp::file file;
+        std::vector<uint8_t> buffer;
+        size_t pos = 0; // read position in buffer
+        size_t end = 0; // end of valid data in buffer
+        int64_t fileSize = 0;
+
+    public:
+        static constexpr size_t BlockSize = 4 * 1024 * 1024;
+
+        explicit BinaryFileReader(rpp::strview path);
+
+        // @return TRUE if the file was opened successfully
+        explicit operator bool() const noexcept { return (bool)file; }
+
+        int64_t FileSize() const noexcept { return fileSize; }
+
+        /**
+         * @param n Number of bytes to look at, must be <= BlockSize
+         * @return Pointer to the next `n` bytes without consuming them, nullptr if the file ends before that
+         */
+        const uint8_t* Peek(size_t n)
+        {
+            if (end - pos >= n)
+                return buffer.data() + pos;
+            return Fill(n) ? buffer.data() + pos : nullptr;
+        }
+
+        // @return Pointer to the next `n` bytes, nullptr if the file ends before that
+        const uint8_t* Read(size_t n)
+        {
+            const uint8_t* p = Peek(n);
+            if (p) pos += n;
+            return p;
+        }
+
+        /**
+         * Reads as many whole records as are available in the buffer, up to maxRecords
+         * @param records Receives a pointer to the first record
+         * @return Number of records read, 0 at the end of file
+         */
+        size_t ReadRecords(size_t recordSize, size_t maxRecords, const uint8_t*& records);
+
+        /**
+         * Skips `n` bytes
+         * @return FALSE if the file ends before that
+         */
+        bool Skip(uint64_t n);
+
+        /**
+         * Reads a text line, for the headers of binary formats
+         * @return FALSE at the end of file or if the line is longer than maxLength
+         */
+        bool ReadLine(std::string& line, size_t maxLength = 4096);
+
+    private:
+        bool Fill(size_t n);
+    };
+
+    /**
+     * Sequential writer which collects small records into big blocks before writing them
+     */
+    class BinaryFileWriter
+    {
+        rpp::file file;
+        std::vector<uint8_t> buffer;
+        bool failed = false;
+
+    public:
+        static constexpr size_t BlockSize = 4 * 1024 * 1024;
+
+        explicit BinaryFileWriter(rpp::strview path);
+        ~BinaryFileWriter() noexcept { Flush(); }
+
+        // @return TRUE if the file was created successfully
+        explicit operator bool() const noexcept { return (bool)file; }
+
+        // @return Pointer to `n` bytes of the output which must be written immediately
+        uint8_t* Reserve(size_t n)
+        {
+            if (buffer.size() + n > BlockSize)
+                Flush();
+            size_t offset = buffer.size();
+            buffer.resize(offset + n);
+            return buffer.data() + offset;
+        }
+
+        void Write(const void* data, size_t n);
+
+        template<class T> void Write(const T& value) { Write(&value, sizeof(T)); }
+
+        /**
+         * Writes all buffered data to the file
+         * @return FALSE if any write has failed
+         */
+        bool Flush() noexcept;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,314 @@
+#include "FbxBinary.h"
+#include <rpp/file_io.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include "Inflate.h"
+#include "Parallel.h"
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * FBX binary layout, all values are little endian:
+     *
+     *   char   magic[23]   "Kaydara FBX Binary  \0\x1A\0"
+     *   uint32 version     7100, 7400, 7500 ...
+     *   NodeRecord[]       top level nodes, terminated by a null record
+     *   footer             ignored
+     *
+     * NodeRecord:
+     *   uint32/64 endOffset       absolute offset of the next record, 0 for a null record
+     *   uint32/64 numProperties
+     *   uint32/64 propertyListLen
+     *   uint8     nameLen
+     *   char      name[nameLen]
+     *   Property  properties[numProperties]
+     *   NodeRecord children[]     terminated by a null record, if there are any
+     *
+     * The offsets are 64-bit since version 7500.
+     */
+    static constexpr char FbxMagic[] = "Kaydara FBX Binary  \0\x1A"; // + implicit \0
+    static constexpr size_t FbxMagicSize = sizeof(FbxMagic);
+    static constexpr size_t FbxHeaderSize = FbxMagicSize + sizeof(uint32_t);
+    static constexpr int FbxMaxDepth = 64;
+
+    template<class T> static T ReadLE(const uint8_t* p) noexcept
+    {
+        T value; memcpy(&value, p, sizeof(T));
+        return value;
+    }
+
+    static int ArrayElementSize(char type) noexcept
+    {
+        switch (type)
+        {
+            case 'f': case 'i': return 4;
+            case 'd': case 'l': return 8;
+            case 'b':           return 1;
+            default:            return 0;
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    double FbxProperty::AsDouble() const noexcept
+    {
+        switch (Type)
+        {
+            case 'Y': case 'C': case 'I': case 'L': return (double)Int;
+            case 'F': case 'D':                     return Real;
+            default:                                return 0.0;
+        }
+    }
+
+    int64_t FbxProperty::AsInt() const noexcept
+    {
+        switch (Type)
+        {
+            case 'Y': case 'C': case 'I': case 'L': return Int;
+            case 'F': case 'D':                     return (int64_t)Real;
+            default:                                return 0;
+        }
+    }
+
+    template<class T> static bool ConvertArray(const FbxProperty& prop, std::vector<T>& out)
+    {
+        if (!prop.IsArray())
+            return false;
+        out.resize(prop.Count);
+        const uint8_t* p = prop.Array;
+        switch (prop.Type)
+        {
+            case 'f': for (T& v : out) { v = (T)ReadLE<float>(p);   p += 4; } break;
+            case 'd': for (T& v : out) { v = (T)ReadLE<double>(p);  p += 8; } break;
+            case 'i': for (T& v : out) { v = (T)ReadLE<int32_t>(p); p += 4; } break;
+            case 'l': for (T& v : out) { v = (T)ReadLE<int64_t>(p); p += 8; } break;
+            case 'b': for (T& v : out) { v = (T)*p;                 p += 1; } break;
+        }
+        return true;
+    }
+
+    bool FbxProperty::GetArray(std::vector<double>& out) const
+    {
+        if (Type == 'd' && IsArray()) // exact match, bulk copy
+        {
+            out.resize(Count);
+            if (Count) memcpy(out.data(), Array, Count * sizeof(double));
+            return true;
+        }
+        return ConvertArray(*this, out);
+    }
+
+    bool FbxProperty::GetArray(std::vector<int>& out) const
+    {
+        if (Type == 'i' && IsArray())
+        {
+            out.resize(Count);
+            if (Count) memcpy(out.data(), Array, Count * sizeof(int));
+            return true;
+        }
+        return ConvertArray(*this, out);
+    }
+
+    const FbxNode* FbxNode::Find(rpp::strview name) const noexcept
+    {
+        for (const FbxNode& child : Children)
+            if (child.Name == name)
+                return &child;
+        return nullptr;
+    }
+
+    const FbxProperty& FbxNode::Prop(size_t index) const noexcept
+    {
+        static const FbxProperty empty;
+        return index < Props.size() ? Props[index] : empty;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    bool FbxDocument::IsBinary(rpp::strview path) noexcept
+    {
+        char magic[FbxMagicSize];
+        rpp::file f { path, rpp::file::READONLY };
+        return f && f.read(magic, (int)FbxMagicSize) == (int)FbxMagicSize
+                 && memcmp(magic, FbxMagic, FbxMagicSize) == 0;
+    }
+
+    bool FbxDocument::Fail(std::string message)
+    {
+        if (Error.empty())
+            Error = std::move(message);
+        return false;
+    }
+
+    bool FbxDocument::Read(rpp::strview path, int numWorkers)
+    {
+        file = FileSource{ path, true };
+        if (!file)
+            return Fail("failed to open file");
+
+        const uint8_t* data = (const uint8_t*)file.str;
+        const uint8_t* end = data + file.len;
+        if ((size_t)file.len < FbxHeaderSize || memcmp(data, FbxMagic, FbxMagicSize) != 0)
+            return Fail("not a binary FBX file");
+
+        Version = ReadLE<uint32_t>(data + FbxMagicSize);
+        if (Version < 7000)
+            return Fail("FBX version " + std::to_string(Version) + " is not supported, only 7.x");
+        is64Bit = Version >= 7500;
+
+        const uint8_t* p = data + FbxHeaderSize;
+        while (p < end)
+        {
+            FbxNode node;
+            bool isNull = false;
+            if (!ReadNode(p, end, node, isNull, 0))
+                return false;
+            if (isNull)
+                break;
+            Root.Children.push_back(std::move(node));
+        }
+        return Decompress(numWorkers);
+    }
+
+    bool FbxDocument::ReadNode(const uint8_t*& p, const uint8_t* end, FbxNode& node, bool& isNull, int depth)
+    {
+        const uint8_t* data = (const uint8_t*)file.str;
+        const size_t headerSize = is64Bit ? 25 : 13;
+        if (size_t(end - p) < headerSize)
+            return Fail("truncated node record");
+
+        uint64_t endOffset, numProps, propsLength;
+        if (is64Bit) {
+            endOffset   = ReadLE<uint64_t>(p);
+            numProps    = ReadLE<uint64_t>(p + 8);
+            propsLength = ReadLE<uint64_t>(p + 16);
+        } else {
+            endOffset   = ReadLE<uint32_t>(p);
+            numProps    = ReadLE<uint32_t>(p + 4);
+            propsLength = ReadLE<uint32_t>(p + 8);
+        }
+        const uint8_t nameLength = p[headerSize - 1];
+        if (endOffset == 0)
+        {
+            isNull = true;
+            p += headerSize;
+            return true;
+        }
+
+        p += headerSize;
+        if (endOffset > uint64_t(end - data) || data + endOffset < p + nameLength
+            || propsLength > uint64_t(data + endOffset - p - nameLength)
+            || numProps > propsLength) // every property is at least 2 bytes
+            return Fail("corrupted node record");
+
+        const uint8_t* nodeEnd = data + endOffset;
+        node.Name = rpp::strview{ (const char*)p, (int)nameLength };
+        p += nameLength;
+
+        const uint8_t* propsEnd = p + propsLength;
+        node.Props.resize((size_t)numProps);
+        for (FbxProperty& prop : node.Props)
+            if (!ReadProperty(p, propsEnd, prop))
+                return false;
+        p = propsEnd;
+
+        while (p < nodeEnd)
+        {
+            if (depth >= FbxMaxDepth)
+                return Fail("nodes are nested too deep");
+            FbxNode child;
+            bool childIsNull = false;
+            if (!ReadNode(p, nodeEnd, child, childIsNull, depth + 1))
+                return false;
+            if (childIsNull)
+                break;
+            node.Children.push_back(std::move(child));
+        }
+        p = nodeEnd;
+        return true;
+    }
+
+    bool FbxDocument::ReadProperty(const uint8_t*& p, const uint8_t* end, FbxProperty& prop)
+    {
+        if (p >= end)
+            return Fail("truncated property");
+        prop.Type = (char)*p++;
+        const size_t avail = size_t(end - p);
+        switch (prop.Type)
+        {
+            case 'Y': if (avail < 2) break; prop.Int = ReadLE<int16_t>(p); p += 2; return true;
+            case 'C': if (avail < 1) break; prop.Int = *p;                 p += 1; return true;
+            case 'I': if (avail < 4) break; prop.Int = ReadLE<int32_t>(p); p += 4; return true;
+            case 'L': if (avail < 8) break; prop.Int = ReadLE<int64_t>(p); p += 8; return true;
+            case 'F': if (avail < 4) break; prop.Real = ReadLE<float>(p);  p += 4; return true;
+            case 'D': if (avail < 8) break; prop.Real = ReadLE<double>(p); p += 8; return true;
+            case 'S': case 'R':
+            {
+                if (avail < 4) break;
+                uint32_t length = ReadLE<uint32_t>(p);
+                if (avail - 4 < length) break;
+                prop.Str = rpp::strview{ (const char*)p + 4, (int)length };
+                p += 4 + length;
+                return true;
+            }
+            case 'f': case 'd': case 'i': case 'l': case 'b':
+            {
+                if (avail < 12) break;
+                uint32_t count    = ReadLE<uint32_t>(p);
+                uint32_t encoding = ReadLE<uint32_t>(p + 4);
+                uint32_t length   = ReadLE<uint32_t>(p + 8);
+                if (avail - 12 < length) break;
+                const uint8_t* src = p + 12;
+                p = src + length;
+
+                uint64_t size = uint64_t(count) * ArrayElementSize(prop.Type);
+                prop.Count = count;
+                prop.Array = src;
+                if (encoding == 0)
+                {
+                    if (size != length)
+                        return Fail("invalid array length");
+                    return true;
+                }
+                if (encoding != 1)
+                    return Fail("unknown array encoding " + std::to_string(encoding));
+                // deflate can't compress better than ~1032:1, don't allocate for bogus counts
+                if (size > uint64_t(length) * 1032 || size > SIZE_MAX / 2)
+                    return Fail("invalid compressed array length");
+                if (size == 0)
+                    return true;
+
+                inflated.emplace_back(new uint8_t[(size_t)size]);
+                prop.Array = inflated.back().get();
+                inflateJobs.push_back({ src, length, inflated.back().get(), (size_t)size });
+                return true;
+            }
+            default:
+                return Fail(std::string{"unknown property type '"} + prop.Type + "'");
+        }
+        return Fail("truncated property");
+    }
+
+    bool FbxDocument::Decompress(int numWorkers)
+    {
+        // biggest arrays first, so the workers finish at about the same time
+        std::sort(inflateJobs.begin(), inflateJobs.end(), [](const InflateJob& a, const InflateJob& b) {
+            return a.dstSize > b.dstSize;
+        });
+        int numJobs = (int)inflateJobs.size();
+        std::atomic<bool> ok { true };
+        ParallelFor(numJobs, std::min(numWorkers, NumWorkers(numJobs)), [&](int job, int)
+        {
+            const InflateJob& j = inflateJobs[job];
+            if (!ZlibDecompress(j.src, j.srcSize, j.dst, j.dstSize))
+                ok = false;
+        });
+        inflateJobs.clear();
+        return ok ? true : Fail("corrupted compressed array");
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <rpp/strview.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "FileSource.h"
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * A single property of an FBX node record
+     *
+     *   Y C I F D L   int16, bool, int32, float, double, int64 scalars
+     *   f d i l b     float, double, int32, int64, bool arrays, optionally zlib compressed
+     *   S R           string and raw binary data
+     */
+    struct FbxProperty
+    {
+        char Type = 0;
+        int64_t Int = 0;   // Y C I L
+        double Real = 0.0; // F D
+        rpp::strview Str;  // S R, points into the file contents
+        const uint8_t* Array = nullptr; // f d i l b, little endian and possibly unaligned
+        uint32_t Count = 0; // number of array elements
+
+        bool IsArray() const noexcept { return Array != nullptr; }
+
+        // @return Scalar value converted to double, 0 if this is not a number
+        double AsDouble() const noexcept;
+        // @return Scalar value converted to int64, 0 if this is not a number
+        int64_t AsInt() const noexcept;
+
+        /**
+         * Converts array elements of any numeric type
+         * @return FALSE if this is not an array
+         */
+        bool GetArray(std::vector<double>& out) const;
+        bool GetArray(std::vector<int>& out) const;
+    };
+
+    struct FbxNode
+    {
+        rpp::strview Name;
+        std::vector<FbxProperty> Props;
+        std::vector<FbxNode> Children;
+
+        // @return First child with this name, or nullptr
+        const FbxNode* Find(rpp::strview name) const noexcept;
+
+        // @return Property at `index`, or an empty property if it doesn't exist
+        const FbxProperty& Prop(size_t index) const noexcept;
+    };
+
+    /**
+     * Node tree of an FBX 7.x binary file (version 7500+ uses 64-bit record offsets).
+     * Strings and uncompressed arrays point straight into the memory mapped file.
+     * Compressed arrays are collected while parsing and then decompressed
+     * in parallel into buffers owned by the document.
+     * Every document is independent, so any number of files can be read concurrently.
+     */
+    class FbxDocument
+    {
+        FileSource file;
+        struct InflateJob
+        {
+            const uint8_t* src;
+            size_t srcSize;
+            uint8_t* dst;
+            size_t dstSize;
+        };
+        std::vector<InflateJob> inflateJobs;
+        std::vector<std::unique_ptr<uint8_t[]>> inflated;
+        bool is64Bit = false;
+
+    public:
+        uint32_t Version = 0;
+        FbxNode Root; // top level nodes such as Objects and Connections
+        std::string Error;
+
+        // @return TRUE if the file starts with the binary FBX magic
+        static bool IsBinary(rpp::strview path) noexcept;
+
+        /**
+         * @param numWorkers Number of threads for decompressing arrays
+         * @return FALSE if the file is not a valid binary FBX, see Error
+         */
+        bool Read(rpp::strview path, int numWorkers);
+
+    private:
+        bool Fail(std::string message);
+        bool ReadNode(const uint8_t*& p, const uint8_t* end, FbxNode& node, bool& isNull, int depth);
+        bool ReadProperty(const uint8_t*& p, const uint8_t* end, FbxProperty& prop);
+        bool Decompress(int numWorkers);
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
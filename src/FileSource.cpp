@@ -0,0 +1,165 @@
+#include "FileSource.h"
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <utility>
+#if _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    FileSource::FileSource(rpp::strview path, bool memoryMap, std::vector<char>* readBuffer)
+    {
+        if (memoryMap && Map(path))
+            return;
+        Read(path, readBuffer ? *readBuffer : ownBuffer);
+    }
+
+    FileSource::~FileSource() noexcept
+    {
+        Close();
+    }
+
+    FileSource::FileSource(FileSource&& fwd) noexcept
+        : ownBuffer{ std::move(fwd.ownBuffer) }, mapping{ fwd.mapping }, mappingSize{ fwd.mappingSize },
+          str{ fwd.str }, len{ fwd.len }
+    {
+        fwd.mapping = nullptr;
+        fwd.mappingSize = 0;
+        fwd.str = nullptr;
+        fwd.len = 0;
+    }
+
+    FileSource& FileSource::operator=(FileSource&& fwd) noexcept
+    {
+        if (this != &fwd)
+        {
+            Close();
+            ownBuffer = std::move(fwd.ownBuffer);
+            std::swap(mapping, fwd.mapping);
+            std::swap(mappingSize, fwd.mappingSize);
+            std::swap(str, fwd.str);
+            std::swap(len, fwd.len);
+        }
+        return *this;
+    }
+
+    void FileSource::Close() noexcept
+    {
+        if (mapping)
+        {
+        #if _WIN32
+            UnmapViewOfFile(mapping);
+        #else
+            munmap(mapping, mappingSize);
+        #endif
+            mapping = nullptr;
+            mappingSize = 0;
+        }
+        ownBuffer = std::vector<char>{};
+        str = nullptr;
+        len = 0;
+    }
+
+    bool FileSource::Read(rpp::strview path, std::vector<char>& readBuffer)
+    {
+        rpp::file file { path };
+        if (!file)
+            return false;
+        int64_t size = file.sizel();
+        if (size < 0 || uint64_t(size) >= SIZE_MAX)
+            return false;
+        readBuffer.resize(size_t(size) + 1); // never empty, so str is valid even for empty files
+
+        // rpp::file reads at most INT_MAX bytes at a time
+        size_t bytesRead = 0;
+        while (bytesRead < size_t(size))
+        {
+            size_t remaining = size_t(size) - bytesRead;
+            int n = file.read(readBuffer.data() + bytesRead, int(remaining < INT_MAX ? remaining : INT_MAX));
+            if (n <= 0) break;
+            bytesRead += size_t(n);
+        }
+        readBuffer[bytesRead] = '\0';
+        str = readBuffer.data();
+        len = bytesRead;
+        return true;
+    }
+
+    bool FileSource::NextWindow(size_t& offset, rpp::strview& window) const noexcept
+    {
+        if (offset >= len)
+            return false;
+        const char* start = str + offset;
+        size_t size = len - offset;
+        if (size > MaxWindowSize)
+        {
+            // end at the last full line, unless a single line is longer than the window
+            size = MaxWindowSize;
+            while (size > 0 && start[size - 1] != '\n') --size;
+            if (size == 0) size = MaxWindowSize;
+        }
+        window = rpp::strview{ start, int(size) };
+        offset += size;
+        return true;
+    }
+
+    bool FileSource::Map(rpp::strview path) noexcept
+    {
+        std::string filename = path; // needs to be null terminated
+    #if _WIN32
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size;
+        void* view = nullptr;
+        // empty files can't be mapped
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0 && uint64_t(size.QuadPart) <= SIZE_MAX)
+        {
+            if (HANDLE map = CreateFileMappingA(file, nullptr, PAGE_READONLY,
+                                                (DWORD)size.HighPart, size.LowPart, nullptr))
+            {
+                view = MapViewOfFile(map, FILE_MAP_READ, 0, 0, (SIZE_T)size.QuadPart);
+                CloseHandle(map); // the view keeps the mapping alive
+            }
+        }
+        CloseHandle(file);
+        if (!view)
+            return false;
+        size_t fileSize = (size_t)size.QuadPart;
+    #else
+        int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+            return false;
+
+        struct stat st;
+        void* view = MAP_FAILED;
+        // empty files can't be mapped
+        if (fstat(fd, &st) == 0 && st.st_size > 0 && uint64_t(st.st_size) <= SIZE_MAX)
+            view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd); // the mapping keeps the file alive
+        if (view == MAP_FAILED)
+            return false;
+        size_t fileSize = (size_t)st.st_size;
+        madvise(view, fileSize, MADV_SEQUENTIAL);
+    #endif
+        mapping = view;
+        mappingSize = fileSize;
+        str = (const char*)view;
+        len = fileSize;
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <rpp/file_io.h>
+#include <rpp/strview.h>
+#include <vector>
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Read-only contents of a whole file for the text parsers.
+     * With memoryMap, the file is mapped straight from the page cache with a
+     * sequential access hint, which avoids copying the file into a heap buffer.
+     * If mapping fails or is not requested, the file is read into a buffer instead,
+     * which can be an external buffer that is reused between files.
+     * Files over 2GB are supported, use NextWindow() to parse them with rpp::line_parser.
+     */
+    class FileSource
+    {
+        std::vector<char> ownBuffer; // fallback if the file is not mapped
+        void* mapping = nullptr;
+        size_t mappingSize = 0;
+
+    public:
+        // rpp::strview and rpp::line_parser are int based, so big files are parsed in windows
+        static constexpr size_t MaxWindowSize = 1u << 30;
+
+        const char* str = nullptr;
+        size_t len = 0;
+
+        FileSource() noexcept = default;
+
+        /**
+         * @param memoryMap Try to memory map the file first
+         * @param readBuffer [optional] Reusable buffer for reading the file if it is not mapped,
+         *                   it must outlive this FileSource
+         */
+        FileSource(rpp::strview path, bool memoryMap, std::vector<char>* readBuffer = nullptr);
+        ~FileSource() noexcept;
+
+        FileSource(FileSource&& fwd) noexcept;
+        FileSource& operator=(FileSource&& fwd) noexcept;
+        FileSource(const FileSource&) = delete;
+        FileSource& operator=(const FileSource&) = delete;
+
+        // @return TRUE if the file was opened successfully
+        explicit operator bool() const noexcept { return str != nullptr; }
+
+        // @return TRUE if the file contents are memory mapped
+        bool IsMapped() const noexcept { return mapping != nullptr; }
+
+        // @return All lines of the file, only for files known to be smaller than MaxWindowSize
+        rpp::line_parser Lines() const noexcept { return { str, int(len < MaxWindowSize ? len : MaxWindowSize) }; }
+
+        /**
+         * Gets the next newline-aligned window of at most MaxWindowSize bytes
+         * @param offset Start of the window, advanced to the end of it
+         * @return FALSE if there is nothing left after `offset`
+         */
+        bool NextWindow(size_t& offset, rpp::strview& window) const noexcept;
+
+        void Close() noexcept;
+
+    private:
+        bool Map(rpp::strview path) noexcept;
+        bool Read(rpp::strview path, std::vector<char>& readBuffer);
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include <Nano/Mesh.h>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <vector>
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * 64-bit non-cryptographic content hash, this is the XXH64 algorithm.
+     * It runs at several GB/s, so hashing a source file costs far less than parsing it.
+     */
+    class Hash64
+    {
+        static constexpr uint64_t P1 = 11400714785074694791ull;
+        static constexpr uint64_t P2 = 14029467366897019727ull;
+        static constexpr uint64_t P3 = 1609587929392839161ull;
+        static constexpr uint64_t P4 = 9650029242287828579ull;
+        static constexpr uint64_t P5 = 2870177450012600261ull;
+
+        static uint64_t Rotl(uint64_t x, int r) noexcept { return (x << r) | (x >> (64 - r)); }
+        static uint64_t Read64(const uint8_t* p) noexcept { uint64_t v; memcpy(&v, p, 8); return v; }
+        static uint32_t Read32(const uint8_t* p) noexcept { uint32_t v; memcpy(&v, p, 4); return v; }
+
+        static uint64_t Round(uint64_t acc, uint64_t input) noexcept
+        {
+            acc += input * P2;
+            return Rotl(acc, 31) * P1;
+        }
+
+        static uint64_t Merge(uint64_t acc, uint64_t val) noexcept
+        {
+            acc ^= Round(0, val);
+            return acc * P1 + P4;
+        }
+
+    public:
+        static uint64_t Bytes(const void* data, size_t len, uint64_t seed = 0) noexcept
+        {
+            const uint8_t* p = (const uint8_t*)data;
+            const uint8_t* end = p + len;
+            uint64_t h;
+            if (len >= 32)
+            {
+                uint64_t v1 = seed + P1 + P2, v2 = seed + P2, v3 = seed, v4 = seed - P1;
+                const uint8_t* limit = end - 32;
+                do {
+                    v1 = Round(v1, Read64(p));      v2 = Round(v2, Read64(p + 8));
+                    v3 = Round(v3, Read64(p + 16)); v4 = Round(v4, Read64(p + 24));
+                    p += 32;
+                } while (p <= limit);
+                h = Rotl(v1, 1) + Rotl(v2, 7) + Rotl(v3, 12) + Rotl(v4, 18);
+                h = Merge(h, v1); h = Merge(h, v2); h = Merge(h, v3); h = Merge(h, v4);
+            }
+            else
+            {
+                h = seed + P5;
+            }
+            h += (uint64_t)len;
+
+            for (; p + 8 <= end; p += 8)
+                h = Rotl(h ^ Round(0, Read64(p)), 27) * P1 + P4;
+            if (p + 4 <= end) {
+                h = Rotl(h ^ (uint64_t(Read32(p)) * P1), 23) * P2 + P3;
+                p += 4;
+            }
+            for (; p < end; ++p)
+                h = Rotl(h ^ (*p * P5), 11) * P1;
+
+            h ^= h >> 33; h *= P2;
+            h ^= h >> 29; h *= P3;
+            h ^= h >> 32;
+            return h;
+        }
+
+        // Combines a value into an existing hash
+        static uint64_t Combine(uint64_t hash, uint64_t value) noexcept
+        {
+            return Bytes(&value, sizeof(value), hash);
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    // Hashes all four indices of a VertexDescr, for tables of unique vertices
+    struct VertexDescrHash
+    {
+        size_t operator()(const VertexDescr& vd) const noexcept
+        {
+            uint64_t h = uint32_t(vd.v) * 0x9E3779B97F4A7C15ull;
+            h ^= (uint32_t(vd.t) + (h << 6) + (h >> 2)) * 0xC2B2AE3D27D4EB4Full;
+            h ^= (uint32_t(vd.n) + (h << 6) + (h >> 2)) * 0x165667B19E3779F9ull;
+            h ^= (uint32_t(vd.c) + (h << 6) + (h >> 2));
+            return size_t(h ^ (h >> 29));
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Flat open addressing table of unique VertexDescr's, which stores the
+     * corner index of each first use instead of the VertexDescr itself.
+     */
+    class CornerTable
+    {
+        const Triangle* tris;
+        std::vector<int> slots; // first use corner index or -1
+        size_t mask = 0;
+        size_t count = 0;
+
+        const VertexDescr& Corner(int corner) const noexcept { return tris[corner / 3][corner % 3]; }
+
+        void Rehash(size_t capacity)
+        {
+            std::vector<int> old = std::move(slots);
+            slots.assign(capacity, -1);
+            mask = capacity - 1;
+            for (int corner : old)
+            {
+                if (corner == -1) continue;
+                size_t slot = VertexDescrHash{}(Corner(corner)) & mask;
+                while (slots[slot] != -1)
+                    slot = (slot + 1) & mask;
+                slots[slot] = corner;
+            }
+        }
+
+    public:
+        CornerTable(const Triangle* tris, size_t expectedVerts) : tris{ tris }
+        {
+            size_t capacity = 1024;
+            while (capacity < expectedVerts * 2) capacity *= 2;
+            slots.assign(capacity, -1);
+            mask = capacity - 1;
+        }
+
+        // @return First corner which uses the same VertexDescr as `corner`, possibly itself
+        int Insert(int corner)
+        {
+            const VertexDescr& vd = Corner(corner);
+            size_t slot = VertexDescrHash{}(vd) & mask;
+            for (int existing; (existing = slots[slot]) != -1; slot = (slot + 1) & mask)
+                if (Corner(existing) == vd)
+                    return existing;
+
+            slots[slot] = corner;
+            if (++count * 2 > slots.size()) // keep the load factor below 0.5
+                Rehash(slots.size() * 2);
+            return corner;
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,351 @@
+#include "Inflate.h"
+#include <cstring>
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    namespace
+    {
+        /**
+         * LSB-first bit reader for deflate data. Reading past the end of the input
+         * yields zero bits, which is checked with Overrun() at block boundaries.
+         */
+        struct BitReader
+        {
+            const uint8_t* p;
+            const uint8_t* end;
+            uint64_t bits = 0;
+            int count = 0;   // number of valid bits in `bits`
+            int padding = 0; // zero bytes added after the end of input
+
+            BitReader(const uint8_t* p, const uint8_t* end) noexcept : p{ p }, end{ end } {}
+
+            // ensures there are at least 56 bits available
+            void Refill() noexcept
+            {
+                while (count <= 56)
+                {
+                    if (p < end) bits |= uint64_t(*p++) << count;
+                    else ++padding;
+                    count += 8;
+                }
+            }
+
+            uint32_t Peek(int n) const noexcept { return uint32_t(bits & ((1ull << n) - 1)); }
+            void Consume(int n) noexcept { bits >>= n; count -= n; }
+            uint32_t Get(int n) noexcept { uint32_t v = Peek(n); Consume(n); return v; }
+
+            // @return TRUE if more bits were consumed than the input had
+            bool Overrun() const noexcept { return padding * 8 > count; }
+
+            /**
+             * Drops the bits up to the next byte boundary and hands the
+             * remaining bytes back to the input, for stored blocks and the trailer.
+             * @return FALSE on overrun
+             */
+            bool AlignToByte() noexcept
+            {
+                Consume(count & 7);
+                int unread = count / 8 - padding;
+                if (unread < 0)
+                    return false;
+                p -= unread;
+                bits = 0;
+                count = 0;
+                padding = 0;
+                return true;
+            }
+        };
+
+        /**
+         * Canonical Huffman decoder. Codes up to FastBits long are decoded with a
+         * single table lookup, longer codes fall back to the canonical ordering.
+         */
+        struct Huffman
+        {
+            static constexpr int MaxBits = 15;
+            static constexpr int FastBits = 10;
+            uint16_t fast[1 << FastBits]; // (symbol << 4) | length, 0 if the code is longer than FastBits
+            uint16_t counts[MaxBits + 1];
+            uint16_t symbols[288];        // symbols ordered by code
+
+            // @return FALSE if the code lengths are over-subscribed
+            bool Build(const uint8_t* lengths, int numSymbols) noexcept
+            {
+                memset(counts, 0, sizeof(counts));
+                for (int s = 0; s < numSymbols; ++s)
+                    ++counts[lengths[s]];
+                counts[0] = 0;
+
+                int left = 1;
+                for (int len = 1; len <= MaxBits; ++len)
+                {
+                    left = (left << 1) - counts[len];
+                    if (left < 0)
+                        return false;
+                }
+
+                uint16_t offsets[MaxBits + 1];
+                offsets[1] = 0;
+                for (int len = 1; len < MaxBits; ++len)
+                    offsets[len + 1] = uint16_t(offsets[len] + counts[len]);
+                for (int s = 0; s < numSymbols; ++s)
+                    if (lengths[s] != 0)
+                        symbols[offsets[lengths[s]]++] = uint16_t(s);
+
+                memset(fast, 0, sizeof(fast));
+                int code = 0, index = 0;
+                for (int len = 1; len <= FastBits; ++len, code <<= 1)
+                {
+                    for (int i = 0; i < counts[len]; ++i, ++code, ++index)
+                    {
+                        int reversed = 0; // deflate stores codes MSB first
+                        for (int b = 0; b < len; ++b)
+                            reversed |= ((code >> b) & 1) << (len - 1 - b);
+                        uint16_t entry = uint16_t((symbols[index] << 4) | len);
+                        for (int fill = reversed; fill < (1 << FastBits); fill += (1 << len))
+                            fast[fill] = entry;
+                    }
+                }
+                return true;
+            }
+
+            // @return Decoded symbol or -1 if the code is invalid, needs up to MaxBits in `br`
+            int Decode(BitReader& br) const noexcept
+            {
+                if (uint16_t entry = fast[br.Peek(FastBits)])
+                {
+                    br.Consume(entry & 15);
+                    return entry >> 4;
+                }
+                int code = 0, first = 0, index = 0;
+                for (int len = 1; len <= MaxBits; ++len)
+                {
+                    code |= (int)br.Get(1);
+                    int count = counts[len];
+                    if (code - first < count)
+                        return symbols[index + (code - first)];
+                    index += count;
+                    first = (first + count) << 1;
+                    code <<= 1;
+                }
+                return -1;
+            }
+        };
+
+        const uint16_t LengthBase[29] = {
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        const uint8_t LengthExtra[29] = {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        const uint16_t DistBase[30] = {
+            1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        const uint8_t DistExtra[30] = {
+            0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+        struct FixedCodes
+        {
+            Huffman lengths, dists;
+            FixedCodes() noexcept
+            {
+                uint8_t l[288];
+                int s = 0;
+                for (; s < 144; ++s) l[s] = 8;
+                for (; s < 256; ++s) l[s] = 9;
+                for (; s < 280; ++s) l[s] = 7;
+                for (; s < 288; ++s) l[s] = 8;
+                lengths.Build(l, 288);
+                uint8_t d[30];
+                for (uint8_t& len : d) len = 5;
+                dists.Build(d, 30);
+            }
+        };
+
+        struct Inflater
+        {
+            BitReader br;
+            uint8_t* out;
+            uint8_t* outEnd;
+            uint8_t* const outBegin;
+
+            Inflater(const uint8_t* src, const uint8_t* srcEnd, uint8_t* dst, size_t dstSize) noexcept
+                : br{ src, srcEnd }, out{ dst }, outEnd{ dst + dstSize }, outBegin{ dst } {}
+
+            bool Stored() noexcept
+            {
+                if (!br.AlignToByte() || br.end - br.p < 4)
+                    return false;
+                uint32_t len  = br.p[0] | (br.p[1] << 8);
+                uint32_t nlen = br.p[2] | (br.p[3] << 8);
+                br.p += 4;
+                if (len != (~nlen & 0xFFFF) || size_t(br.end - br.p) < len || size_t(outEnd - out) < len)
+                    return false;
+                if (len != 0) memcpy(out, br.p, len);
+                out += len;
+                br.p += len;
+                return true;
+            }
+
+            bool Codes(const Huffman& lengths, const Huffman& dists) noexcept
+            {
+                for (;;)
+                {
+                    br.Refill(); // enough for symbol + extra + distance + extra (48 bits)
+                    int symbol = lengths.Decode(br);
+                    if (symbol < 256)
+                    {
+                        if (symbol < 0 || out == outEnd)
+                            return false;
+                        *out++ = uint8_t(symbol);
+                        continue;
+                    }
+                    if (symbol == 256)
+                        return !br.Overrun();
+
+                    symbol -= 257;
+                    if (symbol >= 29)
+                        return false;
+                    size_t len = LengthBase[symbol] + br.Get(LengthExtra[symbol]);
+                    int dsym = dists.Decode(br);
+                    if (dsym < 0 || dsym >= 30)
+                        return false;
+                    size_t dist = DistBase[dsym] + br.Get(DistExtra[dsym]);
+                    if (dist > size_t(out - outBegin) || len > size_t(outEnd - out))
+                        return false;
+
+                    const uint8_t* from = out - dist;
+                    if (dist >= len) {
+                        memcpy(out, from, len);
+                        out += len;
+                    } else { // overlapping run
+                        for (size_t i = 0; i < len; ++i)
+                            *out++ = from[i];
+                    }
+                }
+            }
+
+            bool Dynamic() noexcept
+            {
+                static const uint8_t order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+                br.Refill();
+                int numLengths = (int)br.Get(5) + 257;
+                int numDists   = (int)br.Get(5) + 1;
+                int numCodes   = (int)br.Get(4) + 4;
+                if (numLengths > 286 || numDists > 30)
+                    return false;
+
+                uint8_t lengths[286 + 30] = {};
+                for (int i = 0; i < numCodes; ++i)
+                {
+                    br.Refill();
+                    lengths[order[i]] = uint8_t(br.Get(3));
+                }
+                Huffman codeLengths;
+                if (!codeLengths.Build(lengths, 19))
+                    return false;
+
+                const int total = numLengths + numDists;
+                memset(lengths, 0, sizeof(lengths));
+                for (int i = 0; i < total;)
+                {
+                    br.Refill();
+                    int symbol = codeLengths.Decode(br);
+                    if (symbol < 0)
+                        return false;
+                    if (symbol < 16) {
+                        lengths[i++] = uint8_t(symbol);
+                        continue;
+                    }
+                    uint8_t value = 0;
+                    int repeat;
+                    if (symbol == 16) {
+                        if (i == 0) return false;
+                        value = lengths[i - 1];
+                        repeat = 3 + (int)br.Get(2);
+                    }
+                    else if (symbol == 17) repeat = 3 + (int)br.Get(3);
+                    else                   repeat = 11 + (int)br.Get(7);
+                    if (i + repeat > total)
+                        return false;
+                    while (repeat--)
+                        lengths[i++] = value;
+                }
+                if (lengths[256] == 0 || br.Overrun()) // no end-of-block code
+                    return false;
+
+                Huffman litLengths, dists;
+                return litLengths.Build(lengths, numLengths)
+                    && dists.Build(lengths + numLengths, numDists)
+                    && Codes(litLengths, dists);
+            }
+
+            bool Run() noexcept
+            {
+                static const FixedCodes fixed;
+                for (bool last = false; !last;)
+                {
+                    br.Refill();
+                    last = br.Get(1) != 0;
+                    bool ok;
+                    switch (br.Get(2))
+                    {
+                        case 0:  ok = Stored(); break;
+                        case 1:  ok = Codes(fixed.lengths, fixed.dists); break;
+                        case 2:  ok = Dynamic(); break;
+                        default: ok = false; break;
+                    }
+                    if (!ok || br.Overrun())
+                        return false;
+                }
+                return br.AlignToByte();
+            }
+        };
+
+        uint32_t Adler32(const uint8_t* data, size_t size) noexcept
+        {
+            uint32_t a = 1, b = 0;
+            while (size > 0)
+            {
+                size_t n = size < 5552 ? size : 5552; // largest n where b can't overflow
+                size -= n;
+                for (; n > 0; --n)
+                {
+                    a += *data++;
+                    b += a;
+                }
+                a %= 65521;
+                b %= 65521;
+            }
+            return (b << 16) | a;
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    bool ZlibDecompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) noexcept
+    {
+        if (srcSize < 6)
+            return false;
+        // CM=8 (deflate), header checksum, no preset dictionary
+        uint32_t cmf = src[0], flg = src[1];
+        if ((cmf & 15) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20))
+            return false;
+
+        Inflater inflater { src + 2, src + srcSize, dst, dstSize };
+        if (!inflater.Run() || inflater.out != inflater.outEnd)
+            return false;
+
+        const uint8_t* trailer = inflater.br.p;
+        if (inflater.br.end - trailer < 4)
+            return false;
+        uint32_t expected = (uint32_t(trailer[0]) << 24) | (uint32_t(trailer[1]) << 16)
+                          | (uint32_t(trailer[2]) << 8) | uint32_t(trailer[3]);
+        return Adler32(dst, dstSize) == expected;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Decompresses a zlib stream (RFC 1950 wrapper around RFC 1951 deflate data),
+     * which is how FBX compresses its large arrays. The decompressed size is always
+     * known up front, so the output goes straight into the final buffer.
+     * This has no shared state and can be called from any number of threads.
+     * @param dst Output buffer of exactly `dstSize` bytes
+     * @return TRUE if the stream was valid, its Adler-32 checksum matched,
+     *         and it decompressed to exactly `dstSize` bytes
+     */
+    bool ZlibDecompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) noexcept;
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,359 @@
+#include "Json.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    static const JsonValue JsonNull {};
+
+    const JsonValue& JsonValue::operator[](rpp::strview key) const noexcept
+    {
+        if (type == Type::Object)
+            for (size_t i = 0; i < keys.size(); ++i)
+                if (key == keys[i])
+                    return items[i];
+        return JsonNull;
+    }
+
+    const JsonValue& JsonValue::operator[](int index) const noexcept
+    {
+        if (type == Type::Array && (size_t)index < items.size())
+            return items[index];
+        return JsonNull;
+    }
+
+    int JsonValue::Int(int defaultValue) const noexcept
+    {
+        // out of range and fractional numbers are not valid indices or counts
+        if (!IsNumber() || !(number >= -2147483648.0 && number <= 2147483647.0) || number != std::floor(number))
+            return defaultValue;
+        return (int)number;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    class JsonParser
+    {
+        const char* ptr;
+        const char* end;
+        std::string& error;
+        static constexpr int MaxDepth = 256;
+
+    public:
+        JsonParser(rpp::strview text, std::string& error)
+            : ptr{ text.str }, end{ text.str + text.len }, error{ error } {}
+
+        bool Parse(JsonValue& out)
+        {
+            if (!ParseValue(out, 0))
+                return false;
+            SkipSpace();
+            return ptr == end || Fail("unexpected data after the root value");
+        }
+
+    private:
+        bool Fail(const char* message)
+        {
+            if (error.empty())
+                error = message;
+            return false;
+        }
+
+        void SkipSpace()
+        {
+            while (ptr < end && (*ptr == ' ' || *ptr == '\t' || *ptr == '\n' || *ptr == '\r'))
+                ++ptr;
+        }
+
+        bool Literal(const char* word)
+        {
+            size_t len = strlen(word);
+            if (size_t(end - ptr) < len || memcmp(ptr, word, len) != 0)
+                return Fail("invalid literal");
+            ptr += len;
+            return true;
+        }
+
+        bool ParseValue(JsonValue& out, int depth)
+        {
+            if (depth > MaxDepth)
+                return Fail("nesting too deep");
+            SkipSpace();
+            if (ptr == end)
+                return Fail("unexpected end of data");
+            switch (*ptr)
+            {
+                case '{': out.type = JsonValue::Type::Object; return ParseObject(out, depth);
+                case '[': out.type = JsonValue::Type::Array;  return ParseArray(out, depth);
+                case '"': out.type = JsonValue::Type::String; return ParseString(out.str);
+                case 't': out.type = JsonValue::Type::Bool; out.boolean = true;  return Literal("true");
+                case 'f': out.type = JsonValue::Type::Bool; out.boolean = false; return Literal("false");
+                case 'n': out.type = JsonValue::Type::Null; return Literal("null");
+                default:  out.type = JsonValue::Type::Number; return ParseNumber(out.number);
+            }
+        }
+
+        bool ParseObject(JsonValue& out, int depth)
+        {
+            ++ptr; // {
+            SkipSpace();
+            if (ptr < end && *ptr == '}') { ++ptr; return true; }
+            for (;;)
+            {
+                SkipSpace();
+                if (ptr == end || *ptr != '"')
+                    return Fail("expected an object key");
+                out.keys.emplace_back();
+                if (!ParseString(out.keys.back()))
+                    return false;
+                SkipSpace();
+                if (ptr == end || *ptr != ':')
+                    return Fail("expected ':' after an object key");
+                ++ptr;
+                out.items.emplace_back();
+                if (!ParseValue(out.items.back(), depth + 1))
+                    return false;
+                SkipSpace();
+                if (ptr < end && *ptr == ',') { ++ptr; continue; }
+                if (ptr < end && *ptr == '}') { ++ptr; return true; }
+                return Fail("expected ',' or '}' in an object");
+            }
+        }
+
+        bool ParseArray(JsonValue& out, int depth)
+        {
+            ++ptr; // [
+            SkipSpace();
+            if (ptr < end && *ptr == ']') { ++ptr; return true; }
+            for (;;)
+            {
+                out.items.emplace_back();
+                if (!ParseValue(out.items.back(), depth + 1))
+                    return false;
+                SkipSpace();
+                if (ptr < end && *ptr == ',') { ++ptr; continue; }
+                if (ptr < end && *ptr == ']') { ++ptr; return true; }
+                return Fail("expected ',' or ']' in an array");
+            }
+        }
+
+        bool ParseHex4(unsigned& code)
+        {
+            if (end - ptr < 4)
+                return Fail("truncated unicode escape");
+            code = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                char c = *ptr++;
+                code <<= 4;
+                if      (c >= '0' && c <= '9') code |= unsigned(c - '0');
+                else if (c >= 'a' && c <= 'f') code |= unsigned(c - 'a' + 10);
+                else if (c >= 'A' && c <= 'F') code |= unsigned(c - 'A' + 10);
+                else return Fail("invalid unicode escape");
+            }
+            return true;
+        }
+
+        static void AppendUtf8(std::string& s, unsigned code)
+        {
+            if (code < 0x80) {
+                s += char(code);
+            } else if (code < 0x800) {
+                s += char(0xC0 | (code >> 6));
+                s += char(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                s += char(0xE0 | (code >> 12));
+                s += char(0x80 | ((code >> 6) & 0x3F));
+                s += char(0x80 | (code & 0x3F));
+            } else {
+                s += char(0xF0 | (code >> 18));
+                s += char(0x80 | ((code >> 12) & 0x3F));
+                s += char(0x80 | ((code >> 6) & 0x3F));
+                s += char(0x80 | (code & 0x3F));
+            }
+        }
+
+        bool ParseString(std::string& out)
+        {
+            ++ptr; // "
+            const char* start = ptr;
+            // fast path: most glTF strings have no escapes
+            while (ptr < end && *ptr != '"' && *ptr != '\\')
+                ++ptr;
+            out.assign(start, ptr);
+            while (ptr < end)
+            {
+                char c = *ptr++;
+                if (c == '"')
+                    return true;
+                if (c != '\\') {
+                    out += c;
+                    continue;
+                }
+                if (ptr == end)
+                    break;
+                switch (char e = *ptr++)
+                {
+                    case '"': case '\\': case '/': out += e; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'n': out += '\n'; break;
+                    case 'r': out += '\r'; break;
+                    case 't': out += '\t'; break;
+                    case 'u':
+                    {
+                        unsigned code;
+                        if (!ParseHex4(code))
+                            return false;
+                        if (code >= 0xD800 && code < 0xDC00 && end - ptr >= 6 && ptr[0] == '\\' && ptr[1] == 'u')
+                        {
+                            ptr += 2;
+                            unsigned low;
+                            if (!ParseHex4(low))
+                                return false;
+                            if (low >= 0xDC00 && low < 0xE000)
+                                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        }
+                        AppendUtf8(out, code);
+                        break;
+                    }
+                    default: return Fail("invalid string escape");
+                }
+            }
+            return Fail("unterminated string");
+        }
+
+        bool ParseNumber(double& out)
+        {
+            const char* start = ptr;
+            if (ptr < end && (*ptr == '-' || *ptr == '+')) ++ptr;
+            while (ptr < end && ((*ptr >= '0' && *ptr <= '9') || *ptr == '.' ||
+                                 *ptr == 'e' || *ptr == 'E' || *ptr == '-' || *ptr == '+'))
+                ++ptr;
+            size_t len = size_t(ptr - start);
+            if (len == 0 || len >= 64)
+                return Fail("invalid number");
+
+            char buf[64];
+            memcpy(buf, start, len);
+            buf[len] = '\0';
+            char* parsedEnd;
+            out = strtod(buf, &parsedEnd);
+            return parsedEnd == buf + len || Fail("invalid number");
+        }
+    };
+
+    bool ParseJson(rpp::strview text, JsonValue& out, std::string& error)
+    {
+        out = JsonValue{};
+        error.clear();
+        return JsonParser{ text, error }.Parse(out);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    void JsonWriter::Separate()
+    {
+        if (afterKey) {
+            afterKey = false;
+            return;
+        }
+        if (!needComma.empty())
+        {
+            if (needComma.back()) out += ',';
+            needComma.back() = true;
+        }
+    }
+
+    void JsonWriter::WriteString(rpp::strview s)
+    {
+        out += '"';
+        for (int i = 0; i < s.len; ++i)
+        {
+            char c = s.str[i];
+            switch (c)
+            {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n";  break;
+                case '\r': out += "\\r";  break;
+                case '\t': out += "\\t";  break;
+                default:
+                    if ((unsigned char)c < 0x20) {
+                        char esc[8];
+                        snprintf(esc, sizeof(esc), "\\u%04x", (unsigned)c);
+                        out += esc;
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        out += '"';
+    }
+
+    JsonWriter& JsonWriter::BeginObject() { Separate(); out += '{'; needComma.push_back(false); return *this; }
+    JsonWriter& JsonWriter::EndObject()   { out += '}'; needComma.pop_back(); return *this; }
+    JsonWriter& JsonWriter::BeginArray()  { Separate(); out += '['; needComma.push_back(false); return *this; }
+    JsonWriter& JsonWriter::EndArray()    { out += ']'; needComma.pop_back(); return *this; }
+
+    JsonWriter& JsonWriter::Key(rpp::strview key)
+    {
+        Separate();
+        WriteString(key);
+        out += ':';
+        afterKey = true;
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::Value(rpp::strview s) { Separate(); WriteString(s); return *this; }
+    JsonWriter& JsonWriter::Value(bool boolean)   { Separate(); out += boolean ? "true" : "false"; return *this; }
+
+    JsonWriter& JsonWriter::Value(double number)
+    {
+        Separate();
+        if (!std::isfinite(number)) { // not representable in JSON
+            out += '0';
+            return *this;
+        }
+        // enough digits to read back as the same float
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.9g", number);
+        out += buf;
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::Value(int number)
+    {
+        Separate();
+        out += std::to_string(number);
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::Value(size_t number)
+    {
+        Separate();
+        out += std::to_string(number);
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::Raw(rpp::strview json)
+    {
+        Separate();
+        out.append(json.str, json.len);
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::Array(const float* numbers, int count)
+    {
+        BeginArray();
+        for (int i = 0; i < count; ++i)
+            Value(numbers[i]);
+        return EndArray();
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <rpp/strview.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Minimal JSON document model for the glTF reader.
+     * Numbers are doubles, strings are unescaped UTF-8 copies
+     * and objects keep their keys in document order.
+     */
+    class JsonValue
+    {
+    public:
+        enum class Type : uint8_t { Null, Bool, Number, String, Array, Object };
+
+        Type type = Type::Null;
+        bool boolean = false;
+        double number = 0.0;
+        std::string str;
+        std::vector<JsonValue> items;  // array items or object values
+        std::vector<std::string> keys; // object keys, parallel to items
+
+        bool IsNull()   const noexcept { return type == Type::Null;   }
+        bool IsNumber() const noexcept { return type == Type::Number; }
+        bool IsString() const noexcept { return type == Type::String; }
+        bool IsArray()  const noexcept { return type == Type::Array;  }
+        bool IsObject() const noexcept { return type == Type::Object; }
+
+        // @return Number of array items or object members
+        int Size() const noexcept { return (int)items.size(); }
+
+        // @return Object member with this key, or a Null value if it doesn't exist
+        const JsonValue& operator[](rpp::strview key) const noexcept;
+
+        // @return Array item at this index, or a Null value if out of bounds
+        const JsonValue& operator[](int index) const noexcept;
+
+        bool Has(rpp::strview key) const noexcept { return !(*this)[key].IsNull(); }
+
+        double Number(double defaultValue) const noexcept { return IsNumber() ? number : defaultValue; }
+        float Float(float defaultValue) const noexcept { return IsNumber() ? (float)number : defaultValue; }
+        int Int(int defaultValue) const noexcept;
+        bool Bool(bool defaultValue) const noexcept { return type == Type::Bool ? boolean : defaultValue; }
+        rpp::strview Str() const noexcept { return IsString() ? rpp::strview{ str } : rpp::strview{}; }
+    };
+
+    /**
+     * Parses a complete JSON document
+     * @param error Receives a description of the first syntax error
+     * @return FALSE if the text is not valid JSON
+     */
+    bool ParseJson(rpp::strview text, JsonValue& out, std::string& error);
+
+    /**
+     * Streaming JSON writer without any whitespace,
+     * commas between values are inserted automatically.
+     */
+    class JsonWriter
+    {
+        std::string out;
+        std::vector<bool> needComma; // one entry per open object/array
+        bool afterKey = false;
+
+    public:
+        const std::string& Str() const noexcept { return out; }
+
+        JsonWriter& BeginObject();
+        JsonWriter& EndObject();
+        JsonWriter& BeginArray();
+        JsonWriter& EndArray();
+        JsonWriter& Key(rpp::strview key);
+
+        JsonWriter& Value(rpp::strview s);
+        JsonWriter& Value(const char* s) { return Value(rpp::strview{ s }); }
+        JsonWriter& Value(const std::string& s) { return Value(rpp::strview{ s }); }
+        JsonWriter& Value(double number);
+        JsonWriter& Value(float number) { return Value(double(number)); }
+        JsonWriter& Value(int number);
+        JsonWriter& Value(size_t number);
+        JsonWriter& Value(bool boolean);
+
+        // writes an array of numbers
+        JsonWriter& Array(const float* numbers, int count);
+
+        // inserts an already serialized JSON value
+        JsonWriter& Raw(rpp::strview json);
+
+        template<class T> JsonWriter& Member(rpp::strview key, const T& value)
+        {
+            return Key(key).Value(value);
+        }
+
+    private:
+        void Separate();
+        void WriteString(rpp::strview s);
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -2,7 +2,14 @@
 #include <rpp/file_io.h>
 #include <rpp/sprint.h>
 #include <rpp/timer.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include "InternalConfig.h"
+#include "Hash.h"
+#include "MeshCache.h"
+#include "Parallel.h"
+#include "PositionWeld.h"
 
 namespace Nano
 {
@@ -185,6 +192,12 @@ namespace Nano
 
     void MeshGroup::RecalculateNormals(const bool checkDuplicateVerts) noexcept
     {
+        if (checkDuplicateVerts)
+        {
+            RecalculateWeldedNormals();
+            return;
+        }
+
         for (rpp::Vector3& normal : Normals)
             normal = rpp::Vector3::Zero();
 
@@ -195,11 +208,55 @@ namespace Nano
         {
             if (winding == FaceWinding::CCW)
             {
-                UpdateNormal(tri.a, tri.b, tri.c, checkDuplicateVerts);
+                UpdateNormal(tri.a, tri.b, tri.c);
             }
             else
             {
-                UpdateNormal(tri.c, tri.b, tri.a, checkDuplicateVerts);
+                UpdateNormal(tri.c, tri.b, tri.a);
+            }
+        }
+        for (rpp::Vector3& normal : Normals)
+            normal.normalize();
+    }
+
+    void MeshGroup::RecalculateWeldedNormals(float weldEpsilon) noexcept
+    {
+        // weld class of every vertex, so all vertices at the same position share one normal sum
+        std::vector<rpp::Vector3> classPositions;
+        std::vector<int> classes(Verts.size());
+        {
+            PositionWeldTable welded { classPositions, Verts.size(), weldEpsilon };
+            for (size_t i = 0; i < Verts.size(); ++i)
+                classes[i] = welded.Insert(Verts[i]);
+        }
+
+        // a face contributes once to every class it touches
+        const rpp::Vector3* verts = Verts.data();
+        std::vector<rpp::Vector3> classNormals(classPositions.size(), rpp::Vector3::Zero());
+        const bool ccw = Winding == FaceWinding::CCW;
+        for (const Triangle& tri : Tris)
+        {
+            const VertexDescr& vd0 = ccw ? tri.a : tri.c;
+            const VertexDescr& vd2 = ccw ? tri.c : tri.a;
+            const rpp::Vector3& v0 = verts[vd0.v];
+            rpp::Vector3 normal = (verts[tri.b.v] - v0).cross(verts[vd2.v] - v0);
+
+            int c0 = classes[vd0.v], c1 = classes[tri.b.v], c2 = classes[vd2.v];
+            classNormals[c0] += normal;
+            if (c1 != c0)             classNormals[c1] += normal;
+            if (c2 != c0 && c2 != c1) classNormals[c2] += normal;
+        }
+
+        // and every corner adds its class sum, which matches the exhaustive UpdateNormal search
+        for (rpp::Vector3& normal : Normals)
+            normal = rpp::Vector3::Zero();
+        rpp::Vector3* normals = Normals.data();
+        for (const Triangle& tri : Tris)
+        {
+            for (const VertexDescr& vd : tri)
+            {
+                Assert(vd.n != -1, "Invalid vertex normalId -1");
+                normals[vd.n] += classNormals[classes[vd.v]];
             }
         }
         for (rpp::Vector3& normal : Normals)
@@ -352,51 +409,74 @@ namespace Nano
                 addVertex(vd);
     }
 
-    void MeshGroup::SplitSeamVertices() noexcept
+    void MeshGroup::SplitSeamVertices(int numThreads) noexcept
     {
-        auto canShareVertex = [](const VertexDescr& a, const VertexDescr& b) {
-            return a.t == b.t && a.n == b.n && a.c == b.c;
+        const int numTris    = NumTris();
+        const int numCorners = numTris * 3;
+        const Triangle* oldFaces = Tris.data();
+
+        // corners are sharded by vertex index, so every shard finds its unique corners independently
+        const int numShards = std::max(1, std::min(numThreads, numCorners / 65536));
+        const auto shardOf = [&](int corner) {
+            return int(uint32_t(oldFaces[corner / 3][corner % 3].v) % uint32_t(numShards));
         };
 
-        std::unordered_multimap<int, VertexDescr> addedVerts; addedVerts.reserve(NumVerts());
+        // bucket the corners by shard, keeping them in ascending order within each shard
+        std::vector<int> shardStart(numShards + 1, 0);
+        std::vector<int> shardCorners;
+        if (numShards > 1)
+        {
+            for (int corner = 0; corner < numCorners; ++corner)
+                ++shardStart[shardOf(corner) + 1];
+            for (int shard = 0; shard < numShards; ++shard)
+                shardStart[shard + 1] += shardStart[shard];
+
+            shardCorners.resize(numCorners);
+            std::vector<int> next(shardStart.begin(), shardStart.end() - 1);
+            for (int corner = 0; corner < numCorners; ++corner)
+                shardCorners[next[shardOf(corner)]++] = corner;
+        }
 
-        auto getExistingVertex = [&](const VertexDescr& old, VertexDescr& out) -> bool
+        std::vector<int> firstUse(numCorners);
+        ParallelFor(numShards, numShards, [&](int shard, int)
         {
-            for (auto r = addedVerts.equal_range(old.v); r.first != r.second; ++r.first)
+            CornerTable table { oldFaces, Verts.size() / numShards };
+            if (numShards == 1)
             {
-                VertexDescr existing = r.first->second;
-                if (canShareVertex(old, existing)) {
-                    out = existing;
-                    return true;
-                }
+                for (int corner = 0; corner < numCorners; ++corner)
+                    firstUse[corner] = table.Insert(corner);
+                return;
             }
-            return false;
-        };
-
-        size_t numTris  = Tris.size();
-        auto*  oldFaces = Tris.data();
-        auto*  oldVerts = Verts.data();
+            for (int i = shardStart[shard], end = shardStart[shard + 1]; i < end; ++i)
+                firstUse[shardCorners[i]] = table.Insert(shardCorners[i]);
+        });
+
+        // new vertices are numbered in first use order, same as a serial scan
+        std::vector<int> newIds(numCorners);
+        int numVerts = 0;
+        for (int corner = 0; corner < numCorners; ++corner)
+            if (firstUse[corner] == corner)
+                newIds[corner] = numVerts++;
+
+        const rpp::Vector3* oldVerts = Verts.data();
         std::vector<Triangle> faces; faces.resize(numTris);
-        std::vector<rpp::Vector3>  verts; verts.reserve(Verts.size());
-
-        for (size_t faceId = 0; faceId < numTris; ++faceId)
+        std::vector<rpp::Vector3> verts; verts.resize(numVerts);
+        const int numBlocks = (numTris + 65535) / 65536;
+        ParallelFor(numBlocks, std::min(numShards, numBlocks), [&](int block, int)
         {
-            const Triangle& oldFace = oldFaces[faceId];
-            Triangle& newFace = faces[faceId];
-            for (int i = 0; i < 3; ++i)
+            for (int faceId = block * 65536, end = std::min(faceId + 65536, numTris); faceId < end; ++faceId)
             {
-                const VertexDescr& old = oldFace[i];
-                VertexDescr&    result = newFace[i];
-
-                if (getExistingVertex(old, result))
-                    continue;
-
-                // insert new
-                verts.push_back(oldVerts[old.v]);
-                result = { (int)verts.size() - 1, old.t, old.n, old.c };
-                addedVerts.emplace(old.v, result);
+                for (int i = 0; i < 3; ++i)
+                {
+                    const int corner = faceId * 3 + i;
+                    const VertexDescr& old = oldFaces[faceId][i];
+                    const int newId = newIds[firstUse[corner]];
+                    faces[faceId][i] = { newId, old.t, old.n, old.c };
+                    if (firstUse[corner] == corner)
+                        verts[newId] = oldVerts[old.v];
+                }
             }
-        }
+        });
         Verts = move(verts);
         Tris = move(faces);
     }
@@ -451,9 +531,9 @@ namespace Nano
         }
     }
 
-    void MeshGroup::OptimizedFlatten() noexcept
+    void MeshGroup::OptimizedFlatten(int numThreads) noexcept
     {
-        SplitSeamVertices();
+        SplitSeamVertices(numThreads);
         PerVertexFlatten();
     }
 
@@ -591,9 +671,29 @@ namespace Nano
         write_flag(o & Options::Flatten,     "Flatten");
         write_flag(o & Options::ClockWise,   "ClockWise");
         write_flag(o & Options::Unity,       "Unity");
+        write_flag(o & Options::Parallel,    "Parallel");
+        write_flag(o & Options::MemoryMap,   "MemoryMap");
+        write_flag(o & Options::Compress,    "Compress");
+        write_flag(o & Options::WeldPositions, "WeldPositions");
+        write_flag(o & Options::OptimizeVertexCache, "OptimizeVertexCache");
         return sb.str();
     }
 
+    static std::atomic<int> MaxThreads { 0 };
+
+    void SetMaxThreads(int maxThreads) noexcept
+    {
+        MaxThreads = maxThreads > 0 ? maxThreads : 0;
+    }
+
+    int GetMaxThreads() noexcept
+    {
+        if (int maxThreads = MaxThreads)
+            return maxThreads;
+        int hardwareThreads = (int)std::thread::hardware_concurrency();
+        return hardwareThreads > 0 ? hardwareThreads : 1;
+    }
+
     ///////////////////////////////////////////////////////////////////////////////////////////////
 
 
@@ -694,6 +794,16 @@ namespace Nano
     }
 
     bool Mesh::Load(rpp::strview meshPath, Options opt)
+    {
+        return Load(meshPath, opt, nullptr);
+    }
+
+    bool Mesh::Load(rpp::strview meshPath, Options opt, MeshLoadContext& ctx)
+    {
+        return Load(meshPath, opt, &ctx);
+    }
+
+    bool Mesh::Load(rpp::strview meshPath, Options opt, MeshLoadContext* ctx)
     {
         //rpp::ScopedPerfTimer perf{ "Nano::Mesh::Load" };
 
@@ -702,22 +812,49 @@ namespace Nano
                 |  Options::Flatten     | Options::ClockWise;
         }
 
+        // .nmesh files are already in the cached form
+        MeshCacheSlot cache;
+        if (!rpp::file_ext(meshPath).equalsi("nmesh"_sv) && FindMeshCacheSlot(meshPath, opt, cache))
+        {
+            if (ReadMeshCache(*this, cache, opt))
+                return true;
+            if (!LoadSource(meshPath, opt, ctx))
+                return false;
+            WriteMeshCache(*this, cache, opt);
+            return true;
+        }
+        return LoadSource(meshPath, opt, ctx);
+    }
+
+    bool Mesh::LoadSource(rpp::strview meshPath, Options opt, MeshLoadContext* ctx)
+    {
         rpp::strview ext = rpp::file_ext(meshPath);
         if (ext.equalsi("fbx"_sv)) return LoadFBX(meshPath, opt);
-        if (ext.equalsi("obj"_sv)) return LoadOBJ(meshPath, opt);
+        if (ext.equalsi("obj"_sv)) return LoadOBJ(meshPath, opt, ctx);
         if (ext.equalsi("txt"_sv)) return LoadTXT(meshPath, opt);
+        if (ext.equalsi("nmesh"_sv)) return LoadNMESH(meshPath, opt);
+        if (ext.equalsi("glb"_sv)) return LoadGLB(meshPath, opt);
+        if (ext.equalsi("ply"_sv)) return LoadPLY(meshPath, opt);
+        if (ext.equalsi("stl"_sv)) return LoadSTL(meshPath, opt);
         NanoErr(opt, "Error: unrecognized mesh format for file '%s'", meshPath);
     }
 
     void Mesh::ApplyLoadOptions(Options opt)
     {
+        const int numThreads = (opt & Options::Parallel) ? GetMaxThreads() : 1;
         if (opt & Options::SplitSeams) {
-            SplitSeamVertices();
-            for (MeshGroup& g : Groups)
-                g.SplitSeamVertices();
+            SplitSeamVertices(numThreads);
         }
         if (opt & Options::Flatten) {
-            OptimizedFlatten();
+            OptimizedFlatten(numThreads);
+        }
+        if (opt & Options::OptimizeVertexCache) {
+            for (MeshGroup& g : Groups) {
+                VertexCacheReport r = g.OptimizeVertexCache();
+                if (opt & Options::Log)
+                    LogInfo("   group  %-28s  ACMR %.3f -> %.3f  ATVR %.3f -> %.3f", g.Name,
+                            r.Before.ACMR, r.After.ACMR, r.Before.ATVR, r.After.ATVR);
+            }
         }
 
         FaceWinding winding = (opt & Options::ClockWise) ? FaceWinding::CW
@@ -746,6 +883,10 @@ namespace Nano
         rpp::strview ext = file_ext(meshPath);
         if (ext.equalsi("fbx"_sv)) return SaveAsFBX(meshPath, opt);
         if (ext.equalsi("obj"_sv)) return SaveAsOBJ(meshPath, opt);
+        if (ext.equalsi("nmesh"_sv)) return SaveAsNMESH(meshPath, opt);
+        if (ext.equalsi("glb"_sv)) return SaveAsGLB(meshPath, opt);
+        if (ext.equalsi("ply"_sv)) return SaveAsPLY(meshPath, opt);
+        if (ext.equalsi("stl"_sv)) return SaveAsSTL(meshPath, opt);
 
         NanoErr(opt, "Error: unrecognized mesh format for file '%s'", meshPath);
     }
@@ -758,6 +899,12 @@ namespace Nano
             group.RecalculateNormals(checkDuplicateVerts);
     }
 
+    void Mesh::RecalculateWeldedNormals(float weldEpsilon) noexcept
+    {
+        for (MeshGroup& group : Groups)
+            group.RecalculateWeldedNormals(weldEpsilon);
+    }
+
     void Mesh::InvertNormals() noexcept
     {
         for (MeshGroup& group : Groups)
@@ -800,10 +947,10 @@ namespace Nano
         return bounds;
     }
 
-    void Mesh::SplitSeamVertices() noexcept
+    void Mesh::SplitSeamVertices(int numThreads) noexcept
     {
         for (MeshGroup& g : Groups)
-            g.SplitSeamVertices();
+            g.SplitSeamVertices(numThreads);
     }
 
     void Mesh::FlattenMeshData() noexcept
@@ -819,10 +966,10 @@ namespace Nano
         return true;
     }
 
-    void Mesh::OptimizedFlatten() noexcept
+    void Mesh::OptimizedFlatten(int numThreads) noexcept
     {
         for (MeshGroup& group : Groups)
-            group.OptimizedFlatten();
+            group.OptimizedFlatten(numThreads);
     }
 
     void Mesh::SetFaceWinding(FaceWinding winding) noexcept
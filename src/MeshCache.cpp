@@ -0,0 +1,191 @@
+#include "MeshCache.h"
+#include <rpp/file_io.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include "InternalConfig.h"
+#include "FileSource.h"
+#include "Hash.h"
+#include "Nmesh.h"
+
+namespace Nano
+{
+    using namespace rpp::literals;
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Bump this whenever a loader or load option produces a different mesh,
+     * so all existing cache entries are rebuilt.
+     */
+    static constexpr uint64_t MeshCacheVersion = 3;
+
+    static std::mutex CacheDirMutex;
+    static std::string CacheDir;
+
+    void SetMeshCacheDir(rpp::strview cacheDir)
+    {
+        std::lock_guard<std::mutex> lock { CacheDirMutex };
+        CacheDir = cacheDir.to_string();
+    }
+
+    std::string GetMeshCacheDir()
+    {
+        std::lock_guard<std::mutex> lock { CacheDirMutex };
+        return CacheDir;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    // @return Load options which change the loaded mesh, the rest only affect how it's loaded
+    static int CachedOptions(Options opt)
+    {
+        int ignored = int(Options::NoThrow | Options::Log | Options::Parallel
+                        | Options::MemoryMap | Options::Compress);
+        return int(opt) & ~ignored;
+    }
+
+    // @return Content hash of a dependency file, 0 if it doesn't exist
+    static uint64_t HashDependency(rpp::strview path)
+    {
+        FileSource file { path, true };
+        return file ? Hash64::Bytes(file.str, file.len) : 0;
+    }
+
+    // Calls func(name) for every `mtllib name` statement of an OBJ file
+    template<class Func> static void ForEachMtlLib(const char* data, size_t len, const Func& func)
+    {
+        // 'm' only appears in usemtl/mtllib statements and names, so this skips
+        // through the vertex and face data at memchr speed
+        const char* end = data + len;
+        for (const char* p = data; (p = (const char*)memchr(p, 'm', end - p)) != nullptr; ++p)
+        {
+            if ((p == data || p[-1] == '\n') && end - p > 7 &&
+                memcmp(p, "mtllib", 6) == 0 && (p[6] == ' ' || p[6] == '\t'))
+            {
+                const char* eol = (const char*)memchr(p, '\n', end - p);
+                if (!eol) eol = end;
+                rpp::strview name { p + 7, eol };
+                func(name.trim());
+                p = eol - 1;
+            }
+        }
+    }
+
+    // @return FALSE if the source mesh can't be read
+    static bool HashSource(rpp::strview meshPath, uint64_t& hash)
+    {
+        FileSource file { meshPath, true };
+        if (!file)
+            return false;
+
+        hash = Hash64::Bytes(file.str, file.len, MeshCacheVersion);
+        if (rpp::file_ext(meshPath).equalsi("obj"_sv))
+        {
+            // materials are part of the loaded mesh, so .mtl edits invalidate it too
+            rpp::strview folder = rpp::folder_path(meshPath);
+            ForEachMtlLib(file.str, file.len, [&](rpp::strview matlibFile) {
+                hash = Hash64::Combine(hash, HashDependency(rpp::path_combine(folder, matlibFile)));
+            });
+            hash = Hash64::Combine(hash, HashDependency(rpp::file_replace_ext(meshPath, "mtl")));
+        }
+        return true;
+    }
+
+    bool FindMeshCacheSlot(rpp::strview meshPath, Options opt, MeshCacheSlot& slot)
+    {
+        std::string cacheDir = GetMeshCacheDir();
+        if (cacheDir.empty())
+            return false;
+
+        uint64_t sourceHash;
+        if (!HashSource(meshPath, sourceHash))
+            return false;
+
+        // one slot per source file and options, so every combination keeps its own entry
+        std::string fullPath = rpp::full_path(meshPath);
+        uint64_t pathHash = Hash64::Bytes(fullPath.data(), fullPath.size());
+        int options = CachedOptions(opt);
+
+        char suffix[64];
+        snprintf(suffix, sizeof(suffix), "-%016llx-%x.nmesh", (unsigned long long)pathHash, options);
+        slot.path = rpp::path_combine(cacheDir, rpp::file_name(meshPath).to_string() + suffix);
+        slot.key = Hash64::Combine(sourceHash, (uint64_t)options);
+        if (slot.key == 0) slot.key = 1; // 0 means no source hash
+        return true;
+    }
+
+    bool ReadMeshCache(Mesh& mesh, const MeshCacheSlot& slot, Options opt)
+    {
+        if (!rpp::file_exists(slot.path))
+            return false;
+
+        // stale, corrupted or incompatible entries are simply a cache miss
+        Options readOpt = Options(int(opt) & ~int(Options::NoThrow | Options::Log));
+        bool hit = false;
+        try
+        {
+            hit = ReadNmesh(mesh, slot.path, readOpt, slot.key);
+        }
+        catch (const std::exception&)
+        {
+        }
+        if (!hit)
+        {
+            mesh.Clear();
+            return false;
+        }
+
+        if (opt & Options::Log) {
+            LogInfo("Load %-33s  %5d verts  %5d tris  (cached)",
+                    rpp::file_nameext(slot.path), mesh.TotalVerts(), mesh.TotalTris());
+        }
+        return true;
+    }
+
+    void WriteMeshCache(const Mesh& mesh, const MeshCacheSlot& slot, Options opt)
+    {
+        rpp::strview folder = rpp::folder_path(slot.path);
+        if (!rpp::folder_exists(folder) && !rpp::create_folder(folder)) {
+            LogWarning("Failed to create mesh cache dir: %s", folder);
+            return;
+        }
+
+        // written to a unique temporary file first, so concurrent loads
+        // of the same mesh never read a partially written entry
+        static std::atomic<unsigned> counter { 0 };
+        char suffix[96];
+        snprintf(suffix, sizeof(suffix), ".%zx-%llx-%u.tmp",
+                 std::hash<std::thread::id>{}(std::this_thread::get_id()),
+                 (unsigned long long)std::chrono::steady_clock::now().time_since_epoch().count(),
+                 counter++);
+        std::string tempPath = slot.path + suffix;
+
+        Options writeOpt = Options(int(opt) & ~int(Options::NoThrow | Options::Log));
+        bool written = false;
+        try
+        {
+            written = WriteNmesh(mesh, tempPath, writeOpt, slot.key);
+        }
+        catch (const std::exception& e)
+        {
+            LogWarning("%s", e.what());
+        }
+
+        if (written && std::rename(tempPath.c_str(), slot.path.c_str()) != 0)
+        {
+            // rename doesn't replace existing files on all platforms
+            std::remove(slot.path.c_str());
+            written = std::rename(tempPath.c_str(), slot.path.c_str()) == 0;
+        }
+        if (!written)
+        {
+            std::remove(tempPath.c_str());
+            LogWarning("Failed to write mesh cache entry: %s", slot.path);
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
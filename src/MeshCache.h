@@ -0,0 +1,28 @@
+#pragma once
+#include <Nano/Mesh.h>
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Entry of the derived data cache for one source mesh and set of load options
+     * @see Nano::SetMeshCacheDir()
+     */
+    struct MeshCacheSlot
+    {
+        std::string path; // cached .nmesh file
+        uint64_t key = 0; // hash of the source contents, its dependencies, load options and cache version
+    };
+
+    // @return TRUE if the cache is enabled and the source mesh could be hashed
+    bool FindMeshCacheSlot(rpp::strview meshPath, Options opt, MeshCacheSlot& slot);
+
+    // @return TRUE if the slot holds an up to date entry, which was read into `mesh`
+    bool ReadMeshCache(Mesh& mesh, const MeshCacheSlot& slot, Options opt);
+
+    // Stores a freshly loaded mesh in the slot, failures are only logged
+    void WriteMeshCache(const Mesh& mesh, const MeshCacheSlot& slot, Options opt);
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,617 @@
+#include <Nano/MeshCodec.h>
+#include <algorithm>
+#include <cstring>
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Encoded layout:
+     *
+     *   uint8 format          CodecKind, | CodecEntropy if the rest is wrapped in the rANS stage
+     *   varint count          number of elements or triangles
+     *   ...                   kind specific payload
+     */
+    enum CodecFormat : uint8_t
+    {
+        CodecVertexLayer = 1,
+        CodecTriangles   = 2,
+        CodecKindMask    = 0x0f,
+        CodecEntropy     = 0x80,
+    };
+
+    static void PutVarint(std::vector<uint8_t>& out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(uint8_t(value) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(uint8_t(value));
+    }
+
+    static int CountTrailingZeros(uint64_t bits)
+    {
+    #if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index; _BitScanForward64(&index, bits);
+        return int(index);
+    #else
+        return __builtin_ctzll(bits);
+    #endif
+    }
+
+    // Bounds checked reader, all reads fail after the first overflow
+    struct CodecReader
+    {
+        const uint8_t* ptr;
+        const uint8_t* end;
+        bool ok = true;
+
+        uint64_t Varint()
+        {
+            if (ptr < end && *ptr < 0x80) // most values fit in one byte
+                return *ptr++;
+            if (end - ptr >= 8)
+            {
+                // branchless decode of varints up to 8 bytes, the first byte without
+                // the continuation bit ends the value
+                uint64_t word; memcpy(&word, ptr, 8);
+                uint64_t stops = ~word & 0x8080808080808080ull;
+                if (stops)
+                {
+                    int len = CountTrailingZeros(stops) / 8 + 1;
+                    uint64_t value = 0;
+                    for (int i = 0; i < 8; ++i)
+                        value |= (word >> i) & (0x7full << (7*i));
+                    ptr += len;
+                    return value & ((1ull << (7*len)) - 1);
+                }
+            }
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64 && ptr < end; shift += 7)
+            {
+                uint8_t b = *ptr++;
+                value |= uint64_t(b & 0x7f) << shift;
+                if (b < 0x80)
+                    return value;
+            }
+            ok = false;
+            return 0;
+        }
+
+        uint8_t Byte()
+        {
+            if (ptr < end)
+                return *ptr++;
+            ok = false;
+            return 0;
+        }
+
+        bool AtEnd() const { return ok && ptr == end; }
+    };
+
+    static uint32_t ZigZag(int32_t v) { return (uint32_t(v) << 1) ^ uint32_t(v >> 31); }
+    static int32_t UnZigZag(uint32_t v) { return int32_t(v >> 1) ^ -int32_t(v & 1); }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Order-0 rANS with 12-bit probabilities and four interleaved states:
+     *
+     *   varint size           number of decoded bytes
+     *   varint freq[256]      normalized symbol frequencies, sum is RansProbScale
+     *   uint32 state[4]       final encoder states
+     *   uint16 words...       renormalization words
+     *
+     * States are renormalized 16 bits at a time, which happens at most once per symbol,
+     * so the decoder does it without a loop or branch.
+     */
+    static constexpr int RansProbBits = 12;
+    static constexpr uint32_t RansProbScale = 1u << RansProbBits;
+    static constexpr uint32_t RansLow = 1u << 16; // lower bound of a normalized state
+
+    static void RansNormalize(const uint8_t* data, size_t size, uint32_t (&freq)[256])
+    {
+        uint64_t counts[256] = {};
+        for (size_t i = 0; i < size; ++i)
+            ++counts[data[i]];
+
+        memset(freq, 0, sizeof(freq));
+        if (size == 0)
+        {
+            freq[0] = RansProbScale;
+            return;
+        }
+
+        // every present symbol needs at least 1, the rounding error goes to the most frequent ones
+        uint32_t sum = 0, maxSym = 0;
+        for (uint32_t s = 0; s < 256; ++s)
+        {
+            if (!counts[s]) continue;
+            freq[s] = std::max<uint32_t>(1, uint32_t(counts[s] * RansProbScale / size));
+            sum += freq[s];
+            if (freq[s] > freq[maxSym]) maxSym = s;
+        }
+        if (sum < RansProbScale)
+        {
+            freq[maxSym] += RansProbScale - sum;
+            return;
+        }
+        while (sum > RansProbScale)
+        {
+            uint32_t largest = uint32_t(std::max_element(freq, freq + 256) - freq);
+            --freq[largest];
+            --sum;
+        }
+    }
+
+    static void RansEncode(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+    {
+        uint32_t freq[256], start[256];
+        RansNormalize(data, size, freq);
+        for (uint32_t s = 0, total = 0; s < 256; total += freq[s], ++s)
+            start[s] = total;
+
+        PutVarint(out, size);
+        for (uint32_t f : freq)
+            PutVarint(out, f);
+
+        // the encoder runs backwards, so the words are written from the end of a scratch buffer;
+        // a symbol emits at most one word
+        std::vector<uint8_t> scratch(size*2 + 8);
+        uint8_t* end = scratch.data() + scratch.size();
+        uint8_t* p = end;
+        uint32_t state[4] = { RansLow, RansLow, RansLow, RansLow };
+        for (size_t i = size; i-- > 0;)
+        {
+            uint32_t& x = state[i & 3];
+            uint32_t f = freq[data[i]];
+            uint32_t xmax = ((RansLow >> RansProbBits) << 16) * f;
+            if (x >= xmax)
+            {
+                uint16_t word = uint16_t(x);
+                p -= 2; memcpy(p, &word, 2);
+                x >>= 16;
+            }
+            x = ((x / f) << RansProbBits) + (x % f) + start[data[i]];
+        }
+        p -= sizeof(state);
+        memcpy(p, state, sizeof(state));
+        out.insert(out.end(), p, end);
+    }
+
+    // @param maxSize Upper bound of the decoded size, rejects corrupted size fields
+    static bool RansDecode(CodecReader& r, std::vector<uint8_t>& out, uint64_t maxSize)
+    {
+        uint64_t size = r.Varint();
+        if (!r.ok || size > maxSize)
+            return false;
+
+        uint32_t freq[256], start[256], total = 0;
+        for (uint32_t s = 0; s < 256; ++s)
+        {
+            uint64_t f = r.Varint();
+            if (f > RansProbScale - total)
+                return false;
+            freq[s] = uint32_t(f);
+            start[s] = total;
+            total += freq[s];
+        }
+        if (!r.ok || total != RansProbScale || r.end - r.ptr < 16)
+            return false;
+
+        // one lookup per symbol: (freq - 1) << 20 | (slot - start) << 8 | symbol
+        std::vector<uint32_t> slots(RansProbScale);
+        for (uint32_t s = 0; s < 256; ++s)
+            for (uint32_t i = 0; i < freq[s]; ++i)
+                slots[start[s] + i] = (freq[s] - 1) << 20 | i << 8 | s;
+
+        uint32_t x0, x1, x2, x3;
+        memcpy(&x0, r.ptr, 4);
+        memcpy(&x1, r.ptr + 4, 4);
+        memcpy(&x2, r.ptr + 8, 4);
+        memcpy(&x3, r.ptr + 12, 4);
+        const uint8_t* p = r.ptr + 16;
+        const uint8_t* end = r.end;
+        const uint32_t* table = slots.data();
+
+        auto decode = [table](uint32_t& x) -> uint8_t {
+            uint32_t entry = table[x & (RansProbScale - 1)];
+            x = ((entry >> 20) + 1) * (x >> RansProbBits) + ((entry >> 8) & (RansProbScale - 1));
+            return uint8_t(entry);
+        };
+        // written as arithmetic, because compilers tend to turn the condition into a branch
+        auto renormalize = [&p](uint32_t& x) {
+            uint16_t word; memcpy(&word, p, 2);
+            uint32_t refill = uint32_t(x < RansLow);
+            x = (x << (refill * 16)) | (word & (0u - refill));
+            p += refill * 2;
+        };
+
+        out.resize(size);
+        uint8_t* dst = out.data();
+        size_t i = 0;
+        for (; i + 3 < size && end - p >= 8; i += 4)
+        {
+            dst[i]     = decode(x0);
+            dst[i + 1] = decode(x1);
+            dst[i + 2] = decode(x2);
+            dst[i + 3] = decode(x3);
+            renormalize(x0);
+            renormalize(x1);
+            renormalize(x2);
+            renormalize(x3);
+        }
+        for (; i < size; ++i) // the last words are bounds checked
+        {
+            uint32_t& x = (i & 3) == 0 ? x0 : (i & 3) == 1 ? x1 : (i & 3) == 2 ? x2 : x3;
+            dst[i] = decode(x);
+            if (x < RansLow)
+            {
+                if (end - p < 2)
+                    return false;
+                renormalize(x);
+            }
+        }
+        r.ptr = p;
+        // the decoder ends in the initial encoder states, which doubles as an integrity check
+        return x0 == RansLow && x1 == RansLow && x2 == RansLow && x3 == RansLow;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    // Writes the format byte and payload, wrapped in the entropy stage if that saves at least 1/8,
+    // since it decodes a few times slower than the plain payload
+    static void FinishEncoding(uint8_t kind, const std::vector<uint8_t>& payload,
+                               std::vector<uint8_t>& out, bool entropy)
+    {
+        out.clear();
+        if (entropy)
+        {
+            out.push_back(kind | CodecEntropy);
+            RansEncode(payload.data(), payload.size(), out);
+            if (out.size() <= payload.size() - payload.size()/8)
+                return;
+            out.clear();
+        }
+        out.reserve(payload.size() + 1);
+        out.push_back(kind);
+        out.insert(out.end(), payload.begin(), payload.end());
+    }
+
+    // @return Reader over the plain payload, the entropy stage is decoded into `scratch`
+    static bool OpenPayload(const uint8_t* data, size_t size, uint8_t kind, uint64_t maxPayload,
+                            std::vector<uint8_t>& scratch, CodecReader& r)
+    {
+        if (size == 0 || (data[0] & CodecKindMask) != kind)
+            return false;
+        r = CodecReader{ data + 1, data + size };
+        if (data[0] & CodecEntropy)
+        {
+            if (!RansDecode(r, scratch, maxPayload) || !r.AtEnd())
+                return false;
+            r = CodecReader{ scratch.data(), scratch.data() + scratch.size() };
+        }
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    // maps float bits to integers which sort like the floats, so nearby values have small deltas
+    static uint32_t FloatToOrdered(float f)
+    {
+        uint32_t u; memcpy(&u, &f, 4);
+        return u ^ (uint32_t(int32_t(u) >> 31) & 0x7fffffff);
+    }
+
+    static float OrderedToFloat(uint32_t u)
+    {
+        u ^= uint32_t(int32_t(u) >> 31) & 0x7fffffff;
+        float f; memcpy(&f, &u, 4);
+        return f;
+    }
+
+    /**
+     * Vertex layer payload:
+     *
+     *   uint8 numComponents
+     *   uint8 control[(n+3)/4]   2-bit byte lengths (1-4) of the n = count*numComponents deltas
+     *   deltas...                zigzag deltas from the previous element, 1-4 bytes each,
+     *                            followed by 3 padding bytes
+     *
+     * This is the Stream VByte layout of varints: the lengths are known before the values,
+     * so decoding is a branch free unaligned load per value.
+     */
+    static constexpr uint32_t VByteMasks[4] = { 0xff, 0xffff, 0xffffff, 0xffffffff };
+    static constexpr int VBytePadding = 3;
+
+    void EncodeVertexLayer(const float* values, size_t numElements, int numComponents,
+                           std::vector<uint8_t>& out, bool entropy)
+    {
+        numComponents = std::clamp(numComponents, 1, 4);
+        size_t numValues = numElements * numComponents;
+        std::vector<uint8_t> payload;
+        PutVarint(payload, numElements);
+        payload.push_back(uint8_t(numComponents));
+        size_t control = payload.size();
+        payload.resize(control + (numValues + 3)/4, 0);
+        payload.reserve(payload.size() + numValues*3 + VBytePadding);
+
+        uint32_t prev[4] = {};
+        for (size_t i = 0, j = 0; i < numElements; ++i)
+        {
+            for (int k = 0; k < numComponents; ++k, ++j)
+            {
+                uint32_t ordered = FloatToOrdered(values[j]);
+                uint32_t delta = ZigZag(int32_t(ordered - prev[k]));
+                prev[k] = ordered;
+
+                int len = delta < (1u << 8) ? 1 : delta < (1u << 16) ? 2 : delta < (1u << 24) ? 3 : 4;
+                payload[control + j/4] |= uint8_t((len - 1) << ((j & 3) * 2));
+                for (int b = 0; b < len; ++b)
+                    payload.push_back(uint8_t(delta >> (b*8)));
+            }
+        }
+        payload.insert(payload.end(), VBytePadding, 0);
+        FinishEncoding(CodecVertexLayer, payload, out, entropy);
+    }
+
+    bool DecodeVertexLayer(const uint8_t* data, size_t size, float* values,
+                           size_t numElements, int numComponents)
+    {
+        if (numComponents < 1 || numComponents > 4)
+            return false;
+
+        size_t numValues = numElements * numComponents;
+        size_t numControl = (numValues + 3) / 4;
+        uint64_t maxPayload = 16 + numControl + uint64_t(numValues)*4 + VBytePadding;
+        std::vector<uint8_t> scratch;
+        CodecReader r { nullptr, nullptr };
+        if (!OpenPayload(data, size, CodecVertexLayer, maxPayload, scratch, r))
+            return false;
+        if (r.Varint() != numElements || r.Byte() != numComponents || !r.ok ||
+            uint64_t(r.end - r.ptr) < numControl)
+            return false;
+
+        // the total size is validated up front, so the decode loop needs no bounds checks
+        const uint8_t* control = r.ptr;
+        const uint8_t* deltas = control + numControl;
+        uint64_t deltasSize = VBytePadding;
+        for (size_t j = 0; j < numValues; ++j)
+            deltasSize += ((control[j >> 2] >> ((j & 3) * 2)) & 3) + 1;
+        if (uint64_t(r.end - deltas) != deltasSize)
+            return false;
+
+        uint32_t prev[4] = {};
+        for (size_t i = 0, j = 0; i < numElements; ++i)
+        {
+            for (int k = 0; k < numComponents; ++k, ++j)
+            {
+                uint32_t code = (control[j >> 2] >> ((j & 3) * 2)) & 3;
+                uint32_t delta; memcpy(&delta, deltas, 4);
+                deltas += code + 1;
+                prev[k] += uint32_t(UnZigZag(delta & VByteMasks[code]));
+                values[j] = OrderedToFloat(prev[k]);
+            }
+        }
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Triangle payload:
+     *
+     *   uint8 componentMask   VertexDescr components stored, the others are -1 in every corner
+     *   uint8 codes[count]    0: all corners are coded
+     *                         1 + edge*3 + rotation: corners `rotation` and `rotation+1` are the
+     *                         reversed edge of a recent triangle, only the third corner is coded
+     *   varint corners...     (fifoIndex << 1) | 1 for a recently coded corner, or
+     *                         zigzag delta from the next new index of each stored component,
+     *                         with the first one shifted left by 1
+     *
+     * The encoder and decoder keep identical prediction state, so the decoder
+     * never searches and runs at a constant cost per triangle.
+     */
+    struct TriangleCoderState
+    {
+        static constexpr int FifoSize = 16;
+        static constexpr int MaxCode = 1 + (FifoSize - 1)*3 + 2;
+
+        VertexDescr edges[FifoSize][2]; // directed edges of recent triangles
+        VertexDescr corners[FifoSize];  // recently coded corners
+        int edgeHead = 0;
+        int cornerHead = 0;
+        int next[4] = {}; // highest index + 1 seen for each component
+        uint8_t mask = 0;
+
+        // @param i 0 is the newest edge
+        const VertexDescr* Edge(int i) const { return edges[(edgeHead - 1 - i) & (FifoSize - 1)]; }
+        const VertexDescr& Corner(int i) const { return corners[(cornerHead - 1 - i) & (FifoSize - 1)]; }
+
+        void PushEdges(const Triangle& t)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                VertexDescr* edge = edges[edgeHead];
+                edge[0] = t[i];
+                edge[1] = t[i == 2 ? 0 : i + 1];
+                edgeHead = (edgeHead + 1) & (FifoSize - 1);
+            }
+        }
+
+        void PushCorner(const VertexDescr& d)
+        {
+            corners[cornerHead] = d;
+            cornerHead = (cornerHead + 1) & (FifoSize - 1);
+        }
+
+        void UpdateNext(int k, int index)
+        {
+            int following = int(uint32_t(index) + 1u);
+            if (following > next[k]) next[k] = following;
+        }
+    };
+
+    static_assert(sizeof(VertexDescr) == 4*sizeof(int), "VertexDescr layout changed");
+    static const int* Components(const VertexDescr& d) { return &d.v; }
+    static int* Components(VertexDescr& d) { return &d.v; }
+
+    static void EncodeCorner(TriangleCoderState& state, const VertexDescr& d, std::vector<uint8_t>& out)
+    {
+        for (int i = 0; i < TriangleCoderState::FifoSize; ++i)
+        {
+            if (state.Corner(i) == d)
+            {
+                PutVarint(out, (uint64_t(i) << 1) | 1);
+                return;
+            }
+        }
+
+        const int* c = Components(d);
+        bool first = true;
+        for (int k = 0; k < 4; ++k)
+        {
+            if (!(state.mask & (1 << k)))
+                continue;
+            uint64_t delta = ZigZag(int32_t(uint32_t(c[k]) - uint32_t(state.next[k])));
+            PutVarint(out, first ? delta << 1 : delta);
+            first = false;
+            state.UpdateNext(k, c[k]);
+        }
+        if (first) // no stored components
+            PutVarint(out, 0);
+        state.PushCorner(d);
+    }
+
+    static VertexDescr DecodeCorner(TriangleCoderState& state, CodecReader& r)
+    {
+        uint64_t token = r.Varint();
+        if (token & 1)
+        {
+            if ((token >> 1) >= TriangleCoderState::FifoSize) {
+                r.ok = false;
+                return {};
+            }
+            return state.Corner(int(token >> 1));
+        }
+
+        VertexDescr d;
+        int* c = Components(d);
+        bool first = true;
+        for (int k = 0; k < 4; ++k)
+        {
+            if (!(state.mask & (1 << k)))
+                continue;
+            uint64_t delta = first ? token >> 1 : r.Varint();
+            first = false;
+            c[k] = int(uint32_t(state.next[k]) + uint32_t(UnZigZag(uint32_t(delta))));
+            state.UpdateNext(k, c[k]);
+        }
+        state.PushCorner(d);
+        return d;
+    }
+
+    void EncodeTriangles(const Triangle* tris, size_t numTris, std::vector<uint8_t>& out, bool entropy)
+    {
+        TriangleCoderState state;
+        for (size_t i = 0; i < numTris; ++i)
+            for (const VertexDescr& d : tris[i])
+                for (int k = 0; k < 4; ++k)
+                    if (Components(d)[k] != -1)
+                        state.mask |= uint8_t(1 << k);
+
+        std::vector<uint8_t> payload;
+        std::vector<uint8_t> corners;
+        payload.reserve(numTris + 16);
+        corners.reserve(numTris * 4);
+        PutVarint(payload, numTris);
+        payload.push_back(state.mask);
+
+        for (size_t i = 0; i < numTris; ++i)
+        {
+            const Triangle& t = tris[i];
+            int code = 0;
+            for (int e = 0; e < TriangleCoderState::FifoSize && !code; ++e)
+            {
+                const VertexDescr* edge = state.Edge(e);
+                for (int rot = 0; rot < 3; ++rot)
+                {
+                    if (t[rot] == edge[1] && t[rot == 2 ? 0 : rot + 1] == edge[0])
+                    {
+                        code = 1 + e*3 + rot;
+                        break;
+                    }
+                }
+            }
+            payload.push_back(uint8_t(code));
+
+            if (code)
+            {
+                int rot = (code - 1) % 3;
+                EncodeCorner(state, t[(rot + 2) % 3], corners);
+            }
+            else
+            {
+                EncodeCorner(state, t.a, corners);
+                EncodeCorner(state, t.b, corners);
+                EncodeCorner(state, t.c, corners);
+            }
+            state.PushEdges(t);
+        }
+
+        payload.insert(payload.end(), corners.begin(), corners.end());
+        FinishEncoding(CodecTriangles, payload, out, entropy);
+    }
+
+    bool DecodeTriangles(const uint8_t* data, size_t size, Triangle* tris, size_t numTris)
+    {
+        // a code byte and 3 corners of up to 4 varints each
+        uint64_t maxPayload = 16 + uint64_t(numTris) * (1 + 3*4*10);
+        std::vector<uint8_t> scratch;
+        CodecReader r { nullptr, nullptr };
+        if (!OpenPayload(data, size, CodecTriangles, maxPayload, scratch, r))
+            return false;
+
+        TriangleCoderState state;
+        if (r.Varint() != numTris || !r.ok)
+            return false;
+        state.mask = r.Byte();
+        if (!r.ok || state.mask > 0x0f || uint64_t(r.end - r.ptr) < numTris)
+            return false;
+
+        const uint8_t* codes = r.ptr;
+        r.ptr += numTris;
+        for (size_t i = 0; i < numTris; ++i)
+        {
+            Triangle& t = tris[i];
+            int code = codes[i];
+            if (code)
+            {
+                if (code > TriangleCoderState::MaxCode)
+                    return false;
+                int e = (code - 1) / 3, rot = (code - 1) % 3;
+                const VertexDescr* edge = state.Edge(e);
+                t[rot] = edge[1];
+                t[rot == 2 ? 0 : rot + 1] = edge[0];
+                t[(rot + 2) % 3] = DecodeCorner(state, r);
+            }
+            else
+            {
+                t.a = DecodeCorner(state, r);
+                t.b = DecodeCorner(state, r);
+                t.c = DecodeCorner(state, r);
+            }
+            if (!r.ok)
+                return false;
+            state.PushEdges(t);
+        }
+        return r.AtEnd();
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -47,6 +47,30 @@ void NanoMeshGroup::InitVerts()
 
 ////////////////////////////////////////////////////////////////////////////////////
 
+NanoQuantizedVertices::NanoQuantizedVertices(const MeshGroup& group, const QuantizeOptions& options)
+{
+    group.CreateQuantizedVertexData(Data, options);
+    Vertices         = Data.Vertices;
+    Indices          = Data.Indices;
+    NumVertices      = Data.NumVertices;
+    Stride           = Data.Stride;
+    NormalByteOffset = Data.NormalByteOffset;
+    CoordByteOffset  = Data.CoordByteOffset;
+    ColorByteOffset  = Data.ColorByteOffset;
+    NormalFormat     = Data.NormalFormat;
+    CoordFormat      = Data.CoordFormat;
+    PosOffset        = Data.PosOffset;
+    PosScale         = Data.PosScale;
+    CoordOffset      = Data.CoordOffset;
+    CoordScale       = Data.CoordScale;
+    MaxPosError      = Data.MaxPosError;
+    MaxNormalError   = Data.MaxNormalError;
+    MaxCoordError    = Data.MaxCoordError;
+    MaxColorError    = Data.MaxColorError;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+
 NanoMesh::NanoMesh() = default;
 
 NANOMESH_API void PrintOptions(Nano::Options o)
@@ -152,6 +176,20 @@ NANOMESH_CAPI NanoMeshGroup* NanoMeshNewGroup(NanoMesh* mesh, const char* groupn
     return mesh->AddGroup(groupname);
 }
 
+NANOMESH_CAPI NanoQuantizedVertices* NanoMeshGroupQuantize(NanoMeshGroup* group,
+                                                           NormalQuantization normals,
+                                                           CoordQuantization coords)
+{
+    if (!group || group->Group.IsEmpty())
+        return nullptr;
+    return new NanoQuantizedVertices{ group->Group, QuantizeOptions{ normals, coords } };
+}
+
+NANOMESH_CAPI void NanoQuantizedVerticesClose(NanoQuantizedVertices* vertices)
+{
+    delete vertices;
+}
+
 NANOMESH_CAPI void NanoMeshGroupSetMaterial(
                 NanoMeshGroup* group, 
                 const char* name,
@@ -0,0 +1,44 @@
+#pragma once
+#include <Nano/Mesh.h>
+#include <vector>
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Assigns a dense GPU vertex id to every triangle corner. Every unique VertexDescr
+     * is one vertex, numbered in first use order, so after OptimizedFlatten() the ids
+     * follow the first use order of vd.v
+     * @param ids [out] Vertex id of every corner, 3 per triangle
+     * @return Number of unique vertices
+     */
+    int CornerVertexIds(const MeshGroup& g, std::vector<int>& ids);
+
+    /**
+     * Simulates a FIFO post-transform vertex cache, like the GPU uses
+     * @param ids Vertex id of every corner, 3 per triangle
+     */
+    VertexCacheStats SimulateVertexCache(const std::vector<int>& ids, int numVertices, int cacheSize);
+
+    /**
+     * Attribute layers that are indexed with vd.v instead of their own index.
+     * A PerVertex layer only counts if it has exactly one element per vertex
+     */
+    struct PerVertexLayers
+    {
+        bool Coords, Normals, Colors;
+        explicit PerVertexLayers(const MeshGroup& g) noexcept;
+    };
+
+    /**
+     * Remaps every triangle corner after the vertices or layers were reordered or merged.
+     * Per vertex layers follow vertexRemap, the other layers use their own remap table,
+     * or keep their indices if that table is empty
+     */
+    void RemapCorners(std::vector<Triangle>& tris, const PerVertexLayers& perVertex,
+                      const std::vector<int>& vertexRemap, const std::vector<int>& coordRemap,
+                      const std::vector<int>& normalRemap, const std::vector<int>& colorRemap);
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,357 @@
+#include <Nano/Mesh.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "InternalConfig.h"
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    struct MeshLoadHandle::State
+    {
+        std::string path;
+        Options options;
+        Mesh mesh;
+        std::atomic<MeshLoadStatus> status { MeshLoadStatus::Queued };
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::string error;
+
+        State(rpp::strview path, Options options) : path{ path }, options{ options } {}
+
+        static bool IsFinal(MeshLoadStatus status) noexcept
+        {
+            return status != MeshLoadStatus::Queued && status != MeshLoadStatus::Loading;
+        }
+
+        // Queued -> Loading, fails if the load was cancelled
+        bool Start() noexcept
+        {
+            MeshLoadStatus expected = MeshLoadStatus::Queued;
+            return status.compare_exchange_strong(expected, MeshLoadStatus::Loading);
+        }
+
+        bool Cancel()
+        {
+            {
+                std::lock_guard<std::mutex> lock { mutex };
+                MeshLoadStatus expected = MeshLoadStatus::Queued;
+                if (!status.compare_exchange_strong(expected, MeshLoadStatus::Cancelled))
+                    return false;
+                error = "Mesh load cancelled: " + path;
+            }
+            ready.notify_all();
+            return true;
+        }
+
+        void Run()
+        {
+            // always load with exceptions, so the error message can be captured
+            Options opt = Options(int(options) & ~int(Options::NoThrow));
+            bool loaded = false;
+            std::string message;
+            try
+            {
+                loaded = mesh.Load(path, opt);
+                if (!loaded) message = "Failed to load mesh: " + path;
+            }
+            catch (const std::exception& e)
+            {
+                message = e.what();
+            }
+            if (!loaded && (options & Options::NoThrow)) {
+                LogError("%s", message.c_str());
+            }
+
+            {
+                std::lock_guard<std::mutex> lock { mutex };
+                error = std::move(message);
+                status = loaded ? MeshLoadStatus::Loaded : MeshLoadStatus::Failed;
+            }
+            ready.notify_all();
+        }
+    };
+
+    MeshLoadHandle::MeshLoadHandle(std::shared_ptr<State> state) noexcept : state{ std::move(state) }
+    {
+    }
+
+    MeshLoadStatus MeshLoadHandle::Status() const noexcept
+    {
+        return state ? state->status.load() : MeshLoadStatus::Failed;
+    }
+
+    bool MeshLoadHandle::IsReady() const noexcept
+    {
+        return State::IsFinal(Status());
+    }
+
+    bool MeshLoadHandle::Wait() const
+    {
+        if (!state)
+            return false;
+        std::unique_lock<std::mutex> lock { state->mutex };
+        state->ready.wait(lock, [this] { return State::IsFinal(state->status); });
+        return state->status == MeshLoadStatus::Loaded;
+    }
+
+    bool MeshLoadHandle::WaitFor(double seconds) const
+    {
+        if (!state)
+            return true;
+        std::unique_lock<std::mutex> lock { state->mutex };
+        return state->ready.wait_for(lock, std::chrono::duration<double>{ seconds },
+                                     [this] { return State::IsFinal(state->status); });
+    }
+
+    bool MeshLoadHandle::Cancel() noexcept
+    {
+        return state && state->Cancel();
+    }
+
+    std::string MeshLoadHandle::Error() const
+    {
+        if (!state)
+            return "Invalid mesh load handle";
+        std::lock_guard<std::mutex> lock { state->mutex };
+        return state->error;
+    }
+
+    Mesh& MeshLoadHandle::Get()
+    {
+        if (!state) {
+            ThrowErrType(MeshIOError, "Invalid mesh load handle");
+        }
+        if (!Wait() && !(state->options & Options::NoThrow)) {
+            ThrowErrType(MeshIOError, "%s", Error().c_str());
+        }
+        return state->mesh;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    struct MeshLoadPool::Impl
+    {
+        using StatePtr = std::shared_ptr<MeshLoadHandle::State>;
+
+        Executor executor; // if empty, own worker threads are used
+        int maxInFlight;
+        mutable std::mutex mutex;
+        std::condition_variable wake; // new loads for the worker threads, or stopping
+        std::condition_variable idle; // a load has finished
+        std::deque<StatePtr> queue;
+        int inFlight = 0;
+        bool stopping = false;
+        std::vector<std::thread> threads;
+
+        Impl(Executor executor, int maxInFlight)
+            : executor{ std::move(executor) }, maxInFlight{ maxInFlight > 0 ? maxInFlight : GetMaxThreads() }
+        {
+        }
+
+        ~Impl()
+        {
+            {
+                std::unique_lock<std::mutex> lock { mutex };
+                stopping = true;
+                for (StatePtr& state : queue)
+                    state->Cancel();
+                queue.clear();
+                wake.notify_all();
+                // executor tasks still reference this pool
+                idle.wait(lock, [this] { return inFlight == 0; });
+            }
+            for (std::thread& t : threads)
+                t.join();
+        }
+
+        // @return Next queued load that wasn't cancelled, requires the lock
+        StatePtr PopNext()
+        {
+            bool dropped = false;
+            while (!queue.empty())
+            {
+                StatePtr state = std::move(queue.front());
+                queue.pop_front();
+                if (state->Start())
+                    return state;
+                dropped = true;
+            }
+            // WaitAll() may be waiting for the load that was just cancelled
+            if (dropped)
+                idle.notify_all();
+            return nullptr;
+        }
+
+        int NumQueued() const
+        {
+            int numQueued = 0;
+            for (const StatePtr& state : queue)
+                if (state->status == MeshLoadStatus::Queued)
+                    ++numQueued;
+            return numQueued;
+        }
+
+        void Push(StatePtr state)
+        {
+            std::unique_lock<std::mutex> lock { mutex };
+            queue.emplace_back(std::move(state));
+            if (executor)
+            {
+                Dispatch(lock);
+                return;
+            }
+            // threads are started on demand, each one runs a single load at a time
+            if ((int)threads.size() < maxInFlight && (int)threads.size() < inFlight + (int)queue.size())
+                threads.emplace_back([this] { WorkerLoop(); });
+            wake.notify_one();
+        }
+
+        void WorkerLoop()
+        {
+            std::unique_lock<std::mutex> lock { mutex };
+            for (;;)
+            {
+                wake.wait(lock, [this] { return stopping || (!queue.empty() && inFlight < maxInFlight); });
+                if (stopping)
+                    return;
+                StatePtr state = PopNext();
+                if (!state)
+                    continue;
+
+                ++inFlight;
+                lock.unlock();
+                state->Run();
+                state.reset();
+                lock.lock();
+                --inFlight;
+                idle.notify_all();
+            }
+        }
+
+        // submits queued loads to the executor until maxInFlight is reached, unlocks the lock
+        void Dispatch(std::unique_lock<std::mutex>& lock)
+        {
+            std::vector<StatePtr> started;
+            while (inFlight < maxInFlight && !stopping)
+            {
+                StatePtr state = PopNext();
+                if (!state)
+                    break;
+                ++inFlight;
+                started.emplace_back(std::move(state));
+            }
+            lock.unlock();
+
+            // the executor may run the task inline, so it's called without holding the lock
+            for (StatePtr& state : started)
+                executor([this, state]() mutable { ExecutorTask(std::move(state)); });
+        }
+
+        // runs `state` and then keeps its in-flight slot to drain the queue in a loop,
+        // so an executor which runs tasks inline doesn't recurse once per queued load
+        void ExecutorTask(StatePtr state)
+        {
+            for (;;)
+            {
+                state->Run();
+                state.reset();
+                std::unique_lock<std::mutex> lock { mutex };
+                if (!stopping && inFlight <= maxInFlight)
+                    state = PopNext();
+                if (!state)
+                {
+                    --inFlight;
+                    idle.notify_all();
+                    return;
+                }
+            }
+        }
+
+        void SetMaxInFlight(int newMaxInFlight)
+        {
+            std::unique_lock<std::mutex> lock { mutex };
+            maxInFlight = newMaxInFlight > 0 ? newMaxInFlight : GetMaxThreads();
+            if (executor)
+            {
+                Dispatch(lock);
+                return;
+            }
+            int wanted = std::min(maxInFlight, inFlight + (int)queue.size());
+            while ((int)threads.size() < wanted)
+                threads.emplace_back([this] { WorkerLoop(); });
+            wake.notify_all();
+        }
+
+        void WaitAll()
+        {
+            std::unique_lock<std::mutex> lock { mutex };
+            idle.wait(lock, [this] { return inFlight == 0 && NumQueued() == 0; });
+        }
+    };
+
+    MeshLoadPool::MeshLoadPool(int maxInFlight)
+        : impl{ std::make_unique<Impl>(Executor{}, maxInFlight) }
+    {
+    }
+
+    MeshLoadPool::MeshLoadPool(Executor executor, int maxInFlight)
+        : impl{ std::make_unique<Impl>(std::move(executor), maxInFlight) }
+    {
+    }
+
+    MeshLoadPool::~MeshLoadPool() = default;
+
+    MeshLoadHandle MeshLoadPool::Load(rpp::strview meshPath, Options opt)
+    {
+        auto state = std::make_shared<MeshLoadHandle::State>(meshPath, opt);
+        impl->Push(state);
+        return MeshLoadHandle{ std::move(state) };
+    }
+
+    void MeshLoadPool::SetMaxInFlight(int maxInFlight)
+    {
+        impl->SetMaxInFlight(maxInFlight);
+    }
+
+    int MeshLoadPool::GetMaxInFlight() const noexcept
+    {
+        std::lock_guard<std::mutex> lock { impl->mutex };
+        return impl->maxInFlight;
+    }
+
+    int MeshLoadPool::NumQueued() const noexcept
+    {
+        std::lock_guard<std::mutex> lock { impl->mutex };
+        return impl->NumQueued();
+    }
+
+    int MeshLoadPool::NumInFlight() const noexcept
+    {
+        std::lock_guard<std::mutex> lock { impl->mutex };
+        return impl->inFlight;
+    }
+
+    void MeshLoadPool::WaitAll()
+    {
+        impl->WaitAll();
+    }
+
+    MeshLoadPool& MeshLoadPool::Default()
+    {
+        static MeshLoadPool pool;
+        return pool;
+    }
+
+    MeshLoadHandle Mesh::LoadAsync(rpp::strview meshPath, Options opt, MeshLoadPool* pool)
+    {
+        return (pool ? *pool : MeshLoadPool::Default()).Load(meshPath, opt);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -855,14 +855,14 @@ namespace Nano
 #else // not ENABLE_FBX_MESH_LOADER
 namespace Nano
 {
-    bool Mesh::IsFBXSupported() noexcept { return false; }
+    bool Mesh::IsFBXSupported() noexcept { return true; }
     bool Mesh::LoadFBX(rpp::strview meshPath, Options opt)
     {
-        NanoErr(opt, "FBX not supported in this build!\n%s", meshPath);
+        return LoadBinaryFBX(meshPath, opt); // ASCII FBX needs the SDK
     }
     bool Mesh::SaveAsFBX(rpp::strview meshPath, Options opt) const
     {
-        NanoErr(opt, "FBX not supported in this build!\n%s", meshPath);
+        NanoErr(opt, "FBX saving not supported in this build!\n%s", meshPath);
     }
 }
 #endif
@@ -0,0 +1,648 @@
+#include <Nano/Mesh.h>
+#include <rpp/file_io.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+#include "InternalConfig.h"
+#include "FbxBinary.h"
+#include "Parallel.h"
+
+namespace Nano
+{
+    using namespace rpp::literals;
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * FBX 7.x scene graph, as stored in the binary node tree:
+     *
+     *   Objects/Geometry   id, "Name\0\1Geometry", "Mesh"
+     *     Vertices            xyz doubles (control points)
+     *     PolygonVertexIndex  control point indices, the last index of each polygon is ~index
+     *     LayerElementNormal/UV/Color/Material  optionally indexed vertex layers
+     *   Objects/Model      id, "Name\0\1Model", "Mesh" | "LimbNode" | "Null" | ...
+     *     Properties70        Lcl Translation/Rotation/Scaling
+     *   Objects/Material   id, "Name\0\1Material", ""
+     *   Objects/Texture    id, "Name\0\1Texture", ""
+     *   Connections/C      "OO", child id, parent id  |  "OP", child id, parent id, property name
+     *
+     * Every Mesh model becomes a group named after the model, or several groups
+     * if its polygons use more than one material. LimbNode models become Bones.
+     * Positions and normals are converted from FBX Z-up the same way as the FBX SDK loader.
+     */
+    static rpp::Vector3 FbxToOpenGL(double x, double y, double z) noexcept
+    {
+        return { (float)x, (float)z, -(float)y };
+    }
+
+    // object names are stored as "Name\0\1Class"
+    static rpp::strview ObjectName(const FbxNode& object) noexcept
+    {
+        rpp::strview name = object.Prop(1).Str;
+        const char* nul = (const char*)memchr(name.str, '\0', name.len);
+        return nul ? rpp::strview{ name.str, nul } : name;
+    }
+
+    static rpp::strview ObjectType(const FbxNode& object) noexcept
+    {
+        return object.Prop(2).Str;
+    }
+
+    // @return P node of the object's Properties70 with this property name, or nullptr
+    static const FbxNode* FindP(const FbxNode& object, rpp::strview name) noexcept
+    {
+        if (const FbxNode* props = object.Find("Properties70"_sv))
+            for (const FbxNode& p : props->Children)
+                if (p.Name == "P"_sv && p.Prop(0).Str == name)
+                    return &p;
+        return nullptr;
+    }
+
+    // @return TRUE if the object has a Properties70 vector property with this name
+    static bool GetVector(const FbxNode& object, rpp::strview name, double out[3]) noexcept
+    {
+        const FbxNode* p = FindP(object, name);
+        if (!p || p->Props.size() < 7)
+            return false;
+        for (int i = 0; i < 3; ++i)
+            out[i] = p->Props[4 + i].AsDouble();
+        return true;
+    }
+
+    static bool GetNumber(const FbxNode& object, rpp::strview name, double& out) noexcept
+    {
+        const FbxNode* p = FindP(object, name);
+        if (!p || p->Props.size() < 5)
+            return false;
+        out = p->Props[4].AsDouble();
+        return true;
+    }
+
+    static BonePose GetLocalTransform(const FbxNode& model) noexcept
+    {
+        double t[3] = { 0, 0, 0 }, r[3] = { 0, 0, 0 }, s[3] = { 1, 1, 1 };
+        GetVector(model, "Lcl Translation"_sv, t);
+        GetVector(model, "Lcl Rotation"_sv, r); // @note Euler XYZ Degrees
+        GetVector(model, "Lcl Scaling"_sv, s);
+        return { FbxToOpenGL(t[0], t[1], t[2]), FbxToOpenGL(r[0], r[1], r[2]), FbxToOpenGL(s[0], s[1], s[2]) };
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Copies the faces with material slot `slot` into `dst`, keeping only the layer elements they use.
+     * The elements are renumbered in first use order.
+     */
+    template<class T> static void CompactLayer(const std::vector<T>& src, std::vector<T>& dst,
+                                               std::vector<Triangle>& tris, int VertexDescr::*field,
+                                               std::vector<int>& remap)
+    {
+        remap.assign(src.size(), -1);
+        for (Triangle& tri : tris)
+            for (VertexDescr& vd : tri)
+            {
+                int& index = vd.*field;
+                if (index < 0) continue;
+                int& mapped = remap[index];
+                if (mapped == -1) {
+                    mapped = (int)dst.size();
+                    dst.push_back(src[index]);
+                }
+                index = mapped;
+            }
+    }
+
+    static void ExtractMaterialFaces(const MeshGroup& src, const std::vector<int>& faceSlots,
+                                     int slot, MeshGroup& dst)
+    {
+        for (size_t faceId = 0; faceId < src.Tris.size(); ++faceId)
+            if (faceSlots[faceId] == slot)
+                dst.Tris.push_back(src.Tris[faceId]);
+
+        std::vector<int> remap;
+        CompactLayer(src.Verts,   dst.Verts,   dst.Tris, &VertexDescr::v, remap);
+        CompactLayer(src.Coords,  dst.Coords,  dst.Tris, &VertexDescr::t, remap);
+        CompactLayer(src.Normals, dst.Normals, dst.Tris, &VertexDescr::n, remap);
+        CompactLayer(src.Colors,  dst.Colors,  dst.Tris, &VertexDescr::c, remap);
+        // PerVertex layers are renumbered separately from the vertices, so they're no longer per vertex
+        auto mapping = [](MapMode m) { return m == MapMode::PerVertex ? MapMode::PerFaceVertex : m; };
+        dst.CoordsMapping  = mapping(src.CoordsMapping);
+        dst.NormalsMapping = mapping(src.NormalsMapping);
+        dst.ColorMapping   = mapping(src.ColorMapping);
+        dst.Winding  = src.Winding;
+        dst.Offset   = src.Offset;
+        dst.Rotation = src.Rotation;
+        dst.Scale    = src.Scale;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    struct FbxGeometryJob
+    {
+        const FbxNode* model;
+        const FbxNode* geometry;
+        std::vector<std::shared_ptr<Material>> materials; // material slots of the model
+        std::vector<MeshGroup> groups; // output
+        std::string error;
+    };
+
+    /**
+     * Polygons of a geometry, triangulated as fans.
+     * Layer elements are mapped per control point, per polygon vertex or per polygon,
+     * so every triangle corner remembers its polygon vertex and every triangle its polygon.
+     */
+    struct FbxPolygons
+    {
+        std::vector<int> polygonVertices; // polygon vertex index of every triangle corner
+        std::vector<int> triPolygons;     // polygon index of every triangle
+    };
+
+    class FbxSceneReader
+    {
+        Mesh& mesh;
+        Options opt;
+
+        FbxDocument doc;
+        struct Connection
+        {
+            const FbxNode* child;
+            int64_t childId;
+            rpp::strview property; // for object-property connections
+        };
+        std::unordered_map<int64_t, const FbxNode*> objects;
+        std::unordered_map<int64_t, std::vector<Connection>> children; // parent id -> children in file order
+        std::unordered_map<int64_t, int64_t> modelParents;
+        std::unordered_map<int64_t, std::shared_ptr<Material>> materials;
+        std::vector<int64_t> models; // in file order
+        std::vector<FbxGeometryJob> jobs;
+
+    public:
+        std::string error;
+
+        FbxSceneReader(Mesh& mesh, Options opt) : mesh{ mesh }, opt{ opt } {}
+
+        bool Fail(std::string message)
+        {
+            if (error.empty())
+                error = std::move(message);
+            return false;
+        }
+
+        bool Read(rpp::strview meshPath)
+        {
+            // the document owns all decompressed arrays, so concurrent loads share nothing
+            const int numWorkers = (opt & Options::Parallel) ? GetMaxThreads() : 1;
+            if (!doc.Read(meshPath, numWorkers))
+                return Fail(doc.Error);
+            return ReadObjects()
+                && ReadConnections()
+                && ReadMaterials()
+                && ReadGeometries()
+                && ReadSkeleton();
+        }
+
+    private:
+        bool ReadObjects()
+        {
+            const FbxNode* objectsNode = doc.Root.Find("Objects"_sv);
+            if (!objectsNode)
+                return Fail("missing Objects");
+            for (const FbxNode& object : objectsNode->Children)
+            {
+                int64_t id = object.Prop(0).AsInt();
+                objects[id] = &object;
+                if (object.Name == "Model"_sv)
+                    models.push_back(id);
+            }
+            return true;
+        }
+
+        const FbxNode* FindObject(int64_t id, rpp::strview kind) const noexcept
+        {
+            auto it = objects.find(id);
+            return it != objects.end() && it->second->Name == kind ? it->second : nullptr;
+        }
+
+        bool ReadConnections()
+        {
+            const FbxNode* connections = doc.Root.Find("Connections"_sv);
+            if (!connections)
+                return true; // nothing is attached to anything
+            for (const FbxNode& c : connections->Children)
+            {
+                if (c.Name != "C"_sv || c.Props.size() < 3)
+                    continue;
+                int64_t childId  = c.Props[1].AsInt();
+                int64_t parentId = c.Props[2].AsInt();
+                auto child = objects.find(childId);
+                if (child == objects.end())
+                    continue;
+                children[parentId].push_back({ child->second, childId, c.Prop(3).Str });
+                if (child->second->Name == "Model"_sv && FindObject(parentId, "Model"_sv))
+                    modelParents[childId] = parentId;
+            }
+            return true;
+        }
+
+        // @return Connected children of this object with the given node name
+        template<class Func> void ForEachChild(int64_t parentId, rpp::strview kind, const Func& func) const
+        {
+            auto it = children.find(parentId);
+            if (it == children.end())
+                return;
+            for (const Connection& c : it->second)
+                if (c.child->Name == kind)
+                    func(c);
+        }
+
+        static std::string TexturePath(const FbxNode& texture)
+        {
+            const FbxNode* path = texture.Find("RelativeFilename"_sv);
+            if (!path || path->Prop(0).Str.empty())
+                path = texture.Find("FileName"_sv);
+            return path ? path->Prop(0).Str.to_string() : std::string{};
+        }
+
+        bool ReadMaterials()
+        {
+            for (auto& [id, object] : objects)
+            {
+                if (object->Name != "Material"_sv)
+                    continue;
+                auto mat = std::make_shared<Material>();
+                mat->Name = ObjectName(*object).to_string();
+
+                double c[3], f;
+                if (GetVector(*object, "AmbientColor"_sv, c))  mat->AmbientColor  = { (float)c[0], (float)c[1], (float)c[2] };
+                if (GetVector(*object, "DiffuseColor"_sv, c))  mat->DiffuseColor  = { (float)c[0], (float)c[1], (float)c[2] };
+                if (GetVector(*object, "SpecularColor"_sv, c)) mat->SpecularColor = { (float)c[0], (float)c[1], (float)c[2] };
+                if (GetVector(*object, "EmissiveColor"_sv, c)) mat->EmissiveColor = { (float)c[0], (float)c[1], (float)c[2] };
+                if (GetNumber(*object, "SpecularFactor"_sv, f)) mat->Specular = (float)f;
+                if (GetNumber(*object, "Opacity"_sv, f))
+                    mat->Alpha = (float)f;
+                else if (GetNumber(*object, "TransparencyFactor"_sv, f))
+                    mat->Alpha = 1.0f - (float)f;
+
+                // textures are connected to the material property they drive
+                ForEachChild(id, "Texture"_sv, [&](const Connection& c)
+                {
+                    rpp::strview prop = c.property;
+                    std::string* path = nullptr;
+                    if      (prop.starts_with("Diffuse"_sv))  path = &mat->DiffusePath;
+                    else if (prop.starts_with("Transparen"_sv)) path = &mat->AlphaPath;
+                    else if (prop.starts_with("Specular"_sv)) path = &mat->SpecularPath;
+                    else if (prop == "NormalMap"_sv || prop == "Bump"_sv) path = &mat->NormalPath;
+                    else if (prop.starts_with("Emissive"_sv)) path = &mat->EmissivePath;
+                    if (path && path->empty())
+                        *path = TexturePath(*c.child);
+                });
+                materials[id] = std::move(mat);
+            }
+            return true;
+        }
+
+        bool ReadGeometries()
+        {
+            for (int64_t modelId : models)
+            {
+                const FbxNode& model = *objects[modelId];
+                const FbxNode* geometry = nullptr;
+                ForEachChild(modelId, "Geometry"_sv, [&](const Connection& c) {
+                    if (!geometry && ObjectType(*c.child) == "Mesh"_sv)
+                        geometry = c.child;
+                });
+                bool isMesh = ObjectType(model) == "Mesh"_sv;
+                if (!geometry && !(isMesh || ObjectType(model) == "Null"_sv))
+                    continue; // cameras, lights and skeleton nodes
+                if (!geometry && !(opt & Options::EmptyGroups))
+                    continue;
+
+                FbxGeometryJob& job = rpp::emplace_back(jobs);
+                job.model = &model;
+                job.geometry = geometry;
+                ForEachChild(modelId, "Material"_sv, [&](const Connection& c) {
+                    job.materials.push_back(materials[c.childId]);
+                });
+            }
+
+            // every geometry has its own groups, so they can be loaded in parallel
+            int numJobs = (int)jobs.size();
+            std::atomic<bool> ok { true };
+            ParallelFor(numJobs, (opt & Options::Parallel) ? NumWorkers(numJobs) : 1, [&](int job, int)
+            {
+                if (!LoadGeometry(jobs[job]))
+                    ok = false;
+            });
+            if (!ok)
+            {
+                for (FbxGeometryJob& job : jobs)
+                    if (!job.error.empty())
+                        return Fail(job.error);
+            }
+
+            for (FbxGeometryJob& job : jobs)
+                for (MeshGroup& g : job.groups)
+                {
+                    g.GroupId = mesh.NumGroups();
+                    mesh.Groups.push_back(std::move(g));
+                }
+            return true;
+        }
+
+        static bool Triangulate(MeshGroup& g, const FbxNode& geometry, FbxPolygons& polys, std::string& error)
+        {
+            std::vector<double> positions;
+            if (const FbxNode* vertices = geometry.Find("Vertices"_sv))
+                vertices->Prop(0).GetArray(positions);
+            const int numVerts = int(positions.size() / 3);
+            g.Verts.resize(numVerts);
+            for (int i = 0; i < numVerts; ++i)
+                g.Verts[i] = FbxToOpenGL(positions[i*3+0], positions[i*3+1], positions[i*3+2]);
+
+            std::vector<int> indices;
+            if (const FbxNode* polygons = geometry.Find("PolygonVertexIndex"_sv))
+                polygons->Prop(0).GetArray(indices);
+            g.Tris.reserve(indices.size() / 3);
+            polys.polygonVertices.reserve(indices.size());
+            polys.triPolygons.reserve(indices.size() / 3);
+
+            int polygonStart = 0, polygonId = 0;
+            for (int i = 0; i < (int)indices.size(); ++i)
+            {
+                int v = indices[i];
+                bool last = v < 0;
+                if (last) indices[i] = v = ~v;
+                if (v >= numVerts) {
+                    error = "polygon vertex index out of bounds: " + std::to_string(v);
+                    return false;
+                }
+                if (!last)
+                    continue;
+
+                // CCW fan: v[0], v[k-1], v[k]; points and lines have no triangles
+                for (int k = polygonStart + 2; k <= i; ++k)
+                {
+                    Triangle& tri = rpp::emplace_back(g.Tris);
+                    tri.a.v = indices[polygonStart];
+                    tri.b.v = indices[k - 1];
+                    tri.c.v = indices[k];
+                    polys.polygonVertices.push_back(polygonStart);
+                    polys.polygonVertices.push_back(k - 1);
+                    polys.polygonVertices.push_back(k);
+                    polys.triPolygons.push_back(polygonId);
+                }
+                polygonStart = i + 1;
+                ++polygonId;
+            }
+            return true;
+        }
+
+        /**
+         * Maps a LayerElementNormal/UV/Color to the triangles
+         * @param values Receives the direct array
+         * @return FALSE if the layer has invalid indices
+         */
+        static bool MapLayer(MeshGroup& g, const FbxPolygons& polys, const FbxNode& layer,
+                             rpp::strview valuesName, rpp::strview indicesName, int numComponents,
+                             int VertexDescr::*field, MapMode& mapping,
+                             std::vector<double>& values, std::string& error)
+        {
+            rpp::strview mappingType;
+            if (const FbxNode* n = layer.Find("MappingInformationType"_sv))
+                mappingType = n->Prop(0).Str;
+            bool indexed = false;
+            if (const FbxNode* n = layer.Find("ReferenceInformationType"_sv))
+                indexed = n->Prop(0).Str == "IndexToDirect"_sv || n->Prop(0).Str == "Index"_sv;
+
+            if (const FbxNode* n = layer.Find(valuesName))
+                n->Prop(0).GetArray(values);
+            std::vector<int> indices;
+            if (indexed)
+                if (const FbxNode* n = layer.Find(indicesName))
+                    n->Prop(0).GetArray(indices);
+            const int numElements = int(values.size() / numComponents);
+            const int numKeys = indexed ? (int)indices.size() : numElements;
+
+            enum { ByPolygonVertex, ByVertex, ByPolygon, AllSame } by;
+            if (mappingType == "ByPolygonVertex"_sv) {
+                by = ByPolygonVertex; mapping = MapMode::PerFaceVertex;
+            } else if (mappingType == "ByVertice"_sv || mappingType == "ByVertex"_sv || mappingType == "ByControlPoint"_sv) {
+                by = ByVertex; mapping = MapMode::PerVertex;
+            } else if (mappingType == "ByPolygon"_sv) {
+                by = ByPolygon; mapping = MapMode::PerFace;
+            } else if (mappingType == "AllSame"_sv) {
+                by = AllSame; mapping = MapMode::PerFaceVertex;
+            } else {
+                values.clear(); // edges and other unsupported mappings
+                return true;
+            }
+
+            const int numTris = g.NumTris();
+            Triangle* tris = g.Tris.data();
+            for (int faceId = 0; faceId < numTris; ++faceId)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    VertexDescr& vd = tris[faceId][k];
+                    int key;
+                    switch (by) {
+                        case ByPolygonVertex: key = polys.polygonVertices[faceId*3 + k]; break;
+                        case ByVertex:        key = vd.v; break;
+                        case ByPolygon:       key = polys.triPolygons[faceId]; break;
+                        default:              key = 0; break;
+                    }
+                    if (key >= numKeys) {
+                        error = layer.Name.to_string() + " index out of bounds: " + std::to_string(key);
+                        return false;
+                    }
+                    int index = indexed ? indices[key] : key;
+                    if (index >= numElements) {
+                        error = layer.Name.to_string() + " index out of bounds: " + std::to_string(index);
+                        return false;
+                    }
+                    vd.*field = index < 0 ? -1 : index; // -1 means the element is not mapped
+                }
+            }
+            return true;
+        }
+
+        static bool LoadLayers(MeshGroup& g, const FbxNode& geometry, const FbxPolygons& polys, std::string& error)
+        {
+            std::vector<double> values;
+            if (const FbxNode* layer = geometry.Find("LayerElementNormal"_sv))
+            {
+                if (!MapLayer(g, polys, *layer, "Normals"_sv, "NormalsIndex"_sv, 3,
+                              &VertexDescr::n, g.NormalsMapping, values, error))
+                    return false;
+                g.Normals.resize(values.size() / 3);
+                for (size_t i = 0; i < g.Normals.size(); ++i)
+                    g.Normals[i] = FbxToOpenGL(values[i*3+0], values[i*3+1], values[i*3+2]);
+            }
+            if (const FbxNode* layer = geometry.Find("LayerElementUV"_sv))
+            {
+                if (!MapLayer(g, polys, *layer, "UV"_sv, "UVIndex"_sv, 2,
+                              &VertexDescr::t, g.CoordsMapping, values, error))
+                    return false;
+                g.Coords.resize(values.size() / 2);
+                for (size_t i = 0; i < g.Coords.size(); ++i)
+                    g.Coords[i] = { (float)values[i*2+0], (float)values[i*2+1] };
+            }
+            if (const FbxNode* layer = geometry.Find("LayerElementColor"_sv))
+            {
+                if (!MapLayer(g, polys, *layer, "Colors"_sv, "ColorIndex"_sv, 4,
+                              &VertexDescr::c, g.ColorMapping, values, error))
+                    return false;
+                g.Colors.resize(values.size() / 4);
+                for (size_t i = 0; i < g.Colors.size(); ++i) // alpha is dropped
+                    g.Colors[i] = { (float)values[i*4+0], (float)values[i*4+1], (float)values[i*4+2] };
+            }
+            if (g.Normals.empty()) g.NormalsMapping = MapMode::None;
+            if (g.Coords.empty())  g.CoordsMapping  = MapMode::None;
+            if (g.Colors.empty())  g.ColorMapping   = MapMode::None;
+            return true;
+        }
+
+        // @return Material slot of every triangle
+        static std::vector<int> MaterialSlots(const FbxNode& geometry, const FbxPolygons& polys, int numSlots)
+        {
+            std::vector<int> slots(polys.triPolygons.size(), 0);
+            const FbxNode* layer = geometry.Find("LayerElementMaterial"_sv);
+            const FbxNode* mapping = layer ? layer->Find("MappingInformationType"_sv) : nullptr;
+            std::vector<int> polygonSlots;
+            if (const FbxNode* n = layer ? layer->Find("Materials"_sv) : nullptr)
+                n->Prop(0).GetArray(polygonSlots);
+            if (polygonSlots.empty())
+                return slots;
+
+            const bool allSame = !mapping || mapping->Prop(0).Str != "ByPolygon"_sv;
+            for (size_t faceId = 0; faceId < slots.size(); ++faceId)
+            {
+                size_t polygon = allSame ? 0 : (size_t)polys.triPolygons[faceId];
+                int slot = polygon < polygonSlots.size() ? polygonSlots[polygon] : 0;
+                slots[faceId] = (slot >= 0 && slot < numSlots) ? slot : 0;
+            }
+            return slots;
+        }
+
+        bool LoadGeometry(FbxGeometryJob& job) const
+        {
+            const FbxNode& model = *job.model;
+            std::string name = ObjectName(model).to_string();
+            MeshGroup g { -1, name };
+            BonePose transform = GetLocalTransform(model);
+            g.Offset   = transform.Translation;
+            g.Rotation = transform.Rotation;
+            g.Scale    = transform.Scale;
+            g.Winding  = FaceWinding::CCW; // FBX front faces are CCW
+
+            if (job.geometry)
+            {
+                FbxPolygons polys;
+                if (!Triangulate(g, *job.geometry, polys, job.error) ||
+                    !LoadLayers(g, *job.geometry, polys, job.error))
+                {
+                    job.error = "'" + name + "': " + job.error;
+                    return false;
+                }
+
+                const int numSlots = (int)job.materials.size();
+                if (numSlots > 1)
+                {
+                    std::vector<int> faceSlots = MaterialSlots(*job.geometry, polys, numSlots);
+                    std::vector<bool> used(numSlots, false);
+                    for (int slot : faceSlots) used[slot] = true;
+                    if (std::count(used.begin(), used.end(), true) > 1)
+                    {
+                        // one group per material, all named after the model
+                        for (int slot = 0; slot < numSlots; ++slot)
+                        {
+                            if (!used[slot]) continue;
+                            MeshGroup& part = rpp::emplace_back(job.groups, -1, name);
+                            ExtractMaterialFaces(g, faceSlots, slot, part);
+                            part.Mat = job.materials[slot];
+                        }
+                        return true;
+                    }
+                    g.Mat = job.materials[faceSlots.empty() ? 0 : faceSlots.front()];
+                }
+                else if (numSlots == 1)
+                {
+                    g.Mat = job.materials.front();
+                }
+            }
+            job.groups.push_back(std::move(g));
+            return true;
+        }
+
+        bool ReadSkeleton()
+        {
+            std::vector<int64_t> limbs;
+            std::unordered_set<int64_t> isLimb;
+            for (int64_t modelId : models)
+            {
+                rpp::strview type = ObjectType(*objects[modelId]);
+                if (type == "LimbNode"_sv || type == "Root"_sv) {
+                    limbs.push_back(modelId);
+                    isLimb.insert(modelId);
+                }
+            }
+            if (limbs.empty())
+                return true;
+
+            // depth first from every root, so parents always come before their children
+            std::unordered_set<int64_t> visited;
+            auto addBone = [&](auto& self, int64_t id, int parentIndex) -> void
+            {
+                if (!visited.insert(id).second)
+                    return; // malformed cyclic hierarchy
+                const FbxNode& model = *objects[id];
+                MeshBone& bone = rpp::emplace_back(mesh.Bones);
+                bone.BoneIndex = (int)mesh.Bones.size() - 1;
+                bone.ParentIndex = parentIndex;
+                bone.Name = ObjectName(model).to_string();
+                bone.Pose = GetLocalTransform(model);
+                const int boneIndex = bone.BoneIndex;
+                ForEachChild(id, "Model"_sv, [&](const Connection& c) {
+                    if (isLimb.count(c.childId))
+                        self(self, c.childId, boneIndex);
+                });
+            };
+            for (int64_t id : limbs)
+            {
+                auto parent = modelParents.find(id);
+                if (parent == modelParents.end() || !isLimb.count(parent->second))
+                    addBone(addBone, id, -1);
+            }
+            return true;
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    bool Mesh::LoadBinaryFBX(rpp::strview meshPath, Options opt)
+    {
+        Clear();
+        Bones.clear();
+        SkinnedBones.clear();
+        AnimationClips.clear();
+
+        FbxSceneReader reader { *this, opt };
+        if (!reader.Read(meshPath))
+        {
+            Clear();
+            Bones.clear();
+            NanoErr(opt, "Failed to load FBX '%s': %s", meshPath, reader.error.c_str());
+        }
+
+        Name = rpp::file_name(meshPath);
+        if (opt & Options::Log) {
+            LogInfo("Load %-33s  %5d verts  %5d tris  %s",
+                    file_nameext(meshPath), TotalVerts(), TotalTris(), to_string(opt));
+        }
+        ApplyLoadOptions(opt);
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
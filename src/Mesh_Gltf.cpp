@@ -0,0 +1,1563 @@
+#include <Nano/Mesh.h>
+#include <rpp/file_io.h>
+#include <rpp/sprint.h>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include "InternalConfig.h"
+#include "FileSource.h"
+#include "Hash.h"
+#include "Json.h"
+#include "Parallel.h"
+
+namespace Nano
+{
+    using namespace rpp::literals;
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * glTF 2.0 binary container (.glb), all values are little endian:
+     *
+     *   GlbHeader
+     *   GlbChunk JSON   scene description, padded to 4 bytes with spaces
+     *   GlbChunk BIN    vertex, index, skin and animation data, padded to 4 bytes with zeros
+     *
+     * Every mesh primitive becomes one MeshGroup with PerVertex mapped layers,
+     * named after its node. glTF UVs have their origin at the top left,
+     * so V is flipped to match the OBJ convention of the other loaders.
+     */
+    static constexpr uint32_t GlbMagic     = 0x46546C67; // "glTF"
+    static constexpr uint32_t GlbVersion   = 2;
+    static constexpr uint32_t GlbChunkJson = 0x4E4F534A; // "JSON"
+    static constexpr uint32_t GlbChunkBin  = 0x004E4942; // "BIN\0"
+
+    struct GlbHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t Length; // total file size
+    };
+
+    struct GlbChunk
+    {
+        uint32_t Length; // payload size, excluding this chunk header
+        uint32_t Type;
+    };
+
+    enum GltfComponentType
+    {
+        GltfByte          = 5120,
+        GltfUnsignedByte  = 5121,
+        GltfShort         = 5122,
+        GltfUnsignedShort = 5123,
+        GltfUnsignedInt   = 5125,
+        GltfFloat         = 5126,
+    };
+
+    enum GltfPrimitiveMode
+    {
+        GltfTriangles     = 4,
+        GltfTriangleStrip = 5,
+        GltfTriangleFan   = 6,
+    };
+
+    enum GltfBufferTarget
+    {
+        GltfArrayBuffer        = 34962,
+        GltfElementArrayBuffer = 34963,
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    // Nano Euler rotations are XYZ in DEGREES, so R = Rz * Ry * Rx
+    struct GltfQuat
+    {
+        double x = 0.0, y = 0.0, z = 0.0, w = 1.0;
+    };
+
+    static constexpr double GltfDegToRad = 3.14159265358979323846 / 180.0;
+
+    static GltfQuat EulerToQuat(const rpp::Vector3& degrees)
+    {
+        double cx = std::cos(degrees.x * GltfDegToRad * 0.5), sx = std::sin(degrees.x * GltfDegToRad * 0.5);
+        double cy = std::cos(degrees.y * GltfDegToRad * 0.5), sy = std::sin(degrees.y * GltfDegToRad * 0.5);
+        double cz = std::cos(degrees.z * GltfDegToRad * 0.5), sz = std::sin(degrees.z * GltfDegToRad * 0.5);
+        GltfQuat q;
+        q.w = cz*cy*cx + sz*sy*sx;
+        q.x = cz*cy*sx - sz*sy*cx;
+        q.y = cz*sy*cx + sz*cy*sx;
+        q.z = sz*cy*cx - cz*sy*sx;
+        return q;
+    }
+
+    // @param r Rotation matrix, r[row][col]
+    static rpp::Vector3 MatrixToEuler(const double r[3][3])
+    {
+        double ax, ay, az;
+        double sinY = -r[2][0];
+        if (std::abs(sinY) < 0.9999999)
+        {
+            ay = std::asin(sinY);
+            ax = std::atan2(r[2][1], r[2][2]);
+            az = std::atan2(r[1][0], r[0][0]);
+        }
+        else // gimbal lock, X and Z rotate around the same axis
+        {
+            ay = sinY > 0.0 ? 3.14159265358979323846 / 2 : -3.14159265358979323846 / 2;
+            ax = std::atan2(-r[1][2], r[1][1]);
+            az = 0.0;
+        }
+        return { float(ax / GltfDegToRad), float(ay / GltfDegToRad), float(az / GltfDegToRad) };
+    }
+
+    static void QuatToMatrix(GltfQuat q, double r[3][3])
+    {
+        double len = std::sqrt(q.x*q.x + q.y*q.y + q.z*q.z + q.w*q.w);
+        if (len > 0.0) { q.x /= len; q.y /= len; q.z /= len; q.w /= len; }
+        else           { q = GltfQuat{}; }
+        r[0][0] = 1 - 2*(q.y*q.y + q.z*q.z); r[0][1] = 2*(q.x*q.y - q.w*q.z);     r[0][2] = 2*(q.x*q.z + q.w*q.y);
+        r[1][0] = 2*(q.x*q.y + q.w*q.z);     r[1][1] = 1 - 2*(q.x*q.x + q.z*q.z); r[1][2] = 2*(q.y*q.z - q.w*q.x);
+        r[2][0] = 2*(q.x*q.z - q.w*q.y);     r[2][1] = 2*(q.y*q.z + q.w*q.x);     r[2][2] = 1 - 2*(q.x*q.x + q.y*q.y);
+    }
+
+    static rpp::Vector3 QuatToEuler(const GltfQuat& q)
+    {
+        double r[3][3];
+        QuatToMatrix(q, r);
+        return MatrixToEuler(r);
+    }
+
+    /**
+     * Column-major 4x4 affine transform, same memory layout as glTF node matrices
+     */
+    struct GltfMatrix
+    {
+        double m[16] = { 1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1 };
+
+        double& At(int row, int col) { return m[col*4 + row]; }
+        double  At(int row, int col) const { return m[col*4 + row]; }
+
+        static GltfMatrix FromTRS(const double t[3], const GltfQuat& q, const double s[3])
+        {
+            double r[3][3];
+            QuatToMatrix(q, r);
+            GltfMatrix out;
+            for (int row = 0; row < 3; ++row)
+            {
+                for (int col = 0; col < 3; ++col)
+                    out.At(row, col) = r[row][col] * s[col];
+                out.At(row, 3) = t[row];
+            }
+            return out;
+        }
+
+        GltfMatrix operator*(const GltfMatrix& b) const
+        {
+            GltfMatrix out;
+            for (int row = 0; row < 4; ++row)
+                for (int col = 0; col < 4; ++col)
+                    out.At(row, col) = At(row,0)*b.At(0,col) + At(row,1)*b.At(1,col)
+                                     + At(row,2)*b.At(2,col) + At(row,3)*b.At(3,col);
+            return out;
+        }
+
+        // splits the matrix into translation, XYZ Euler rotation in DEGREES and scale
+        void Decompose(rpp::Vector3& translation, rpp::Vector3& rotation, rpp::Vector3& scale) const
+        {
+            double s[3];
+            for (int col = 0; col < 3; ++col)
+                s[col] = std::sqrt(At(0,col)*At(0,col) + At(1,col)*At(1,col) + At(2,col)*At(2,col));
+
+            double det = At(0,0)*(At(1,1)*At(2,2) - At(2,1)*At(1,2))
+                       - At(0,1)*(At(1,0)*At(2,2) - At(2,0)*At(1,2))
+                       + At(0,2)*(At(1,0)*At(2,1) - At(2,0)*At(1,1));
+            if (det < 0.0) s[0] = -s[0]; // mirrored
+
+            double r[3][3];
+            for (int row = 0; row < 3; ++row)
+                for (int col = 0; col < 3; ++col)
+                    r[row][col] = s[col] != 0.0 ? At(row, col) / s[col] : (row == col ? 1.0 : 0.0);
+
+            translation = { float(At(0,3)), float(At(1,3)), float(At(2,3)) };
+            rotation    = MatrixToEuler(r);
+            scale       = { float(s[0]), float(s[1]), float(s[2]) };
+        }
+    };
+
+    static bool ReadNumbers(const JsonValue& array, double* out, int count)
+    {
+        if (array.Size() != count)
+            return false;
+        for (int i = 0; i < count; ++i)
+            out[i] = array[i].Number(out[i]);
+        return true;
+    }
+
+    // byte offsets and lengths must be whole non-negative numbers before they can be cast
+    static bool ReadByteSize(const JsonValue& value, uint64_t& out)
+    {
+        double number = value.Number(0.0);
+        if (!(number >= 0.0 && number <= 9007199254740992.0) || number != std::floor(number))
+            return false; // negative, NaN, fractional or too big to be exact
+        out = (uint64_t)number;
+        return true;
+    }
+
+    static GltfMatrix NodeLocalMatrix(const JsonValue& node)
+    {
+        GltfMatrix m;
+        if (ReadNumbers(node["matrix"], m.m, 16))
+            return m;
+        double t[3] = { 0, 0, 0 }, s[3] = { 1, 1, 1 }, q[4] = { 0, 0, 0, 1 };
+        ReadNumbers(node["translation"], t, 3);
+        ReadNumbers(node["scale"], s, 3);
+        ReadNumbers(node["rotation"], q, 4);
+        return GltfMatrix::FromTRS(t, GltfQuat{ q[0], q[1], q[2], q[3] }, s);
+    }
+
+    static BonePose NodeLocalPose(const JsonValue& node)
+    {
+        BonePose pose;
+        NodeLocalMatrix(node).Decompose(pose.Translation, pose.Rotation, pose.Scale);
+        return pose;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    struct GltfAccessor
+    {
+        const uint8_t* data = nullptr; // nullptr if the accessor has no bufferView, which means all zeros
+        int count = 0;
+        int componentType = 0;
+        int componentSize = 0;
+        int numComponents = 0;
+        int stride = 0;
+        bool normalized = false;
+    };
+
+    static float ReadComponent(const uint8_t* p, int componentType, bool normalized)
+    {
+        switch (componentType)
+        {
+            case GltfFloat:         { float v;    memcpy(&v, p, sizeof(v)); return v; }
+            case GltfUnsignedByte:  { uint8_t v = *p; return normalized ? v / 255.0f : float(v); }
+            case GltfByte:          { int8_t v = (int8_t)*p; return normalized ? std::max(v / 127.0f, -1.0f) : float(v); }
+            case GltfUnsignedShort: { uint16_t v; memcpy(&v, p, sizeof(v)); return normalized ? v / 65535.0f : float(v); }
+            case GltfShort:         { int16_t v;  memcpy(&v, p, sizeof(v)); return normalized ? std::max(v / 32767.0f, -1.0f) : float(v); }
+            case GltfUnsignedInt:   { uint32_t v; memcpy(&v, p, sizeof(v)); return float(v); }
+            default: return 0.0f;
+        }
+    }
+
+    static uint32_t ReadIndex(const uint8_t* p, int componentType)
+    {
+        switch (componentType)
+        {
+            case GltfUnsignedByte:  return *p;
+            case GltfUnsignedShort: { uint16_t v; memcpy(&v, p, sizeof(v)); return v; }
+            case GltfUnsignedInt:   { uint32_t v; memcpy(&v, p, sizeof(v)); return v; }
+            default: return 0;
+        }
+    }
+
+    /**
+     * Reads the accessor into `count` elements of `numComponents` floats.
+     * Missing components are set to 0, extra components are dropped.
+     */
+    static void ReadFloats(const GltfAccessor& a, float* dst, int numComponents)
+    {
+        if (!a.data)
+        {
+            memset(dst, 0, sizeof(float) * size_t(a.count) * numComponents);
+            return;
+        }
+        if (a.componentType == GltfFloat && a.numComponents == numComponents &&
+            a.stride == int(sizeof(float)) * numComponents)
+        {
+            // the layouts match, so this is a bulk copy out of the mapped binary chunk
+            memcpy(dst, a.data, sizeof(float) * size_t(a.count) * numComponents);
+            return;
+        }
+        int n = std::min(numComponents, a.numComponents);
+        for (int i = 0; i < a.count; ++i)
+        {
+            const uint8_t* element = a.data + size_t(i) * a.stride;
+            float* out = dst + size_t(i) * numComponents;
+            for (int k = 0; k < n; ++k)
+                out[k] = ReadComponent(element + k * a.componentSize, a.componentType, a.normalized);
+            for (int k = n; k < numComponents; ++k)
+                out[k] = 0.0f;
+        }
+    }
+
+    // vertex attributes of one primitive, loaded into a MeshGroup by a worker
+    struct GltfPrimitiveJob
+    {
+        int groupIndex;
+        const JsonValue* primitive;
+        std::vector<int> jointRemap; // skin joint index -> SkinnedBones index
+        std::string error;
+    };
+
+    class GltfReader
+    {
+        Mesh& mesh;
+        rpp::strview meshPath;
+        Options opt;
+
+        JsonValue doc;
+        FileSource file;
+        std::vector<FileSource> externalBuffers;
+        struct Buffer { const uint8_t* data = nullptr; uint64_t size = 0; };
+        std::vector<Buffer> buffers;
+        std::vector<std::shared_ptr<Material>> materials;
+        std::vector<int> nodeParents;
+        std::vector<int> nodeToBone; // node index -> Bones/SkinnedBones index, -1 if not a joint
+        std::vector<GltfPrimitiveJob> jobs;
+
+    public:
+        std::string error;
+
+        GltfReader(Mesh& mesh, rpp::strview meshPath, Options opt)
+            : mesh{ mesh }, meshPath{ meshPath }, opt{ opt } {}
+
+        bool Fail(std::string message)
+        {
+            if (error.empty())
+                error = std::move(message);
+            return false;
+        }
+
+        bool Read()
+        {
+            // always mapped, accessors with matching layouts are copied straight from the page cache
+            file = FileSource{ meshPath, true };
+            if (!file)
+                return Fail("failed to open file");
+            return ReadContainer()
+                && ReadBuffers()
+                && ReadMaterials()
+                && ReadNodes()
+                && ReadSkins()
+                && ReadScene()
+                && ReadPrimitives()
+                && ReadAnimations();
+        }
+
+    private:
+        bool ReadContainer()
+        {
+            const uint8_t* data = (const uint8_t*)file.str;
+            const uint64_t size = (uint64_t)file.len;
+            GlbHeader header;
+            if (size < sizeof(header))
+                return Fail("not a .glb file");
+            memcpy(&header, data, sizeof(header));
+            if (header.Magic != GlbMagic)
+                return Fail("not a .glb file");
+            if (header.Version != GlbVersion)
+                return Fail("unsupported glTF version " + std::to_string(header.Version));
+            if (header.Length > size)
+                return Fail("truncated file");
+
+            rpp::strview json;
+            uint64_t offset = sizeof(GlbHeader);
+            while (offset + sizeof(GlbChunk) <= header.Length)
+            {
+                GlbChunk chunk;
+                memcpy(&chunk, data + offset, sizeof(chunk));
+                offset += sizeof(GlbChunk);
+                if (chunk.Length > header.Length - offset)
+                    return Fail("corrupted chunk");
+                if (chunk.Type == GlbChunkJson && json.empty())
+                    json = rpp::strview{ (const char*)data + offset, (int)chunk.Length };
+                else if (chunk.Type == GlbChunkBin && buffers.empty())
+                    buffers.push_back({ data + offset, chunk.Length });
+                offset += (chunk.Length + 3) & ~3u;
+            }
+            if (json.empty())
+                return Fail("missing JSON chunk");
+
+            std::string jsonError;
+            if (!ParseJson(json, doc, jsonError))
+                return Fail("invalid JSON: " + jsonError);
+            if (!doc.IsObject())
+                return Fail("invalid JSON: the root is not an object");
+            return true;
+        }
+
+        bool ReadBuffers()
+        {
+            const JsonValue& list = doc["buffers"];
+            bool hasBinChunk = !buffers.empty();
+            Buffer binChunk = hasBinChunk ? buffers[0] : Buffer{};
+            buffers.assign(list.Size(), Buffer{});
+            for (int i = 0; i < list.Size(); ++i)
+            {
+                const JsonValue& buffer = list[i];
+                uint64_t byteLength;
+                if (!ReadByteSize(buffer["byteLength"], byteLength))
+                    return Fail("invalid byteLength in buffer " + std::to_string(i));
+                rpp::strview uri = buffer["uri"].Str();
+                if (uri.empty())
+                {
+                    // only the first buffer can refer to the GLB binary chunk
+                    if (i != 0 || !hasBinChunk)
+                        return Fail("buffer " + std::to_string(i) + " has no data");
+                    buffers[i] = binChunk;
+                }
+                else if (uri.starts_with("data:"))
+                {
+                    return Fail("embedded data URIs are not supported");
+                }
+                else
+                {
+                    std::string path = rpp::path_combine(rpp::folder_path(meshPath), uri);
+                    FileSource& external = rpp::emplace_back(externalBuffers, path, true);
+                    if (!external)
+                        return Fail("failed to open buffer " + path);
+                    buffers[i] = { (const uint8_t*)external.str, (uint64_t)external.len };
+                }
+                if (byteLength > buffers[i].size)
+                    return Fail("buffer " + std::to_string(i) + " is truncated");
+                buffers[i].size = byteLength;
+            }
+            return true;
+        }
+
+        // thread safe, the error goes to `err` instead of this->error
+        bool ReadAccessor(int index, GltfAccessor& a, std::string& err) const
+        {
+            auto Fail = [&err](std::string message) { err = std::move(message); return false; };
+            const JsonValue& accessor = doc["accessors"][index];
+            if (!accessor.IsObject())
+                return Fail("invalid accessor " + std::to_string(index));
+            if (accessor.Has("sparse"))
+                return Fail("sparse accessors are not supported");
+
+            rpp::strview type = accessor["type"].Str();
+            if      (type == "SCALAR") a.numComponents = 1;
+            else if (type == "VEC2")   a.numComponents = 2;
+            else if (type == "VEC3")   a.numComponents = 3;
+            else if (type == "VEC4")   a.numComponents = 4;
+            else if (type == "MAT4")   a.numComponents = 16;
+            else return Fail("unsupported accessor type in accessor " + std::to_string(index));
+
+            a.componentType = accessor["componentType"].Int(0);
+            switch (a.componentType)
+            {
+                case GltfByte: case GltfUnsignedByte:   a.componentSize = 1; break;
+                case GltfShort: case GltfUnsignedShort: a.componentSize = 2; break;
+                case GltfUnsignedInt: case GltfFloat:   a.componentSize = 4; break;
+                default: return Fail("invalid componentType in accessor " + std::to_string(index));
+            }
+            a.count = accessor["count"].Int(-1);
+            if (a.count < 0)
+                return Fail("invalid count in accessor " + std::to_string(index));
+            a.normalized = accessor["normalized"].Bool(false);
+
+            const int elementSize = a.componentSize * a.numComponents;
+            a.stride = elementSize;
+            a.data = nullptr;
+            if (!accessor.Has("bufferView"))
+                return true;
+
+            const JsonValue& view = doc["bufferViews"][accessor["bufferView"].Int(-1)];
+            int bufferIndex = view["buffer"].Int(-1);
+            if (!view.IsObject() || (size_t)bufferIndex >= buffers.size())
+                return Fail("invalid bufferView in accessor " + std::to_string(index));
+
+            const Buffer& buffer = buffers[bufferIndex];
+            uint64_t viewOffset, viewLength, offset;
+            if (!ReadByteSize(view["byteOffset"], viewOffset) || !ReadByteSize(view["byteLength"], viewLength))
+                return Fail("invalid bufferView in accessor " + std::to_string(index));
+            if (!ReadByteSize(accessor["byteOffset"], offset))
+                return Fail("invalid byteOffset in accessor " + std::to_string(index));
+            int byteStride = view["byteStride"].Int(0);
+            if (byteStride != 0)
+            {
+                if (byteStride < elementSize || byteStride > 252)
+                    return Fail("invalid byteStride in accessor " + std::to_string(index));
+                a.stride = byteStride;
+            }
+            if (viewOffset > buffer.size || viewLength > buffer.size - viewOffset)
+                return Fail("bufferView out of bounds in accessor " + std::to_string(index));
+            if (a.count > 0 && (offset > viewLength ||
+                uint64_t(a.count - 1) * a.stride + elementSize > viewLength - offset))
+                return Fail("accessor " + std::to_string(index) + " out of bounds");
+
+            a.data = buffer.data + viewOffset + offset;
+            return true;
+        }
+
+        bool GetAccessor(int index, GltfAccessor& a)
+        {
+            std::string err;
+            return ReadAccessor(index, a, err) || Fail(std::move(err));
+        }
+
+        // @return Path of the image used by a textureInfo object, empty if none
+        std::string TexturePath(const JsonValue& textureInfo)
+        {
+            const JsonValue& texture = doc["textures"][textureInfo["index"].Int(-1)];
+            const JsonValue& image = doc["images"][texture["source"].Int(-1)];
+            return image["uri"].Str().to_string();
+        }
+
+        static rpp::Color3 ReadColor(const JsonValue& array, rpp::Color3 color)
+        {
+            double c[3] = { color.r, color.g, color.b };
+            if (array.Size() >= 3)
+                for (int i = 0; i < 3; ++i)
+                    c[i] = array[i].Number(c[i]);
+            return { float(c[0]), float(c[1]), float(c[2]) };
+        }
+
+        bool ReadMaterials()
+        {
+            const JsonValue& list = doc["materials"];
+            materials.resize(list.Size());
+            for (int i = 0; i < list.Size(); ++i)
+            {
+                const JsonValue& m = list[i];
+                const JsonValue& pbr = m["pbrMetallicRoughness"];
+                const JsonValue& extras = m["extras"];
+                auto mat = std::make_shared<Material>();
+                mat->Name = m.Has("name") ? m["name"].Str().to_string() : "material" + std::to_string(i);
+
+                const JsonValue& baseColor = pbr["baseColorFactor"];
+                mat->DiffuseColor  = ReadColor(baseColor, rpp::Color3::White());
+                mat->Alpha         = baseColor[3].Float(1.0f);
+                mat->DiffusePath   = TexturePath(pbr["baseColorTexture"]);
+                mat->NormalPath    = TexturePath(m["normalTexture"]);
+                mat->EmissivePath  = TexturePath(m["emissiveTexture"]);
+                mat->EmissiveColor = ReadColor(m["emissiveFactor"], rpp::Color3::Black());
+
+                // properties without a glTF equivalent, written by SaveAsGLB()
+                mat->AmbientColor  = ReadColor(extras["ambientColor"], mat->AmbientColor);
+                mat->SpecularColor = ReadColor(extras["specularColor"], mat->SpecularColor);
+                mat->Specular      = extras["specular"].Float(mat->Specular);
+                mat->AlphaPath     = extras["alphaTexture"].Str().to_string();
+                mat->SpecularPath  = extras["specularTexture"].Str().to_string();
+                materials[i] = std::move(mat);
+            }
+            return true;
+        }
+
+        bool ReadNodes()
+        {
+            const JsonValue& nodes = doc["nodes"];
+            nodeParents.assign(nodes.Size(), -1);
+            for (int i = 0; i < nodes.Size(); ++i)
+            {
+                const JsonValue& children = nodes[i]["children"];
+                for (int c = 0; c < children.Size(); ++c)
+                {
+                    int child = children[c].Int(-1);
+                    if (child < 0 || child >= nodes.Size() || child == i || nodeParents[child] != -1)
+                        return Fail("invalid node hierarchy at node " + std::to_string(i));
+                    nodeParents[child] = i;
+                }
+            }
+            // a valid hierarchy has no cycles, so every walk up ends at a root
+            for (int i = 0; i < nodes.Size(); ++i)
+            {
+                int depth = 0;
+                for (int n = nodeParents[i]; n != -1; n = nodeParents[n])
+                    if (++depth > nodes.Size())
+                        return Fail("node hierarchy has a cycle");
+            }
+            return true;
+        }
+
+        // all skin joints become bones, BlendIndices refer to SkinnedBones
+        bool ReadSkins()
+        {
+            const JsonValue& nodes = doc["nodes"];
+            const JsonValue& skins = doc["skins"];
+            nodeToBone.assign(nodes.Size(), -1);
+            std::vector<const float*> inverseBindMatrices;
+            std::vector<float> matrixData;
+            for (int s = 0; s < skins.Size(); ++s)
+            {
+                const JsonValue& joints = skins[s]["joints"];
+                GltfAccessor ibm;
+                bool hasMatrices = skins[s].Has("inverseBindMatrices");
+                if (hasMatrices)
+                {
+                    if (!GetAccessor(skins[s]["inverseBindMatrices"].Int(-1), ibm))
+                        return false;
+                    if (ibm.numComponents != 16 || ibm.count < joints.Size())
+                        return Fail("invalid inverseBindMatrices in skin " + std::to_string(s));
+                    matrixData.resize(size_t(ibm.count) * 16);
+                    ReadFloats(ibm, matrixData.data(), 16);
+                }
+                for (int j = 0; j < joints.Size(); ++j)
+                {
+                    int node = joints[j].Int(-1);
+                    if (node < 0 || node >= nodes.Size())
+                        return Fail("invalid joint in skin " + std::to_string(s));
+                    if (nodeToBone[node] != -1)
+                        continue;
+
+                    int boneIndex = (int)mesh.SkinnedBones.size();
+                    nodeToBone[node] = boneIndex;
+                    std::string name = nodes[node].Has("name") ? nodes[node]["name"].Str().to_string()
+                                                               : "joint" + std::to_string(node);
+                    BonePose pose = NodeLocalPose(nodes[node]);
+
+                    SkinnedBone& skinned = rpp::emplace_back(mesh.SkinnedBones);
+                    skinned.BoneIndex = boneIndex;
+                    skinned.Name = name;
+                    skinned.Pose = pose;
+                    static_assert(sizeof(rpp::Matrix4) == sizeof(float) * 16, "Matrix4 must be 16 floats");
+                    if (hasMatrices)
+                        memcpy(&skinned.InverseBindPoseTransform, &matrixData[size_t(j) * 16], sizeof(rpp::Matrix4));
+                    else
+                        skinned.InverseBindPoseTransform = rpp::Matrix4::Identity();
+
+                    MeshBone& bone = rpp::emplace_back(mesh.Bones);
+                    bone.BoneIndex = boneIndex;
+                    bone.Name = std::move(name);
+                    bone.Pose = pose;
+                }
+            }
+
+            // parent is the closest ancestor which is also a joint
+            for (int node = 0; node < nodes.Size(); ++node)
+            {
+                int bone = nodeToBone[node];
+                if (bone == -1)
+                    continue;
+                int parent = nodeParents[node];
+                while (parent != -1 && nodeToBone[parent] == -1)
+                    parent = nodeParents[parent];
+                int parentBone = parent != -1 ? nodeToBone[parent] : -1;
+                mesh.SkinnedBones[bone].ParentIndex = parentBone;
+                mesh.Bones[bone].ParentIndex = parentBone;
+            }
+            return true;
+        }
+
+        void AddMeshNode(int nodeIndex, const GltfMatrix& world)
+        {
+            const JsonValue& node = doc["nodes"][nodeIndex];
+            int meshIndex = node["mesh"].Int(-1);
+            const JsonValue& gltfMesh = doc["meshes"][meshIndex];
+            const JsonValue& primitives = gltfMesh["primitives"];
+
+            std::string name = node.Has("name") ? node["name"].Str().to_string()
+                             : gltfMesh.Has("name") ? gltfMesh["name"].Str().to_string()
+                             : "mesh" + std::to_string(meshIndex);
+
+            std::vector<int> jointRemap;
+            const JsonValue& joints = doc["skins"][node["skin"].Int(-1)]["joints"];
+            for (int j = 0; j < joints.Size(); ++j)
+                jointRemap.push_back(nodeToBone[joints[j].Int(0)]);
+
+            for (int p = 0; p < primitives.Size(); ++p)
+            {
+                MeshGroup& g = mesh.CreateGroup(primitives.Size() > 1 ? name + "_" + std::to_string(p) : name);
+                world.Decompose(g.Offset, g.Rotation, g.Scale);
+                int material = primitives[p]["material"].Int(-1);
+                if ((size_t)material < materials.size())
+                    g.Mat = materials[material];
+                jobs.push_back({ g.GroupId, &primitives[p], jointRemap, {} });
+            }
+        }
+
+        void AddNode(int nodeIndex, const GltfMatrix& parentWorld)
+        {
+            const JsonValue& node = doc["nodes"][nodeIndex];
+            GltfMatrix world = parentWorld * NodeLocalMatrix(node);
+            if (node.Has("mesh"))
+            {
+                AddMeshNode(nodeIndex, world);
+            }
+            else if ((opt & Options::EmptyGroups) && nodeToBone[nodeIndex] == -1)
+            {
+                MeshGroup& g = mesh.CreateGroup(node["name"].Str().to_string());
+                world.Decompose(g.Offset, g.Rotation, g.Scale);
+            }
+            const JsonValue& children = node["children"];
+            for (int c = 0; c < children.Size(); ++c)
+                AddNode(children[c].Int(0), world);
+        }
+
+        bool ReadScene()
+        {
+            const JsonValue& nodes = doc["nodes"];
+            const JsonValue& scenes = doc["scenes"];
+            if (scenes.Size() > 0)
+            {
+                const JsonValue& roots = scenes[doc["scene"].Int(0)]["nodes"];
+                for (int i = 0; i < roots.Size(); ++i)
+                {
+                    int root = roots[i].Int(-1);
+                    if (root < 0 || root >= nodes.Size() || nodeParents[root] != -1)
+                        return Fail("invalid scene root node");
+                    AddNode(root, GltfMatrix{});
+                }
+            }
+            else // no scene, so show every node hierarchy
+            {
+                for (int i = 0; i < nodes.Size(); ++i)
+                    if (nodeParents[i] == -1)
+                        AddNode(i, GltfMatrix{});
+            }
+            return true;
+        }
+
+        bool LoadPrimitive(GltfPrimitiveJob& job)
+        {
+            MeshGroup& g = mesh.Groups[job.groupIndex];
+            const JsonValue& prim = *job.primitive;
+            const JsonValue& attributes = prim["attributes"];
+            auto fail = [&](const std::string& message) {
+                job.error = "group " + g.Name + ": " + message;
+                return false;
+            };
+
+            int mode = prim["mode"].Int(GltfTriangles);
+            if (mode != GltfTriangles && mode != GltfTriangleStrip && mode != GltfTriangleFan)
+                return true; // points and lines are not meshes
+
+            GltfAccessor position;
+            if (!attributes.Has("POSITION"))
+                return fail("missing POSITION attribute");
+            if (!ReadAccessor(attributes["POSITION"].Int(-1), position, job.error))
+                return fail(job.error);
+            const int numVerts = position.count;
+            g.Verts.resize(numVerts);
+            ReadFloats(position, &g.Verts.data()->x, 3);
+
+            auto readLayer = [&](const char* name, auto& layer, int numComponents, MapMode& mapping) {
+                if (!attributes.Has(name))
+                    return true;
+                GltfAccessor a;
+                if (!ReadAccessor(attributes[name].Int(-1), a, job.error))
+                    return fail(job.error);
+                if (a.count != numVerts)
+                    return fail(std::string{ name } + " count doesn't match POSITION");
+                layer.resize(numVerts);
+                ReadFloats(a, (float*)layer.data(), numComponents);
+                mapping = MapMode::PerVertex;
+                return true;
+            };
+            if (!readLayer("NORMAL",     g.Normals, 3, g.NormalsMapping) ||
+                !readLayer("TEXCOORD_0", g.Coords,  2, g.CoordsMapping)  ||
+                !readLayer("COLOR_0",    g.Colors,  3, g.ColorMapping)   ||
+                !readLayer("WEIGHTS_0",  g.BlendWeights, 4, g.BlendMapping))
+                return false;
+
+            for (rpp::Vector2& uv : g.Coords)
+                uv.y = 1.0f - uv.y;
+
+            if (attributes.Has("JOINTS_0"))
+            {
+                GltfAccessor joints;
+                if (!ReadAccessor(attributes["JOINTS_0"].Int(-1), joints, job.error))
+                    return fail(job.error);
+                if (joints.count != numVerts || joints.numComponents != 4 || joints.componentType == GltfFloat)
+                    return fail("invalid JOINTS_0 attribute");
+                g.BlendIndices.resize(numVerts);
+                for (int i = 0; joints.data && i < numVerts; ++i)
+                {
+                    for (int k = 0; k < 4; ++k)
+                    {
+                        uint32_t joint = ReadIndex(joints.data + size_t(i)*joints.stride + k*joints.componentSize,
+                                                   joints.componentType);
+                        int bone = joint < job.jointRemap.size() ? job.jointRemap[joint] : 0;
+                        if (bone > 255)
+                            return fail("more than 256 skinned bones are not supported");
+                        g.BlendIndices[i].indices[k] = (unsigned char)bone;
+                    }
+                }
+                g.BlendMapping = MapMode::PerVertex;
+            }
+
+            std::vector<uint32_t> indices;
+            if (prim.Has("indices"))
+            {
+                GltfAccessor a;
+                if (!ReadAccessor(prim["indices"].Int(-1), a, job.error))
+                    return fail(job.error);
+                if (a.numComponents != 1 || (a.componentType != GltfUnsignedByte &&
+                    a.componentType != GltfUnsignedShort && a.componentType != GltfUnsignedInt))
+                    return fail("invalid index accessor");
+                // an accessor without a bufferView is all zeros, which still needs a vertex
+                indices.resize(a.count);
+                for (int i = 0; i < a.count; ++i)
+                {
+                    indices[i] = a.data ? ReadIndex(a.data + size_t(i) * a.stride, a.componentType) : 0;
+                    if (indices[i] >= (uint32_t)numVerts)
+                        return fail("vertex index out of bounds");
+                }
+            }
+            else
+            {
+                indices.resize(numVerts);
+                for (int i = 0; i < numVerts; ++i)
+                    indices[i] = i;
+            }
+
+            const bool hasCoords = !g.Coords.empty();
+            const bool hasNormals = !g.Normals.empty();
+            const bool hasColors = !g.Colors.empty();
+            auto corner = [&](uint32_t index) {
+                int i = (int)index;
+                return VertexDescr{ i, hasCoords ? i : -1, hasNormals ? i : -1, hasColors ? i : -1 };
+            };
+            auto addTriangle = [&](uint32_t a, uint32_t b, uint32_t c) {
+                g.Tris.push_back({ corner(a), corner(b), corner(c) });
+            };
+
+            const size_t n = indices.size();
+            if (mode == GltfTriangles)
+            {
+                g.Tris.reserve(n / 3);
+                for (size_t i = 0; i + 2 < n; i += 3)
+                    addTriangle(indices[i], indices[i+1], indices[i+2]);
+            }
+            else if (mode == GltfTriangleStrip)
+            {
+                for (size_t i = 0; i + 2 < n; ++i)
+                {
+                    if (i % 2 == 0) addTriangle(indices[i],   indices[i+1], indices[i+2]);
+                    else            addTriangle(indices[i+1], indices[i],   indices[i+2]);
+                }
+            }
+            else // GltfTriangleFan
+            {
+                for (size_t i = 1; i + 1 < n; ++i)
+                    addTriangle(indices[0], indices[i], indices[i+1]);
+            }
+
+            // glTF front faces are CCW, same as OBJ
+            g.Winding = FaceWinding::CCW;
+            return true;
+        }
+
+        bool ReadPrimitives()
+        {
+            // every primitive has its own group, so they can be loaded in parallel
+            int numJobs = (int)jobs.size();
+            std::atomic<bool> ok { true };
+            ParallelFor(numJobs, (opt & Options::Parallel) ? NumWorkers(numJobs) : 1, [&](int job, int)
+            {
+                if (!LoadPrimitive(jobs[job]))
+                    ok = false;
+            });
+            if (!ok)
+            {
+                for (GltfPrimitiveJob& job : jobs)
+                    if (!job.error.empty())
+                        return Fail(job.error);
+            }
+            return true;
+        }
+
+        struct Channel
+        {
+            std::vector<float> times;
+            std::vector<float> values; // numComponents per key, 3x for cubic splines
+            int numComponents = 0;
+            bool step = false;
+            bool cubic = false;
+
+            // samples the channel at time t
+            void Sample(float t, double* out) const
+            {
+                const int n = numComponents;
+                const int keyStride = cubic ? n * 3 : n;
+                const int valueOffset = cubic ? n : 0; // in-tangent, value, out-tangent
+                size_t count = times.size();
+                size_t next = std::upper_bound(times.begin(), times.end(), t) - times.begin();
+                if (next == 0 || next == count)
+                {
+                    size_t key = next == 0 ? 0 : count - 1;
+                    for (int k = 0; k < n; ++k)
+                        out[k] = values[key * keyStride + valueOffset + k];
+                    return;
+                }
+
+                size_t prev = next - 1;
+                double dt = double(times[next]) - times[prev];
+                double s = dt > 0.0 ? (t - times[prev]) / dt : 0.0;
+                const float* a = &values[prev * keyStride + valueOffset];
+                const float* b = &values[next * keyStride + valueOffset];
+                if (step)
+                {
+                    for (int k = 0; k < n; ++k) out[k] = a[k];
+                }
+                else if (cubic) // hermite spline
+                {
+                    const float* outTangent = a + n;
+                    const float* inTangent  = b - n;
+                    double s2 = s*s, s3 = s2*s;
+                    for (int k = 0; k < n; ++k)
+                        out[k] = (2*s3 - 3*s2 + 1) * a[k] + (s3 - 2*s2 + s) * dt * outTangent[k]
+                               + (-2*s3 + 3*s2) * b[k] + (s3 - s2) * dt * inTangent[k];
+                }
+                else if (n == 4) // quaternion nlerp along the shortest path
+                {
+                    double dot = a[0]*b[0] + a[1]*b[1] + a[2]*b[2] + a[3]*b[3];
+                    double sign = dot < 0.0 ? -1.0 : 1.0;
+                    for (int k = 0; k < n; ++k) out[k] = a[k] + (sign*b[k] - a[k]) * s;
+                }
+                else
+                {
+                    for (int k = 0; k < n; ++k) out[k] = a[k] + (b[k] - a[k]) * s;
+                }
+            }
+        };
+
+        bool ReadChannel(const JsonValue& sampler, int numComponents, Channel& c)
+        {
+            GltfAccessor input, output;
+            if (!GetAccessor(sampler["input"].Int(-1), input) ||
+                !GetAccessor(sampler["output"].Int(-1), output))
+                return false;
+            rpp::strview interpolation = sampler["interpolation"].Str();
+            c.step  = interpolation == "STEP";
+            c.cubic = interpolation == "CUBICSPLINE";
+            c.numComponents = numComponents;
+            int valuesPerKey = c.cubic ? 3 : 1;
+            if (input.numComponents != 1 || output.numComponents != numComponents ||
+                output.count != input.count * valuesPerKey)
+                return Fail("invalid animation sampler");
+
+            c.times.resize(input.count);
+            c.values.resize(size_t(output.count) * numComponents);
+            ReadFloats(input, c.times.data(), 1);
+            ReadFloats(output, c.values.data(), numComponents);
+            if (!std::is_sorted(c.times.begin(), c.times.end()))
+                return Fail("animation keyframe times are not sorted");
+            return true;
+        }
+
+        bool ReadAnimations()
+        {
+            const JsonValue& nodes = doc["nodes"];
+            const JsonValue& animations = doc["animations"];
+            for (int a = 0; a < animations.Size(); ++a)
+            {
+                const JsonValue& animation = animations[a];
+                const JsonValue& channels = animation["channels"];
+                const JsonValue& samplers = animation["samplers"];
+
+                // translation, rotation and scale channels of every animated bone
+                struct BoneChannels { int node = -1; Channel trs[3]; bool has[3] = {}; };
+                std::vector<BoneChannels> bones;
+                for (int c = 0; c < channels.Size(); ++c)
+                {
+                    const JsonValue& target = channels[c]["target"];
+                    int node = target["node"].Int(-1);
+                    if (node < 0 || node >= nodes.Size() || nodeToBone[node] == -1)
+                        continue; // only skeletons are animated
+                    rpp::strview path = target["path"].Str();
+                    int trs = path == "translation" ? 0 : path == "rotation" ? 1 : path == "scale" ? 2 : -1;
+                    if (trs == -1)
+                        continue; // morph target weights
+                    const JsonValue& sampler = samplers[channels[c]["sampler"].Int(-1)];
+                    if (!sampler.IsObject())
+                        return Fail("invalid animation channel");
+
+                    auto it = std::find_if(bones.begin(), bones.end(), [&](auto& b) { return b.node == node; });
+                    BoneChannels& bone = it != bones.end() ? *it : rpp::emplace_back(bones);
+                    bone.node = node;
+                    if (!ReadChannel(sampler, trs == 1 ? 4 : 3, bone.trs[trs]))
+                        return false;
+                    bone.has[trs] = true;
+                }
+
+                AnimationClip& clip = rpp::emplace_back(mesh.AnimationClips);
+                clip.Name = animation.Has("name") ? animation["name"].Str().to_string()
+                                                  : "animation" + std::to_string(a);
+                for (BoneChannels& b : bones)
+                {
+                    // keyframes at the union of all channel key times
+                    std::vector<float> times;
+                    for (int k = 0; k < 3; ++k)
+                        if (b.has[k]) times.insert(times.end(), b.trs[k].times.begin(), b.trs[k].times.end());
+                    std::sort(times.begin(), times.end());
+                    times.erase(std::unique(times.begin(), times.end()), times.end());
+
+                    BoneAnimation& anim = rpp::emplace_back(clip.Animations);
+                    anim.SkinnedBoneIndex = nodeToBone[b.node];
+                    const BonePose& rest = mesh.SkinnedBones[anim.SkinnedBoneIndex].Pose;
+                    for (float t : times)
+                    {
+                        AnimationKeyFrame frame { t, rest };
+                        double v[4];
+                        if (b.has[0]) {
+                            b.trs[0].Sample(t, v);
+                            frame.Pose.Translation = { float(v[0]), float(v[1]), float(v[2]) };
+                        }
+                        if (b.has[1]) {
+                            b.trs[1].Sample(t, v);
+                            frame.Pose.Rotation = QuatToEuler({ v[0], v[1], v[2], v[3] });
+                        }
+                        if (b.has[2]) {
+                            b.trs[2].Sample(t, v);
+                            frame.Pose.Scale = { float(v[0]), float(v[1]), float(v[2]) };
+                        }
+                        anim.Frames.push_back(frame);
+                        clip.Duration = std::max(clip.Duration, t);
+                    }
+                }
+            }
+            return true;
+        }
+    };
+
+    // same as the OBJ loader, all geometry goes into the first group
+    static void MergeIntoSingleGroup(Mesh& mesh)
+    {
+        if (mesh.Groups.size() <= 1)
+            return;
+        MeshGroup& first = mesh.Groups.front();
+        for (size_t i = 1; i < mesh.Groups.size(); ++i)
+        {
+            const MeshGroup& g = mesh.Groups[i];
+            size_t numVertsOld = first.Verts.size();
+            first.AddMeshData(g);
+            if (!g.BlendIndices.empty() || !first.BlendIndices.empty())
+            {
+                first.BlendIndices.resize(numVertsOld);
+                first.BlendWeights.resize(numVertsOld);
+                rpp::append(first.BlendIndices, g.BlendIndices);
+                rpp::append(first.BlendWeights, g.BlendWeights);
+                first.BlendIndices.resize(first.Verts.size());
+                first.BlendWeights.resize(first.Verts.size());
+                first.BlendMapping = MapMode::PerVertex;
+            }
+            if (!first.Mat) first.Mat = g.Mat;
+        }
+        if (!first.Coords.empty())  first.CoordsMapping  = MapMode::PerFaceVertex;
+        if (!first.Normals.empty()) first.NormalsMapping = MapMode::PerFaceVertex;
+        mesh.Groups.erase(mesh.Groups.begin() + 1, mesh.Groups.end());
+    }
+
+    bool Mesh::LoadGLB(rpp::strview meshPath, Options opt)
+    {
+        Clear();
+        Bones.clear();
+        SkinnedBones.clear();
+        AnimationClips.clear();
+
+        GltfReader reader { *this, meshPath, opt };
+        if (!reader.Read())
+        {
+            Clear();
+            NanoErr(opt, "Failed to load '%s': %s", meshPath, reader.error.c_str());
+        }
+
+        Name = file_name(meshPath);
+        if (!(opt & Options::EmptyGroups))
+        {
+            for (auto it = Groups.begin(); it != Groups.end();)
+                if (it->IsEmpty()) it = Groups.erase(it); else ++it;
+        }
+        if (opt & Options::SingleGroup)
+            MergeIntoSingleGroup(*this);
+        for (int i = 0; i < NumGroups(); ++i)
+            Groups[i].GroupId = i;
+
+        if (opt & Options::Log) {
+            LogInfo("Load %-33s  %5d verts  %5d tris  %s",
+                    file_nameext(meshPath), TotalVerts(), TotalTris(), to_string(opt));
+        }
+        ApplyLoadOptions(opt);
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    class GltfWriter
+    {
+        const Mesh& mesh;
+        std::vector<uint8_t> bin;
+        JsonWriter accessors, views, meshes, nodes, materials, textures, images, skins, animations;
+        int numAccessors = 0, numViews = 0, numMeshes = 0, numNodes = 0, numImages = 0;
+        std::vector<std::string> imagePaths;
+        std::vector<int> sceneRoots;
+        std::vector<const Material*> materialList;
+        std::vector<int> skinnedNodes; // SkinnedBones index -> node
+
+    public:
+        explicit GltfWriter(const Mesh& mesh) : mesh{ mesh }
+        {
+            for (JsonWriter* w : { &accessors, &views, &meshes, &nodes, &materials,
+                                   &textures, &images, &skins, &animations })
+                w->BeginArray();
+        }
+
+        // @return Index of the new bufferView
+        int AddView(const void* data, size_t size, int target)
+        {
+            bin.resize((bin.size() + 3) & ~size_t(3), 0); // accessors must be aligned to their component size
+            size_t offset = bin.size();
+            bin.resize(offset + size);
+            if (size) memcpy(bin.data() + offset, data, size);
+
+            views.BeginObject()
+                .Member("buffer", 0)
+                .Member("byteOffset", offset)
+                .Member("byteLength", size);
+            if (target) views.Member("target", target);
+            views.EndObject();
+            return numViews++;
+        }
+
+        // @return Index of the new accessor
+        int AddAccessor(const void* data, int count, int componentType, const char* type,
+                        size_t elementSize, int target, const float* min = nullptr,
+                        const float* max = nullptr, int numMinMax = 0)
+        {
+            int view = AddView(data, size_t(count) * elementSize, target);
+            accessors.BeginObject()
+                .Member("bufferView", view)
+                .Member("componentType", componentType)
+                .Member("count", count)
+                .Member("type", type);
+            if (min && max)
+            {
+                accessors.Key("min").Array(min, numMinMax);
+                accessors.Key("max").Array(max, numMinMax);
+            }
+            accessors.EndObject();
+            return numAccessors++;
+        }
+
+        template<class T> int AddFloats(const std::vector<T>& items, const char* type, int target)
+        {
+            return AddAccessor(items.data(), (int)items.size(), GltfFloat, type, sizeof(T), target);
+        }
+
+        int AddTexture(const std::string& path)
+        {
+            auto it = std::find(imagePaths.begin(), imagePaths.end(), path);
+            int image = int(it - imagePaths.begin());
+            if (it == imagePaths.end())
+            {
+                imagePaths.push_back(path);
+                images.BeginObject().Member("uri", path).EndObject();
+                textures.BeginObject().Member("source", image).EndObject();
+                ++numImages;
+            }
+            return image; // one texture per image
+        }
+
+        static void WriteColor(JsonWriter& w, const rpp::Color3& c)
+        {
+            w.BeginArray().Value(c.r).Value(c.g).Value(c.b).EndArray();
+        }
+
+        int AddMaterial(const Material* m)
+        {
+            auto it = std::find(materialList.begin(), materialList.end(), m);
+            if (it != materialList.end())
+                return int(it - materialList.begin());
+            materialList.push_back(m);
+
+            materials.BeginObject().Member("name", m->Name);
+            materials.Key("pbrMetallicRoughness").BeginObject();
+            {
+                materials.Key("baseColorFactor").BeginArray()
+                    .Value(m->DiffuseColor.r).Value(m->DiffuseColor.g)
+                    .Value(m->DiffuseColor.b).Value(m->Alpha).EndArray();
+                if (!m->DiffusePath.empty())
+                    materials.Key("baseColorTexture").BeginObject().Member("index", AddTexture(m->DiffusePath)).EndObject();
+                materials.Member("metallicFactor", 0.0);
+            }
+            materials.EndObject();
+            if (!m->NormalPath.empty())
+                materials.Key("normalTexture").BeginObject().Member("index", AddTexture(m->NormalPath)).EndObject();
+            if (!m->EmissivePath.empty())
+                materials.Key("emissiveTexture").BeginObject().Member("index", AddTexture(m->EmissivePath)).EndObject();
+            materials.Key("emissiveFactor"); WriteColor(materials, m->EmissiveColor);
+            if (m->Alpha < 1.0f)
+                materials.Member("alphaMode", "BLEND");
+
+            // properties without a glTF equivalent, so they survive a round trip
+            materials.Key("extras").BeginObject();
+            materials.Key("ambientColor");  WriteColor(materials, m->AmbientColor);
+            materials.Key("specularColor"); WriteColor(materials, m->SpecularColor);
+            materials.Member("specular", m->Specular);
+            if (!m->AlphaPath.empty())    materials.Member("alphaTexture", m->AlphaPath);
+            if (!m->SpecularPath.empty()) materials.Member("specularTexture", m->SpecularPath);
+            materials.EndObject();
+
+            materials.EndObject();
+            return (int)materialList.size() - 1;
+        }
+
+        static void WriteTRS(JsonWriter& w, const rpp::Vector3& t, const rpp::Vector3& r, const rpp::Vector3& s)
+        {
+            GltfQuat q = EulerToQuat(r);
+            w.Key("translation").BeginArray().Value(t.x).Value(t.y).Value(t.z).EndArray();
+            w.Key("rotation").BeginArray().Value(q.x).Value(q.y).Value(q.z).Value(q.w).EndArray();
+            w.Key("scale").BeginArray().Value(s.x).Value(s.y).Value(s.z).EndArray();
+        }
+
+        void AddGroup(const MeshGroup& group)
+        {
+            // glTF is always GL coordinates with CCW front faces
+            const MeshGroup* src = &group;
+            MeshGroup converted { group.GroupId, group.Name };
+            if (group.System != CoordSys::GL || group.Winding != FaceWinding::CCW)
+            {
+                converted = group;
+                converted.SetCoordSys(CoordSys::GL);
+                converted.SetFaceWinding(FaceWinding::CCW);
+                src = &converted;
+            }
+            const MeshGroup& g = *src;
+
+            // glTF attributes are per vertex, so every unique corner becomes a vertex,
+            // groups which are already mapped per vertex are written as they are
+            bool perVertex = true;
+            for (const Triangle& tri : g.Tris)
+                for (const VertexDescr& vd : tri)
+                    if ((vd.t != -1 && vd.t != vd.v) || (vd.n != -1 && vd.n != vd.v) || (vd.c != -1 && vd.c != vd.v))
+                        perVertex = false;
+
+            bool hasCoords = false, hasNormals = false, hasColors = false;
+            for (const Triangle& tri : g.Tris)
+                for (const VertexDescr& vd : tri) {
+                    hasCoords  |= vd.t != -1;
+                    hasNormals |= vd.n != -1;
+                    hasColors  |= vd.c != -1;
+                }
+            perVertex = perVertex
+                && (!hasCoords  || g.Coords.size()  >= g.Verts.size())
+                && (!hasNormals || g.Normals.size() >= g.Verts.size())
+                && (!hasColors  || g.Colors.size()  >= g.Verts.size());
+            const bool hasSkin = !g.BlendIndices.empty() && g.BlendIndices.size() == g.Verts.size()
+                              && g.BlendWeights.size() == g.Verts.size();
+
+            std::vector<rpp::Vector3> verts, normals;
+            std::vector<rpp::Vector2> coords;
+            std::vector<rpp::Color3>  colors;
+            std::vector<BlendIndices> joints;
+            std::vector<BlendWeights> weights;
+            std::vector<uint32_t> indices;
+            indices.reserve(g.Tris.size() * 3);
+
+            auto addVertex = [&](const VertexDescr& vd, const VertexDescr& attribs) {
+                verts.push_back(vd.v != -1 ? g.Verts[vd.v] : rpp::Vector3::Zero());
+                if (hasCoords) {
+                    rpp::Vector2 uv = attribs.t != -1 ? g.Coords[attribs.t] : rpp::Vector2::Zero();
+                    coords.push_back({ uv.x, 1.0f - uv.y });
+                }
+                if (hasNormals) normals.push_back(attribs.n != -1 ? g.Normals[attribs.n] : rpp::Vector3::Zero());
+                if (hasColors)  colors.push_back(attribs.c != -1 ? g.Colors[attribs.c] : rpp::Color3::White());
+                if (hasSkin) {
+                    joints.push_back(vd.v != -1 ? g.BlendIndices[vd.v] : BlendIndices{});
+                    weights.push_back(vd.v != -1 ? g.BlendWeights[vd.v] : BlendWeights{});
+                }
+            };
+
+            if (perVertex)
+            {
+                for (int i = 0; i < g.NumVerts(); ++i)
+                    addVertex({ i, -1, -1, -1 }, { i, hasCoords ? i : -1, hasNormals ? i : -1, hasColors ? i : -1 });
+                for (const Triangle& tri : g.Tris)
+                    for (const VertexDescr& vd : tri)
+                        indices.push_back((uint32_t)vd.v);
+            }
+            else
+            {
+                std::unordered_map<VertexDescr, uint32_t, VertexDescrHash> unique;
+                unique.reserve(g.Tris.size() * 2);
+                for (const Triangle& tri : g.Tris)
+                {
+                    for (const VertexDescr& vd : tri)
+                    {
+                        auto result = unique.emplace(vd, (uint32_t)verts.size());
+                        if (result.second)
+                            addVertex(vd, vd);
+                        indices.push_back(result.first->second);
+                    }
+                }
+            }
+
+            const int numVerts = (int)verts.size();
+            float min[3] = { 0, 0, 0 }, max[3] = { 0, 0, 0 };
+            for (int i = 0; i < numVerts; ++i)
+            {
+                const float* p = &verts[i].x;
+                for (int k = 0; k < 3; ++k)
+                {
+                    min[k] = i == 0 ? p[k] : std::min(min[k], p[k]);
+                    max[k] = i == 0 ? p[k] : std::max(max[k], p[k]);
+                }
+            }
+
+            int position = AddAccessor(verts.data(), numVerts, GltfFloat, "VEC3", sizeof(rpp::Vector3),
+                                       GltfArrayBuffer, min, max, 3);
+            int normal  = hasNormals ? AddFloats(normals, "VEC3", GltfArrayBuffer) : -1;
+            int coord   = hasCoords  ? AddFloats(coords,  "VEC2", GltfArrayBuffer) : -1;
+            int color   = hasColors  ? AddFloats(colors,  "VEC3", GltfArrayBuffer) : -1;
+            int joint   = hasSkin ? AddAccessor(joints.data(), numVerts, GltfUnsignedByte, "VEC4",
+                                                sizeof(BlendIndices), GltfArrayBuffer) : -1;
+            int weight  = hasSkin ? AddFloats(weights, "VEC4", GltfArrayBuffer) : -1;
+
+            int index;
+            if (numVerts <= 65535) // index 65535 is reserved for primitive restart
+            {
+                std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+                index = AddAccessor(shortIndices.data(), (int)shortIndices.size(), GltfUnsignedShort,
+                                    "SCALAR", sizeof(uint16_t), GltfElementArrayBuffer);
+            }
+            else
+            {
+                index = AddAccessor(indices.data(), (int)indices.size(), GltfUnsignedInt,
+                                    "SCALAR", sizeof(uint32_t), GltfElementArrayBuffer);
+            }
+
+            int meshIndex = numMeshes++;
+            meshes.BeginObject().Member("name", g.Name);
+            meshes.Key("primitives").BeginArray().BeginObject();
+            meshes.Key("attributes").BeginObject();
+            meshes.Member("POSITION", position);
+            if (normal != -1) meshes.Member("NORMAL", normal);
+            if (coord  != -1) meshes.Member("TEXCOORD_0", coord);
+            if (color  != -1) meshes.Member("COLOR_0", color);
+            if (joint  != -1) meshes.Member("JOINTS_0", joint).Member("WEIGHTS_0", weight);
+            meshes.EndObject();
+            meshes.Member("indices", index).Member("mode", (int)GltfTriangles);
+            if (g.Mat) meshes.Member("material", AddMaterial(g.Mat.get()));
+            meshes.EndObject().EndArray().EndObject();
+
+            nodes.BeginObject().Member("name", g.Name).Member("mesh", meshIndex);
+            WriteTRS(nodes, g.Offset, g.Rotation, g.Scale);
+            if (hasSkin && !mesh.SkinnedBones.empty()) nodes.Member("skin", 0);
+            nodes.EndObject();
+            sceneRoots.push_back(numNodes++);
+        }
+
+        template<class Bone> void AddBoneNodes(const std::vector<Bone>& bones, std::vector<int>& boneNodes)
+        {
+            boneNodes.resize(bones.size());
+            for (size_t i = 0; i < bones.size(); ++i)
+                boneNodes[i] = numNodes + (int)i;
+            for (size_t i = 0; i < bones.size(); ++i)
+            {
+                const Bone& bone = bones[i];
+                nodes.BeginObject().Member("name", bone.Name);
+                WriteTRS(nodes, bone.Pose.Translation, bone.Pose.Rotation, bone.Pose.Scale);
+                bool hasChildren = false;
+                for (size_t c = 0; c < bones.size(); ++c)
+                {
+                    if (c != i && bones[c].ParentIndex == (int)i)
+                    {
+                        if (!hasChildren) nodes.Key("children").BeginArray();
+                        hasChildren = true;
+                        nodes.Value(boneNodes[c]);
+                    }
+                }
+                if (hasChildren) nodes.EndArray();
+                nodes.EndObject();
+
+                if ((size_t)bone.ParentIndex >= bones.size() || bone.ParentIndex == (int)i)
+                    sceneRoots.push_back(boneNodes[i]);
+            }
+            numNodes += (int)bones.size();
+        }
+
+        void AddSkeleton()
+        {
+            // Bones is the full skeleton, SkinnedBones are matched to it by name
+            std::vector<int> boneNodes;
+            AddBoneNodes(mesh.Bones, boneNodes);
+
+            skinnedNodes.assign(mesh.SkinnedBones.size(), -1);
+            std::vector<SkinnedBone> unmatched;
+            std::vector<int> unmatchedIndex;
+            for (size_t i = 0; i < mesh.SkinnedBones.size(); ++i)
+            {
+                const SkinnedBone& skinned = mesh.SkinnedBones[i];
+                for (size_t b = 0; b < mesh.Bones.size(); ++b)
+                    if (mesh.Bones[b].Name == skinned.Name) { skinnedNodes[i] = boneNodes[b]; break; }
+                if (skinnedNodes[i] == -1)
+                {
+                    unmatched.push_back(skinned);
+                    unmatchedIndex.push_back((int)i);
+                }
+            }
+            if (!unmatched.empty())
+            {
+                // keep the hierarchy among the unmatched bones only
+                for (SkinnedBone& bone : unmatched)
+                {
+                    auto it = std::find(unmatchedIndex.begin(), unmatchedIndex.end(), bone.ParentIndex);
+                    bone.ParentIndex = it != unmatchedIndex.end() ? int(it - unmatchedIndex.begin()) : -1;
+                }
+                std::vector<int> extraNodes;
+                AddBoneNodes(unmatched, extraNodes);
+                for (size_t i = 0; i < unmatched.size(); ++i)
+                    skinnedNodes[unmatchedIndex[i]] = extraNodes[i];
+            }
+
+            if (mesh.SkinnedBones.empty())
+                return;
+            std::vector<float> matrices(mesh.SkinnedBones.size() * 16);
+            for (size_t i = 0; i < mesh.SkinnedBones.size(); ++i)
+                memcpy(&matrices[i * 16], &mesh.SkinnedBones[i].InverseBindPoseTransform, sizeof(rpp::Matrix4));
+            int ibm = AddAccessor(matrices.data(), (int)mesh.SkinnedBones.size(), GltfFloat, "MAT4",
+                                  sizeof(float) * 16, 0);
+            skins.BeginObject().Member("inverseBindMatrices", ibm);
+            skins.Key("joints").BeginArray();
+            for (int node : skinnedNodes) skins.Value(node);
+            skins.EndArray().EndObject();
+        }
+
+        void AddAnimations()
+        {
+            for (const AnimationClip& clip : mesh.AnimationClips)
+            {
+                JsonWriter samplers, channels;
+                samplers.BeginArray();
+                channels.BeginArray();
+                int numSamplers = 0;
+                for (const BoneAnimation& anim : clip.Animations)
+                {
+                    if (anim.Frames.empty() || (size_t)anim.SkinnedBoneIndex >= skinnedNodes.size())
+                        continue;
+                    const int numFrames = (int)anim.Frames.size();
+                    std::vector<float> times;
+                    std::vector<rpp::Vector3> translations, scales;
+                    std::vector<float> rotations;
+                    for (const AnimationKeyFrame& frame : anim.Frames)
+                    {
+                        times.push_back(frame.Time);
+                        translations.push_back(frame.Pose.Translation);
+                        scales.push_back(frame.Pose.Scale);
+                        GltfQuat q = EulerToQuat(frame.Pose.Rotation);
+                        rotations.insert(rotations.end(), { float(q.x), float(q.y), float(q.z), float(q.w) });
+                    }
+                    // glTF keyframe times must be increasing
+                    if (!std::is_sorted(times.begin(), times.end()))
+                        continue;
+
+                    float minTime = times.front(), maxTime = times.back();
+                    int input = AddAccessor(times.data(), numFrames, GltfFloat, "SCALAR", sizeof(float), 0,
+                                            &minTime, &maxTime, 1);
+                    int outputs[3] = {
+                        AddAccessor(translations.data(), numFrames, GltfFloat, "VEC3", sizeof(rpp::Vector3), 0),
+                        AddAccessor(rotations.data(), numFrames, GltfFloat, "VEC4", sizeof(float) * 4, 0),
+                        AddAccessor(scales.data(), numFrames, GltfFloat, "VEC3", sizeof(rpp::Vector3), 0),
+                    };
+                    const char* paths[3] = { "translation", "rotation", "scale" };
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        samplers.BeginObject().Member("input", input).Member("output", outputs[k])
+                                .Member("interpolation", "LINEAR").EndObject();
+                        channels.BeginObject().Member("sampler", numSamplers++);
+                        channels.Key("target").BeginObject()
+                                .Member("node", skinnedNodes[anim.SkinnedBoneIndex])
+                                .Member("path", paths[k]).EndObject();
+                        channels.EndObject();
+                    }
+                }
+                samplers.EndArray();
+                channels.EndArray();
+                animations.BeginObject().Member("name", clip.Name);
+                animations.Key("samplers").Raw(samplers.Str());
+                animations.Key("channels").Raw(channels.Str());
+                animations.EndObject();
+            }
+        }
+
+        std::string Json()
+        {
+            for (JsonWriter* w : { &accessors, &views, &meshes, &nodes, &materials,
+                                   &textures, &images, &skins, &animations })
+                w->EndArray();
+
+            JsonWriter doc;
+            doc.BeginObject();
+            doc.Key("asset").BeginObject().Member("version", "2.0").Member("generator", "NanoMesh").EndObject();
+            doc.Member("scene", 0);
+            doc.Key("scenes").BeginArray().BeginObject().Member("name", mesh.Name);
+            doc.Key("nodes").BeginArray();
+            for (int root : sceneRoots) doc.Value(root);
+            doc.EndArray().EndObject().EndArray();
+            doc.Key("nodes").Raw(nodes.Str());
+            doc.Key("meshes").Raw(meshes.Str());
+            if (!materialList.empty())         doc.Key("materials").Raw(materials.Str());
+            if (numImages > 0)                 doc.Key("textures").Raw(textures.Str())
+                                                  .Key("images").Raw(images.Str());
+            if (!mesh.SkinnedBones.empty())    doc.Key("skins").Raw(skins.Str());
+            if (!mesh.AnimationClips.empty())  doc.Key("animations").Raw(animations.Str());
+            doc.Key("accessors").Raw(accessors.Str());
+            doc.Key("bufferViews").Raw(views.Str());
+            if (!bin.empty())
+                doc.Key("buffers").BeginArray().BeginObject().Member("byteLength", bin.size()).EndObject().EndArray();
+            doc.EndObject();
+            return doc.Str();
+        }
+
+        bool Write(rpp::file& f)
+        {
+            AddSkeleton();
+            for (const MeshGroup& g : mesh.Groups)
+                if (!g.IsEmpty())
+                    AddGroup(g);
+            AddAnimations();
+
+            std::string json = Json();
+            json.resize((json.size() + 3) & ~size_t(3), ' ');
+            bin.resize((bin.size() + 3) & ~size_t(3), 0);
+
+            GlbChunk jsonChunk { (uint32_t)json.size(), GlbChunkJson };
+            GlbChunk binChunk  { (uint32_t)bin.size(),  GlbChunkBin };
+            uint64_t length = sizeof(GlbHeader) + sizeof(GlbChunk) + json.size()
+                            + (bin.empty() ? 0 : sizeof(GlbChunk) + bin.size());
+            if (length > UINT32_MAX)
+                return false;
+            GlbHeader header { GlbMagic, GlbVersion, (uint32_t)length };
+
+            auto write = [&f](const void* data, size_t size) {
+                const char* p = (const char*)data;
+                while (size > 0)
+                {
+                    int chunk = (int)std::min<size_t>(size, INT_MAX / 2);
+                    if (f.write(p, chunk) != chunk)
+                        return false;
+                    p += chunk;
+                    size -= (size_t)chunk;
+                }
+                return true;
+            };
+            return write(&header, sizeof(header))
+                && write(&jsonChunk, sizeof(jsonChunk)) && write(json.data(), json.size())
+                && (bin.empty() || (write(&binChunk, sizeof(binChunk)) && write(bin.data(), bin.size())));
+        }
+    };
+
+    bool Mesh::SaveAsGLB(rpp::strview meshPath, Options opt) const
+    {
+        if (opt & Options::Log) {
+            LogInfo("Save %-33s  %5d verts  %5d tris",
+                file_nameext(meshPath), TotalVerts(), TotalTris());
+        }
+
+        rpp::file f { meshPath, rpp::file::CREATENEW };
+        if (!f) {
+            NanoErr(opt, "Failed to create file: %s", meshPath);
+        }
+        GltfWriter writer { *this };
+        if (!writer.Write(f)) {
+            NanoErr(opt, "File write failed: %s", meshPath);
+        }
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
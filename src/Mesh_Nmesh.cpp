@@ -0,0 +1,721 @@
+#include <Nano/Mesh.h>
+#include <Nano/MeshCodec.h>
+#include <rpp/file_io.h>
+#include <rpp/sprint.h>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include "InternalConfig.h"
+#include "FileSource.h"
+#include "Nmesh.h"
+#include "Parallel.h"
+
+namespace Nano
+{
+    using namespace rpp::literals;
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * .nmesh binary layout, all values are in the native byte order of the writer,
+     * and EndianTag rejects files written on a machine with the opposite byte order:
+     *
+     *   NmeshHeader
+     *   NmeshSection[NumSections]  at SectionTableOffset
+     *   payloads                   each one 16-byte aligned
+     *
+     * Array sections (Verts, Tris, ...) store the raw in-memory arrays of one MeshGroup,
+     * so loading them is a bulk copy. With NmeshCompressed they're encoded with the
+     * mesh codec instead (Options::Compress). Other sections are small serialized blobs.
+     * Readers skip unknown section types, so new sections only bump the minor version.
+     *
+     * 1.1: NmeshCompressed array sections
+     */
+    static constexpr char NmeshMagic[4] = { 'N', 'M', 'S', 'H' };
+    static constexpr uint16_t NmeshVersionMajor = 1;
+    static constexpr uint16_t NmeshVersionMinor = 1;
+    static constexpr uint32_t NmeshEndianTag = 0x01020304;
+    static constexpr uint64_t NmeshAlignment = 16;
+
+    struct NmeshHeader
+    {
+        char Magic[4];
+        uint16_t VersionMajor;
+        uint16_t VersionMinor;
+        uint32_t EndianTag;
+        uint32_t HeaderSize;
+        uint32_t NumGroups;
+        uint32_t NumSections;
+        uint64_t SectionTableOffset;
+        uint64_t FileSize;
+        uint64_t SourceHash; // content hash of the source mesh this was derived from, 0 if none
+        uint8_t Reserved[16];
+    };
+    static_assert(sizeof(NmeshHeader) == 64, "NmeshHeader layout changed");
+
+    enum class NmeshSectionType : uint32_t
+    {
+        MeshInfo      = 1,  // blob: mesh name
+        Materials     = 2,  // blob: all materials referenced by groups
+        Bones         = 3,  // blob: Mesh::Bones
+        SkinnedBones  = 4,  // blob: Mesh::SkinnedBones
+        AnimClips     = 5,  // blob: Mesh::AnimationClips
+        GroupInfo     = 16, // blob: name, material, transform and mapping modes of a group
+        Verts         = 17,
+        Coords        = 18,
+        Normals       = 19,
+        Colors        = 20,
+        Weights       = 21,
+        BlendIndices  = 22,
+        BlendWeights  = 23,
+        Tris          = 24,
+    };
+
+    struct NmeshSection
+    {
+        NmeshSectionType Type;
+        int32_t GroupIndex;   // -1 for mesh level sections
+        uint32_t ElementSize; // 1 for blobs
+        uint32_t Flags;       // NmeshSectionFlags
+        uint64_t Count;       // number of elements
+        uint64_t Offset;      // from the start of the file, 16-byte aligned
+        uint64_t Size;        // payload size in bytes
+    };
+    static_assert(sizeof(NmeshSection) == 40, "NmeshSection layout changed");
+
+    enum NmeshSectionFlags : uint32_t
+    {
+        NmeshCompressed = 1, // payload is encoded with Nano/MeshCodec.h, Count is the decoded count
+    };
+
+    // Max ratio of decoded to encoded size, which bounds the allocations of corrupted files
+    static constexpr uint64_t NmeshMaxExpansion = 256;
+
+    static_assert(std::is_trivially_copyable<Triangle>::value && sizeof(Triangle) == 48, "Triangle layout changed");
+    static_assert(sizeof(rpp::Vector3) == 12 && sizeof(rpp::Vector2) == 8 && sizeof(rpp::Vector4) == 16, "");
+    static_assert(sizeof(BlendIndices) == 4 && sizeof(BlendWeights) == 16, "");
+    static_assert(sizeof(AnimationKeyFrame) == 40, "AnimationKeyFrame layout changed");
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    // Serializes the small non-array sections
+    struct NmeshBlobWriter
+    {
+        std::vector<char> data;
+
+        template<class T> void Write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "");
+            const char* p = (const char*)&value;
+            data.insert(data.end(), p, p + sizeof(T));
+        }
+        void WriteStr(rpp::strview s)
+        {
+            Write<uint32_t>((uint32_t)s.len);
+            data.insert(data.end(), s.str, s.str + s.len);
+        }
+        template<class T> void WriteArray(const std::vector<T>& items)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "");
+            Write<uint32_t>((uint32_t)items.size());
+            const char* p = (const char*)items.data();
+            data.insert(data.end(), p, p + items.size()*sizeof(T));
+        }
+    };
+
+    // Bounds checked reader of a blob section, all reads fail after the first overflow
+    struct NmeshBlobReader
+    {
+        const char* ptr;
+        const char* end;
+        bool ok = true;
+
+        template<class T> T Read()
+        {
+            T value {};
+            if (!Check(sizeof(T))) return value;
+            memcpy(&value, ptr, sizeof(T));
+            ptr += sizeof(T);
+            return value;
+        }
+        std::string ReadStr()
+        {
+            uint32_t len = Read<uint32_t>();
+            if (!Check(len)) return {};
+            std::string s { ptr, len };
+            ptr += len;
+            return s;
+        }
+        // @return Element count, if the remaining data can hold `count` elements of at least `minSize` bytes
+        uint32_t ReadCount(uint32_t minSize)
+        {
+            uint32_t count = Read<uint32_t>();
+            if (!ok || uint64_t(count) * minSize > uint64_t(end - ptr)) {
+                ok = false;
+                return 0;
+            }
+            return count;
+        }
+        template<class T> void ReadArray(std::vector<T>& items)
+        {
+            uint32_t count = ReadCount(sizeof(T));
+            if (!ok) return;
+            items.resize(count);
+            memcpy(items.data(), ptr, count * sizeof(T));
+            ptr += count * sizeof(T);
+        }
+        bool Check(uint64_t size)
+        {
+            ok = ok && size <= uint64_t(end - ptr);
+            return ok;
+        }
+    };
+
+    // float vector and triangle layers have a codec, other arrays are always stored raw
+    template<class T> static bool EncodeArray(const std::vector<T>&, std::vector<uint8_t>&)
+    {
+        return false;
+    }
+    template<class T> static bool DecodeArray(std::vector<T>&, const uint8_t*, size_t)
+    {
+        return false;
+    }
+
+    static bool EncodeArray(const std::vector<rpp::Vector2>& items, std::vector<uint8_t>& out)
+    {
+        EncodeVertexLayer(&items.data()->x, items.size(), 2, out, true);
+        return true;
+    }
+    static bool EncodeArray(const std::vector<rpp::Vector3>& items, std::vector<uint8_t>& out)
+    {
+        EncodeVertexLayer(&items.data()->x, items.size(), 3, out, true);
+        return true;
+    }
+    static bool EncodeArray(const std::vector<rpp::Vector4>& items, std::vector<uint8_t>& out)
+    {
+        EncodeVertexLayer(&items.data()->x, items.size(), 4, out, true);
+        return true;
+    }
+    static bool EncodeArray(const std::vector<Triangle>& items, std::vector<uint8_t>& out)
+    {
+        EncodeTriangles(items.data(), items.size(), out, true);
+        return true;
+    }
+
+    static bool DecodeArray(std::vector<rpp::Vector2>& items, const uint8_t* data, size_t size)
+    {
+        return DecodeVertexLayer(data, size, &items.data()->x, items.size(), 2);
+    }
+    static bool DecodeArray(std::vector<rpp::Vector3>& items, const uint8_t* data, size_t size)
+    {
+        return DecodeVertexLayer(data, size, &items.data()->x, items.size(), 3);
+    }
+    static bool DecodeArray(std::vector<rpp::Vector4>& items, const uint8_t* data, size_t size)
+    {
+        return DecodeVertexLayer(data, size, &items.data()->x, items.size(), 4);
+    }
+    static bool DecodeArray(std::vector<Triangle>& items, const uint8_t* data, size_t size)
+    {
+        return DecodeTriangles(data, size, items.data(), items.size());
+    }
+
+    static void WriteBonePose(NmeshBlobWriter& w, const BonePose& pose)
+    {
+        w.Write(pose.Translation); w.Write(pose.Rotation); w.Write(pose.Scale);
+    }
+
+    static BonePose ReadBonePose(NmeshBlobReader& r)
+    {
+        BonePose pose;
+        pose.Translation = r.Read<rpp::Vector3>();
+        pose.Rotation    = r.Read<rpp::Vector3>();
+        pose.Scale       = r.Read<rpp::Vector3>();
+        return pose;
+    }
+
+    static void WriteMaterial(NmeshBlobWriter& w, const Material& mat)
+    {
+        w.WriteStr(mat.Name);
+        w.WriteStr(mat.DiffusePath);
+        w.WriteStr(mat.AlphaPath);
+        w.WriteStr(mat.SpecularPath);
+        w.WriteStr(mat.NormalPath);
+        w.WriteStr(mat.EmissivePath);
+        w.Write(mat.AmbientColor);
+        w.Write(mat.DiffuseColor);
+        w.Write(mat.SpecularColor);
+        w.Write(mat.EmissiveColor);
+        w.Write(mat.Specular);
+        w.Write(mat.Alpha);
+    }
+
+    static std::shared_ptr<Material> ReadMaterial(NmeshBlobReader& r)
+    {
+        auto mat = std::make_shared<Material>();
+        mat->Name          = r.ReadStr();
+        mat->DiffusePath   = r.ReadStr();
+        mat->AlphaPath     = r.ReadStr();
+        mat->SpecularPath  = r.ReadStr();
+        mat->NormalPath    = r.ReadStr();
+        mat->EmissivePath  = r.ReadStr();
+        mat->AmbientColor  = r.Read<rpp::Color3>();
+        mat->DiffuseColor  = r.Read<rpp::Color3>();
+        mat->SpecularColor = r.Read<rpp::Color3>();
+        mat->EmissiveColor = r.Read<rpp::Color3>();
+        mat->Specular      = r.Read<float>();
+        mat->Alpha         = r.Read<float>();
+        return mat;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    struct NmeshWriter
+    {
+        struct Payload
+        {
+            const void* data;                 // raw array data
+            std::vector<char> blob;           // owned data for blob sections
+            std::vector<uint8_t> encoded;     // owned data for compressed array sections
+            std::function<bool(std::vector<uint8_t>&)> encode; // deferred array encoder
+
+            const void* Data() const
+            {
+                return !encoded.empty() ? (const void*)encoded.data() : data ? data : blob.data();
+            }
+        };
+
+        std::vector<NmeshSection> sections;
+        std::vector<Payload> payloads;
+        bool tooManyElements = false; // MeshGroup indices are int, so the loader would reject it
+
+        void AddBlob(NmeshSectionType type, int group, NmeshBlobWriter&& w)
+        {
+            uint64_t size = w.data.size();
+            sections.push_back({ type, group, 1, 0, size, 0, size });
+            payloads.push_back({ nullptr, std::move(w.data), {}, {} });
+        }
+
+        template<class T> void AddArray(NmeshSectionType type, int group, const std::vector<T>& items, bool compress)
+        {
+            if (items.empty())
+                return;
+            tooManyElements |= items.size() > INT_MAX;
+            sections.push_back({ type, group, (uint32_t)sizeof(T), 0, items.size(), 0, items.size()*sizeof(T) });
+            payloads.push_back({ items.data(), {}, {}, {} });
+            if (compress)
+                payloads.back().encode = [&items](std::vector<uint8_t>& out) { return EncodeArray(items, out); };
+        }
+
+        // encodes the compressed array sections, the ones that don't get smaller are stored raw
+        void Encode(bool parallel)
+        {
+            std::vector<size_t> jobs;
+            for (size_t i = 0; i < payloads.size(); ++i)
+                if (payloads[i].encode)
+                    jobs.push_back(i);
+
+            int numJobs = (int)jobs.size();
+            ParallelFor(numJobs, parallel ? NumWorkers(numJobs) : 1, [&](int job, int)
+            {
+                NmeshSection& s = sections[jobs[job]];
+                Payload& p = payloads[jobs[job]];
+                if (p.encode(p.encoded) && p.encoded.size() < s.Size &&
+                    p.encoded.size() * NmeshMaxExpansion >= s.Size)
+                {
+                    s.Flags |= NmeshCompressed;
+                    s.Size = p.encoded.size();
+                }
+                else
+                {
+                    p.encoded = {};
+                }
+            });
+        }
+
+        // assigns aligned offsets to all sections
+        uint64_t Layout()
+        {
+            uint64_t offset = sizeof(NmeshHeader) + sections.size()*sizeof(NmeshSection);
+            for (NmeshSection& s : sections)
+            {
+                offset = (offset + NmeshAlignment - 1) & ~(NmeshAlignment - 1);
+                s.Offset = offset;
+                offset += s.Size;
+            }
+            return offset;
+        }
+
+        bool Write(rpp::file& f, uint32_t numGroups, uint64_t sourceHash)
+        {
+            NmeshHeader header {};
+            memcpy(header.Magic, NmeshMagic, sizeof(NmeshMagic));
+            header.VersionMajor = NmeshVersionMajor;
+            header.VersionMinor = NmeshVersionMinor;
+            header.EndianTag    = NmeshEndianTag;
+            header.HeaderSize   = sizeof(NmeshHeader);
+            header.NumGroups    = numGroups;
+            header.NumSections  = (uint32_t)sections.size();
+            header.SectionTableOffset = sizeof(NmeshHeader);
+            header.FileSize     = Layout();
+            header.SourceHash   = sourceHash;
+
+            // rpp::file is int based, so big sections are written in pieces
+            auto write = [&f](const void* data, uint64_t size) {
+                const char* p = (const char*)data;
+                while (size > 0)
+                {
+                    int chunk = (int)std::min<uint64_t>(size, INT_MAX / 2);
+                    if (f.write(p, chunk) != chunk)
+                        return false;
+                    p += chunk;
+                    size -= (uint64_t)chunk;
+                }
+                return true;
+            };
+            if (!write(&header, sizeof(header)) ||
+                !write(sections.data(), sections.size()*sizeof(NmeshSection)))
+                return false;
+
+            static constexpr char padding[NmeshAlignment] = {};
+            uint64_t offset = sizeof(NmeshHeader) + sections.size()*sizeof(NmeshSection);
+            for (size_t i = 0; i < sections.size(); ++i)
+            {
+                const NmeshSection& s = sections[i];
+                const Payload& p = payloads[i];
+                if (!write(padding, s.Offset - offset) ||
+                    !write(p.Data(), s.Size))
+                    return false;
+                offset = s.Offset + s.Size;
+            }
+            return true;
+        }
+    };
+
+    bool WriteNmesh(const Mesh& mesh, rpp::strview meshPath, Options opt, uint64_t sourceHash)
+    {
+        if (opt & Options::Log) {
+            LogInfo("Save %-33s  %5d verts  %5d tris",
+                file_nameext(meshPath), mesh.TotalVerts(), mesh.TotalTris());
+        }
+
+        NmeshWriter writer;
+        {
+            NmeshBlobWriter info;
+            info.WriteStr(mesh.Name);
+            writer.AddBlob(NmeshSectionType::MeshInfo, -1, std::move(info));
+        }
+
+        // materials are shared between groups, so they're stored once and referenced by index
+        std::vector<const Material*> materials;
+        for (const MeshGroup& g : mesh.Groups)
+            if (g.Mat && !rpp::contains(materials, g.Mat.get()))
+                materials.push_back(g.Mat.get());
+        if (!materials.empty())
+        {
+            NmeshBlobWriter w;
+            w.Write<uint32_t>((uint32_t)materials.size());
+            for (const Material* mat : materials)
+                WriteMaterial(w, *mat);
+            writer.AddBlob(NmeshSectionType::Materials, -1, std::move(w));
+        }
+
+        if (!mesh.Bones.empty())
+        {
+            NmeshBlobWriter w;
+            w.Write<uint32_t>((uint32_t)mesh.Bones.size());
+            for (const MeshBone& bone : mesh.Bones) {
+                w.Write<int32_t>(bone.BoneIndex);
+                w.Write<int32_t>(bone.ParentIndex);
+                w.WriteStr(bone.Name);
+                WriteBonePose(w, bone.Pose);
+            }
+            writer.AddBlob(NmeshSectionType::Bones, -1, std::move(w));
+        }
+        if (!mesh.SkinnedBones.empty())
+        {
+            NmeshBlobWriter w;
+            w.Write<uint32_t>((uint32_t)mesh.SkinnedBones.size());
+            for (const SkinnedBone& bone : mesh.SkinnedBones) {
+                w.Write<int32_t>(bone.BoneIndex);
+                w.Write<int32_t>(bone.ParentIndex);
+                w.WriteStr(bone.Name);
+                WriteBonePose(w, bone.Pose);
+                w.Write(bone.InverseBindPoseTransform);
+            }
+            writer.AddBlob(NmeshSectionType::SkinnedBones, -1, std::move(w));
+        }
+        if (!mesh.AnimationClips.empty())
+        {
+            NmeshBlobWriter w;
+            w.Write<uint32_t>((uint32_t)mesh.AnimationClips.size());
+            for (const AnimationClip& clip : mesh.AnimationClips) {
+                w.WriteStr(clip.Name);
+                w.Write(clip.Duration);
+                w.Write<uint32_t>((uint32_t)clip.Animations.size());
+                for (const BoneAnimation& anim : clip.Animations) {
+                    w.Write<int32_t>(anim.SkinnedBoneIndex);
+                    w.WriteArray(anim.Frames);
+                }
+            }
+            writer.AddBlob(NmeshSectionType::AnimClips, -1, std::move(w));
+        }
+
+        bool compress = opt & Options::Compress;
+        for (int i = 0; i < mesh.NumGroups(); ++i)
+        {
+            const MeshGroup& g = mesh.Groups[i];
+            NmeshBlobWriter info;
+            info.Write<int32_t>(g.GroupId);
+            info.WriteStr(g.Name);
+            info.Write<int32_t>(g.Mat ? int(std::find(materials.begin(), materials.end(), g.Mat.get()) - materials.begin()) : -1);
+            info.Write(g.Offset);
+            info.Write(g.Rotation);
+            info.Write(g.Scale);
+            info.Write<uint8_t>((uint8_t)g.CoordsMapping);
+            info.Write<uint8_t>((uint8_t)g.NormalsMapping);
+            info.Write<uint8_t>((uint8_t)g.ColorMapping);
+            info.Write<uint8_t>((uint8_t)g.BlendMapping);
+            info.Write<uint8_t>((uint8_t)g.Winding);
+            info.Write<uint8_t>((uint8_t)g.System);
+            writer.AddBlob(NmeshSectionType::GroupInfo, i, std::move(info));
+
+            writer.AddArray(NmeshSectionType::Verts,        i, g.Verts,        compress);
+            writer.AddArray(NmeshSectionType::Coords,       i, g.Coords,       compress);
+            writer.AddArray(NmeshSectionType::Normals,      i, g.Normals,      compress);
+            writer.AddArray(NmeshSectionType::Colors,       i, g.Colors,       compress);
+            writer.AddArray(NmeshSectionType::Weights,      i, g.Weights,      compress);
+            writer.AddArray(NmeshSectionType::BlendIndices, i, g.BlendIndices, compress);
+            writer.AddArray(NmeshSectionType::BlendWeights, i, g.BlendWeights, compress);
+            writer.AddArray(NmeshSectionType::Tris,         i, g.Tris,         compress);
+        }
+
+        if (writer.tooManyElements) {
+            NanoErr(opt, "Failed to save '%s': a group has more than INT_MAX elements", meshPath);
+        }
+        writer.Encode(opt & Options::Parallel);
+
+        rpp::file f { meshPath, rpp::file::CREATENEW };
+        if (!f) {
+            NanoErr(opt, "Failed to create file: %s", meshPath);
+        }
+        if (!writer.Write(f, (uint32_t)mesh.Groups.size(), sourceHash)) {
+            NanoErr(opt, "File write failed: %s", meshPath);
+        }
+        return true;
+    }
+
+    bool Mesh::SaveAsNMESH(rpp::strview meshPath, Options opt) const
+    {
+        return WriteNmesh(*this, meshPath, opt, 0);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    using NmeshDecodeJobs = std::vector<std::function<bool()>>;
+
+    // @param decodeJobs Compressed sections are decoded later by these jobs
+    template<class T> static bool ReadArraySection(std::vector<T>& items, const NmeshSection& s, const char* file,
+                                                   NmeshDecodeJobs& decodeJobs)
+    {
+        if (s.ElementSize != sizeof(T) || s.Count > INT_MAX)
+            return false;
+        if (s.Flags & NmeshCompressed)
+        {
+            if (s.Count > s.Size * NmeshMaxExpansion / sizeof(T))
+                return false;
+            items.resize(s.Count);
+            const uint8_t* data = (const uint8_t*)file + s.Offset;
+            decodeJobs.emplace_back([&items, data, size = s.Size] { return DecodeArray(items, data, size); });
+            return true;
+        }
+        if (s.Size != s.Count * sizeof(T))
+            return false;
+        // payloads are 16-byte aligned, so the file data can be read in place
+        const T* begin = (const T*)(file + s.Offset);
+        items.assign(begin, begin + s.Count);
+        return true;
+    }
+
+    // vertexId must be valid, the other layers may also be -1 for unmapped
+    static bool HasValidIndices(const MeshGroup& g) noexcept
+    {
+        auto valid = [](int index, int size) { return index == -1 || (unsigned)index < (unsigned)size; };
+        const unsigned numVerts = (unsigned)g.NumVerts();
+        for (const Triangle& tri : g.Tris)
+        {
+            for (const VertexDescr& vd : tri)
+            {
+                if ((unsigned)vd.v >= numVerts || !valid(vd.t, g.NumCoords()) ||
+                    !valid(vd.n, g.NumNormals()) || !valid(vd.c, g.NumColors()))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    bool ReadNmesh(Mesh& mesh, rpp::strview meshPath, Options opt, uint64_t sourceHash)
+    {
+        mesh.Clear();
+
+        // always mapped, the arrays are copied straight from the page cache
+        FileSource file { meshPath, true };
+        if (!file) {
+            NanoErr(opt, "Failed to open file: %s", meshPath);
+        }
+
+        const uint64_t fileSize = (uint64_t)file.len;
+        NmeshHeader header;
+        if (fileSize < sizeof(header)) {
+            NanoErr(opt, "Not a .nmesh file: %s", meshPath);
+        }
+        memcpy(&header, file.str, sizeof(header));
+        if (memcmp(header.Magic, NmeshMagic, sizeof(NmeshMagic)) != 0 || header.EndianTag != NmeshEndianTag) {
+            NanoErr(opt, "Not a .nmesh file: %s", meshPath);
+        }
+        if (header.VersionMajor != NmeshVersionMajor) {
+            NanoErr(opt, "Unsupported .nmesh version %d.%d: %s",
+                    header.VersionMajor, header.VersionMinor, meshPath);
+        }
+        if (header.FileSize != fileSize || header.SectionTableOffset % 8 != 0 ||
+            header.SectionTableOffset + uint64_t(header.NumSections)*sizeof(NmeshSection) > fileSize ||
+            header.NumGroups > fileSize / sizeof(NmeshSection)) {
+            NanoErr(opt, "Corrupted .nmesh header: %s", meshPath);
+        }
+        if (sourceHash != 0 && header.SourceHash != sourceHash)
+            return false; // derived from a different version of the source
+        if (opt & Options::Log) {
+            LogInfo("Load %-33s  %d groups  %d sections", file_nameext(meshPath),
+                    header.NumGroups, header.NumSections);
+        }
+
+        for (uint32_t i = 0; i < header.NumGroups; ++i)
+            mesh.CreateGroup({});
+
+        std::vector<std::shared_ptr<Material>> materials;
+        NmeshDecodeJobs decodeJobs;
+        const NmeshSection* sections = (const NmeshSection*)(file.str + header.SectionTableOffset);
+        for (uint32_t i = 0; i < header.NumSections; ++i)
+        {
+            const NmeshSection& s = sections[i];
+            if (s.Offset % NmeshAlignment != 0 || s.Offset > fileSize || s.Size > fileSize - s.Offset ||
+                (s.GroupIndex != -1 && (uint32_t)s.GroupIndex >= header.NumGroups) ||
+                (s.Flags & ~uint32_t(NmeshCompressed)) != 0) {
+                NanoErr(opt, "Corrupted .nmesh section %d: %s", (int)i, meshPath);
+            }
+
+            NmeshBlobReader blob { file.str + s.Offset, file.str + s.Offset + s.Size };
+            MeshGroup* g = s.GroupIndex != -1 ? &mesh.Groups[s.GroupIndex] : nullptr;
+            bool ok = true;
+            switch (s.Type)
+            {
+                case NmeshSectionType::MeshInfo:
+                    mesh.Name = blob.ReadStr();
+                    break;
+                case NmeshSectionType::Materials:
+                    materials.resize(blob.ReadCount(sizeof(Material::Alpha)));
+                    for (std::shared_ptr<Material>& mat : materials)
+                        mat = ReadMaterial(blob);
+                    break;
+                case NmeshSectionType::Bones:
+                    mesh.Bones.resize(blob.ReadCount(sizeof(MeshBone::Pose)));
+                    for (MeshBone& bone : mesh.Bones) {
+                        bone.BoneIndex   = blob.Read<int32_t>();
+                        bone.ParentIndex = blob.Read<int32_t>();
+                        bone.Name        = blob.ReadStr();
+                        bone.Pose        = ReadBonePose(blob);
+                        if (!blob.ok) break;
+                    }
+                    break;
+                case NmeshSectionType::SkinnedBones:
+                    mesh.SkinnedBones.resize(blob.ReadCount(sizeof(SkinnedBone::Pose)));
+                    for (SkinnedBone& bone : mesh.SkinnedBones) {
+                        bone.BoneIndex   = blob.Read<int32_t>();
+                        bone.ParentIndex = blob.Read<int32_t>();
+                        bone.Name        = blob.ReadStr();
+                        bone.Pose        = ReadBonePose(blob);
+                        bone.InverseBindPoseTransform = blob.Read<rpp::Matrix4>();
+                        if (!blob.ok) break;
+                    }
+                    break;
+                case NmeshSectionType::AnimClips:
+                    mesh.AnimationClips.resize(blob.ReadCount(sizeof(AnimationClip::Duration)));
+                    for (AnimationClip& clip : mesh.AnimationClips) {
+                        clip.Name     = blob.ReadStr();
+                        clip.Duration = blob.Read<float>();
+                        clip.Animations.resize(blob.ReadCount(sizeof(BoneAnimation::SkinnedBoneIndex)));
+                        for (BoneAnimation& anim : clip.Animations) {
+                            anim.SkinnedBoneIndex = blob.Read<int32_t>();
+                            blob.ReadArray(anim.Frames);
+                            if (!blob.ok) break;
+                        }
+                        if (!blob.ok) break;
+                    }
+                    break;
+                case NmeshSectionType::GroupInfo:
+                    if ((ok = g != nullptr))
+                    {
+                        g->GroupId  = blob.Read<int32_t>();
+                        g->Name     = blob.ReadStr();
+                        int matIndex = blob.Read<int32_t>();
+                        g->Offset   = blob.Read<rpp::Vector3>();
+                        g->Rotation = blob.Read<rpp::Vector3>();
+                        g->Scale    = blob.Read<rpp::Vector3>();
+                        g->CoordsMapping  = (MapMode)blob.Read<uint8_t>();
+                        g->NormalsMapping = (MapMode)blob.Read<uint8_t>();
+                        g->ColorMapping   = (MapMode)blob.Read<uint8_t>();
+                        g->BlendMapping   = (MapMode)blob.Read<uint8_t>();
+                        g->Winding        = (FaceWinding)blob.Read<uint8_t>();
+                        g->System         = (CoordSys)blob.Read<uint8_t>();
+                        // materials are always stored before the groups
+                        if ((unsigned)matIndex < materials.size())
+                            g->Mat = materials[matIndex];
+                    }
+                    break;
+                case NmeshSectionType::Verts:        ok = g && ReadArraySection(g->Verts,        s, file.str, decodeJobs); break;
+                case NmeshSectionType::Coords:       ok = g && ReadArraySection(g->Coords,       s, file.str, decodeJobs); break;
+                case NmeshSectionType::Normals:      ok = g && ReadArraySection(g->Normals,      s, file.str, decodeJobs); break;
+                case NmeshSectionType::Colors:       ok = g && ReadArraySection(g->Colors,       s, file.str, decodeJobs); break;
+                case NmeshSectionType::Weights:      ok = g && ReadArraySection(g->Weights,      s, file.str, decodeJobs); break;
+                case NmeshSectionType::BlendIndices: ok = g && ReadArraySection(g->BlendIndices, s, file.str, decodeJobs); break;
+                case NmeshSectionType::BlendWeights: ok = g && ReadArraySection(g->BlendWeights, s, file.str, decodeJobs); break;
+                case NmeshSectionType::Tris:         ok = g && ReadArraySection(g->Tris,         s, file.str, decodeJobs); break;
+                default: break; // unknown sections from a newer minor version
+            }
+            if (!ok || !blob.ok) {
+                NanoErr(opt, "Corrupted .nmesh section %d: %s", (int)i, meshPath);
+            }
+        }
+
+        // compressed sections are independent, so they can be decoded concurrently
+        int numJobs = (int)decodeJobs.size();
+        std::atomic<bool> decoded { true };
+        ParallelFor(numJobs, (opt & Options::Parallel) ? NumWorkers(numJobs) : 1, [&](int job, int) {
+            if (!decodeJobs[job]())
+                decoded = false;
+        });
+        if (!decoded) {
+            NanoErr(opt, "Corrupted .nmesh compressed section: %s", meshPath);
+        }
+
+        // every later pass indexes the layers without checks, so bad indices must not load
+        for (const MeshGroup& g : mesh.Groups)
+        {
+            if (!HasValidIndices(g)) {
+                NanoErr(opt, "Corrupted .nmesh triangle indices in group %d: %s", g.GroupId, meshPath);
+            }
+        }
+        return true;
+    }
+
+    bool Mesh::LoadNMESH(rpp::strview meshPath, Options opt)
+    {
+        if (!ReadNmesh(*this, meshPath, opt, 0))
+            return false;
+        ApplyLoadOptions(opt);
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,169 @@
+#include <Nano/Mesh.h>
+#include <algorithm>
+#include <cmath>
+#include "InternalConfig.h"
+#include "Parallel.h"
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Work is split into fixed size blocks, independent of the thread count,
+     * and every block is processed in small batches of SoA arrays on the stack.
+     * The batch loops have no dependencies between iterations, so the compiler
+     * vectorizes them for whatever SIMD width the target has.
+     */
+    static constexpr int NormalBlockSize = 64 * 1024;
+    static constexpr int NormalBatchSize = 256;
+
+    static int NumBlocks(int count) noexcept
+    {
+        return (count + NormalBlockSize - 1) / NormalBlockSize;
+    }
+
+    // Face normals of tris [start, end) into SoA arrays fx/fy/fz
+    static void CalculateFaceNormals(const Triangle* tris, const rpp::Vector3* verts, bool ccw,
+                                     int start, int end, float* fx, float* fy, float* fz) noexcept
+    {
+        float e1x[NormalBatchSize], e1y[NormalBatchSize], e1z[NormalBatchSize];
+        float e2x[NormalBatchSize], e2y[NormalBatchSize], e2z[NormalBatchSize];
+        for (int batch = start; batch < end; batch += NormalBatchSize)
+        {
+            const int n = std::min(NormalBatchSize, end - batch);
+            for (int i = 0; i < n; ++i) // gather the triangle edges
+            {
+                const Triangle& tri = tris[batch + i];
+                const rpp::Vector3& v0 = verts[(ccw ? tri.a : tri.c).v];
+                const rpp::Vector3& v1 = verts[tri.b.v];
+                const rpp::Vector3& v2 = verts[(ccw ? tri.c : tri.a).v];
+                e1x[i] = v1.x - v0.x; e1y[i] = v1.y - v0.y; e1z[i] = v1.z - v0.z;
+                e2x[i] = v2.x - v0.x; e2y[i] = v2.y - v0.y; e2z[i] = v2.z - v0.z;
+            }
+            float* outX = fx + batch;
+            float* outY = fy + batch;
+            float* outZ = fz + batch;
+            for (int i = 0; i < n; ++i) // e1.cross(e2)
+            {
+                outX[i] = e1y[i]*e2z[i] - e1z[i]*e2y[i];
+                outY[i] = e1z[i]*e2x[i] - e1x[i]*e2z[i];
+                outZ[i] = e1x[i]*e2y[i] - e1y[i]*e2x[i];
+            }
+        }
+    }
+
+    void MeshGroup::RecalculateNormalsParallel(int numThreads) noexcept
+    {
+        const int numTris    = NumTris();
+        const int numNormals = NumNormals();
+        if (numThreads <= 0)
+            numThreads = GetMaxThreads();
+
+        std::vector<float> fx(numTris), fy(numTris), fz(numTris);
+        const Triangle* tris = Tris.data();
+        const int numTriBlocks = NumBlocks(numTris);
+        ParallelFor(numTriBlocks, std::min(numThreads, numTriBlocks), [&](int block, int)
+        {
+            int start = block * NormalBlockSize;
+            int end = std::min(start + NormalBlockSize, numTris);
+            CalculateFaceNormals(tris, Verts.data(), Winding == FaceWinding::CCW,
+                                 start, end, fx.data(), fy.data(), fz.data());
+        });
+
+        // CSR of normal index -> faces in face order, so every normal gathers its face
+        // normals in the same order as the serial RecalculateNormals() scatter.
+        // Tris are split into contiguous shards which count and scatter their corners
+        // independently, and each shard's faces go after the previous shards' faces.
+        const int numShards = std::max(1, std::min(numThreads, numTriBlocks));
+        const int shardTris = (numTris + numShards - 1) / numShards;
+        std::vector<std::vector<int>> cursors(numShards);
+        ParallelFor(numShards, numShards, [&](int shard, int)
+        {
+            std::vector<int>& counts = cursors[shard];
+            counts.assign(numNormals, 0);
+            for (int faceId = shard * shardTris, end = std::min(faceId + shardTris, numTris); faceId < end; ++faceId)
+                for (const VertexDescr& vd : tris[faceId])
+                {
+                    Assert(vd.n != -1, "Invalid vertex normalId -1");
+                    ++counts[vd.n];
+                }
+        });
+
+        // prefix sum of the counts in normal blocks, turning the counts into scatter cursors
+        const int numNormalBlocks = NumBlocks(numNormals);
+        std::vector<int> blockStart(size_t(numNormalBlocks) + 1, 0);
+        ParallelFor(numNormalBlocks, std::min(numThreads, numNormalBlocks), [&](int block, int)
+        {
+            int total = 0;
+            for (int n = block * NormalBlockSize, end = std::min(n + NormalBlockSize, numNormals); n < end; ++n)
+                for (const std::vector<int>& counts : cursors)
+                    total += counts[n];
+            blockStart[block + 1] = total;
+        });
+        for (int block = 0; block < numNormalBlocks; ++block)
+            blockStart[block + 1] += blockStart[block];
+
+        std::vector<int> offsets(size_t(numNormals) + 1, 0);
+        offsets[numNormals] = blockStart[numNormalBlocks];
+        ParallelFor(numNormalBlocks, std::min(numThreads, numNormalBlocks), [&](int block, int)
+        {
+            int total = blockStart[block];
+            for (int n = block * NormalBlockSize, end = std::min(n + NormalBlockSize, numNormals); n < end; ++n)
+            {
+                offsets[n] = total;
+                for (std::vector<int>& cursor : cursors)
+                {
+                    int count = cursor[n];
+                    cursor[n] = total;
+                    total += count;
+                }
+            }
+        });
+
+        std::vector<int> faces(size_t(numTris) * 3);
+        ParallelFor(numShards, numShards, [&](int shard, int)
+        {
+            std::vector<int>& cursor = cursors[shard];
+            for (int faceId = shard * shardTris, end = std::min(faceId + shardTris, numTris); faceId < end; ++faceId)
+                for (const VertexDescr& vd : tris[faceId])
+                    faces[cursor[vd.n]++] = faceId;
+        });
+
+        rpp::Vector3* normals = Normals.data();
+        ParallelFor(numNormalBlocks, std::min(numThreads, numNormalBlocks), [&](int block, int)
+        {
+            float sx[NormalBatchSize], sy[NormalBatchSize], sz[NormalBatchSize];
+            int blockEnd = std::min((block + 1) * NormalBlockSize, numNormals);
+            for (int batch = block * NormalBlockSize; batch < blockEnd; batch += NormalBatchSize)
+            {
+                const int n = std::min(NormalBatchSize, blockEnd - batch);
+                for (int i = 0; i < n; ++i)
+                {
+                    float x = 0.0f, y = 0.0f, z = 0.0f;
+                    for (int k = offsets[batch + i], end = offsets[batch + i + 1]; k < end; ++k)
+                    {
+                        int faceId = faces[k];
+                        x += fx[faceId]; y += fy[faceId]; z += fz[faceId];
+                    }
+                    sx[i] = x; sy[i] = y; sz[i] = z;
+                }
+                for (int i = 0; i < n; ++i) // normalize, unused normals stay zero
+                {
+                    float len = std::sqrt(sx[i]*sx[i] + sy[i]*sy[i] + sz[i]*sz[i]);
+                    float inv = len > 0.0f ? 1.0f / len : 0.0f;
+                    sx[i] *= inv; sy[i] *= inv; sz[i] *= inv;
+                }
+                for (int i = 0; i < n; ++i)
+                    normals[batch + i] = { sx[i], sy[i], sz[i] };
+            }
+        });
+    }
+
+    void Mesh::RecalculateNormalsParallel(int numThreads) noexcept
+    {
+        for (MeshGroup& group : Groups)
+            group.RecalculateNormalsParallel(numThreads);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -2,9 +2,17 @@
 #include <rpp/file_io.h>
 #include <rpp/sprint.h>
 #include <rpp/timer.h>
+#include <unordered_map>
 #include <unordered_set>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <cstdlib>
 #include "InternalConfig.h"
+#include "FileSource.h"
+#include "NumberScanner.h"
+#include "NumberWriter.h"
+#include "Parallel.h"
 
 namespace Nano
 {
@@ -72,12 +80,40 @@ namespace Nano
         return true;
     }
 
-    static std::vector<std::shared_ptr<Material>> LoadMaterials(rpp::strview matlibFile)
+    // Ka r [g b], if only r is given then g and b are equal to r
+    static rpp::Color3 ParseColor(rpp::strview line)
+    {
+        NumberScanner scanner { line };
+        rpp::Color3 color;
+        color.r = color.g = color.b = scanner.Float();
+        scanner.ParseFloat(color.g);
+        scanner.ParseFloat(color.b);
+        return color;
+    }
+
+    /**
+     * Parsed .mtl file, shared between all loaders that reference it.
+     * Materials are looked up by lowercase name, the first newmtl of a name wins.
+     */
+    struct MaterialLibrary
     {
         std::vector<std::shared_ptr<Material>> materials;
+        std::unordered_map<std::string, std::shared_ptr<Material>> byName;
 
-        if (auto parser = rpp::buffer_line_parser::from_file(matlibFile))
+        std::shared_ptr<Material> Find(rpp::strview matName) const
         {
+            auto it = byName.find(rpp::to_lower(matName));
+            return it != byName.end() ? it->second : nullptr;
+        }
+    };
+
+    static std::vector<std::shared_ptr<Material>> LoadMaterials(rpp::strview matlibFile, Options opt)
+    {
+        std::vector<std::shared_ptr<Material>> materials;
+
+        if (FileSource file { matlibFile, opt & Options::MemoryMap })
+        {
+            rpp::line_parser parser = file.Lines();
             std::string matlibFolder = folder_path(matlibFile);
             Material* mat = nullptr;
             rpp::strview line;
@@ -92,13 +128,13 @@ namespace Nano
                 }
                 else if (mat)
                 {
-                    if      (id == "Ka") mat->AmbientColor  = rpp::Color3::parseColor(line);
-                    else if (id == "Kd") mat->DiffuseColor  = rpp::Color3::parseColor(line);
-                    else if (id == "Ks") mat->SpecularColor = rpp::Color3::parseColor(line);
-                    else if (id == "Ke") mat->EmissiveColor = rpp::Color3::parseColor(line);
-                    else if (id == "Ns") mat->Specular = line.to_float() / 1000.0f; // Ns is [0, 1000], normalize to [0, 1]
-                    else if (id == "d")  mat->Alpha    = line.to_float();
-                    else if (id == "Tr") mat->Alpha    = 1.0f - line.to_float();
+                    if      (id == "Ka") mat->AmbientColor  = ParseColor(line);
+                    else if (id == "Kd") mat->DiffuseColor  = ParseColor(line);
+                    else if (id == "Ks") mat->SpecularColor = ParseColor(line);
+                    else if (id == "Ke") mat->EmissiveColor = ParseColor(line);
+                    else if (id == "Ns") mat->Specular = NumberScanner{line}.Float() / 1000.0f; // Ns is [0, 1000], normalize to [0, 1]
+                    else if (id == "d")  mat->Alpha    = NumberScanner{line}.Float();
+                    else if (id == "Tr") mat->Alpha    = 1.0f - NumberScanner{line}.Float();
                     else if (id == "map_Kd")   mat->DiffusePath  = matlibFolder + line.next(' ');
                     else if (id == "map_d")    mat->AlphaPath    = matlibFolder + line.next(' ');
                     else if (id == "map_Ks")   mat->SpecularPath = matlibFolder + line.next(' ');
@@ -110,18 +146,489 @@ namespace Nano
         return materials;
     }
 
+    /**
+     * Process-wide cache of material libraries, keyed by the full path.
+     * An entry is reloaded if the file modification time or size has changed.
+     */
+    struct MaterialCache
+    {
+        struct Entry
+        {
+            time_t modified;
+            int64_t size;
+            std::shared_ptr<const MaterialLibrary> library;
+        };
+
+        std::mutex mutex;
+        std::unordered_map<std::string, Entry> entries;
+
+        static MaterialCache& Instance()
+        {
+            static MaterialCache cache;
+            return cache;
+        }
+
+        std::shared_ptr<const MaterialLibrary> Load(rpp::strview matlibFile, Options opt)
+        {
+            std::string key = rpp::full_path(matlibFile);
+            if (key.empty()) // file doesn't exist
+                return std::make_shared<MaterialLibrary>();
+
+            time_t modified = rpp::file_modified(key);
+            int64_t size = rpp::file_sizel(key);
+            {
+                std::lock_guard<std::mutex> lock { mutex };
+                auto it = entries.find(key);
+                if (it != entries.end() && it->second.modified == modified && it->second.size == size)
+                    return it->second.library;
+            }
+
+            // parse outside of the lock, so unrelated libraries can load concurrently;
+            // if two threads race on the same file, the last one wins, which is harmless
+            auto library = std::make_shared<MaterialLibrary>();
+            library->materials = LoadMaterials(key, opt);
+            for (const std::shared_ptr<Material>& mat : library->materials)
+                library->byName.emplace(rpp::to_lower(mat->Name), mat);
+
+            std::lock_guard<std::mutex> lock { mutex };
+            entries[key] = Entry{ modified, size, library };
+            return library;
+        }
+
+        void Clear()
+        {
+            std::lock_guard<std::mutex> lock { mutex };
+            entries.clear();
+        }
+    };
+
+    void ClearMaterialCache() noexcept
+    {
+        MaterialCache::Instance().Clear();
+    }
+
     ///////////////////////////////////////////////////////////////////////////////////////////////
 
     static constexpr size_t MaxStackAlloc = 1024 * 1024;
 
+    // Options::Parallel will not split the file into chunks smaller than this
+    static constexpr int MinParallelChunkSize = 256 * 1024;
+
+    // v 1.0 1.0 1.0 [r g b]
+    // @return TRUE if the vertex has a non-black vertex color
+    static bool ParseVertex(rpp::strview line, rpp::Vector3& v, rpp::Vector3& color)
+    {
+        NumberScanner scanner { line };
+        scanner >> v.x >> v.y >> v.z;
+        if (scanner.HasMore())
+        {
+            scanner >> color.x >> color.y >> color.z;
+            return color.sqlength() > 0.001f;
+        }
+        return false;
+    }
+
+    /**
+     * f Vertex1/Texture1/Normal1 Vertex2/Texture2/Normal2 Vertex3/Texture3/Normal3 ...
+     * Polygons are fan-triangulated into one or more faces.
+     * Negative indices are relative to the current vertexId, coordId and normalId.
+     * @param relative [optional] Receives a bitmask of relative indices for each new face,
+     *                 bit (corner*3 + 0) is VertexDescr::v, +1 is t, +2 is n
+     */
+    static void ParseFace(rpp::strview line, std::vector<Triangle>& faces, std::vector<uint16_t>* relative,
+                          int vertexId, int coordId, int normalId)
+    {
+        uint16_t mask = 0;
+        int v, t, n; // as written in the file, 0 if missing
+        auto toDescr = [&](VertexDescr& vd, int corner)
+        {
+            if (v) {
+                vd.v = v - 1;
+                // negative indices, relative to the current maximum vertex position
+                // (-1 references the last vertex defined)
+                if (vd.v < 0) { vd.v = vertexId + vd.v + 1; mask |= 1 << (corner*3 + 0); }
+            }
+            if (t) {
+                vd.t = t - 1;
+                if (vd.t < 0) { vd.t = coordId + vd.t + 1; mask |= 1 << (corner*3 + 1); }
+            }
+            if (n) {
+                vd.n = n - 1;
+                if (vd.n < 0) { vd.n = normalId + vd.n + 1; mask |= 1 << (corner*3 + 2); }
+            }
+        };
+
+        NumberScanner scanner { line };
+
+        // parse triangle
+        Triangle* f = &rpp::emplace_back(faces);
+        for (int corner = 0; corner < 3; ++corner)
+            if (scanner.FaceVertex(v, t, n))
+                toDescr((*f)[corner], corner);
+        if (relative) relative->push_back(mask);
+
+        // when encountering quads or large polygons, we need to triangulate the mesh
+        // by tracking the first vertex descr and forming a fan; this requires convex polys
+        while (scanner.FaceVertex(v, t, n))
+        {
+            // @note According to OBJ spec, face vertices are in CCW order:
+            // 0--3
+            // |\ |
+            // | \|
+            // 1--2
+
+            // v[0], v[2], v[3]
+            VertexDescr vd0 = f->a; // by value, because emplace_back may realloc
+            VertexDescr vd2 = f->c;
+            f = &rpp::emplace_back(faces);
+            f->a = vd0;
+            f->b = vd2;
+            mask = uint16_t((mask & 0b111) | ((mask >> 6) & 0b111) << 3); // a=a, b=c
+            toDescr(f->c, 2);
+            if (relative) relative->push_back(mask);
+        }
+    }
+
+    // Offsets the relative indices of a face that was parsed with chunk-local element counts
+    static void AddRelativeBase(Triangle& face, uint16_t mask, int vertexBase, int coordBase, int normalBase)
+    {
+        for (int corner = 0; corner < 3; ++corner, mask >>= 3)
+        {
+            VertexDescr& vd = face[corner];
+            if (mask & 1) vd.v += vertexBase;
+            if (mask & 2) vd.t += coordBase;
+            if (mask & 4) vd.n += normalBase;
+        }
+    }
+
+    /**
+     * Dispatches OBJ statements line by line to a Sink.
+     * This is shared by the serial loader and the parallel chunk parser,
+     * so both interpret every line in exactly the same way.
+     */
+    template<class Sink> static void ParseObjLines(rpp::line_parser lines, Sink& sink)
+    {
+        rpp::strview line;
+        while (lines.read_line(line)) // for each line
+        {
+            // memory mapped files are not NUL terminated, so nothing may be read past line.len
+            // every statement has at least a keyword and a separator
+            if (line.len < 2)
+                continue;
+
+            char c = line[0];
+            if (c == 'v')
+            {
+                c = line[1];
+                if (c == ' ') { // v 1.0 1.0 1.0
+                    line.skip(2); // skip 'v '
+                    sink.OnVertex(line);
+                }
+                else if (c == 'n' && line.len >= 3) { // vn 1.0 1.0 1.0
+                    line.skip(3); // skip 'vn '
+                    sink.OnNormal(line);
+                }
+                else if (c == 't' && line.len >= 3) { // vt 1.0 1.0
+                    line.skip(3); // skip 'vt '
+                    sink.OnCoord(line);
+                }
+            }
+            else if (c == 'f')
+            {
+                line.skip(2); // skip 'f '
+                sink.OnFace(line);
+            }
+            //else if (c == 's')
+            //{
+            //    line.skip(2); // skip "s "
+            //    line >> group->SmoothingGroup;
+            //}
+            else if (c == 'u' && line.len >= 7 && memcmp(line.str, "usemtl", 6) == 0)
+            {
+                line.skip(7); // skip "usemtl "
+                sink.OnUseMtl(line.next(' '));
+            }
+            else if (c == 'm' && line.len >= 7 && memcmp(line.str, "mtllib", 6) == 0)
+            {
+                line.skip(7); // skip "mtllib "
+                sink.OnMtlLib(line.next(' '));
+            }
+            else if (c == 'g')
+            {
+                line.skip(2); // skip "g "
+                sink.OnGroup(line.next(' '));
+            }
+            else if (c == 'o')
+            {
+                line.skip(2); // skip "o "
+                sink.OnObject(line.next(' '));
+            }
+        }
+    }
+
+    /**
+     * Mesh data parsed from one newline-aligned chunk of an OBJ file.
+     * All relative indices are chunk-local until the chunks are stitched together.
+     */
+    struct ObjChunk
+    {
+        // g/usemtl/mtllib/o statements and runs of faces, in file order
+        struct Command
+        {
+            enum Type { Faces, Group, UseMtl, MtlLib, Object } type;
+            rpp::strview arg;
+            int facesEnd; // end of the Faces run
+        };
+
+        rpp::strview text;
+        std::vector<rpp::Vector3> verts;
+        std::vector<rpp::Vector2> coords;
+        std::vector<rpp::Vector3> normals;
+        std::vector<rpp::Color3>  colors; // empty if this chunk has no vertex colors
+        std::vector<Triangle> faces;
+        std::vector<uint16_t> relative; // relative index mask for each face
+        std::vector<Command> commands;
+        size_t numFaceLines = 0;
+
+        // global element counts preceding this chunk
+        int vertexBase = 0, coordBase = 0, normalBase = 0;
+
+        // clears all parsed data, but keeps the capacity for the next file
+        void Reset(rpp::strview chunkText)
+        {
+            text = chunkText;
+            verts.clear(); coords.clear(); normals.clear(); colors.clear();
+            faces.clear(); relative.clear(); commands.clear();
+            numFaceLines = 0;
+            vertexBase = coordBase = normalBase = 0;
+        }
+
+        void OnVertex(rpp::strview line)
+        {
+            rpp::Vector3& v = rpp::emplace_back(verts);
+            rpp::Vector3 col;
+            if (ParseVertex(line, v, col))
+            {
+                colors.resize(verts.size(), rpp::Color3::Zero());
+                colors.back() = col;
+            }
+            else if (!colors.empty())
+            {
+                colors.push_back(rpp::Color3::Zero());
+            }
+        }
+        void OnNormal(rpp::strview line)
+        {
+            rpp::Vector3& n = rpp::emplace_back(normals);
+            NumberScanner{line} >> n.x >> n.y >> n.z;
+        }
+        void OnCoord(rpp::strview line)
+        {
+            rpp::Vector2& uv = rpp::emplace_back(coords);
+            NumberScanner{line} >> uv.x >> uv.y;
+        }
+        void OnFace(rpp::strview line)
+        {
+            ++numFaceLines;
+            ParseFace(line, faces, &relative, (int)verts.size(), (int)coords.size(), (int)normals.size());
+            if (commands.empty() || commands.back().type != Command::Faces)
+                commands.push_back({ Command::Faces, {}, 0 });
+            commands.back().facesEnd = (int)faces.size();
+        }
+        void OnUseMtl(rpp::strview name)  { commands.push_back({ Command::UseMtl, name, 0 }); }
+        void OnMtlLib(rpp::strview path)  { commands.push_back({ Command::MtlLib, path, 0 }); }
+        void OnGroup(rpp::strview name)   { commands.push_back({ Command::Group,  name, 0 }); }
+        void OnObject(rpp::strview name)  { commands.push_back({ Command::Object, name, 0 }); }
+    };
+
+    /**
+     * Dense global -> group-local index remap table.
+     * Local indices are assigned in first-use order and only the touched
+     * entries are reset, so one table is reused for all groups in O(corners).
+     */
+    struct IndexRemap
+    {
+        std::vector<int> localIds;  // global id -> local id, -1 if unused in this group
+        std::vector<int> globalIds; // global ids in first-use order
+        size_t count = 0; // number of global elements, localIds can be bigger if it's reused
+
+        void Resize(size_t numElements)
+        {
+            count = numElements;
+            if (localIds.size() < count)
+                localIds.resize(count, -1);
+        }
+
+        // @return New index
+        int Map(int globalId)
+        {
+            if (count == 0)
+                return globalId;
+            if ((unsigned)globalId >= count) // invalid index, clamp it
+                globalId = globalId < 0 ? 0 : int(count) - 1;
+            int& localId = localIds[globalId];
+            if (localId == -1)
+            {
+                localId = (int)globalIds.size();
+                globalIds.push_back(globalId);
+            }
+            return localId;
+        }
+
+        void Reset()
+        {
+            for (int globalId : globalIds)
+                localIds[globalId] = -1;
+            globalIds.clear();
+        }
+    };
+
+    // scratch tables for building one group at a time, one per worker
+    struct GroupRemap
+    {
+        IndexRemap verts, coords, normals;
+
+        // grows the tables to the current global element counts
+        void Resize(size_t numVerts, size_t numCoords, size_t numNormals)
+        {
+            verts.Resize(numVerts);
+            coords.Resize(numCoords);
+            normals.Resize(numNormals);
+        }
+    };
+
+    // unfortunately, Blender does not export verts in linear order,
+    // so every group is compacted to the elements it uses, in first-use order
+    // @param colors [optional] Per-vertex colors
+    static void RemapGroupElements(MeshGroup& g, GroupRemap& remap, const rpp::Vector3* verts,
+                                   const rpp::Vector2* coords, const rpp::Vector3* normals,
+                                   const rpp::Color3* colors)
+    {
+        for (Triangle& face : g.Tris)
+        {
+            for (VertexDescr& vd : face)
+            {
+                vd.v = remap.verts.Map(vd.v);
+                if (vd.t != -1) vd.t = remap.coords.Map(vd.t);
+                if (vd.n != -1) vd.n = remap.normals.Map(vd.n);
+                if (colors) vd.c = vd.v;
+            }
+        }
+
+        auto copyElements = [](auto& dst, auto* src, const IndexRemap& remap) {
+            dst.resize(remap.globalIds.size());
+            auto* out = dst.data();
+            for (int index : remap.globalIds)
+                *out++ = src[index];
+        };
+        copyElements(g.Verts, verts, remap.verts);
+        copyElements(g.Coords, coords, remap.coords);
+        copyElements(g.Normals, normals, remap.normals);
+        if (colors) {
+            // OBJ colors use per-vertex mapping
+            copyElements(g.Colors, colors, remap.verts);
+            g.ColorMapping = MapMode::PerVertex;
+        }
+
+        remap.verts.Reset();
+        remap.coords.Reset();
+        remap.normals.Reset();
+    }
+
+    static void SetGroupMappings(MeshGroup& g)
+    {
+        int numVerts   = g.NumVerts();
+        int numNormals = g.NumNormals();
+        int numCoords  = g.NumCoords();
+        int numTris    = g.NumTris();
+
+        if      (numNormals <= 0)        g.NormalsMapping = MapMode::None;
+        else if (numNormals == numVerts) g.NormalsMapping = MapMode::PerVertex;
+        else if (numNormals == numTris)  g.NormalsMapping = MapMode::PerFace;
+        else if (numNormals >  numVerts) g.NormalsMapping = MapMode::PerFaceVertex;
+        else                             g.NormalsMapping = MapMode::SharedElements;
+        if      (numCoords == 0)         g.CoordsMapping  = MapMode::None;
+        else if (numCoords == numVerts)  g.CoordsMapping  = MapMode::PerVertex;
+        else if (numCoords >  numVerts)  g.CoordsMapping  = MapMode::PerFaceVertex;
+        else Assert(false, "Unfamiliar CoordsMapping mode");
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    struct MeshLoadContext::Impl
+    {
+        std::vector<char> readBuffer; // file contents, if not memory mapped
+        void* megaBuffer = nullptr;
+        size_t megaBufferSize = 0;
+        std::vector<ObjChunk> chunks;
+        std::vector<GroupRemap> remaps;
+        std::vector<MeshGroup> spareGroups; // recycled groups of the previous Mesh
+
+        ~Impl() { free(megaBuffer); }
+
+        void* ReserveMegaBuffer(size_t size)
+        {
+            if (megaBufferSize < size)
+                AdoptMegaBuffer(malloc(size), size);
+            return megaBuffer;
+        }
+
+        // takes ownership of a bigger malloc-ed megaBuffer
+        void AdoptMegaBuffer(void* buffer, size_t size)
+        {
+            free(megaBuffer);
+            megaBuffer = buffer;
+            megaBufferSize = size;
+        }
+
+        void RecycleGroups(Mesh& mesh)
+        {
+            for (MeshGroup& g : mesh.Groups)
+                spareGroups.emplace_back(std::move(g));
+            mesh.Groups.clear();
+        }
+    };
+
+    MeshLoadContext::MeshLoadContext() : impl{ std::make_unique<Impl>() } {}
+    MeshLoadContext::~MeshLoadContext() = default;
+    MeshLoadContext::MeshLoadContext(MeshLoadContext&&) noexcept = default;
+    MeshLoadContext& MeshLoadContext::operator=(MeshLoadContext&&) noexcept = default;
+
+    void MeshLoadContext::Release() noexcept
+    {
+        impl = std::make_unique<Impl>();
+    }
+
+    size_t MeshLoadContext::CapacityBytes() const noexcept
+    {
+        if (!impl)
+            return 0;
+        auto bytes = [](const auto& v) { return v.capacity() * sizeof(v[0]); };
+        size_t total = bytes(impl->readBuffer) + impl->megaBufferSize;
+        for (const ObjChunk& c : impl->chunks)
+            total += sizeof(c) + bytes(c.verts) + bytes(c.coords) + bytes(c.normals) + bytes(c.colors)
+                   + bytes(c.faces) + bytes(c.relative) + bytes(c.commands);
+        for (const GroupRemap& r : impl->remaps)
+            total += bytes(r.verts.localIds)   + bytes(r.verts.globalIds)
+                   + bytes(r.coords.localIds)  + bytes(r.coords.globalIds)
+                   + bytes(r.normals.localIds) + bytes(r.normals.globalIds);
+        for (const MeshGroup& g : impl->spareGroups)
+            total += sizeof(g) + g.Name.capacity() + bytes(g.Verts) + bytes(g.Coords)
+                   + bytes(g.Normals) + bytes(g.Colors) + bytes(g.Tris);
+        return total;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
     struct ObjLoader
     {
         Mesh& mesh;
         rpp::strview meshPath;
         Options options;
-        rpp::buffer_line_parser parser;
+        MeshLoadContext::Impl* ctx; // optional
+        FileSource buffer;
         size_t numVerts = 0, numCoords = 0, numNormals = 0, numColors = 0, numFaces = 0;
-        std::vector<std::shared_ptr<Material>> materials;
+        std::shared_ptr<const MaterialLibrary> matlib;
         MeshGroup* group = nullptr;
         bool triedDefaultMat = false;
 
@@ -130,50 +637,93 @@ namespace Nano
         rpp::Vector3* normalsData = nullptr;
         rpp::Color3*  colorsData  = nullptr;
 
+        int vertexId = 0, coordId = 0, normalId = 0, colorId = 0;
+
+        // megaBuffer element capacities, these are estimates until parsing has finished
+        size_t maxVerts = 0, maxCoords = 0, maxNormals = 0;
+
         void* dataBuffer = nullptr;
         size_t bufferSize = 0;
+        bool heapBuffer = false; // if TRUE, dataBuffer was malloc-ed
 
-        explicit ObjLoader(Mesh& mesh, rpp::strview meshPath, Options options)
-            : mesh{ mesh }, meshPath{ meshPath }, options{ options }, 
-              parser{ rpp::buffer_line_parser::from_file(meshPath) }
+        explicit ObjLoader(Mesh& mesh, rpp::strview meshPath, Options options, MeshLoadContext::Impl* ctx)
+            : mesh{ mesh }, meshPath{ meshPath }, options{ options }, ctx{ ctx },
+              buffer{ meshPath, options & Options::MemoryMap, ctx ? &ctx->readBuffer : nullptr }
         {
         }
 
         ~ObjLoader()
         {
-            if (bufferSize > MaxStackAlloc) free(dataBuffer);
+            if (heapBuffer) free(dataBuffer);
         }
 
-        bool ProbeStats()
+        /**
+         * Estimates megaBuffer capacities without reading the whole file twice.
+         * Small files are counted exactly, larger files are sampled at evenly spaced
+         * windows and the element counts are extrapolated from the file size.
+         * If the estimate is too low, the megaBuffer is grown while parsing.
+         */
+        void EstimateCapacity()
         {
-            rpp::strview line;
-            while (parser.read_line(line))
+            constexpr int NumSamples = 16;
+            constexpr int SampleSize = 4096;
+            size_t sampledBytes = 0, sampledVerts = 0, sampledCoords = 0, sampledNormals = 0;
+
+            auto countLines = [&](const char* start, const char* end)
             {
-                char c = line[0];
-                if (c == 'v') switch (line[1])
+                sampledBytes += size_t(end - start);
+                rpp::line_parser parser { start, int(end - start) };
+                rpp::strview line;
+                while (parser.read_line(line))
                 {
-                    case ' ': ++numVerts;   break;
-                    case 'n': ++numNormals; break;
-                    case 't': ++numCoords;  break;
-                    default:;
+                    if (line.len >= 2 && line[0] == 'v') switch (line[1])
+                    {
+                        case ' ': ++sampledVerts;   break;
+                        case 'n': ++sampledNormals; break;
+                        case 't': ++sampledCoords;  break;
+                        default:;
+                    }
                 }
-                else if (c == 'f' && line[1] == ' ')
+            };
+
+            const char* data = buffer.str;
+            const size_t size = buffer.len;
+            if (size <= NumSamples*SampleSize)
+            {
+                countLines(data, data + size);
+                maxVerts   = sampledVerts;
+                maxCoords  = sampledCoords;
+                maxNormals = sampledNormals;
+                return;
+            }
+
+            for (int i = 0; i < NumSamples; ++i)
+            {
+                const char* start = data + (size - SampleSize) * i / (NumSamples - 1);
+                const char* end   = start + SampleSize;
+                if (i > 0) // align to the next full line
                 {
-                    ++numFaces;
+                    const char* eol = (const char*)memchr(start, '\n', end - start);
+                    if (!eol) continue;
+                    start = eol + 1;
                 }
+                countLines(start, end);
             }
 
-            parser.reset();
-            if (numVerts == 0) {
-                NanoErr(options, "Mesh::LoadOBJ() failed: No vertices in %s\n", meshPath);
-            }
+            // extrapolate with 5% slack, so we rarely need to grow
+            double scale = (double(size) / sampledBytes) * 1.05;
+            maxVerts   = size_t(sampledVerts   * scale) + 64;
+            maxCoords  = size_t(sampledCoords  * scale) + 64;
+            maxNormals = size_t(sampledNormals * scale) + 64;
+        }
 
+        void CalculateBufferSize()
+        {
             // megaBuffer strategy - one big allocation instead of a dozen small ones
-            bufferSize = numVerts    * sizeof(rpp::Vector3)
-                        + numCoords  * sizeof(rpp::Vector2)
-                        + numNormals * sizeof(rpp::Vector3)
-                        + numVerts   * sizeof(rpp::Color3);
-            return true;
+            bufferSize = maxVerts    * sizeof(rpp::Vector3)
+                        + maxCoords  * sizeof(rpp::Vector2)
+                        + maxNormals * sizeof(rpp::Vector3)
+                        + maxVerts   * sizeof(rpp::Color3);
         }
 
         struct pool_helper {
@@ -185,227 +735,286 @@ namespace Nano
             }
         };
 
-        void InitPointers(void* allocated)
+        void InitPointers(void* allocated, bool onHeap)
         {
             dataBuffer = allocated;
+            heapBuffer = onHeap;
             pool_helper pool = { allocated };
-            vertsData   = pool.next<rpp::Vector3>(numVerts);
-            coordsData  = pool.next<rpp::Vector2>(numCoords);
-            normalsData = pool.next<rpp::Vector3>(numNormals);
-            colorsData  = pool.next<rpp::Color3>(numVerts);
+            vertsData   = pool.next<rpp::Vector3>(maxVerts);
+            coordsData  = pool.next<rpp::Vector2>(maxCoords);
+            normalsData = pool.next<rpp::Vector3>(maxNormals);
+            colorsData  = pool.next<rpp::Color3>(maxVerts);
+        }
+
+        // capacity estimate was too low, so move all elements into a bigger megaBuffer
+        void GrowBuffer(size_t& capacity)
+        {
+            void* oldBuffer = dataBuffer;
+            bool oldOnHeap = heapBuffer;
+            rpp::Vector3* oldVerts   = vertsData;
+            rpp::Vector2* oldCoords  = coordsData;
+            rpp::Vector3* oldNormals = normalsData;
+            rpp::Color3*  oldColors  = colorsData;
+
+            capacity += capacity / 2 + 1024;
+            CalculateBufferSize();
+            InitPointers(malloc(bufferSize), true);
+
+            memcpy(vertsData,   oldVerts,   vertexId * sizeof(rpp::Vector3));
+            memcpy(coordsData,  oldCoords,  coordId  * sizeof(rpp::Vector2));
+            memcpy(normalsData, oldNormals, normalId * sizeof(rpp::Vector3));
+            if (colorId > 0) {
+                memcpy(colorsData, oldColors, vertexId * sizeof(rpp::Color3));
+                memset(colorsData + vertexId, 0, (maxVerts - vertexId) * sizeof(rpp::Color3));
+            }
+
+            if (oldOnHeap) free(oldBuffer);
+            if (ctx) // the context keeps the bigger buffer for the next load
+            {
+                ctx->AdoptMegaBuffer(dataBuffer, bufferSize);
+                heapBuffer = false;
+            }
         }
 
         std::shared_ptr<Material> FindMat(rpp::strview matName)
         {
-            if (materials.empty() && !triedDefaultMat) {
+            if ((!matlib || matlib->materials.empty()) && !triedDefaultMat) {
                 triedDefaultMat = true;
                 std::string defaultMat = file_replace_ext(meshPath, "mtl");
-                materials = LoadMaterials(defaultMat);
+                matlib = MaterialCache::Instance().Load(defaultMat, options);
             }
-            for (auto& mat : materials)
-                if (matName.equalsi(mat->Name))
-                    return mat;
-            return {};
+            return matlib ? matlib->Find(matName) : nullptr;
         }
 
-        MeshGroup* CurrentGroup()
+        MeshGroup& CreateGroup(rpp::strview name)
         {
-            return group ? group : (group = &mesh.CreateGroup({}));
+            if (!ctx || ctx->spareGroups.empty())
+                return mesh.CreateGroup(name);
+
+            // recycle the vectors of a previously loaded group
+            MeshGroup& g = rpp::emplace_back(mesh.Groups, std::move(ctx->spareGroups.back()));
+            ctx->spareGroups.pop_back();
+            g.Clear();
+            g.GroupId = (int)mesh.Groups.size() - 1;
+            g.Name.assign(name.str, name.len);
+            g.Mat.reset();
+            g.Offset   = rpp::Vector3::Zero();
+            g.Rotation = rpp::Vector3::Zero();
+            g.Scale    = rpp::Vector3::One();
+            g.Winding  = FaceWinding::CW;
+            g.System   = CoordSys::GL;
+            return g;
         }
 
-        void ParseMeshData()
+        MeshGroup* CurrentGroup()
         {
-            int vertexId = 0, coordId = 0, normalId = 0, colorId = 0;
+            return group ? group : (group = &CreateGroup({}));
+        }
 
-            rpp::strview line;
-            while (parser.read_line(line)) // for each line
+        void OnVertex(rpp::strview line)
+        {
+            if (vertexId == (int)maxVerts) GrowBuffer(maxVerts);
+            rpp::Vector3 col;
+            if (ParseVertex(line, vertsData[vertexId], col))
             {
-                char c = line[0];
-                if (c == 'v')
-                {
-                    c = line[1];
-                    if (c == ' ') { // v 1.0 1.0 1.0
-                        line.skip(2); // skip 'v '
-                        rpp::Vector3& v = vertsData[vertexId];
-                        line >> v.x >> v.y >> v.z;
-
-                        if (!line.empty())
-                        {
-                            rpp::Vector3 col;
-                            line >> col.x >> col.y >> col.z;
-                            if (col.sqlength() > 0.001f)
-                            {
-                                // for OBJ we always use Per-Vertex color mapping...
-                                // there is simply no other standardised way to do it
-                                if (colorId == 0) {
-                                    memset(colorsData, 0, numVerts*sizeof(rpp::Color3));
-                                    numColors = numVerts;
-                                }
-                                ++colorId;
-                                colorsData[vertexId] = col;
-                            }
-                        }
-                        ++vertexId;
-                        continue;
-                    }
-                    if (c == 'n') { // vn 1.0 1.0 1.0
-                        line.skip(3); // skip 'vn '
-                        rpp::Vector3& n = normalsData[normalId++];
-                        line >> n.x >> n.y >> n.z;
-                        // Use this if exporting for Direct3D
-                        //n.z = -n.z; // invert Z to convert to lhs coordinates
-                        continue;
-                    }
-                    if (c == 't') { // vt 1.0 1.0
-                        line.skip(3); // skip 'vt '
-                        rpp::Vector2& uv = coordsData[coordId++];
-                        line >> uv.x >> uv.y;
-                        //if (fmt == TXC_Direct3DTexCoords) // Use this if exporting for Direct3D
-                        //    c.y = 1.0f - c.y; // invert the V coord to convert to lhs coordinates
-                        continue;
-                    }
+                // for OBJ we always use Per-Vertex color mapping...
+                // there is simply no other standardised way to do it
+                if (colorId == 0) {
+                    memset(colorsData, 0, maxVerts*sizeof(rpp::Color3));
                 }
-                else if (c == 'f')
-                {
-                    // f Vertex1/Texture1/Normal1 Vertex2/Texture2/Normal2 Vertex3/Texture3/Normal3
-                    auto& faces = CurrentGroup()->Tris;
-                    Triangle* f = &rpp::emplace_back(faces);
+                ++colorId;
+                colorsData[vertexId] = col;
+            }
+            ++vertexId;
+        }
 
-                    // load the face indices
-                    line.skip(2); // skip 'f '
-                    line.trim_start(' ');
+        void OnNormal(rpp::strview line)
+        {
+            if (normalId == (int)maxNormals) GrowBuffer(maxNormals);
+            rpp::Vector3& n = normalsData[normalId++];
+            NumberScanner{line} >> n.x >> n.y >> n.z;
+            // Use this if exporting for Direct3D
+            //n.z = -n.z; // invert Z to convert to lhs coordinates
+        }
 
-                    auto parseDescr = [&](VertexDescr& vd, rpp::strview vertdescr)
-                    {
-                        if (rpp::strview v = vertdescr.next('/')) {
-                            vd.v = v.to_int() - 1;
-                            // negative indices, relative to the current maximum vertex position
-                            // (-1 references the last vertex defined)
-                            if (vd.v < 0) vd.v = vertexId + vd.v + 1; 
-                        }
-                        if (rpp::strview t = vertdescr.next('/')) {
-                            vd.t = t.to_int() - 1;
-                            if (vd.t < 0) vd.t = coordId + vd.t + 1;
-                        }
-                        if (rpp::strview n = vertdescr) {
-                            vd.n = n.to_int() - 1;
-                            if (vd.n < 0) vd.n = normalId + vd.n + 1;
-                        }
-                    };
+        void OnCoord(rpp::strview line)
+        {
+            if (coordId == (int)maxCoords) GrowBuffer(maxCoords);
+            rpp::Vector2& uv = coordsData[coordId++];
+            NumberScanner{line} >> uv.x >> uv.y;
+            //if (fmt == TXC_Direct3DTexCoords) // Use this if exporting for Direct3D
+            //    c.y = 1.0f - c.y; // invert the V coord to convert to lhs coordinates
+        }
 
-                    // parse triangle
-                    parseDescr(f->a, line.next(' '));
-                    parseDescr(f->b, line.next(' '));
-                    parseDescr(f->c, line.next(' '));
+        void OnFace(rpp::strview line)
+        {
+            ++numFaces;
+            ParseFace(line, CurrentGroup()->Tris, nullptr, vertexId, coordId, normalId);
+        }
 
-                    // when encountering quads or large polygons, we need to triangulate the mesh
-                    // by tracking the first vertex descr and forming a fan; this requires convex polys
-                    while (rpp::strview vertdescr = line.next(' '))
-                    {
-                        // @note According to OBJ spec, face vertices are in CCW order:
-                        // 0--3
-                        // |\ |
-                        // | \|
-                        // 1--2
-
-                        // v[0], v[2], v[3]
-                        VertexDescr vd0 = f->a; // by value, because emplace_back may realloc
-                        VertexDescr vd2 = f->c;
-                        f = &rpp::emplace_back(faces);
-                        f->a = vd0;
-                        f->b = vd2;
-                        parseDescr(f->c, vertdescr);
-                    }
-                }
-                //else if (c == 's')
-                //{
-                //    line.skip(2); // skip "s "
-                //    line >> group->SmoothingGroup;
-                //}
-                else if (c == 'u' && memcmp(line.str, "usemtl", 6) == 0)
-                {
-                    line.skip(7); // skip "usemtl "
-                    rpp::strview matName = line.next(' ');
-                    CurrentGroup()->Mat = FindMat(matName);
-                }
-                else if (c == 'm' && memcmp(line.str, "mtllib", 6) == 0)
-                {
-                    line.skip(7); // skip "mtllib "
-                    rpp::strview matlib = line.next(' ');
-                    std::string matlibPath = path_combine(folder_path(meshPath), matlib);
-                    materials = LoadMaterials(matlibPath);
-                }
-                else if (c == 'g')
-                {
-                    line.skip(2); // skip "g "
-                    bool ignoreGroup = (options & Options::SingleGroup) && group;
-                    if (!ignoreGroup)
-                    {
-                        group = &mesh.FindOrCreateGroup(line.next(' '));
-                    }
-                }
-                else if (c == 'o')
-                {
-                    line.skip(2); // skip "o "
-                    mesh.Name = (std::string)line.next(' ');
-                }
+        void OnUseMtl(rpp::strview matName)
+        {
+            CurrentGroup()->Mat = FindMat(matName);
+        }
+
+        void OnMtlLib(rpp::strview matlibFile)
+        {
+            std::string matlibPath = path_combine(folder_path(meshPath), matlibFile);
+            matlib = MaterialCache::Instance().Load(matlibPath, options);
+        }
+
+        void OnGroup(rpp::strview name)
+        {
+            bool ignoreGroup = (options & Options::SingleGroup) && group;
+            if (!ignoreGroup)
+            {
+                MeshGroup* existing = mesh.FindGroup(name);
+                group = existing ? existing : &CreateGroup(name);
             }
         }
 
-        void RemoveEmptyGroups() const
+        void OnObject(rpp::strview name)
         {
-            for (auto it = mesh.Groups.begin(); it != mesh.Groups.end();)
-                if (it->IsEmpty()) it = mesh.Groups.erase(it); else ++it;
+            mesh.Name = (std::string)name;
         }
 
-        // unfortunately, Blender does not export verts in linear order
-        // @return New index
-        static int GetNewIndex(std::vector<int>& orderedUniqueIds, int oldIndex)
+        void ParseMeshData()
         {
-            int* data = orderedUniqueIds.data();
-            int size = (int)orderedUniqueIds.size();
-            for (int newIndex = 0; newIndex < size; ++newIndex)
-                if (data[newIndex] == oldIndex)
-                    return newIndex;
-            orderedUniqueIds.push_back(oldIndex);
-            return size;
+            // rpp::line_parser is int based, so files over 2GB are parsed in windows
+            size_t offset = 0;
+            rpp::strview window;
+            while (buffer.NextWindow(offset, window))
+                ParseObjLines(rpp::line_parser{ window }, *this);
+            numVerts   = vertexId;
+            numCoords  = coordId;
+            numNormals = normalId;
+            if (colorId > 0)
+                numColors = numVerts;
         }
 
-        void SlowBlenderHack(MeshGroup& g) const
+        // splits the file into newline-aligned chunks, one or more per worker
+        void SplitChunks(std::vector<ObjChunk>& chunks) const
         {
-            const bool vertexColors = numColors > 0;
+            size_t numWorkers = GetMaxThreads();
+            size_t chunkSize = buffer.len / (numWorkers * 4);
+            if (chunkSize < MinParallelChunkSize)
+                chunkSize = MinParallelChunkSize;
+            if (chunkSize > FileSource::MaxWindowSize) // + the rest of the last line still fits rpp::strview
+                chunkSize = FileSource::MaxWindowSize;
+
+            size_t numChunks = 0;
+            const char* end = buffer.str + buffer.len;
+            for (const char* start = buffer.str; start < end;)
+            {
+                const char* split = start + chunkSize;
+                if (split >= end)
+                    split = end;
+                else if (const char* eol = (const char*)memchr(split, '\n', end - split))
+                    split = eol + 1;
+                else
+                    split = end;
+                if (numChunks == chunks.size())
+                    chunks.emplace_back();
+                chunks[numChunks++].Reset(rpp::strview{ start, split });
+                start = split;
+            }
+            chunks.resize(numChunks);
+        }
 
-            std::vector<int> uniqueVerts, uniqueCoords, uniqueNormals;
-            uniqueVerts.reserve(g.Tris.size() * 3);
-            if (g.Tris.front().a.t != -1) uniqueCoords.reserve(uniqueVerts.size());
-            if (g.Tris.front().a.n != -1) uniqueNormals.reserve(uniqueVerts.size());
+        /**
+         * Parses newline-aligned chunks of the file on worker threads,
+         * then stitches the chunks together in file order.
+         * Element counts are prefix-summed over the chunks to resolve relative indices
+         * and the g/usemtl/mtllib/o statements are replayed serially,
+         * so the result is identical to ParseMeshData()
+         */
+        void ParseMeshDataParallel(std::vector<ObjChunk>& chunks)
+        {
+            ParallelFor((int)chunks.size(), [&](int i) {
+                ParseObjLines(rpp::line_parser{ chunks[i].text }, chunks[i]);
+            });
 
-            for (Triangle& face : g.Tris)
+            bool vertexColors = false;
+            for (ObjChunk& chunk : chunks)
             {
-                for (VertexDescr& vd : face)
-                {
-                    vd.v = GetNewIndex(uniqueVerts, vd.v);
-                    if (vd.t != -1) vd.t = GetNewIndex(uniqueCoords, vd.t);
-                    if (vd.n != -1) vd.n = GetNewIndex(uniqueNormals, vd.n);
-                    if (vertexColors) vd.c = vd.v;
-                }
+                chunk.vertexBase = (int)numVerts;
+                chunk.coordBase  = (int)numCoords;
+                chunk.normalBase = (int)numNormals;
+                numVerts   += chunk.verts.size();
+                numCoords  += chunk.coords.size();
+                numNormals += chunk.normals.size();
+                numFaces   += chunk.numFaceLines;
+                vertexColors |= !chunk.colors.empty();
             }
+            if (vertexColors)
+                numColors = numVerts;
+
+            // exact capacities, no need to grow
+            maxVerts   = numVerts;
+            maxCoords  = numCoords;
+            maxNormals = numNormals;
+            vertexId = (int)numVerts;
+            coordId  = (int)numCoords;
+            normalId = (int)numNormals;
+        }
 
-            auto copyElements = [](auto& dst, auto* src, const std::vector<int>& uniqueIndices) {
-                dst.reserve(uniqueIndices.size());
-                for (int index : uniqueIndices)
-                    dst.push_back(src[index]);
+        void StitchChunks(std::vector<ObjChunk>& chunks)
+        {
+            auto copyElements = [](auto* dst, const auto& src) {
+                if (!src.empty()) memcpy(dst, src.data(), src.size()*sizeof(src[0]));
             };
-            copyElements(g.Verts, vertsData, uniqueVerts);
-            copyElements(g.Coords, coordsData, uniqueCoords);
-            copyElements(g.Normals, normalsData, uniqueNormals);
-            if (vertexColors) {
-                // OBJ colors use per-vertex mapping
-                copyElements(g.Colors, colorsData, uniqueVerts);
-                g.ColorMapping = MapMode::PerVertex;
+
+            ParallelFor((int)chunks.size(), [&](int i)
+            {
+                ObjChunk& chunk = chunks[i];
+                copyElements(vertsData   + chunk.vertexBase, chunk.verts);
+                copyElements(coordsData  + chunk.coordBase,  chunk.coords);
+                copyElements(normalsData + chunk.normalBase, chunk.normals);
+                if (numColors)
+                {
+                    if (chunk.colors.empty())
+                        memset(colorsData + chunk.vertexBase, 0, chunk.verts.size()*sizeof(rpp::Color3));
+                    else
+                        copyElements(colorsData + chunk.vertexBase, chunk.colors);
+                }
+
+                Triangle* faces = chunk.faces.data();
+                const uint16_t* relative = chunk.relative.data();
+                for (size_t faceId = 0, numFaces = chunk.faces.size(); faceId < numFaces; ++faceId)
+                    if (uint16_t mask = relative[faceId])
+                        AddRelativeBase(faces[faceId], mask, chunk.vertexBase, chunk.coordBase, chunk.normalBase);
+            });
+
+            for (ObjChunk& chunk : chunks)
+            {
+                int facesBegin = 0;
+                for (const ObjChunk::Command& cmd : chunk.commands)
+                {
+                    switch (cmd.type)
+                    {
+                        case ObjChunk::Command::Faces: {
+                            std::vector<Triangle>& tris = CurrentGroup()->Tris;
+                            tris.insert(tris.end(), chunk.faces.begin() + facesBegin,
+                                                    chunk.faces.begin() + cmd.facesEnd);
+                            facesBegin = cmd.facesEnd;
+                            break;
+                        }
+                        case ObjChunk::Command::Group:  OnGroup(cmd.arg);  break;
+                        case ObjChunk::Command::UseMtl: OnUseMtl(cmd.arg); break;
+                        case ObjChunk::Command::MtlLib: OnMtlLib(cmd.arg); break;
+                        case ObjChunk::Command::Object: OnObject(cmd.arg); break;
+                    }
+                }
+                if (!ctx) std::vector<Triangle>().swap(chunk.faces); // release memory early
             }
         }
 
+        void RemoveEmptyGroups() const
+        {
+            for (auto it = mesh.Groups.begin(); it != mesh.Groups.end();)
+                if (it->IsEmpty()) it = mesh.Groups.erase(it); else ++it;
+        }
+
         // when OBJ mesh has only 1 group
         void CopyAllMeshDataToOneGroup(MeshGroup& g) const
         {
@@ -422,7 +1031,7 @@ namespace Nano
             }
         }
 
-        void BuildGroup(MeshGroup& g, int numGroups) const
+        void BuildGroup(MeshGroup& g, int numGroups, GroupRemap* remap) const
         {
             if (g.Name.empty() && g.Mat) // assign default name
                 g.Name = g.Mat->Name;
@@ -440,36 +1049,39 @@ namespace Nano
                 // because OBJ stores a global list of vertices, normals, uvs,
                 // we need to completely recalculate indices and arrays for each group
             {
-                SlowBlenderHack(g);
+                RemapGroupElements(g, *remap, vertsData, coordsData, normalsData,
+                                   numColors > 0 ? colorsData : nullptr);
             }
 
-            int numVerts   = g.NumVerts();
-            int numNormals = g.NumNormals();
-            int numCoords  = g.NumCoords();
-            int numTris    = g.NumTris();
-
-            if      (numNormals <= 0)        g.NormalsMapping = MapMode::None;
-            else if (numNormals == numVerts) g.NormalsMapping = MapMode::PerVertex;
-            else if (numNormals == numTris)  g.NormalsMapping = MapMode::PerFace;
-            else if (numNormals >  numVerts) g.NormalsMapping = MapMode::PerFaceVertex;
-            else                             g.NormalsMapping = MapMode::SharedElements;
-            if      (numCoords == 0)         g.CoordsMapping  = MapMode::None;
-            else if (numCoords == numVerts)  g.CoordsMapping  = MapMode::PerVertex;
-            else if (numCoords >  numVerts)  g.CoordsMapping  = MapMode::PerFaceVertex;
-            else Assert(false, "Unfamiliar CoordsMapping mode");
+            SetGroupMappings(g);
 
             //LogInfo("BuildGroup %s elapsed: %.1fms", g.Name, t.elapsed_ms());
         }
 
         void BuildMeshGroups() const
         {
-            for (MeshGroup& g : mesh.Groups)
+            // groups are independent, so they can be built in parallel,
+            // each worker has its own remap tables
+            int numGroups = (int)mesh.Groups.size();
+            int numWorkers = (options & Options::Parallel) ? NumWorkers(numGroups) : 1;
+            std::vector<GroupRemap> localRemaps;
+            std::vector<GroupRemap>& remaps = ctx ? ctx->remaps : localRemaps;
+            if (numGroups > 1)
+            {
+                if ((int)remaps.size() < numWorkers)
+                    remaps.resize(numWorkers);
+                for (GroupRemap& remap : remaps)
+                    remap.Resize(numVerts, numCoords, numNormals);
+            }
+
+            ParallelFor(numGroups, numWorkers, [&](int groupIndex, int worker)
             {
-                BuildGroup(g, (int)mesh.Groups.size());
+                MeshGroup& g = mesh.Groups[groupIndex];
+                BuildGroup(g, numGroups, numGroups > 1 ? &remaps[worker] : nullptr);
 
                 // OBJ default face winding is CCW
                 g.Winding = FaceWinding::CCW;
-            }
+            });
 
             if (!mesh.Groups.empty() && mesh.Groups.front().Name.empty())
                 mesh.Groups.front().Name = "default";
@@ -478,34 +1090,72 @@ namespace Nano
 
     bool Mesh::LoadOBJ(rpp::strview meshPath, Options opt)
     {
+        return LoadOBJ(meshPath, opt, nullptr);
+    }
+
+    bool Mesh::LoadOBJ(rpp::strview meshPath, Options opt, MeshLoadContext& ctx)
+    {
+        return LoadOBJ(meshPath, opt, &ctx);
+    }
+
+    bool Mesh::LoadOBJ(rpp::strview meshPath, Options opt, MeshLoadContext* context)
+    {
+        MeshLoadContext::Impl* ctx = context ? context->GetImpl() : nullptr;
+        if (ctx && context->ReuseMeshCapacity)
+            ctx->RecycleGroups(*this);
         Clear();
 
-        ObjLoader loader { *this, meshPath, opt };
+        ObjLoader loader { *this, meshPath, opt, ctx };
 
-        if (!loader.parser) {
+        if (!loader.buffer) {
             NanoErr(opt, "Failed to open file: %s", meshPath);
         }
 
-        if (!loader.ProbeStats()) {
-            NanoErr(opt, "Mesh::LoadOBJ() failed! No vertices in: %s", meshPath);
+        // the parallel parser needs at least 2 chunks to be worthwhile
+        std::vector<ObjChunk> localChunks;
+        std::vector<ObjChunk>& chunks = ctx ? ctx->chunks : localChunks;
+        bool parallel = (opt & Options::Parallel) && GetMaxThreads() > 1
+                     && loader.buffer.len >= 2*MinParallelChunkSize;
+        if (parallel)
+        {
+            loader.SplitChunks(chunks);
+            loader.ParseMeshDataParallel(chunks);
         }
-
-        if (opt & Options::Log) {
-            LogInfo("Load %-33s  %5zu verts  %5zu polys  %s",
-                file_nameext(meshPath), loader.numVerts, loader.numFaces, to_string(opt));
+        else
+        {
+            loader.EstimateCapacity();
         }
-        
+
         // OBJ maps vertex data globally, not per-mesh-group like most game engines expect
         // so this really complicates things when we build the mesh groups...
         // to speed up mesh loading, we use very heavy stack allocation
 
         // ObjLoader will free these in destructor if malloc was used
         // ReSharper disable once CppNonReclaimedResourceAcquisition
-        void* mem = loader.bufferSize <= MaxStackAlloc
-                    ? alloca(loader.bufferSize)
-                    : malloc(loader.bufferSize);
-        loader.InitPointers(mem);
-        loader.ParseMeshData();
+        loader.CalculateBufferSize();
+        if (ctx)
+        {
+            loader.InitPointers(ctx->ReserveMegaBuffer(loader.bufferSize), false);
+        }
+        else
+        {
+            bool onHeap = loader.bufferSize > MaxStackAlloc;
+            void* mem = onHeap ? malloc(loader.bufferSize) : alloca(loader.bufferSize);
+            loader.InitPointers(mem, onHeap);
+        }
+        if (!parallel)
+            loader.ParseMeshData();
+        else
+            loader.StitchChunks(chunks);
+
+        if (loader.numVerts == 0) {
+            NanoErr(opt, "Mesh::LoadOBJ() failed! No vertices in: %s", meshPath);
+        }
+
+        if (opt & Options::Log) {
+            LogInfo("Load %-33s  %5zu verts  %5zu polys  %s",
+                file_nameext(meshPath), loader.numVerts, loader.numFaces, to_string(opt));
+        }
 
         if (!(opt & Options::EmptyGroups))
             loader.RemoveEmptyGroups();
@@ -515,6 +1165,225 @@ namespace Nano
         return true;
     }
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * ParseObjLines() sink for StreamOBJ(), which keeps only the global elements,
+     * the current file window and the triangles of the current group in memory.
+     */
+    struct ObjStreamReader
+    {
+        rpp::strview meshPath;
+        Options options;
+        ObjStreamOptions streamOpt;
+        const MeshGroupCallback& onGroup;
+
+        std::vector<rpp::Vector3> verts;
+        std::vector<rpp::Vector2> coords;
+        std::vector<rpp::Vector3> normals;
+        std::vector<rpp::Color3>  colors; // empty until the first vertex color
+
+        std::shared_ptr<const MaterialLibrary> matlib;
+        bool triedDefaultMat = false;
+
+        std::vector<std::string> groupNames; // index is the GroupId
+        int groupId = -1;
+        std::shared_ptr<Material> groupMat;
+        std::vector<Triangle> tris; // pending triangles of the current group, global indices
+        GroupRemap remap;
+        bool stopped = false;
+
+        ObjStreamReader(rpp::strview meshPath, Options options,
+                        const ObjStreamOptions& streamOpt, const MeshGroupCallback& onGroup)
+            : meshPath{ meshPath }, options{ options }, streamOpt{ streamOpt }, onGroup{ onGroup }
+        {
+        }
+
+        std::shared_ptr<Material> FindMat(rpp::strview matName)
+        {
+            if ((!matlib || matlib->materials.empty()) && !triedDefaultMat) {
+                triedDefaultMat = true;
+                std::string defaultMat = file_replace_ext(meshPath, "mtl");
+                matlib = MaterialCache::Instance().Load(defaultMat, options);
+            }
+            return matlib ? matlib->Find(matName) : nullptr;
+        }
+
+        void SetGroup(rpp::strview name)
+        {
+            for (int i = 0; i < (int)groupNames.size(); ++i)
+                if (name == groupNames[i]) { groupId = i; return; }
+            groupId = (int)groupNames.size();
+            groupNames.emplace_back(name);
+        }
+
+        void OnVertex(rpp::strview line)
+        {
+            rpp::Vector3& v = rpp::emplace_back(verts);
+            rpp::Vector3 col;
+            if (ParseVertex(line, v, col))
+            {
+                colors.resize(verts.size(), rpp::Color3::Zero());
+                colors.back() = col;
+            }
+            else if (!colors.empty())
+            {
+                colors.push_back(rpp::Color3::Zero());
+            }
+        }
+        void OnNormal(rpp::strview line)
+        {
+            rpp::Vector3& n = rpp::emplace_back(normals);
+            NumberScanner{line} >> n.x >> n.y >> n.z;
+        }
+        void OnCoord(rpp::strview line)
+        {
+            rpp::Vector2& uv = rpp::emplace_back(coords);
+            NumberScanner{line} >> uv.x >> uv.y;
+        }
+        void OnFace(rpp::strview line)
+        {
+            if (groupId == -1)
+                SetGroup({});
+            ParseFace(line, tris, nullptr, (int)verts.size(), (int)coords.size(), (int)normals.size());
+            if (streamOpt.MaxBatchTris > 0 && (int)tris.size() >= streamOpt.MaxBatchTris)
+                EmitGroup();
+        }
+        void OnUseMtl(rpp::strview matName)
+        {
+            std::shared_ptr<Material> mat = FindMat(matName);
+            if (mat != groupMat)
+            {
+                EmitGroup(); // only one material per group
+                groupMat = std::move(mat);
+            }
+            if (groupId == -1)
+                SetGroup({});
+        }
+        void OnMtlLib(rpp::strview matlibFile)
+        {
+            std::string matlibPath = path_combine(folder_path(meshPath), matlibFile);
+            matlib = MaterialCache::Instance().Load(matlibPath, options);
+        }
+        void OnGroup(rpp::strview name)
+        {
+            bool ignoreGroup = (options & Options::SingleGroup) && groupId != -1;
+            if (!ignoreGroup)
+            {
+                EmitGroup();
+                SetGroup(name);
+            }
+        }
+        void OnObject(rpp::strview) {}
+
+        void EmitGroup()
+        {
+            if (tris.empty() || stopped)
+                return;
+
+            MeshGroup g { groupId, groupNames[groupId] };
+            g.Mat = groupMat;
+            if (g.Name.empty()) // assign default name
+                g.Name = g.Mat ? g.Mat->Name : "default"s;
+
+            g.Tris.swap(tris);
+            remap.Resize(verts.size(), coords.size(), normals.size());
+            RemapGroupElements(g, remap, verts.data(), coords.data(), normals.data(),
+                               colors.empty() ? nullptr : colors.data());
+            SetGroupMappings(g);
+            g.Winding = FaceWinding::CCW; // OBJ default face winding is CCW
+            ApplyGroupLoadOptions(g);
+
+            stopped = !onGroup(g);
+
+            // reuse the triangle buffer, unless the callback took it
+            tris.swap(g.Tris);
+            tris.clear();
+        }
+
+        // same as Mesh::ApplyLoadOptions() for a single group
+        void ApplyGroupLoadOptions(MeshGroup& g) const
+        {
+            const int numThreads = (options & Options::Parallel) ? GetMaxThreads() : 1;
+            if (options & Options::SplitSeams)
+                g.SplitSeamVertices(numThreads);
+            if (options & Options::Flatten)
+                g.OptimizedFlatten(numThreads);
+            if (options & Options::OptimizeVertexCache)
+                g.OptimizeVertexCache();
+            g.SetFaceWinding((options & Options::ClockWise) ? FaceWinding::CW : FaceWinding::CCW);
+            if (options & Options::Unity)
+                g.SetCoordSys(CoordSys::Unity);
+            if (options & Options::Log)
+                g.Print();
+        }
+    };
+
+    bool StreamOBJ(rpp::strview meshPath, const MeshGroupCallback& onGroup,
+                   const ObjStreamOptions& streamOpt, Options opt)
+    {
+        if (opt & Options::Unity) {
+            opt |= Options::SingleGroup | Options::SplitSeams
+                |  Options::Flatten     | Options::ClockWise;
+        }
+
+        rpp::file file { meshPath };
+        if (!file) {
+            NanoErr(opt, "Failed to open file: %s", meshPath);
+        }
+        if (opt & Options::Log) {
+            LogInfo("Stream %-31s  %s", file_nameext(meshPath), to_string(opt));
+        }
+
+        ObjStreamReader reader { meshPath, opt, streamOpt, onGroup };
+
+        // window holds the incomplete last line of the previous read + the next read
+        int windowSize = streamOpt.WindowSize > 0 ? streamOpt.WindowSize : 64 * 1024;
+        int maxWindowSize = std::max(windowSize, streamOpt.MaxWindowSize);
+        std::vector<char> window(windowSize);
+        int used = 0;
+        bool eof = false;
+        while (!eof && !reader.stopped)
+        {
+            if (used == (int)window.size()) // a single line doesn't fit
+            {
+                if (used >= maxWindowSize) {
+                    NanoErr(opt, "Nano::StreamOBJ() failed! Line longer than %d bytes in: %s",
+                            maxWindowSize, meshPath);
+                }
+                window.resize(used > maxWindowSize / 2 ? maxWindowSize : used * 2);
+            }
+
+            int bytesRead = file.read(window.data() + used, int(window.size()) - used);
+            eof = bytesRead <= 0;
+            if (bytesRead > 0)
+                used += bytesRead;
+
+            // only parse complete lines, unless this is the end of the file
+            int parseEnd = used;
+            if (!eof)
+            {
+                const char* data = window.data();
+                const char* lastEol = data + used;
+                while (lastEol > data && lastEol[-1] != '\n')
+                    --lastEol;
+                parseEnd = int(lastEol - data);
+            }
+            if (parseEnd > 0)
+            {
+                ParseObjLines(rpp::line_parser{ window.data(), parseEnd }, reader);
+                used -= parseEnd;
+                memmove(window.data(), window.data() + parseEnd, used);
+            }
+        }
+
+        reader.EmitGroup();
+        if (reader.verts.empty()) {
+            NanoErr(opt, "Nano::StreamOBJ() failed! No vertices in: %s", meshPath);
+        }
+        return true;
+    }
+
 
     ///////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -533,88 +1402,265 @@ namespace Nano
         return colors;
     }
 
-    bool Mesh::SaveAsOBJ(rpp::strview meshPath, Options opt) const
+    /**
+     * Output text of a single write job, grown one line at a time
+     * so that untouched capacity is never zero-filled
+     */
+    struct ObjOutBuffer
     {
-        rpp::file f { meshPath, rpp::file::CREATENEW };
-        if (!f) {
-            NanoErr(opt, "Failed to create file: %s", meshPath);
-        }
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+        size_t capacity = 0;
 
-        rpp::string_buffer sb;
-        // straight to file, #dontcare about perf atm
-        if (opt & Options::Log) {
-            LogInfo("Save %-33s  %5d verts  %5d tris", 
-                file_nameext(meshPath), TotalVerts(), TotalTris());
+        // @return Write pointer with room for at least `maxLineLength` characters
+        char* Reserve(size_t maxLineLength)
+        {
+            if (capacity - size < maxLineLength)
+            {
+                size_t newCapacity = capacity + capacity / 2 + maxLineLength + 4096;
+                std::unique_ptr<char[]> newData { new char[newCapacity] };
+                if (size) memcpy(newData.get(), data.get(), size);
+                data = std::move(newData);
+                capacity = newCapacity;
+            }
+            return data.get() + size;
         }
-        std::string matlib = rpp::file_replace_ext(meshPath, "mtl");
-        rpp::strview matlibFile = rpp::file_nameext(matlib);
-        if (SaveMaterials(*this, matlib, matlibFile, opt))
-            sb.writeln("mtllib", matlibFile);
 
-        if (!Name.empty())
-            sb.writeln("o", Name);
+        void Commit(const NumberWriter& w) { size = size_t(w.End() - data.get()); }
+    };
 
-        int vertexBase  = 1;
-        int coordsBase  = 1;
-        int normalsBase = 1;
+    /**
+     * Formats the OBJ text as a list of independent jobs, each covering a range of lines.
+     * Batches of jobs are formatted in parallel and written in order,
+     * while the next batch is formatted into a second set of buffers.
+     * This keeps peak memory bounded by 2 batches instead of the whole file.
+     */
+    struct ObjWriter
+    {
+        static constexpr int LinesPerJob = 32 * 1024;
 
-        for (int group = 0; group < (int)Groups.size(); ++group)
+        enum class JobType { Text, Verts, Coords, Normals, Faces };
+
+        struct Job
         {
-            const MeshGroup& g = Groups[group];
-            if (opt & Options::Log) {
-                g.Print();
+            JobType type;
+            int group;
+            int begin, end; // element range
+        };
+
+        struct GroupOut
+        {
+            const MeshGroup* g;
+            const rpp::Vector3* colors = nullptr; // per-vertex colors or null
+            std::vector<rpp::Vector3> flattened;  // PerFaceVertex colors flattened to PerVertex
+            int vertexBase, coordsBase, normalsBase;
+        };
+
+        const Mesh& mesh;
+        Options opt;
+        std::vector<GroupOut> groups;
+        std::vector<std::string> texts; // header lines
+        std::vector<Job> jobs;
+
+        ObjWriter(const Mesh& mesh, Options opt) : mesh{ mesh }, opt{ opt } {}
+
+        void AddText(std::string&& text)
+        {
+            if (!text.empty()) {
+                jobs.push_back({ JobType::Text, (int)texts.size(), 0, 0 });
+                texts.emplace_back(std::move(text));
             }
+        }
+
+        void AddRange(JobType type, int group, int count)
+        {
+            for (int begin = 0; begin < count; begin += LinesPerJob)
+                jobs.push_back({ type, group, begin, std::min(begin + LinesPerJob, count) });
+        }
 
-            auto* vertsData = g.Verts.data();
-            if (g.Colors.empty())
+        void Prepare(rpp::strview matlibFile)
+        {
+            rpp::string_buffer sb;
+            if (matlibFile) sb.writeln("mtllib", matlibFile);
+            if (!mesh.Name.empty()) sb.writeln("o", mesh.Name);
+            AddText(sb.str());
+
+            int vertexBase  = 1;
+            int coordsBase  = 1;
+            int normalsBase = 1;
+            groups.resize(mesh.Groups.size());
+            for (int group = 0; group < (int)mesh.Groups.size(); ++group)
             {
-                for (const rpp::Vector3& v : g.Verts)
-                    sb.writef("v %.6f %.6f %.6f\n", v.x, v.y, v.z);
+                const MeshGroup& g = mesh.Groups[group];
+                if (opt & Options::Log) {
+                    g.Print();
+                }
+
+                GroupOut& out = groups[group];
+                out.g = &g;
+                out.vertexBase  = vertexBase;
+                out.coordsBase  = coordsBase;
+                out.normalsBase = normalsBase;
+                if (!g.Colors.empty()) // non-standard extension for OBJ vertex colors
+                {
+                    // @todo Just leave a warning and export incorrect vertex colors?
+                    Assert((g.ColorMapping == MapMode::PerVertex || g.ColorMapping == MapMode::PerFaceVertex),
+                           "OBJ export only supports per-vertex and per-face-vertex color mapping!");
+                    Assert(g.NumColors() >= g.NumVerts(), "Group %s NumColors does not match NumVerts", g.Name);
+                    if (g.ColorMapping == MapMode::PerFaceVertex)
+                        out.flattened = FlattenColors(g);
+                    out.colors = out.flattened.empty() ? g.Colors.data() : out.flattened.data();
+                }
+
+                AddRange(JobType::Verts,   group, g.NumVerts());
+                AddRange(JobType::Coords,  group, g.NumCoords());
+                AddRange(JobType::Normals, group, g.NumNormals());
+
+                sb.clear();
+                if (!g.Name.empty()) sb.writeln("g", g.Name);
+                if (g.Mat)           sb.writeln("usemtl", g.Mat->Name);
+                sb.writeln("s", group);
+                AddText(sb.str());
+                AddRange(JobType::Faces, group, g.NumTris());
+
+                vertexBase  += g.NumVerts();
+                coordsBase  += g.NumCoords();
+                normalsBase += g.NumNormals();
             }
-            else // non-standard extension for OBJ vertex colors
+        }
+
+        void Format(const Job& job, ObjOutBuffer& out) const
+        {
+            constexpr int F = NumberWriter::MaxFixedChars;
+            constexpr int I = NumberWriter::MaxIntChars;
+            out.size = 0;
+            if (job.type == JobType::Text)
             {
-                // @todo Just leave a warning and export incorrect vertex colors?
-                Assert((g.ColorMapping == MapMode::PerVertex || g.ColorMapping == MapMode::PerFaceVertex),
-                       "OBJ export only supports per-vertex and per-face-vertex color mapping!");
-                Assert(g.NumColors() >= g.NumVerts(), "Group %s NumColors does not match NumVerts", g.Name);
+                const std::string& text = texts[job.group];
+                NumberWriter w { out.Reserve(text.size()) };
+                out.Commit(w.Str(text));
+                return;
+            }
 
-                auto& colors = g.ColorMapping == MapMode::PerFaceVertex ? FlattenColors(g) : g.Colors;
-                auto* colorsData = colors.data();
+            const GroupOut& go = groups[job.group];
+            const MeshGroup& g = *go.g;
+            switch (job.type)
+            {
+                case JobType::Verts:
+                    for (int i = job.begin; i < job.end; ++i)
+                    {
+                        const rpp::Vector3& v = g.Verts[i];
+                        NumberWriter w { out.Reserve(8 + 6*F) };
+                        w.Str("v "_sv).Fixed(v.x, 6).Char(' ').Fixed(v.y, 6).Char(' ').Fixed(v.z, 6);
+                        if (go.colors && go.colors[i] != rpp::Vector3::Zero())
+                        {
+                            const rpp::Vector3& c = go.colors[i];
+                            w.Char(' ').Fixed(c.x, 6).Char(' ').Fixed(c.y, 6).Char(' ').Fixed(c.z, 6);
+                        }
+                        out.Commit(w.Char('\n'));
+                    }
+                    break;
+                case JobType::Coords:
+                    for (int i = job.begin; i < job.end; ++i)
+                    {
+                        const rpp::Vector2& v = g.Coords[i];
+                        NumberWriter w { out.Reserve(8 + 2*F) };
+                        w.Str("vt "_sv).Fixed(v.x, 4).Char(' ').Fixed(v.y, 4);
+                        out.Commit(w.Char('\n'));
+                    }
+                    break;
+                case JobType::Normals:
+                    for (int i = job.begin; i < job.end; ++i)
+                    {
+                        const rpp::Vector3& v = g.Normals[i];
+                        NumberWriter w { out.Reserve(8 + 3*F) };
+                        w.Str("vn "_sv).Fixed(v.x, 4).Char(' ').Fixed(v.y, 4).Char(' ').Fixed(v.z, 4);
+                        out.Commit(w.Char('\n'));
+                    }
+                    break;
+                case JobType::Faces:
+                    for (int i = job.begin; i < job.end; ++i)
+                    {
+                        NumberWriter w { out.Reserve(4 + 3*(3*I + 3)) };
+                        w.Char('f');
+                        for (const VertexDescr& vd : g.Tris[i])
+                        {
+                            w.Char(' ').Int(vd.v + go.vertexBase);
+                            if (vd.t != -1 || vd.n != -1) w.Char('/');
+                            if (vd.t != -1) w.Int(vd.t + go.coordsBase);
+                            if (vd.n != -1) w.Char('/').Int(vd.n + go.normalsBase);
+                        }
+                        out.Commit(w.Char('\n'));
+                    }
+                    break;
+                case JobType::Text: break;
+            }
+        }
 
-                const int numVerts = g.NumVerts();
-                for (int i = 0; i < numVerts; ++i)
+        bool Write(rpp::file& f) const
+        {
+            int numJobs = (int)jobs.size();
+            int numWorkers = (opt & Options::Parallel) ? NumWorkers(numJobs) : 1;
+            int batchSize = numWorkers * 2;
+
+            std::vector<ObjOutBuffer> batches[2];
+            batches[0].resize(batchSize);
+            batches[1].resize(batchSize);
+
+            std::atomic<bool> failed { false };
+            auto writeBatch = [&f, &failed](const std::vector<ObjOutBuffer>* buffers, int count)
+            {
+                for (int i = 0; i < count && !failed; ++i)
                 {
-                    const rpp::Vector3& v = vertsData[i];
-                    const rpp::Vector3& c = colorsData[i];
-                    if (c == rpp::Vector3::Zero()) sb.writef("v %.6f %.6f %.6f\n", v.x, v.y, v.z);
-                    else sb.writef("v %.6f %.6f %.6f %.6f %.6f %.6f\n", v.x, v.y, v.z, c.x, c.y, c.z);
+                    const ObjOutBuffer& out = (*buffers)[i];
+                    if (out.size && f.write(out.data.get(), (int)out.size) != (int)out.size)
+                        failed = true;
                 }
-            }
-
-            for (const rpp::Vector2& v : g.Coords)  sb.writef("vt %.4f %.4f\n", v.x, v.y);
-            for (const rpp::Vector3& v : g.Normals) sb.writef("vn %.4f %.4f %.4f\n", v.x, v.y, v.z);
+            };
 
-            if (!g.Name.empty()) sb.writeln("g", g.Name);
-            if (g.Mat)           sb.writeln("usemtl", g.Mat->Name);
-            sb.writeln("s", group);
-            for (const Triangle& face : g.Tris)
+            std::thread writer;
+            for (int first = 0, batch = 0; first < numJobs && !failed; first += batchSize, batch ^= 1)
             {
-                sb.write('f');
-                for (const VertexDescr& vd : face)
+                int count = std::min(batchSize, numJobs - first);
+                std::vector<ObjOutBuffer>& buffers = batches[batch];
+                ParallelFor(count, numWorkers, [&](int i, int) {
+                    Format(jobs[first + i], buffers[i]);
+                });
+
+                if (numWorkers > 1) // write this batch while the next one is being formatted
                 {
-                    sb.write(' '); sb.write(vd.v + vertexBase);
-                    if (vd.t != -1) { sb.write('/'); sb.write(vd.t + coordsBase); }
-                    if (vd.n != -1) { sb.write('/'); sb.write(vd.n + normalsBase); }
+                    if (writer.joinable()) writer.join();
+                    writer = std::thread{ writeBatch, &buffers, count };
+                }
+                else
+                {
+                    writeBatch(&buffers, count);
                 }
-                sb.writeln();
             }
+            if (writer.joinable()) writer.join();
+            return !failed;
+        }
+    };
 
-            vertexBase  += g.NumVerts();
-            coordsBase  += g.NumCoords();
-            normalsBase += g.NumNormals();
+    bool Mesh::SaveAsOBJ(rpp::strview meshPath, Options opt) const
+    {
+        rpp::file f { meshPath, rpp::file::CREATENEW };
+        if (!f) {
+            NanoErr(opt, "Failed to create file: %s", meshPath);
         }
 
-        if (f.write(sb) != sb.size()) {
+        if (opt & Options::Log) {
+            LogInfo("Save %-33s  %5d verts  %5d tris", 
+                file_nameext(meshPath), TotalVerts(), TotalTris());
+        }
+        std::string matlib = rpp::file_replace_ext(meshPath, "mtl");
+        rpp::strview matlibFile = rpp::file_nameext(matlib);
+        if (!SaveMaterials(*this, matlib, matlibFile, opt))
+            matlibFile = {};
+
+        ObjWriter writer { *this, opt };
+        writer.Prepare(matlibFile);
+        if (!writer.Write(f)) {
             NanoErr(opt, "File write failed: %s", meshPath);
         }
         return true;
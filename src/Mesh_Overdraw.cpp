@@ -0,0 +1,294 @@
+#include <Nano/Mesh.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "InternalConfig.h"
+#include "MeshOptimize.h"
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    // FIFO vertex cache which counts the misses of every triangle and can be flushed
+    class TriangleCache
+    {
+        std::vector<int> addedAt;
+        int time;
+        int size;
+    public:
+        TriangleCache(int numVertices, int cacheSize)
+            : addedAt(numVertices, 0), time{ cacheSize + 1 }, size{ cacheSize } {}
+
+        void Flush() noexcept { time += size + 1; }
+
+        int Misses(const int* tri) noexcept
+        {
+            int misses = 0;
+            for (int i = 0; i < 3; ++i)
+            {
+                if (time - addedAt[tri[i]] > size)
+                {
+                    addedAt[tri[i]] = time++;
+                    ++misses;
+                }
+            }
+            return misses;
+        }
+    };
+
+    /**
+     * Clusters of the vertex cache ordered stream, as the first triangle of every cluster.
+     * Hard boundaries are where all 3 vertices miss the cache, which is where Tipsify
+     * started a new fan sequence. Every hard cluster is then split further as soon as
+     * its running ACMR, starting from an empty cache, drops to `threshold` times the ACMR
+     * of the whole cluster. (Sander, Nehab, Barczak 2007, "Fast Triangle Reordering
+     * for Vertex Locality and Reduced Overdraw")
+     */
+    static std::vector<int> SplitClusters(const std::vector<int>& ids, int numVertices,
+                                          int cacheSize, float threshold)
+    {
+        const int numTris = int(ids.size() / 3);
+        std::vector<int> hard;
+        {
+            TriangleCache cache { numVertices, cacheSize };
+            for (int tri = 0; tri < numTris; ++tri)
+                if (cache.Misses(&ids[tri * 3]) == 3 || tri == 0)
+                    hard.push_back(tri);
+        }
+        if (threshold <= 1.0f)
+            return hard;
+
+        std::vector<int> clusters;
+        TriangleCache cache { numVertices, cacheSize };
+        for (size_t i = 0; i < hard.size(); ++i)
+        {
+            const int start = hard[i];
+            const int end = i + 1 < hard.size() ? hard[i + 1] : numTris;
+
+            cache.Flush();
+            int clusterMisses = 0;
+            for (int tri = start; tri < end; ++tri)
+                clusterMisses += cache.Misses(&ids[tri * 3]);
+            const float maxACMR = threshold * float(clusterMisses) / float(end - start);
+
+            cache.Flush();
+            clusters.push_back(start);
+            int misses = 0, count = 0;
+            for (int tri = start; tri < end; ++tri)
+            {
+                misses += cache.Misses(&ids[tri * 3]);
+                ++count;
+                if (float(misses) <= maxACMR * float(count) && tri + 1 < end)
+                {
+                    clusters.push_back(tri + 1);
+                    cache.Flush();
+                    misses = count = 0;
+                }
+            }
+            // the last piece didn't reach the target ACMR, so it stays with the previous one
+            if (count != 0 && clusters.back() != start)
+                clusters.pop_back();
+        }
+        return clusters;
+    }
+
+    /**
+     * Orders clusters by their view independent occlusion potential: clusters far out
+     * from the group centroid that face away from it are drawn first, because from
+     * any direction they can see, they are in front of the rest of the group.
+     * @return Cluster indices in draw order
+     */
+    static std::vector<int> SortClusters(const MeshGroup& g, const std::vector<int>& clusters)
+    {
+        const int numTris = g.NumTris();
+        const bool ccw = g.Winding == FaceWinding::CCW;
+        std::vector<rpp::Vector3> centroids(clusters.size());
+        std::vector<rpp::Vector3> normals(clusters.size());
+        rpp::Vector3 groupCentroid = rpp::Vector3::Zero();
+        float groupArea = 0.0f;
+
+        for (size_t i = 0; i < clusters.size(); ++i)
+        {
+            const int end = i + 1 < clusters.size() ? clusters[i + 1] : numTris;
+            rpp::Vector3 centroid = rpp::Vector3::Zero();
+            rpp::Vector3 normal = rpp::Vector3::Zero();
+            float area = 0.0f;
+            for (int tri = clusters[i]; tri < end; ++tri)
+            {
+                const Triangle& t = g.Tris[tri];
+                const rpp::Vector3& v0 = g.Verts[(ccw ? t.a : t.c).v];
+                const rpp::Vector3& v1 = g.Verts[t.b.v];
+                const rpp::Vector3& v2 = g.Verts[(ccw ? t.c : t.a).v];
+                rpp::Vector3 n = (v1 - v0).cross(v2 - v0); // length is 2x area
+                float a = n.length();
+                centroid += (v0 + v1 + v2) * (a / 3.0f);
+                normal += n;
+                area += a;
+            }
+            groupCentroid += centroid;
+            groupArea += area;
+            centroids[i] = area > 0.0f ? centroid / area : g.Verts[g.Tris[clusters[i]].a.v];
+            normals[i] = normal.normalized();
+        }
+        if (groupArea > 0.0f)
+            groupCentroid /= groupArea;
+
+        std::vector<float> keys(clusters.size());
+        for (size_t i = 0; i < clusters.size(); ++i)
+            keys[i] = (centroids[i] - groupCentroid).dot(normals[i]);
+
+        std::vector<int> order(clusters.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = int(i);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return keys[a] > keys[b]; });
+        return order;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    OverdrawStats MeshGroup::AnalyzeOverdraw(int resolution) const noexcept
+    {
+        OverdrawStats stats;
+        if (Tris.empty() || resolution <= 0)
+            return stats;
+
+        // uniform scale, so the group keeps its proportions in every view
+        rpp::BoundingBox bounds = rpp::BoundingBox::create(Verts);
+        rpp::Vector3 size = bounds.max - bounds.min;
+        float extent = std::max(size.x, std::max(size.y, size.z));
+        float scale = extent > 0.0f ? float(resolution) / extent : 0.0f;
+
+        // screen axes u, v and the depth axis of the 6 views, with u x v pointing at the
+        // viewer, so front faces are counter-clockwise on screen in every view
+        struct View { int u, v, depth; float sign; };
+        static constexpr View views[6] = {
+            { 0, 1, 2, -1.0f }, { 1, 0, 2, +1.0f },
+            { 1, 2, 0, -1.0f }, { 2, 1, 0, +1.0f },
+            { 2, 0, 1, -1.0f }, { 0, 2, 1, +1.0f },
+        };
+
+        const bool ccw = Winding == FaceWinding::CCW;
+        constexpr float noDepth = std::numeric_limits<float>::max();
+        std::vector<float> depth(size_t(resolution) * resolution);
+        for (const View& view : views)
+        {
+            std::fill(depth.begin(), depth.end(), noDepth);
+            for (const Triangle& t : Tris)
+            {
+                float x[3], y[3], z[3];
+                for (int i = 0; i < 3; ++i)
+                {
+                    const rpp::Vector3& p = Verts[t[ccw ? i : 2 - i].v];
+                    rpp::Vector3 local = p - bounds.min;
+                    x[i] = (&local.x)[view.u] * scale;
+                    y[i] = (&local.x)[view.v] * scale;
+                    z[i] = (&p.x)[view.depth] * view.sign;
+                }
+
+                float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+                if (!(area > 0.0f)) // back face or degenerate
+                    continue;
+
+                int minX = std::max(0, int(std::floor(std::min({ x[0], x[1], x[2] }))));
+                int minY = std::max(0, int(std::floor(std::min({ y[0], y[1], y[2] }))));
+                int maxX = std::min(resolution - 1, int(std::ceil(std::max({ x[0], x[1], x[2] }))));
+                int maxY = std::min(resolution - 1, int(std::ceil(std::max({ y[0], y[1], y[2] }))));
+
+                // edge i is opposite to vertex i, shared edges only belong to one triangle
+                float dx[3], dy[3];
+                bool owned[3];
+                for (int i = 0; i < 3; ++i)
+                {
+                    int p = (i + 1) % 3, q = (i + 2) % 3;
+                    dx[i] = x[q] - x[p];
+                    dy[i] = y[q] - y[p];
+                    owned[i] = dy[i] > 0.0f || (dy[i] == 0.0f && dx[i] < 0.0f);
+                }
+
+                const float invArea = 1.0f / area;
+                for (int py = minY; py <= maxY; ++py)
+                {
+                    for (int px = minX; px <= maxX; ++px)
+                    {
+                        float sx = px + 0.5f, sy = py + 0.5f;
+                        float w[3];
+                        bool inside = true;
+                        for (int i = 0; i < 3 && inside; ++i)
+                        {
+                            int p = (i + 1) % 3;
+                            w[i] = dx[i] * (sy - y[p]) - dy[i] * (sx - x[p]);
+                            inside = w[i] > 0.0f || (w[i] == 0.0f && owned[i]);
+                        }
+                        if (!inside)
+                            continue;
+
+                        // early depth test, only visible fragments are shaded
+                        float d = (w[0]*z[0] + w[1]*z[1] + w[2]*z[2]) * invArea;
+                        float& stored = depth[size_t(py) * resolution + px];
+                        if (d < stored)
+                        {
+                            if (stored == noDepth) ++stats.PixelsCovered;
+                            stored = d;
+                            ++stats.PixelsShaded;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (stats.PixelsCovered)
+            stats.Overdraw = float(stats.PixelsShaded) / stats.PixelsCovered;
+        return stats;
+    }
+
+    VertexCacheReport MeshGroup::OptimizeOverdraw(float threshold, int cacheSize) noexcept
+    {
+        std::vector<int> ids;
+        const int numVertices = CornerVertexIds(*this, ids);
+        VertexCacheReport report;
+        report.Before = report.After = SimulateVertexCache(ids, numVertices, cacheSize);
+        if (Tris.size() < 2 || cacheSize < 3)
+            return report;
+
+        // clusters only split further at the threshold, so if the cluster order still
+        // costs too much, retrying with the hard clusters alone can only get closer
+        const float maxACMR = report.Before.ACMR * std::max(threshold, 1.0f);
+        for (float clusterThreshold : { threshold, 1.0f })
+        {
+            std::vector<int> clusters = SplitClusters(ids, numVertices, cacheSize, clusterThreshold);
+            if (clusters.size() < 2)
+                return report;
+
+            std::vector<int> order = SortClusters(*this, clusters);
+            std::vector<int> newIds; newIds.reserve(ids.size());
+            std::vector<Triangle> tris; tris.reserve(Tris.size());
+            for (int cluster : order)
+            {
+                const int end = cluster + 1 < (int)clusters.size() ? clusters[cluster + 1] : NumTris();
+                for (int tri = clusters[cluster]; tri < end; ++tri)
+                {
+                    newIds.insert(newIds.end(), &ids[tri * 3], &ids[tri * 3] + 3);
+                    tris.push_back(Tris[tri]);
+                }
+            }
+
+            VertexCacheStats after = SimulateVertexCache(newIds, numVertices, cacheSize);
+            if (after.ACMR <= maxACMR)
+            {
+                Tris = std::move(tris);
+                report.After = after;
+                return report;
+            }
+            if (clusterThreshold <= 1.0f)
+                break;
+        }
+        return report; // the vertex cache would suffer too much, keep the original order
+    }
+
+    void Mesh::OptimizeOverdraw(float threshold, int cacheSize) noexcept
+    {
+        for (MeshGroup& group : Groups)
+            group.OptimizeOverdraw(threshold, cacheSize);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,539 @@
+#include <Nano/Mesh.h>
+#include <rpp/sprint.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include "InternalConfig.h"
+#include "BinaryFile.h"
+
+namespace Nano
+{
+    using namespace rpp::literals;
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Binary PLY, a text header followed by the element records:
+     *
+     *   ply
+     *   format binary_little_endian 1.0
+     *   element vertex 8
+     *   property float x
+     *   ...
+     *   element face 12
+     *   property list uchar int vertex_indices
+     *   end_header
+     *   <8 vertex records><12 face records>
+     *
+     * Vertex records have a fixed size, so they are decoded in bulk out of the read buffer.
+     * Polygons are triangulated as fans. Elements other than vertex and face are skipped.
+     */
+    enum class PlyType : uint8_t { None, Int8, Uint8, Int16, Uint16, Int32, Uint32, Float32, Float64 };
+
+    static PlyType ParsePlyType(rpp::strview name)
+    {
+        if (name == "char"   || name == "int8")    return PlyType::Int8;
+        if (name == "uchar"  || name == "uint8")   return PlyType::Uint8;
+        if (name == "short"  || name == "int16")   return PlyType::Int16;
+        if (name == "ushort" || name == "uint16")  return PlyType::Uint16;
+        if (name == "int"    || name == "int32")   return PlyType::Int32;
+        if (name == "uint"   || name == "uint32")  return PlyType::Uint32;
+        if (name == "float"  || name == "float32") return PlyType::Float32;
+        if (name == "double" || name == "float64") return PlyType::Float64;
+        return PlyType::None;
+    }
+
+    static int PlyTypeSize(PlyType type)
+    {
+        switch (type)
+        {
+            case PlyType::Int8:  case PlyType::Uint8:   return 1;
+            case PlyType::Int16: case PlyType::Uint16:  return 2;
+            case PlyType::Int32: case PlyType::Uint32: case PlyType::Float32: return 4;
+            case PlyType::Float64: return 8;
+            default: return 0;
+        }
+    }
+
+    // reads a scalar of this type, swapping the bytes of big endian files
+    static double ReadPlyScalar(const uint8_t* p, PlyType type, bool bigEndian)
+    {
+        uint8_t b[8];
+        int size = PlyTypeSize(type);
+        if (bigEndian) { for (int i = 0; i < size; ++i) b[i] = p[size - 1 - i]; }
+        else           { memcpy(b, p, size); }
+        switch (type)
+        {
+            case PlyType::Int8:    return (int8_t)b[0];
+            case PlyType::Uint8:   return b[0];
+            case PlyType::Int16:   { int16_t v;  memcpy(&v, b, 2); return v; }
+            case PlyType::Uint16:  { uint16_t v; memcpy(&v, b, 2); return v; }
+            case PlyType::Int32:   { int32_t v;  memcpy(&v, b, 4); return v; }
+            case PlyType::Uint32:  { uint32_t v; memcpy(&v, b, 4); return v; }
+            case PlyType::Float32: { float v;    memcpy(&v, b, 4); return v; }
+            case PlyType::Float64: { double v;   memcpy(&v, b, 8); return v; }
+            default: return 0.0;
+        }
+    }
+
+    struct PlyProperty
+    {
+        std::string Name;
+        PlyType Type = PlyType::None;
+        PlyType CountType = PlyType::None; // only for list properties
+        int Offset = -1; // offset in fixed size records, -1 after a list property
+    };
+
+    struct PlyElement
+    {
+        std::string Name;
+        uint64_t Count = 0;
+        std::vector<PlyProperty> Properties;
+        int RecordSize = 0; // 0 if the element has list properties
+
+        int Find(std::initializer_list<rpp::strview> names) const
+        {
+            for (rpp::strview name : names)
+                for (size_t i = 0; i < Properties.size(); ++i)
+                    if (Properties[i].Name == name)
+                        return (int)i;
+            return -1;
+        }
+    };
+
+    class PlyReader
+    {
+        BinaryFileReader file;
+        std::vector<PlyElement> elements;
+        bool bigEndian = false;
+        int numVerts = -1; // -1 until the vertex element has been read
+
+    public:
+        std::string error;
+
+        explicit PlyReader(rpp::strview meshPath) : file{ meshPath } {}
+
+        bool Fail(std::string message)
+        {
+            if (error.empty())
+                error = std::move(message);
+            return false;
+        }
+
+        bool Read(MeshGroup& g)
+        {
+            if (!file)
+                return Fail("failed to open file");
+            if (!ReadHeader())
+                return false;
+            for (const PlyElement& e : elements)
+            {
+                bool ok = e.Name == "vertex" ? ReadVertices(e, g)
+                        : e.Name == "face"   ? ReadFaces(e, g)
+                        : SkipElement(e);
+                if (!ok)
+                    return false;
+            }
+            if (numVerts == -1)
+                return Fail("missing vertex element");
+            // faces can come before vertices, so the indices are validated at the end
+            for (const Triangle& tri : g.Tris)
+                for (const VertexDescr& vd : tri)
+                    if ((unsigned)vd.v >= (unsigned)numVerts)
+                        return Fail("vertex index out of bounds");
+            return true;
+        }
+
+    private:
+        bool ReadHeader()
+        {
+            std::string line;
+            if (!file.ReadLine(line) || line != "ply")
+                return Fail("not a PLY file");
+            bool hasFormat = false;
+            while (file.ReadLine(line))
+            {
+                rpp::strview l = line;
+                rpp::strview keyword = l.next(' ');
+                if (keyword == "end_header")
+                {
+                    if (!hasFormat)
+                        return Fail("missing format");
+                    return true;
+                }
+                if (keyword == "format")
+                {
+                    rpp::strview format = l.next(' ');
+                    if      (format == "binary_little_endian") bigEndian = false;
+                    else if (format == "binary_big_endian")    bigEndian = true;
+                    else if (format == "ascii") return Fail("ASCII PLY is not supported");
+                    else return Fail("unknown format " + format.to_string());
+                    hasFormat = true;
+                }
+                else if (keyword == "element")
+                {
+                    PlyElement& e = rpp::emplace_back(elements);
+                    e.Name = l.next(' ').to_string();
+                    rpp::strview count = l.next(' ');
+                    if (count.empty() || !std::all_of(count.begin(), count.end(), [](char c) { return c >= '0' && c <= '9'; }))
+                        return Fail("invalid element count");
+                    e.Count = strtoull(count.to_string().c_str(), nullptr, 10);
+                }
+                else if (keyword == "property")
+                {
+                    if (elements.empty())
+                        return Fail("property before element");
+                    PlyElement& e = elements.back();
+                    PlyProperty& p = rpp::emplace_back(e.Properties);
+                    rpp::strview type = l.next(' ');
+                    if (type == "list")
+                    {
+                        p.CountType = ParsePlyType(l.next(' '));
+                        type = l.next(' ');
+                        if (p.CountType == PlyType::None || p.CountType == PlyType::Float32 ||
+                            p.CountType == PlyType::Float64)
+                            return Fail("invalid list count type");
+                    }
+                    p.Type = ParsePlyType(type);
+                    p.Name = l.next(' ').to_string();
+                    if (p.Type == PlyType::None)
+                        return Fail("unknown property type " + type.to_string());
+                }
+                // comment, obj_info and unknown keywords are ignored
+            }
+            return Fail("missing end_header");
+        }
+
+        // computes property offsets of elements without lists
+        static void Layout(PlyElement& e)
+        {
+            int offset = 0;
+            for (PlyProperty& p : e.Properties)
+            {
+                if (p.CountType != PlyType::None) { e.RecordSize = 0; return; }
+                p.Offset = offset;
+                offset += PlyTypeSize(p.Type);
+            }
+            e.RecordSize = offset;
+        }
+
+        bool ReadVertices(PlyElement e, MeshGroup& g)
+        {
+            Layout(e);
+            if (e.RecordSize == 0)
+                return Fail("list properties in the vertex element are not supported");
+            if (e.Count > INT_MAX)
+                return Fail("too many vertices");
+            if (e.Count * e.RecordSize > (uint64_t)file.FileSize())
+                return Fail("truncated vertex data");
+            numVerts = (int)e.Count;
+
+            const int x = e.Find({"x"}), y = e.Find({"y"}), z = e.Find({"z"});
+            const int nx = e.Find({"nx"}), ny = e.Find({"ny"}), nz = e.Find({"nz"});
+            const int u = e.Find({"s", "u", "texture_u", "texture_s"});
+            const int v = e.Find({"t", "v", "texture_v", "texture_t"});
+            const int r = e.Find({"red", "diffuse_red"}), gr = e.Find({"green", "diffuse_green"});
+            const int b = e.Find({"blue", "diffuse_blue"});
+            if (x == -1 || y == -1 || z == -1)
+                return Fail("vertex element has no x y z");
+            const bool hasNormals = nx != -1 && ny != -1 && nz != -1;
+            const bool hasCoords  = u != -1 && v != -1;
+            const bool hasColors  = r != -1 && gr != -1 && b != -1;
+
+            g.Verts.resize(numVerts);
+            if (hasNormals) { g.Normals.resize(numVerts); g.NormalsMapping = MapMode::PerVertex; }
+            if (hasCoords)  { g.Coords.resize(numVerts);  g.CoordsMapping  = MapMode::PerVertex; }
+            if (hasColors)  { g.Colors.resize(numVerts);  g.ColorMapping   = MapMode::PerVertex; }
+
+            const std::vector<PlyProperty>& p = e.Properties;
+            auto get = [&](const uint8_t* record, int prop) {
+                return (float)ReadPlyScalar(record + p[prop].Offset, p[prop].Type, bigEndian);
+            };
+            // integer colors are normalized to [0,1]
+            auto color = [&](const uint8_t* record, int prop) {
+                float c = get(record, prop);
+                if (p[prop].Type == PlyType::Uint8)  return c / 255.0f;
+                if (p[prop].Type == PlyType::Uint16) return c / 65535.0f;
+                return c;
+            };
+            // the most common layout, little endian float x y z at the start of the record
+            const bool packedPositions = !bigEndian && x == 0 && y == 1 && z == 2
+                && p[0].Type == PlyType::Float32 && p[1].Type == PlyType::Float32 && p[2].Type == PlyType::Float32;
+
+            int vertexId = 0;
+            const uint8_t* records;
+            while (vertexId < numVerts)
+            {
+                size_t count = file.ReadRecords(e.RecordSize, numVerts - vertexId, records);
+                if (count == 0)
+                    return Fail("truncated vertex data");
+                for (size_t i = 0; i < count; ++i, ++vertexId)
+                {
+                    const uint8_t* record = records + i * e.RecordSize;
+                    if (packedPositions)
+                        memcpy(&g.Verts[vertexId], record, sizeof(rpp::Vector3));
+                    else
+                        g.Verts[vertexId] = { get(record, x), get(record, y), get(record, z) };
+                    if (hasNormals) g.Normals[vertexId] = { get(record, nx), get(record, ny), get(record, nz) };
+                    if (hasCoords)  g.Coords[vertexId]  = { get(record, u), get(record, v) };
+                    if (hasColors)  g.Colors[vertexId]  = { color(record, r), color(record, gr), color(record, b) };
+                }
+            }
+            return true;
+        }
+
+        // @return Number of items in the list at `p`, or -1 if the file ends
+        int64_t ReadListCount(const PlyProperty& prop)
+        {
+            const uint8_t* p = file.Read(PlyTypeSize(prop.CountType));
+            if (!p)
+                return -1;
+            double count = ReadPlyScalar(p, prop.CountType, bigEndian);
+            return count >= 0.0 ? (int64_t)count : -1;
+        }
+
+        uint32_t ReadIndex(const uint8_t* p, PlyType type) const
+        {
+            if (!bigEndian && (type == PlyType::Int32 || type == PlyType::Uint32))
+            {
+                uint32_t index; memcpy(&index, p, sizeof(index));
+                return index;
+            }
+            double index = ReadPlyScalar(p, type, bigEndian);
+            return index >= 0.0 && index <= double(UINT32_MAX) ? (uint32_t)index : UINT32_MAX;
+        }
+
+        bool ReadFaces(const PlyElement& e, MeshGroup& g)
+        {
+            const int indices = e.Find({"vertex_indices", "vertex_index"});
+            if (indices == -1 || e.Properties[indices].CountType == PlyType::None)
+                return Fail("face element has no vertex_indices list");
+            if (e.Count > INT_MAX)
+                return Fail("too many faces");
+
+            const PlyProperty& list = e.Properties[indices];
+            const int indexSize = PlyTypeSize(list.Type);
+            // every face needs at least its list count, so corrupted counts can't reserve too much
+            g.Tris.reserve((size_t)std::min<uint64_t>(e.Count, (uint64_t)file.FileSize() / PlyTypeSize(list.CountType)));
+            std::vector<uint32_t> polygon;
+            for (uint64_t face = 0; face < e.Count; ++face)
+            {
+                for (size_t i = 0; i < e.Properties.size(); ++i)
+                {
+                    const PlyProperty& prop = e.Properties[i];
+                    if ((int)i != indices)
+                    {
+                        if (!SkipProperty(prop))
+                            return Fail("truncated face data");
+                        continue;
+                    }
+                    int64_t count = ReadListCount(prop);
+                    if (count < 0 || count * indexSize > (int64_t)BinaryFileReader::BlockSize)
+                        return Fail("truncated or invalid face data");
+                    const uint8_t* p = file.Read(size_t(count) * indexSize);
+                    if (!p)
+                        return Fail("truncated face data");
+
+                    polygon.resize((size_t)count);
+                    for (int64_t k = 0; k < count; ++k)
+                        polygon[k] = ReadIndex(p + k * indexSize, list.Type);
+                    for (int64_t k = 2; k < count; ++k)
+                    {
+                        if (g.Tris.size() >= (size_t)INT_MAX)
+                            return Fail("too many triangles");
+                        g.Tris.push_back({ { (int)polygon[0] }, { (int)polygon[k-1] }, { (int)polygon[k] } });
+                    }
+                }
+            }
+            return true;
+        }
+
+        bool SkipProperty(const PlyProperty& prop)
+        {
+            if (prop.CountType == PlyType::None)
+                return file.Skip(PlyTypeSize(prop.Type));
+            int64_t count = ReadListCount(prop);
+            return count >= 0 && file.Skip(uint64_t(count) * PlyTypeSize(prop.Type));
+        }
+
+        bool SkipElement(PlyElement e)
+        {
+            Layout(e);
+            if (e.RecordSize != 0)
+            {
+                if (!file.Skip(e.Count * e.RecordSize))
+                    return Fail("truncated " + e.Name + " element");
+                return true;
+            }
+            for (uint64_t i = 0; i < e.Count; ++i)
+                for (const PlyProperty& prop : e.Properties)
+                    if (!SkipProperty(prop))
+                        return Fail("truncated " + e.Name + " element");
+            return true;
+        }
+    };
+
+    bool Mesh::LoadPLY(rpp::strview meshPath, Options opt)
+    {
+        Clear();
+        Name = file_name(meshPath);
+        MeshGroup& g = CreateGroup(Name);
+
+        PlyReader reader { meshPath };
+        if (!reader.Read(g))
+        {
+            Clear();
+            NanoErr(opt, "Failed to load '%s': %s", meshPath, reader.error.c_str());
+        }
+
+        // PLY attributes are always per vertex
+        const bool hasCoords = !g.Coords.empty(), hasNormals = !g.Normals.empty(), hasColors = !g.Colors.empty();
+        for (Triangle& tri : g.Tris)
+        {
+            for (VertexDescr& vd : tri)
+            {
+                vd.t = hasCoords  ? vd.v : -1;
+                vd.n = hasNormals ? vd.v : -1;
+                vd.c = hasColors  ? vd.v : -1;
+            }
+        }
+        g.Winding = FaceWinding::CCW;
+        if (g.IsEmpty() && !(opt & Options::EmptyGroups))
+            Groups.clear();
+
+        if (opt & Options::Log) {
+            LogInfo("Load %-33s  %5d verts  %5d tris  %s",
+                    file_nameext(meshPath), TotalVerts(), TotalTris(), to_string(opt));
+        }
+        ApplyLoadOptions(opt);
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    static bool IsPerVertex(const MeshGroup& g)
+    {
+        auto perVertex = [&](MapMode mapping, size_t size) {
+            return mapping == MapMode::None || size == 0 || (mapping == MapMode::PerVertex && size == g.Verts.size());
+        };
+        return perVertex(g.CoordsMapping, g.Coords.size())
+            && perVertex(g.NormalsMapping, g.Normals.size())
+            && perVertex(g.ColorMapping, g.Colors.size());
+    }
+
+    static uint8_t ToUnorm8(float c)
+    {
+        return (uint8_t)std::lround(std::clamp(c, 0.0f, 1.0f) * 255.0f);
+    }
+
+    bool Mesh::SaveAsPLY(rpp::strview meshPath, Options opt) const
+    {
+        if (opt & Options::Log) {
+            LogInfo("Save %-33s  %5d verts  %5d tris",
+                file_nameext(meshPath), TotalVerts(), TotalTris());
+        }
+
+        // PLY attributes are per vertex, so shared or per face data is flattened first
+        std::vector<MeshGroup> flattened;
+        std::vector<const MeshGroup*> groups;
+        for (const MeshGroup& g : Groups)
+        {
+            if (g.IsEmpty())
+                continue;
+            if (IsPerVertex(g)) {
+                groups.push_back(&g);
+            } else {
+                MeshGroup& copy = flattened.emplace_back(g);
+                copy.OptimizedFlatten();
+            }
+        }
+        for (const MeshGroup& g : flattened)
+            groups.push_back(&g);
+
+        // PLY has no groups, so the layers of any group are written for all of them
+        uint64_t numVerts = 0, numTris = 0;
+        bool hasNormals = false, hasCoords = false, hasColors = false;
+        for (const MeshGroup* g : groups)
+        {
+            numVerts += g->Verts.size();
+            numTris  += g->Tris.size();
+            hasNormals |= !g->Normals.empty();
+            hasCoords  |= !g->Coords.empty();
+            hasColors  |= !g->Colors.empty();
+        }
+        if (numVerts > UINT32_MAX) {
+            NanoErr(opt, "Failed to save '%s': too many vertices", meshPath);
+        }
+
+        BinaryFileWriter file { meshPath };
+        if (!file) {
+            NanoErr(opt, "Failed to create file: %s", meshPath);
+        }
+
+        rpp::string_buffer header;
+        header.writeln("ply");
+        header.writeln("format binary_little_endian 1.0");
+        header.writeln("comment NanoMesh");
+        header.writef("element vertex %llu\n", (unsigned long long)numVerts);
+        header.writeln("property float x\nproperty float y\nproperty float z");
+        if (hasNormals) header.writeln("property float nx\nproperty float ny\nproperty float nz");
+        if (hasCoords)  header.writeln("property float s\nproperty float t");
+        if (hasColors)  header.writeln("property uchar red\nproperty uchar green\nproperty uchar blue");
+        header.writef("element face %llu\n", (unsigned long long)numTris);
+        header.writeln("property list uchar uint vertex_indices");
+        header.writeln("end_header");
+        file.Write(header.data(), header.size());
+
+        const size_t recordSize = sizeof(float) * (3 + (hasNormals ? 3 : 0) + (hasCoords ? 2 : 0))
+                                + (hasColors ? 3 : 0);
+        for (const MeshGroup* g : groups)
+        {
+            for (int i = 0; i < g->NumVerts(); ++i)
+            {
+                uint8_t* record = file.Reserve(recordSize);
+                float f[8]; int n = 0;
+                const rpp::Vector3& p = g->Verts[i];
+                f[n++] = p.x; f[n++] = p.y; f[n++] = p.z;
+                if (hasNormals) {
+                    rpp::Vector3 nrm = i < g->NumNormals() ? g->Normals[i] : rpp::Vector3::Zero();
+                    f[n++] = nrm.x; f[n++] = nrm.y; f[n++] = nrm.z;
+                }
+                if (hasCoords) {
+                    rpp::Vector2 uv = i < g->NumCoords() ? g->Coords[i] : rpp::Vector2::Zero();
+                    f[n++] = uv.x; f[n++] = uv.y;
+                }
+                memcpy(record, f, sizeof(float) * n);
+                if (hasColors) {
+                    rpp::Color3 c = i < g->NumColors() ? g->Colors[i] : rpp::Color3::White();
+                    record += sizeof(float) * n;
+                    record[0] = ToUnorm8(c.r); record[1] = ToUnorm8(c.g); record[2] = ToUnorm8(c.b);
+                }
+            }
+        }
+
+        uint32_t baseVertex = 0;
+        for (const MeshGroup* g : groups)
+        {
+            const bool flip = g->Winding == FaceWinding::CW; // PLY faces are CCW
+            for (const Triangle& tri : g->Tris)
+            {
+                uint8_t* record = file.Reserve(1 + 3 * sizeof(uint32_t));
+                uint32_t face[3] = {
+                    baseVertex + (uint32_t)tri.a.v,
+                    baseVertex + (uint32_t)(flip ? tri.c.v : tri.b.v),
+                    baseVertex + (uint32_t)(flip ? tri.b.v : tri.c.v),
+                };
+                record[0] = 3;
+                memcpy(record + 1, face, sizeof(face));
+            }
+            baseVertex += (uint32_t)g->Verts.size();
+        }
+
+        if (!file.Flush()) {
+            NanoErr(opt, "File write failed: %s", meshPath);
+        }
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,306 @@
+#include <Nano/Mesh.h>
+#include <cmath>
+#include <cstring>
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    // @param v Value in [0,1], out of range values are clamped
+    static int QuantizeUnorm(float v, int bits)
+    {
+        const float scale = float((1 << bits) - 1);
+        if (!(v > 0.0f)) return 0; // also NaN
+        if (v >= 1.0f) return int(scale);
+        return int(v * scale + 0.5f);
+    }
+
+    // IEEE 754 half float with round-to-nearest-even, out of range values become infinity
+    static uint16_t FloatToHalf(float value)
+    {
+        uint32_t f; memcpy(&f, &value, sizeof(f));
+        const uint32_t sign = (f >> 16) & 0x8000;
+        f &= 0x7FFFFFFF;
+
+        uint16_t h;
+        if (f >= ((127 + 16) << 23)) // overflow, inf or NaN
+        {
+            h = f > (255u << 23) ? 0x7E00 : 0x7C00;
+        }
+        else if (f < (113 << 23)) // half denormal, let the FPU do the rounding
+        {
+            const uint32_t magicBits = ((127 - 15) + (23 - 10) + 1) << 23;
+            float magic; memcpy(&magic, &magicBits, sizeof(magic));
+            float v; memcpy(&v, &f, sizeof(v));
+            v += magic;
+            memcpy(&f, &v, sizeof(f));
+            h = uint16_t(f - magicBits);
+        }
+        else
+        {
+            const uint32_t mantissaOdd = (f >> 13) & 1;
+            f += (uint32_t(15 - 127) << 23) + 0xFFF; // rebias the exponent and round
+            f += mantissaOdd;
+            h = uint16_t(f >> 13);
+        }
+        return uint16_t(h | sign);
+    }
+
+    static float HalfToFloat(uint16_t h)
+    {
+        const uint32_t sign = uint32_t(h & 0x8000) << 16;
+        const uint32_t exponent = (h >> 10) & 0x1F;
+        const uint32_t mantissa = h & 0x3FF;
+
+        uint32_t f;
+        if (exponent == 0) // zero or denormal
+        {
+            float v = float(mantissa) * (1.0f / 16777216.0f);
+            memcpy(&f, &v, sizeof(f));
+        }
+        else if (exponent == 31) // inf or NaN
+        {
+            f = 0x7F800000 | (mantissa << 13);
+        }
+        else
+        {
+            f = ((exponent + 112) << 23) | (mantissa << 13);
+        }
+        f |= sign;
+        float value; memcpy(&value, &f, sizeof(value));
+        return value;
+    }
+
+    static rpp::Vector3 Normalized(const rpp::Vector3& v)
+    {
+        float len = std::sqrt(v.x*v.x + v.y*v.y + v.z*v.z);
+        if (!(len > 0.0f)) return rpp::Vector3::Zero();
+        return { v.x / len, v.y / len, v.z / len };
+    }
+
+    static float Sign(float v) { return v >= 0.0f ? 1.0f : -1.0f; }
+
+    static void OctDecode(double x, double y, double d[3])
+    {
+        double z = 1.0 - std::abs(x) - std::abs(y);
+        if (z < 0.0)
+        {
+            double ox = (1.0 - std::abs(y)) * (x >= 0.0 ? 1.0 : -1.0);
+            double oy = (1.0 - std::abs(x)) * (y >= 0.0 ? 1.0 : -1.0);
+            x = ox; y = oy;
+        }
+        double len = std::sqrt(x*x + y*y + z*z);
+        d[0] = x / len; d[1] = y / len; d[2] = z / len;
+    }
+
+    /**
+     * Octahedral encoding of a unit vector into 2 snorm values.
+     * Rounding each component separately isn't always the closest code,
+     * so all 4 neighbouring codes are tried.
+     * @return Angle in radians between n and the decoded normal, in double precision,
+     *         because float cosines can't resolve snorm16 errors
+     */
+    static double OctEncode(const rpp::Vector3& n, int bits, int& outX, int& outY)
+    {
+        float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+        if (!(l1 > 0.0f)) { outX = outY = 0; return 0.0; }
+
+        float x = n.x / l1, y = n.y / l1;
+        if (n.z < 0.0f)
+        {
+            float ox = (1.0f - std::abs(y)) * Sign(x);
+            float oy = (1.0f - std::abs(x)) * Sign(y);
+            x = ox; y = oy;
+        }
+
+        const int maxCode = (1 << (bits - 1)) - 1;
+        const double scale = maxCode;
+        int baseX = int(std::floor(x * scale));
+        int baseY = int(std::floor(y * scale));
+        double best[3] = { 0.0, 0.0, 1.0 };
+        double bestDot = -2.0;
+        for (int dy = 0; dy <= 1; ++dy)
+        {
+            for (int dx = 0; dx <= 1; ++dx)
+            {
+                int cx = baseX + dx, cy = baseY + dy;
+                if (cx < -maxCode || cx > maxCode || cy < -maxCode || cy > maxCode)
+                    continue;
+                double d[3];
+                OctDecode(cx / scale, cy / scale, d);
+                double dot = d[0]*n.x + d[1]*n.y + d[2]*n.z;
+                if (dot > bestDot)
+                {
+                    bestDot = dot; outX = cx; outY = cy;
+                    best[0] = d[0]; best[1] = d[1]; best[2] = d[2];
+                }
+            }
+        }
+        double cx = best[1]*n.z - best[2]*n.y;
+        double cy = best[2]*n.x - best[0]*n.z;
+        double cz = best[0]*n.y - best[1]*n.x;
+        return std::atan2(std::sqrt(cx*cx + cy*cy + cz*cz), bestDot);
+    }
+
+    static float MaxAbsDiff(float maxError, float a, float b)
+    {
+        float diff = std::abs(a - b);
+        return diff > maxError ? diff : maxError; // NaN/inf inputs don't count as errors
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    void MeshGroup::CreateQuantizedVertexData(QuantizedVertexData& out, const QuantizeOptions& options) const noexcept
+    {
+        auto* meshVerts   = Verts.data();
+        auto* meshCoords  = Coords.data();
+        auto* meshNormals = Normals.data();
+        auto* meshColors  = Colors.empty() ? nullptr : Colors.data();
+
+        const bool normal8 = options.Normals == NormalQuantization::Snorm8;
+        const bool halfUV  = options.Coords == CoordQuantization::Half;
+        out.NormalFormat = options.Normals;
+        out.CoordFormat  = options.Coords;
+        out.NormalByteOffset = normal8 ? 6 : 8; // snorm8 fits in the pad after the 3x16 bit position
+        out.CoordByteOffset  = normal8 ? 8 : 12;
+        out.ColorByteOffset  = meshColors ? out.CoordByteOffset + 4 : -1;
+        out.Stride           = out.CoordByteOffset + (meshColors ? 8 : 4);
+
+        auto position = [&](const VertexDescr& vd) { return vd.v != -1 ? meshVerts[vd.v]  : rpp::Vector3::Zero(); };
+        auto coord    = [&](const VertexDescr& vd) { return vd.t != -1 ? meshCoords[vd.t] : rpp::Vector2::Zero(); };
+
+        // quantization ranges
+        rpp::Vector3 minPos = rpp::Vector3::Zero(), maxPos = rpp::Vector3::Zero();
+        rpp::Vector2 minUV  = rpp::Vector2::Zero(), maxUV  = rpp::Vector2::Zero();
+        bool first = true;
+        for (const Triangle& face : Tris)
+        {
+            for (const VertexDescr& vd : face)
+            {
+                rpp::Vector3 p = position(vd);
+                rpp::Vector2 t = coord(vd);
+                if (first) { minPos = maxPos = p; minUV = maxUV = t; first = false; continue; }
+                minPos.x = std::fmin(minPos.x, p.x); maxPos.x = std::fmax(maxPos.x, p.x);
+                minPos.y = std::fmin(minPos.y, p.y); maxPos.y = std::fmax(maxPos.y, p.y);
+                minPos.z = std::fmin(minPos.z, p.z); maxPos.z = std::fmax(maxPos.z, p.z);
+                minUV.x  = std::fmin(minUV.x, t.x);  maxUV.x  = std::fmax(maxUV.x, t.x);
+                minUV.y  = std::fmin(minUV.y, t.y);  maxUV.y  = std::fmax(maxUV.y, t.y);
+            }
+        }
+
+        out.PosOffset = minPos;
+        out.PosScale  = { maxPos.x - minPos.x, maxPos.y - minPos.y, maxPos.z - minPos.z };
+        if (halfUV)
+        {
+            out.CoordOffset = rpp::Vector2::Zero();
+            out.CoordScale  = rpp::Vector2::One();
+        }
+        else
+        {
+            out.CoordOffset = minUV;
+            out.CoordScale  = { maxUV.x - minUV.x, maxUV.y - minUV.y };
+        }
+
+        auto inverse = [](float extent) { return extent > 0.0f ? 1.0f / extent : 0.0f; };
+        const rpp::Vector3 invPos { inverse(out.PosScale.x), inverse(out.PosScale.y), inverse(out.PosScale.z) };
+        const rpp::Vector2 invUV  { inverse(out.CoordScale.x), inverse(out.CoordScale.y) };
+
+        const int numVerts = (int)Tris.size() * 3;
+        out.NumVertices = numVerts;
+        out.Vertices.assign(size_t(numVerts) * out.Stride, 0);
+        out.Indices.resize(size_t(numVerts));
+
+        float maxPosError = 0.0f, maxNormalError = 0.0f, maxCoordError = 0.0f, maxColorError = 0.0f;
+
+        // normals are shared by many corners and expensive to encode, so encode the layer once
+        std::vector<int16_t> octNormals(Normals.size() * 2);
+        for (size_t i = 0; i < Normals.size(); ++i)
+        {
+            int ox = 0, oy = 0;
+            float angle = float(OctEncode(Normalized(meshNormals[i]), normal8 ? 8 : 16, ox, oy));
+            if (angle > maxNormalError) maxNormalError = angle;
+            octNormals[i*2 + 0] = int16_t(ox);
+            octNormals[i*2 + 1] = int16_t(oy);
+        }
+        uint8_t* dst = out.Vertices.data();
+        int vertexId = 0;
+        for (const Triangle& face : Tris)
+        {
+            for (const VertexDescr& vd : face)
+            {
+                out.Indices[vertexId] = vertexId;
+                ++vertexId;
+
+                rpp::Vector3 p = position(vd);
+                uint16_t pos[3] = {
+                    uint16_t(QuantizeUnorm((p.x - minPos.x) * invPos.x, 16)),
+                    uint16_t(QuantizeUnorm((p.y - minPos.y) * invPos.y, 16)),
+                    uint16_t(QuantizeUnorm((p.z - minPos.z) * invPos.z, 16)),
+                };
+                memcpy(dst, pos, sizeof(pos));
+                maxPosError = MaxAbsDiff(maxPosError, p.x, minPos.x + out.PosScale.x * (pos[0] / 65535.0f));
+                maxPosError = MaxAbsDiff(maxPosError, p.y, minPos.y + out.PosScale.y * (pos[1] / 65535.0f));
+                maxPosError = MaxAbsDiff(maxPosError, p.z, minPos.z + out.PosScale.z * (pos[2] / 65535.0f));
+
+                int ox = 0, oy = 0;
+                if (vd.n != -1)
+                {
+                    ox = octNormals[vd.n*2 + 0];
+                    oy = octNormals[vd.n*2 + 1];
+                }
+                if (normal8)
+                {
+                    int8_t norm[2] = { int8_t(ox), int8_t(oy) };
+                    memcpy(dst + out.NormalByteOffset, norm, sizeof(norm));
+                }
+                else
+                {
+                    int16_t norm[2] = { int16_t(ox), int16_t(oy) };
+                    memcpy(dst + out.NormalByteOffset, norm, sizeof(norm));
+                }
+
+                rpp::Vector2 t = coord(vd);
+                uint16_t uv[2];
+                if (halfUV)
+                {
+                    uv[0] = FloatToHalf(t.x);
+                    uv[1] = FloatToHalf(t.y);
+                    maxCoordError = MaxAbsDiff(maxCoordError, t.x, HalfToFloat(uv[0]));
+                    maxCoordError = MaxAbsDiff(maxCoordError, t.y, HalfToFloat(uv[1]));
+                }
+                else
+                {
+                    uv[0] = uint16_t(QuantizeUnorm((t.x - minUV.x) * invUV.x, 16));
+                    uv[1] = uint16_t(QuantizeUnorm((t.y - minUV.y) * invUV.y, 16));
+                    maxCoordError = MaxAbsDiff(maxCoordError, t.x, minUV.x + out.CoordScale.x * (uv[0] / 65535.0f));
+                    maxCoordError = MaxAbsDiff(maxCoordError, t.y, minUV.y + out.CoordScale.y * (uv[1] / 65535.0f));
+                }
+                memcpy(dst + out.CoordByteOffset, uv, sizeof(uv));
+
+                if (meshColors)
+                {
+                    rpp::Color3 c = vd.c != -1 ? meshColors[vd.c] : rpp::Color3::White();
+                    uint8_t rgba[4] = {
+                        uint8_t(QuantizeUnorm(c.r, 8)),
+                        uint8_t(QuantizeUnorm(c.g, 8)),
+                        uint8_t(QuantizeUnorm(c.b, 8)),
+                        255,
+                    };
+                    memcpy(dst + out.ColorByteOffset, rgba, sizeof(rgba));
+                    maxColorError = MaxAbsDiff(maxColorError, c.r, rgba[0] / 255.0f);
+                    maxColorError = MaxAbsDiff(maxColorError, c.g, rgba[1] / 255.0f);
+                    maxColorError = MaxAbsDiff(maxColorError, c.b, rgba[2] / 255.0f);
+                }
+                dst += out.Stride;
+            }
+        }
+
+        const float radToDeg = 57.29577951f;
+        out.MaxPosError    = maxPosError;
+        out.MaxNormalError = maxNormalError * radToDeg;
+        out.MaxCoordError  = maxCoordError;
+        out.MaxColorError  = maxColorError;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
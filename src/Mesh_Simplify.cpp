@@ -0,0 +1,373 @@
+#include <Nano/Mesh.h>
+#include <algorithm>
+#include <cmath>
+#include "InternalConfig.h"
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    // Garland-Heckbert error quadric, sum of squared distances to a set of weighted planes
+    struct Quadric
+    {
+        double xx = 0, xy = 0, xz = 0, yy = 0, yz = 0, zz = 0;
+        double dx = 0, dy = 0, dz = 0, dd = 0;
+        double weight = 0;
+
+        static Quadric Plane(const rpp::Vector3& n, double d, double w) noexcept
+        {
+            Quadric q;
+            q.xx = w*n.x*n.x; q.xy = w*n.x*n.y; q.xz = w*n.x*n.z;
+            q.yy = w*n.y*n.y; q.yz = w*n.y*n.z; q.zz = w*n.z*n.z;
+            q.dx = w*n.x*d;   q.dy = w*n.y*d;   q.dz = w*n.z*d;
+            q.dd = w*d*d;
+            q.weight = w;
+            return q;
+        }
+
+        Quadric& operator+=(const Quadric& q) noexcept
+        {
+            xx += q.xx; xy += q.xy; xz += q.xz; yy += q.yy; yz += q.yz; zz += q.zz;
+            dx += q.dx; dy += q.dy; dz += q.dz; dd += q.dd;
+            weight += q.weight;
+            return *this;
+        }
+
+        // weighted sum of squared distances from p to the planes
+        double Error(const rpp::Vector3& p) const noexcept
+        {
+            double x = p.x, y = p.y, z = p.z;
+            double e = x*x*xx + y*y*yy + z*z*zz + 2*(x*y*xy + x*z*xz + y*z*yz)
+                     + 2*(x*dx + y*dy + z*dz) + dd;
+            return e > 0 ? e : 0;
+        }
+    };
+
+    static Quadric operator+(Quadric a, const Quadric& b) noexcept { return a += b; }
+
+    static bool SameAttributes(const VertexDescr& a, const VertexDescr& b) noexcept
+    {
+        return a.t == b.t && a.n == b.n && a.c == b.c;
+    }
+
+    static rpp::Vector3 TriangleNormal(const rpp::Vector3& a, const rpp::Vector3& b, const rpp::Vector3& c) noexcept
+    {
+        return (b - a).cross(c - a);
+    }
+
+    /**
+     * Half-edge collapse simplifier, every collapse moves a vertex onto one of its neighbors,
+     * so the simplified triangles only reference existing vertices and layer elements.
+     *
+     * Vertices are locked if they are on an open border, on a non-manifold edge,
+     * or if their corners don't all share the same UV, normal and color, which keeps
+     * UV seams, hard normal edges and the borders between groups exactly in place.
+     * Collapses are done in passes of independent edges in order of increasing error,
+     * which keeps the result deterministic.
+     */
+    class Simplifier
+    {
+        const MeshGroup& g;
+        std::vector<Triangle>& tris;
+        std::vector<char> dead;      // removed triangles
+        std::vector<int> offsets;    // vertex -> triangles CSR, rebuilt every pass
+        std::vector<int> adjacency;
+        std::vector<Quadric> quadrics;
+        std::vector<char> locked;
+        std::vector<int> stamps;     // scratch marks per vertex
+        int stamp = 0;
+        int liveTris = 0;
+
+        struct Collapse
+        {
+            double error;
+            int from, to;
+        };
+
+    public:
+        double MaxError = 0.0; // largest squared error of any collapse
+
+        Simplifier(const MeshGroup& g, std::vector<Triangle>& tris)
+            : g{ g }, tris{ tris }, dead(tris.size(), 0), quadrics(g.Verts.size()),
+              locked(g.Verts.size(), 0), stamps(g.Verts.size(), 0), liveTris{ (int)tris.size() }
+        {
+            const bool ccw = g.Winding == FaceWinding::CCW;
+            for (const Triangle& t : tris)
+            {
+                if (t.a.v == t.b.v || t.b.v == t.c.v || t.a.v == t.c.v)
+                {
+                    for (const VertexDescr& vd : t) locked[vd.v] = 1;
+                    continue;
+                }
+                const rpp::Vector3& p0 = g.Verts[(ccw ? t.a : t.c).v];
+                rpp::Vector3 n = TriangleNormal(p0, g.Verts[t.b.v], g.Verts[(ccw ? t.c : t.a).v]);
+                float area2 = n.length();
+                if (area2 <= 0.0f)
+                    continue;
+                n /= area2;
+                Quadric q = Quadric::Plane(n, -n.dot(p0), area2 * 0.5);
+                for (const VertexDescr& vd : t)
+                    quadrics[vd.v] += q;
+            }
+            BuildAdjacency();
+            LockSeamsAndBorders();
+        }
+
+        int NumLiveTris() const noexcept { return liveTris; }
+
+        /**
+         * Runs one pass of independent collapses
+         * @return Number of collapses, 0 if nothing can be collapsed within the limits
+         */
+        int Pass(int targetTris, double maxError)
+        {
+            std::vector<Collapse> collapses = PickCollapses(maxError);
+            std::stable_sort(collapses.begin(), collapses.end(),
+                             [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+            std::vector<char> touched(g.Verts.size(), 0);
+            int numCollapses = 0;
+            for (const Collapse& c : collapses)
+            {
+                if (liveTris <= targetTris)
+                    break;
+                if (touched[c.from] || touched[c.to])
+                    continue;
+                VertexDescr target;
+                if (!CanCollapse(c.from, c.to, target))
+                    continue;
+
+                for (int k = offsets[c.from]; k < offsets[c.from + 1]; ++k)
+                {
+                    const int tri = adjacency[k];
+                    if (dead[tri]) continue;
+                    Triangle& t = tris[tri];
+                    if (t.ContainsVertexId(c.to))
+                    {
+                        dead[tri] = 1;
+                        --liveTris;
+                        continue;
+                    }
+                    for (VertexDescr& vd : t)
+                        if (vd.v == c.from) vd = target;
+                }
+                quadrics[c.to] += quadrics[c.from];
+                locked[c.from] = 1; // gone for good
+                touched[c.from] = touched[c.to] = 1;
+                MaxError = std::max(MaxError, c.error);
+                ++numCollapses;
+            }
+
+            if (numCollapses)
+                BuildAdjacency();
+            return numCollapses;
+        }
+
+        void RemoveDeadTriangles()
+        {
+            size_t n = 0;
+            for (size_t i = 0; i < tris.size(); ++i)
+                if (!dead[i]) tris[n++] = tris[i];
+            tris.resize(n);
+            dead.assign(n, 0);
+        }
+
+    private:
+        void BuildAdjacency()
+        {
+            offsets.assign(g.Verts.size() + 1, 0);
+            for (size_t i = 0; i < tris.size(); ++i)
+                if (!dead[i])
+                    for (const VertexDescr& vd : tris[i]) ++offsets[vd.v + 1];
+            for (size_t v = 0; v < g.Verts.size(); ++v)
+                offsets[v + 1] += offsets[v];
+            adjacency.resize(offsets.back());
+            std::vector<int> cursor { offsets.begin(), offsets.end() - 1 };
+            for (size_t i = 0; i < tris.size(); ++i)
+                if (!dead[i])
+                    for (const VertexDescr& vd : tris[i]) adjacency[cursor[vd.v]++] = int(i);
+        }
+
+        void LockSeamsAndBorders()
+        {
+            std::vector<int> edgeCount(g.Verts.size(), 0);
+            std::vector<int> neighbors;
+            for (int v = 0; v < (int)g.Verts.size(); ++v)
+            {
+                const VertexDescr* first = nullptr;
+                neighbors.clear();
+                for (int k = offsets[v]; k < offsets[v + 1]; ++k)
+                {
+                    for (const VertexDescr& vd : tris[adjacency[k]])
+                    {
+                        if (vd.v == v)
+                        {
+                            if (!first) first = &vd;
+                            else if (!SameAttributes(*first, vd)) locked[v] = 1;
+                        }
+                        else
+                        {
+                            if (edgeCount[vd.v]++ == 0) neighbors.push_back(vd.v);
+                        }
+                    }
+                }
+                for (int w : neighbors)
+                {
+                    if (edgeCount[w] != 2) locked[v] = 1; // border or non-manifold edge
+                    edgeCount[w] = 0;
+                }
+            }
+        }
+
+        std::vector<Collapse> PickCollapses(double maxError) const
+        {
+            std::vector<Collapse> collapses;
+            for (int v = 0; v < (int)g.Verts.size(); ++v)
+            {
+                if (locked[v] || offsets[v] == offsets[v + 1])
+                    continue;
+                Collapse best { maxError, -1, -1 };
+                for (int k = offsets[v]; k < offsets[v + 1]; ++k)
+                {
+                    for (const VertexDescr& vd : tris[adjacency[k]])
+                    {
+                        if (vd.v == v) continue;
+                        const Quadric q = quadrics[v] + quadrics[vd.v];
+                        double error = q.weight > 0 ? q.Error(g.Verts[vd.v]) / q.weight : 0.0;
+                        if (error < best.error || (error == best.error && best.to == -1))
+                            best = { error, v, vd.v };
+                    }
+                }
+                if (best.to != -1)
+                    collapses.push_back(best);
+            }
+            return collapses;
+        }
+
+        bool CanCollapse(int from, int to, VertexDescr& target)
+        {
+            // the edge must have exactly two triangles, which agree on the attributes of `to`
+            int shared = 0;
+            for (int k = offsets[from]; k < offsets[from + 1]; ++k)
+            {
+                const int tri = adjacency[k];
+                if (dead[tri]) continue;
+                for (const VertexDescr& vd : tris[tri])
+                {
+                    if (vd.v != to) continue;
+                    if (shared++ == 0) target = vd;
+                    else if (!SameAttributes(target, vd)) return false;
+                }
+            }
+            if (shared != 2)
+                return false;
+
+            // link condition: only the two opposite vertices may be neighbors of both,
+            // otherwise the collapse creates non-manifold edges
+            ++stamp;
+            for (int k = offsets[from]; k < offsets[from + 1]; ++k)
+                if (!dead[adjacency[k]])
+                    for (const VertexDescr& vd : tris[adjacency[k]]) stamps[vd.v] = stamp;
+            ++stamp;
+            int common = 0;
+            for (int k = offsets[to]; k < offsets[to + 1]; ++k)
+            {
+                if (dead[adjacency[k]]) continue;
+                for (const VertexDescr& vd : tris[adjacency[k]])
+                {
+                    if (vd.v == from || vd.v == to || stamps[vd.v] != stamp - 1) continue;
+                    stamps[vd.v] = stamp; // count every common neighbor once
+                    ++common;
+                }
+            }
+            if (common != 2)
+                return false;
+
+            // the remaining triangles around `from` must not flip or collapse into slivers
+            const rpp::Vector3& p = g.Verts[to];
+            for (int k = offsets[from]; k < offsets[from + 1]; ++k)
+            {
+                const Triangle& t = tris[adjacency[k]];
+                if (dead[adjacency[k]] || t.ContainsVertexId(to)) continue;
+                const rpp::Vector3& a = g.Verts[t.a.v];
+                const rpp::Vector3& b = g.Verts[t.b.v];
+                const rpp::Vector3& c = g.Verts[t.c.v];
+                rpp::Vector3 before = TriangleNormal(a, b, c);
+                rpp::Vector3 after = TriangleNormal(t.a.v == from ? p : a,
+                                                    t.b.v == from ? p : b,
+                                                    t.c.v == from ? p : c);
+                if (after.dot(before) <= 0.25f * after.length() * before.length())
+                    return false;
+            }
+            return true;
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    static float GroupExtent(const MeshGroup& g) noexcept
+    {
+        rpp::BoundingBox bounds = rpp::BoundingBox::create(g.Verts);
+        rpp::Vector3 size = bounds.max - bounds.min;
+        return std::max(size.x, std::max(size.y, size.z));
+    }
+
+    // @return Relative error of the simplified triangles
+    static float SimplifyTris(const MeshGroup& g, std::vector<Triangle>& tris, int targetTris, float maxError)
+    {
+        const float extent = GroupExtent(g);
+        if (tris.empty() || extent <= 0.0f)
+            return 0.0f;
+
+        const double maxAbsError = double(maxError) * extent;
+        Simplifier simplifier { g, tris };
+        while (simplifier.NumLiveTris() > targetTris &&
+               simplifier.Pass(targetTris, maxAbsError * maxAbsError) > 0)
+        {
+        }
+        simplifier.RemoveDeadTriangles();
+        return float(std::sqrt(simplifier.MaxError) / extent);
+    }
+
+    static int TargetTris(int numTris, const SimplifyOptions& opt) noexcept
+    {
+        if (opt.TargetTris > 0)
+            return opt.TargetTris;
+        return int(numTris * std::max(opt.TargetRatio, 0.0f));
+    }
+
+    float MeshGroup::Simplify(const SimplifyOptions& opt) noexcept
+    {
+        return SimplifyTris(*this, Tris, TargetTris(NumTris(), opt), opt.MaxError);
+    }
+
+    std::vector<MeshLod> MeshGroup::CreateLodChain(int numLevels, float reduction, float maxError) const noexcept
+    {
+        std::vector<MeshLod> lods;
+        if (numLevels <= 0)
+            return lods;
+        lods.push_back({ Tris, 0.0f });
+
+        // every level starts from the full detail triangles, so its error is measured
+        // against the original surface instead of the previous level
+        float ratio = 1.0f;
+        for (int level = 1; level < numLevels; ++level)
+        {
+            ratio *= reduction;
+            MeshLod lod { Tris, 0.0f };
+            lod.Error = SimplifyTris(*this, lod.Tris, int(NumTris() * ratio), maxError);
+            if (lod.Tris.size() >= lods.back().Tris.size())
+                break; // the error budget doesn't allow any further reduction
+            lods.push_back(std::move(lod));
+        }
+        return lods;
+    }
+
+    void Mesh::Simplify(const SimplifyOptions& opt) noexcept
+    {
+        for (MeshGroup& group : Groups)
+            group.Simplify(opt);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
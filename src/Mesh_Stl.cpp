@@ -0,0 +1,173 @@
+#include <Nano/Mesh.h>
+#include <rpp/sprint.h>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include "InternalConfig.h"
+#include "BinaryFile.h"
+#include "PositionWeld.h"
+
+namespace Nano
+{
+    using namespace rpp::literals;
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Binary STL, all values are little endian:
+     *
+     *   char     header[80]  free text, must not start with "solid" which marks ASCII STL
+     *   uint32   numTriangles
+     *   StlTriangle[numTriangles]
+     *
+     * STL is an unindexed triangle soup, so without Options::WeldPositions
+     * every triangle has 3 vertices of its own.
+     */
+    static constexpr size_t StlHeaderSize = 80;
+
+    #pragma pack(push, 1)
+    struct StlTriangle
+    {
+        float Normal[3];
+        float Verts[3][3];
+        uint16_t Attributes;
+    };
+    #pragma pack(pop)
+    static_assert(sizeof(StlTriangle) == 50, "STL triangle records are 50 bytes");
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    bool Mesh::LoadSTL(rpp::strview meshPath, Options opt)
+    {
+        Clear();
+
+        BinaryFileReader file { meshPath };
+        if (!file) {
+            NanoErr(opt, "Failed to open file: %s", meshPath);
+        }
+
+        const uint8_t* header = file.Read(StlHeaderSize + sizeof(uint32_t));
+        uint32_t numTris = 0;
+        if (header) memcpy(&numTris, header + StlHeaderSize, sizeof(numTris));
+        uint64_t expectedSize = StlHeaderSize + sizeof(uint32_t) + uint64_t(numTris) * sizeof(StlTriangle);
+        if (!header || (uint64_t)file.FileSize() < expectedSize)
+        {
+            if (header && rpp::strview{ (const char*)header, 5 } == "solid"_sv) {
+                NanoErr(opt, "Failed to load '%s': ASCII STL is not supported", meshPath);
+            }
+            NanoErr(opt, "Failed to load '%s': truncated or invalid binary STL", meshPath);
+        }
+        // both modes index Tris, Normals and corners with int, even if welding shares the verts
+        if (uint64_t(numTris) * 3 > INT_MAX) {
+            NanoErr(opt, "Failed to load '%s': %u triangles is too many", meshPath, numTris);
+        }
+        const bool weld = opt & Options::WeldPositions;
+
+        Name = file_name(meshPath);
+        MeshGroup& g = CreateGroup(Name);
+        g.Tris.resize(numTris);
+        g.Normals.resize(numTris);
+        if (!weld)
+            g.Verts.resize(size_t(numTris) * 3);
+        PositionWeldTable welded { g.Verts, weld ? numTris / 2 : 0 }; // closed meshes have ~tris/2 verts
+
+        bool hasNormals = false;
+        int faceId = 0;
+        const uint8_t* records;
+        while (size_t count = file.ReadRecords(sizeof(StlTriangle), numTris - faceId, records))
+        {
+            for (size_t r = 0; r < count; ++r, ++faceId)
+            {
+                StlTriangle t;
+                memcpy(&t, records + r * sizeof(StlTriangle), sizeof(t));
+                rpp::Vector3& n = g.Normals[faceId];
+                n = { t.Normal[0], t.Normal[1], t.Normal[2] };
+                hasNormals |= n.x != 0.0f || n.y != 0.0f || n.z != 0.0f;
+
+                Triangle& tri = g.Tris[faceId];
+                for (int k = 0; k < 3; ++k)
+                {
+                    rpp::Vector3 p { t.Verts[k][0], t.Verts[k][1], t.Verts[k][2] };
+                    int v;
+                    if (weld) {
+                        v = welded.Insert(p);
+                    } else {
+                        v = faceId * 3 + k;
+                        g.Verts[v] = p;
+                    }
+                    tri[k] = { v, -1, faceId, -1 };
+                }
+            }
+        }
+        if (faceId != (int)numTris) {
+            Clear();
+            NanoErr(opt, "Failed to load '%s': truncated binary STL", meshPath);
+        }
+
+        // most exporters leave the facet normals empty
+        if (hasNormals) {
+            g.NormalsMapping = MapMode::PerFace;
+        } else {
+            g.Normals.clear();
+            for (Triangle& tri : g.Tris)
+                for (VertexDescr& vd : tri)
+                    vd.n = -1;
+        }
+        g.Winding = FaceWinding::CCW;
+
+        if (opt & Options::Log) {
+            LogInfo("Load %-33s  %5d verts  %5d tris  %s",
+                    file_nameext(meshPath), TotalVerts(), TotalTris(), to_string(opt));
+        }
+        ApplyLoadOptions(opt);
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    bool Mesh::SaveAsSTL(rpp::strview meshPath, Options opt) const
+    {
+        if (opt & Options::Log) {
+            LogInfo("Save %-33s  %5d verts  %5d tris",
+                file_nameext(meshPath), TotalVerts(), TotalTris());
+        }
+
+        BinaryFileWriter file { meshPath };
+        if (!file) {
+            NanoErr(opt, "Failed to create file: %s", meshPath);
+        }
+
+        char header[StlHeaderSize] = {};
+        snprintf(header, sizeof(header), "NanoMesh binary STL: %s", Name.c_str());
+        file.Write(header, sizeof(header));
+        file.Write((uint32_t)TotalTris());
+
+        // STL has no groups, every group goes into the same triangle soup
+        for (const MeshGroup& g : Groups)
+        {
+            const rpp::Vector3* verts = g.Verts.data();
+            const bool flip = g.Winding == FaceWinding::CW; // STL is always CCW
+            for (const Triangle& tri : g.Tris)
+            {
+                const rpp::Vector3& a = verts[tri.a.v];
+                const rpp::Vector3& b = verts[flip ? tri.c.v : tri.b.v];
+                const rpp::Vector3& c = verts[flip ? tri.b.v : tri.c.v];
+                rpp::Vector3 n = (b - a).cross(c - a);
+                float len = n.length();
+                n = len > 0.0f ? n / len : rpp::Vector3::Zero();
+
+                StlTriangle t = {
+                    { n.x, n.y, n.z },
+                    { { a.x, a.y, a.z }, { b.x, b.y, b.z }, { c.x, c.y, c.z } },
+                    0
+                };
+                memcpy(file.Reserve(sizeof(t)), &t, sizeof(t));
+            }
+        }
+        if (!file.Flush()) {
+            NanoErr(opt, "File write failed: %s", meshPath);
+        }
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
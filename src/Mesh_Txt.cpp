@@ -4,6 +4,8 @@
 #include <rpp/timer.h>
 #include <cstdlib>
 #include "InternalConfig.h"
+#include "FileSource.h"
+#include "NumberScanner.h"
 
 namespace Nano
 {
@@ -23,65 +25,63 @@ namespace Nano
         return elements.data() + oldSize;
     }
 
-    static void ParseVerts(MeshGroup& g, rpp::strview line, rpp::buffer_line_parser& parser)
+    static void ParseVerts(MeshGroup& g, rpp::strview line, rpp::line_parser& parser)
     {
         int numVerts = SkipAndParse(line);
         rpp::Vector3* verts = ExpandArray(g.Verts, numVerts);
         for (int i = 0; i < numVerts && parser.read_line(line); ++i) {
             rpp::Vector3& v = verts[i];
-            line >> v.x >> v.y >> v.z;
+            NumberScanner{line} >> v.x >> v.y >> v.z;
         }
     }
 
-    static void ParseCoords(MeshGroup& g, rpp::strview line, rpp::buffer_line_parser& parser)
+    static void ParseCoords(MeshGroup& g, rpp::strview line, rpp::line_parser& parser)
     {
         int numCoords = SkipAndParse(line);
         rpp::Vector2* coords = ExpandArray(g.Coords, numCoords);
         for (int i = 0; i < numCoords && parser.read_line(line); ++i) {
             rpp::Vector2& c = coords[i];
-            line >> c.x >> c.y;
+            NumberScanner{line} >> c.x >> c.y;
         }
     }
 
-    static void ParseNormals(MeshGroup& g, rpp::strview line, rpp::buffer_line_parser& parser)
+    static void ParseNormals(MeshGroup& g, rpp::strview line, rpp::line_parser& parser)
     {
         int numNormals = SkipAndParse(line);
         rpp::Vector3* normals = ExpandArray(g.Normals, numNormals);
         for (int i = 0; i < numNormals && parser.read_line(line); ++i) {
             rpp::Vector3& n = normals[i];
-            line >> n.x >> n.y >> n.z;
+            NumberScanner{line} >> n.x >> n.y >> n.z;
         }
     }
 
-    static void ParsePolys(MeshGroup& g, rpp::strview line, rpp::buffer_line_parser& parser)
+    static void ParsePolys(MeshGroup& g, rpp::strview line, rpp::line_parser& parser)
     {
         int numPolys = SkipAndParse(line);
         g.Tris.reserve(g.Tris.size() + (numPolys * 2)); // assume we are getting 4-point polys
 
-        auto parseDescr = [&](VertexDescr& vd, rpp::strview vertdescr) {
-            if (rpp::strview v = vertdescr.next('/')) {
-                vd.v = v.to_int() - 1;
-            }
-            if (rpp::strview t = vertdescr.next('/')) {
-                vd.t = t.to_int() - 1;
-            }
-            if (rpp::strview n = vertdescr) {
-                vd.n = n.to_int() - 1;
+        auto parseDescr = [](VertexDescr& vd, NumberScanner& scanner) {
+            int v, t, n; // 0 if missing
+            if (scanner.FaceVertex(v, t, n)) {
+                if (v) vd.v = v - 1;
+                if (t) vd.t = t - 1;
+                if (n) vd.n = n - 1;
             }
         };
 
         for (int i = 0; i < numPolys && parser.read_line(line); ++i)
         {
             Triangle* t = &rpp::emplace_back(g.Tris);
+            NumberScanner scanner { line };
 
             // parse first triangle
-            parseDescr(t->a, line.next(' '));
-            parseDescr(t->b, line.next(' '));
-            parseDescr(t->c, line.next(' '));
+            parseDescr(t->a, scanner);
+            parseDescr(t->b, scanner);
+            parseDescr(t->c, scanner);
 
             // when encountering quads or large polygons, we need to triangulate the mesh
             // by tracking the first vertex descr and forming a fan; this requires convex polys
-            while (rpp::strview vertdescr = line.next(' '))
+            while (scanner.HasMore())
             {
                 // face vertices are in CCW order:
                 // 0--3
@@ -94,7 +94,7 @@ namespace Nano
                 t = &rpp::emplace_back(g.Tris);
                 t->a = vd0;
                 t->b = vd2;
-                parseDescr(t->c, vertdescr);
+                parseDescr(t->c, scanner);
             }
         }
     }
@@ -131,10 +131,14 @@ namespace Nano
     {
         Clear();
 
-        auto parser = rpp::buffer_line_parser::from_file(meshPath);
-        if (!parser) {
+        FileSource file { meshPath, opt & Options::MemoryMap };
+        if (!file) {
             NanoErr(opt, "Failed to open file: %s", meshPath);
         }
+        if (file.len > FileSource::MaxWindowSize) {
+            NanoErr(opt, "Failed to load '%s': TXT files over 1GB are not supported", meshPath);
+        }
+        rpp::line_parser parser = file.Lines();
 
         if (opt & Options::Log) {
             LogInfo("Load %s", file_nameext(meshPath));
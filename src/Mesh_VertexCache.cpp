@@ -0,0 +1,166 @@
+#include <Nano/Mesh.h>
+#include "InternalConfig.h"
+#include "Hash.h"
+#include "MeshOptimize.h"
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    int CornerVertexIds(const MeshGroup& g, std::vector<int>& ids)
+    {
+        const int numCorners = g.NumTris() * 3;
+        ids.resize(numCorners);
+        CornerTable table { g.Tris.data(), g.Verts.size() };
+        int numVertices = 0;
+        for (int corner = 0; corner < numCorners; ++corner)
+        {
+            int first = table.Insert(corner);
+            ids[corner] = first == corner ? numVertices++ : ids[first];
+        }
+        return numVertices;
+    }
+
+    VertexCacheStats SimulateVertexCache(const std::vector<int>& ids, int numVertices, int cacheSize)
+    {
+        // a vertex is in the FIFO until cacheSize more vertices were added after it
+        std::vector<int> addedAt(numVertices, 0);
+        int time = cacheSize + 1, misses = 0;
+        for (int id : ids)
+        {
+            if (time - addedAt[id] > cacheSize)
+            {
+                addedAt[id] = time++;
+                ++misses;
+            }
+        }
+
+        VertexCacheStats stats;
+        const int numTris = int(ids.size() / 3);
+        if (numTris)     stats.ACMR = float(misses) / numTris;
+        if (numVertices) stats.ATVR = float(misses) / numVertices;
+        return stats;
+    }
+
+    /**
+     * Tipsify triangle order (Sander, Nehab, Barczak 2007, "Fast Triangle Reordering
+     * for Vertex Locality and Reduced Overdraw"). Triangles are emitted as fans around
+     * a fanning vertex, and the next fanning vertex is the neighbor which will still be
+     * in the cache after all of its remaining triangles are emitted. Runs in linear time.
+     * @return Triangle indices in their new order
+     */
+    static std::vector<int> TipsifyOrder(const std::vector<int>& ids, int numVertices, int cacheSize)
+    {
+        const int numTris = int(ids.size() / 3);
+
+        // vertex -> triangles adjacency
+        std::vector<int> offsets(size_t(numVertices) + 1, 0);
+        for (int id : ids) ++offsets[id + 1];
+        for (int v = 0; v < numVertices; ++v) offsets[v + 1] += offsets[v];
+        std::vector<int> adjacency(ids.size());
+        {
+            std::vector<int> cursor { offsets.begin(), offsets.end() - 1 };
+            for (size_t corner = 0; corner < ids.size(); ++corner)
+                adjacency[cursor[ids[corner]]++] = int(corner / 3);
+        }
+
+        std::vector<int> live(numVertices); // number of triangles not emitted yet
+        for (int v = 0; v < numVertices; ++v) live[v] = offsets[v + 1] - offsets[v];
+        std::vector<int> cachedAt(numVertices, 0);
+        std::vector<char> emitted(numTris, 0);
+        std::vector<int> deadEnds; // recently used vertices, to continue from when a fan runs out
+        std::vector<int> candidates;
+        std::vector<int> order; order.reserve(numTris);
+
+        int fanning = numVertices ? 0 : -1;
+        int time = cacheSize + 1;
+        int cursor = 1; // next vertex in input order, for when the dead end stack runs out
+        while (fanning >= 0)
+        {
+            candidates.clear();
+            for (int k = offsets[fanning]; k < offsets[fanning + 1]; ++k)
+            {
+                const int tri = adjacency[k];
+                if (emitted[tri]) continue;
+                for (int i = 0; i < 3; ++i)
+                {
+                    const int v = ids[tri * 3 + i];
+                    deadEnds.push_back(v);
+                    candidates.push_back(v);
+                    --live[v];
+                    if (time - cachedAt[v] > cacheSize)
+                        cachedAt[v] = time++;
+                }
+                emitted[tri] = 1;
+                order.push_back(tri);
+            }
+
+            // prefer the candidate that stays in the cache and has the oldest cache entry
+            int next = -1, bestPriority = -1;
+            for (int v : candidates)
+            {
+                if (live[v] <= 0) continue;
+                int priority = 0;
+                if (time - cachedAt[v] + 2 * live[v] <= cacheSize)
+                    priority = time - cachedAt[v];
+                if (priority > bestPriority) {
+                    bestPriority = priority;
+                    next = v;
+                }
+            }
+            while (next == -1 && !deadEnds.empty())
+            {
+                int v = deadEnds.back(); deadEnds.pop_back();
+                if (live[v] > 0) next = v;
+            }
+            for (; next == -1 && cursor < numVertices; ++cursor)
+                if (live[cursor] > 0) next = cursor;
+            fanning = next;
+        }
+        return order;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    VertexCacheStats MeshGroup::AnalyzeVertexCache(int cacheSize) const noexcept
+    {
+        std::vector<int> ids;
+        int numVertices = CornerVertexIds(*this, ids);
+        return SimulateVertexCache(ids, numVertices, cacheSize);
+    }
+
+    VertexCacheReport MeshGroup::OptimizeVertexCache(int cacheSize) noexcept
+    {
+        std::vector<int> ids;
+        const int numVertices = CornerVertexIds(*this, ids);
+        VertexCacheReport report;
+        report.Before = report.After = SimulateVertexCache(ids, numVertices, cacheSize);
+        if (Tris.size() < 2 || cacheSize < 3)
+            return report;
+
+        std::vector<int> order = TipsifyOrder(ids, numVertices, cacheSize);
+        std::vector<int> newIds(ids.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            for (int k = 0; k < 3; ++k)
+                newIds[i*3 + k] = ids[order[i]*3 + k];
+
+        VertexCacheStats after = SimulateVertexCache(newIds, numVertices, cacheSize);
+        if (after.ACMR >= report.Before.ACMR)
+            return report; // already optimized, keep the original order
+
+        std::vector<Triangle> tris(Tris.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            tris[i] = Tris[order[i]];
+        Tris = std::move(tris);
+        report.After = after;
+        return report;
+    }
+
+    void Mesh::OptimizeVertexCache(int cacheSize) noexcept
+    {
+        for (MeshGroup& group : Groups)
+            group.OptimizeVertexCache(cacheSize);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,115 @@
+#include <Nano/Mesh.h>
+#include "InternalConfig.h"
+#include "MeshOptimize.h"
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    PerVertexLayers::PerVertexLayers(const MeshGroup& g) noexcept
+    {
+        const int numVerts = g.NumVerts();
+        Coords  = g.CoordsMapping  == MapMode::PerVertex && g.NumCoords()  == numVerts;
+        Normals = g.NormalsMapping == MapMode::PerVertex && g.NumNormals() == numVerts;
+        Colors  = g.ColorMapping   == MapMode::PerVertex && g.NumColors()  == numVerts;
+    }
+
+    void RemapCorners(std::vector<Triangle>& tris, const PerVertexLayers& perVertex,
+                      const std::vector<int>& vertexRemap, const std::vector<int>& coordRemap,
+                      const std::vector<int>& normalRemap, const std::vector<int>& colorRemap)
+    {
+        auto remapIndex = [&](int& index, bool perVertexLayer, const std::vector<int>& layerRemap)
+        {
+            if (index == -1) return;
+            if (perVertexLayer)           index = vertexRemap[index];
+            else if (!layerRemap.empty()) index = layerRemap[index];
+        };
+        for (Triangle& tri : tris)
+        {
+            for (VertexDescr& vd : tri)
+            {
+                vd.v = vertexRemap[vd.v];
+                remapIndex(vd.t, perVertex.Coords,  coordRemap);
+                remapIndex(vd.n, perVertex.Normals, normalRemap);
+                remapIndex(vd.c, perVertex.Colors,  colorRemap);
+            }
+        }
+    }
+
+    /**
+     * Numbers the elements of a layer in the order Tris first use them.
+     * Unused elements keep their relative order after all used elements.
+     * @param layerIndex Selects the layer index of a VertexDescr, -1 is ignored
+     * @return Remap table from old to new element index
+     */
+    template<class LayerIndex>
+    static std::vector<int> FirstUseRemap(int count, const std::vector<Triangle>& tris, const LayerIndex& layerIndex)
+    {
+        std::vector<int> remap(count, -1);
+        int next = 0;
+        for (const Triangle& tri : tris)
+        {
+            for (const VertexDescr& vd : tri)
+            {
+                int index = layerIndex(vd);
+                if (index != -1 && remap[index] == -1)
+                    remap[index] = next++;
+            }
+        }
+        for (int& index : remap)
+            if (index == -1) index = next++;
+        return remap;
+    }
+
+    template<class T> static void ReorderLayer(std::vector<T>& items, const std::vector<int>& remap)
+    {
+        std::vector<T> reordered(items.size());
+        for (size_t i = 0; i < items.size(); ++i)
+            reordered[remap[i]] = items[i];
+        items = std::move(reordered);
+    }
+
+    std::vector<int> MeshGroup::OptimizeVertexFetch() noexcept
+    {
+        const int numVerts = NumVerts();
+        const PerVertexLayers perVertex { *this };
+
+        std::vector<int> vertexRemap = FirstUseRemap(numVerts, Tris, [](const VertexDescr& vd) { return vd.v; });
+        ReorderLayer(Verts, vertexRemap);
+        if (perVertex.Coords)  ReorderLayer(Coords,  vertexRemap);
+        if (perVertex.Normals) ReorderLayer(Normals, vertexRemap);
+        if (perVertex.Colors)  ReorderLayer(Colors,  vertexRemap);
+        if ((int)Weights.size() == numVerts) ReorderLayer(Weights, vertexRemap);
+        if (NumBlendIndices() == numVerts)   ReorderLayer(BlendIndices, vertexRemap);
+        if (NumBlendWeights() == numVerts)   ReorderLayer(BlendWeights, vertexRemap);
+
+        // independently indexed layers get their own first use order
+        std::vector<int> coordRemap, normalRemap, colorRemap;
+        if (!perVertex.Coords && !Coords.empty())
+        {
+            coordRemap = FirstUseRemap(NumCoords(), Tris, [](const VertexDescr& vd) { return vd.t; });
+            ReorderLayer(Coords, coordRemap);
+        }
+        if (!perVertex.Normals && !Normals.empty())
+        {
+            normalRemap = FirstUseRemap(NumNormals(), Tris, [](const VertexDescr& vd) { return vd.n; });
+            ReorderLayer(Normals, normalRemap);
+        }
+        if (!perVertex.Colors && !Colors.empty())
+        {
+            colorRemap = FirstUseRemap(NumColors(), Tris, [](const VertexDescr& vd) { return vd.c; });
+            ReorderLayer(Colors, colorRemap);
+        }
+
+        RemapCorners(Tris, perVertex, vertexRemap, coordRemap, normalRemap, colorRemap);
+        return vertexRemap;
+    }
+
+    void Mesh::OptimizeVertexFetch() noexcept
+    {
+        for (MeshGroup& group : Groups)
+            group.OptimizeVertexFetch();
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,269 @@
+#include <Nano/Mesh.h>
+#include <cmath>
+#include <cstring>
+#include "InternalConfig.h"
+#include "MeshOptimize.h"
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Spatial hash grid of N-dimensional welded points.
+     * Every inserted point either matches an existing point whose components all differ
+     * by at most `epsilon`, or becomes a new unique point. The grid cells are `epsilon`
+     * sized, so only the 3^N neighboring cells need to be searched for a match.
+     * With epsilon == 0 points must be bitwise identical, +0.0 and -0.0 are the same.
+     */
+    template<int N> class WeldGrid
+    {
+        struct Cell
+        {
+            int64_t key[N];
+            int head; // most recently added point in this cell, -1 if the slot is empty
+        };
+
+        float epsilon;
+        float invEpsilon;
+        std::vector<Cell> cells;
+        size_t mask = 0;
+        size_t numCells = 0;
+        std::vector<float> points; // N floats per unique point
+        std::vector<int> next;     // next point in the same cell
+
+        static int64_t Bits(float f) noexcept
+        {
+            uint32_t u; memcpy(&u, &f, sizeof(u));
+            return u == 0x80000000u ? 0 : int64_t(u); // -0.0 --> +0.0
+        }
+
+        static size_t Hash(const int64_t* key) noexcept
+        {
+            uint64_t h = 0x9E3779B97F4A7C15ull;
+            for (int i = 0; i < N; ++i)
+                h = (h ^ (h >> 32) ^ uint64_t(key[i])) * 0xC2B2AE3D27D4EB4Full;
+            return size_t(h ^ (h >> 29));
+        }
+
+        void MakeKey(const float* p, int64_t* key) const noexcept
+        {
+            for (int i = 0; i < N; ++i)
+                key[i] = epsilon == 0.0f ? Bits(p[i]) : (int64_t)std::floor(p[i] * invEpsilon);
+        }
+
+        Cell& FindCell(const int64_t* key) noexcept
+        {
+            size_t slot = Hash(key) & mask;
+            for (;; slot = (slot + 1) & mask)
+            {
+                Cell& cell = cells[slot];
+                if (cell.head == -1 || memcmp(cell.key, key, sizeof(cell.key)) == 0)
+                    return cell;
+            }
+        }
+
+        void Grow()
+        {
+            std::vector<Cell> old = std::move(cells);
+            cells.assign(old.size() * 2, Cell{ {}, -1 });
+            mask = cells.size() - 1;
+            for (const Cell& cell : old)
+                if (cell.head != -1)
+                    FindCell(cell.key) = cell;
+        }
+
+        bool Matches(const float* p, int point) const noexcept
+        {
+            const float* q = &points[size_t(point) * N];
+            for (int i = 0; i < N; ++i)
+            {
+                if (epsilon == 0.0f ? Bits(p[i]) != Bits(q[i]) : !(std::abs(p[i] - q[i]) <= epsilon))
+                    return false;
+            }
+            return true;
+        }
+
+        template<class Accept> int FindInCell(const float* p, const int64_t* key, const Accept& accept) noexcept
+        {
+            for (int point = FindCell(key).head; point != -1; point = next[point])
+                if (Matches(p, point) && accept(point))
+                    return point;
+            return -1;
+        }
+
+    public:
+        WeldGrid(float epsilon, size_t expectedPoints)
+            : epsilon{ epsilon > 0.0f ? epsilon : 0.0f }, invEpsilon{ epsilon > 0.0f ? 1.0f / epsilon : 0.0f }
+        {
+            size_t capacity = 1024;
+            while (capacity < expectedPoints * 2) capacity *= 2;
+            cells.assign(capacity, Cell{ {}, -1 });
+            mask = capacity - 1;
+            points.reserve(expectedPoints * N);
+            next.reserve(expectedPoints);
+        }
+
+        int NumPoints() const noexcept { return (int)next.size(); }
+
+        /**
+         * @param accept accept(int point) can reject a matching point, for example if
+         *               the other attributes of the two vertices differ
+         * @return Index of the matching unique point, or of the new unique point
+         */
+        template<class Accept> int Insert(const float* p, const Accept& accept)
+        {
+            int64_t key[N];
+            MakeKey(p, key);
+            if (epsilon == 0.0f)
+            {
+                int found = FindInCell(p, key, accept);
+                if (found != -1) return found;
+            }
+            else // search all neighboring cells, odometer style over the offsets -1, 0, +1
+            {
+                int offsets[N];
+                for (int& o : offsets) o = -1;
+                for (;;)
+                {
+                    int64_t neighbor[N];
+                    for (int i = 0; i < N; ++i)
+                        neighbor[i] = key[i] + offsets[i];
+                    int found = FindInCell(p, neighbor, accept);
+                    if (found != -1) return found;
+
+                    int i = 0;
+                    while (i < N && offsets[i] == 1) offsets[i++] = -1;
+                    if (i == N) break;
+                    ++offsets[i];
+                }
+            }
+
+            const int point = NumPoints();
+            points.insert(points.end(), p, p + N);
+            Cell& cell = FindCell(key);
+            if (cell.head == -1)
+            {
+                memcpy(cell.key, key, sizeof(cell.key));
+                ++numCells;
+            }
+            next.push_back(cell.head);
+            cell.head = point;
+            if (numCells * 2 > cells.size()) // keep the load factor below 0.5
+                Grow();
+            return point;
+        }
+
+        int Insert(const float* p)
+        {
+            return Insert(p, [](int) { return true; });
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Merges the elements of an independently indexed layer
+     * @return Remap table from old to new element index
+     */
+    template<int N, class T> static std::vector<int> WeldLayer(std::vector<T>& items, float epsilon)
+    {
+        static_assert(sizeof(T) == N * sizeof(float), "layer elements must be N floats");
+        WeldGrid<N> grid { epsilon, items.size() };
+        std::vector<int> remap(items.size());
+        std::vector<T> unique;
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            int point = grid.Insert((const float*)&items[i]);
+            if (point == (int)unique.size())
+                unique.push_back(items[i]);
+            remap[i] = point;
+        }
+        items = std::move(unique);
+        return remap;
+    }
+
+    // copies per vertex layer elements of every first vertex of a weld group
+    template<class T> static void CompactPerVertex(std::vector<T>& items, const std::vector<int>& firstVertex)
+    {
+        if (items.empty())
+            return;
+        std::vector<T> welded(firstVertex.size());
+        for (size_t i = 0; i < firstVertex.size(); ++i)
+            welded[i] = items[firstVertex[i]];
+        items = std::move(welded);
+    }
+
+    static bool WithinEpsilon(const float* a, const float* b, int n, float epsilon) noexcept
+    {
+        for (int i = 0; i < n; ++i)
+            if (!(std::abs(a[i] - b[i]) <= epsilon))
+                return false;
+        return true;
+    }
+
+    void MeshGroup::WeldVertices(const WeldOptions& opt) noexcept
+    {
+        const int numVerts = NumVerts();
+        const PerVertexLayers perVertex { *this };
+        const bool weightsPerVertex = (int)Weights.size() == numVerts;
+        const bool blendPerVertex   = NumBlendIndices() == numVerts || NumBlendWeights() == numVerts;
+
+        // independently indexed layers are simply deduplicated
+        std::vector<int> coordRemap, normalRemap, colorRemap;
+        if (!perVertex.Coords  && !Coords.empty())  coordRemap  = WeldLayer<2>(Coords,  opt.CoordEpsilon);
+        if (!perVertex.Normals && !Normals.empty()) normalRemap = WeldLayer<3>(Normals, opt.NormalEpsilon);
+        if (!perVertex.Colors  && !Colors.empty())  colorRemap  = WeldLayer<3>(Colors,  opt.ColorEpsilon);
+
+        // vertices only merge if their per vertex layers match as well
+        auto sameAttributes = [&](int a, int b) -> bool
+        {
+            if (perVertex.Coords && !WithinEpsilon(&Coords[a].x, &Coords[b].x, 2, opt.CoordEpsilon))
+                return false;
+            if (perVertex.Normals && !WithinEpsilon(&Normals[a].x, &Normals[b].x, 3, opt.NormalEpsilon))
+                return false;
+            if (perVertex.Colors && !WithinEpsilon((const float*)&Colors[a], (const float*)&Colors[b], 3, opt.ColorEpsilon))
+                return false;
+            if (weightsPerVertex && memcmp(&Weights[a], &Weights[b], sizeof(Weights[a])) != 0)
+                return false;
+            if (blendPerVertex)
+            {
+                if (NumBlendIndices() == numVerts && memcmp(&BlendIndices[a], &BlendIndices[b], sizeof(Nano::BlendIndices)) != 0)
+                    return false;
+                if (NumBlendWeights() == numVerts && memcmp(&BlendWeights[a], &BlendWeights[b], sizeof(Nano::BlendWeights)) != 0)
+                    return false;
+            }
+            return true;
+        };
+
+        WeldGrid<3> grid { opt.PositionEpsilon, Verts.size() };
+        std::vector<int> vertexRemap(numVerts);
+        std::vector<int> firstVertex; // first old vertex of every welded vertex
+        for (int v = 0; v < numVerts; ++v)
+        {
+            int welded = grid.Insert(&Verts[v].x, [&](int point) {
+                return sameAttributes(firstVertex[point], v);
+            });
+            if (welded == (int)firstVertex.size())
+                firstVertex.push_back(v);
+            vertexRemap[v] = welded;
+        }
+
+        CompactPerVertex(Verts, firstVertex);
+        if (perVertex.Coords)  CompactPerVertex(Coords,  firstVertex);
+        if (perVertex.Normals) CompactPerVertex(Normals, firstVertex);
+        if (perVertex.Colors)  CompactPerVertex(Colors,  firstVertex);
+        if (weightsPerVertex) CompactPerVertex(Weights, firstVertex);
+        if (NumBlendIndices() == numVerts) CompactPerVertex(BlendIndices, firstVertex);
+        if (NumBlendWeights() == numVerts) CompactPerVertex(BlendWeights, firstVertex);
+
+        RemapCorners(Tris, perVertex, vertexRemap, coordRemap, normalRemap, colorRemap);
+    }
+
+    void Mesh::WeldVertices(const WeldOptions& opt) noexcept
+    {
+        for (MeshGroup& group : Groups)
+            group.WeldVertices(opt);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <Nano/Mesh.h>
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Reads a .nmesh file into `mesh` as it was saved, load options are not applied.
+     * @param sourceHash If not 0, the file must have been written with the same source hash,
+     *                   otherwise FALSE is returned without an error
+     */
+    bool ReadNmesh(Mesh& mesh, rpp::strview meshPath, Options opt, uint64_t sourceHash);
+
+    /**
+     * Writes `mesh` as a .nmesh file
+     * @param sourceHash Content hash of the source this mesh was derived from, 0 if none
+     */
+    bool WriteNmesh(const Mesh& mesh, rpp::strview meshPath, Options opt, uint64_t sourceHash);
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
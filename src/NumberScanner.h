@@ -0,0 +1,312 @@
+#pragma once
+#include <rpp/strview.h>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <cfloat>
+#include <cmath>
+#if __has_include(<charconv>)
+    #include <charconv>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define NANOMESH_SCANNER_SSE2 1
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Fast number scanner for the hot loops of the text mesh readers (OBJ, MTL, TXT).
+     * It scans a single line and never reads past the end of that line.
+     *
+     * Digit runs are classified 16 bytes at a time with SSE2 where available
+     * and converted 8 digits at a time. Floats are correctly rounded:
+     * the common case is resolved with exact double arithmetic (Clinger's fast path),
+     * anything else falls back to std::from_chars (or strtof).
+     */
+    class NumberScanner
+    {
+        const char* ptr;
+        const char* end;
+
+    public:
+        explicit NumberScanner(rpp::strview line) noexcept
+            : ptr{ line.str }, end{ line.str + line.len } {}
+
+        NumberScanner(const char* begin, const char* end) noexcept
+            : ptr{ begin }, end{ end } {}
+
+        // @return TRUE if there are any non-whitespace characters left
+        bool HasMore() noexcept
+        {
+            SkipSpaces();
+            return ptr < end;
+        }
+
+        // @return Remaining unscanned part of the line
+        rpp::strview Rest() const noexcept { return { ptr, end }; }
+
+        /**
+         * Skips leading whitespace and parses a float, e.g. `-1.25`, `.5`, `3e-4`
+         * @return Parsed float or 0.0f if there is no number at the current position
+         */
+        float Float() noexcept
+        {
+            float f = 0.0f;
+            ParseFloat(f);
+            return f;
+        }
+
+        /**
+         * Skips leading whitespace and parses a float
+         * @return FALSE if there is no number at the current position, `out` is left unchanged
+         */
+        bool ParseFloat(float& out) noexcept;
+
+        // Stream style extraction, same as `rpp::strview >> float` but correctly rounded
+        NumberScanner& operator>>(float& out) noexcept { out = Float(); return *this; }
+        NumberScanner& operator>>(int& out) noexcept { out = Int(); return *this; }
+
+        /**
+         * Skips leading whitespace and parses a decimal integer
+         * @return Parsed integer or 0 if there is no number at the current position
+         */
+        int Int() noexcept
+        {
+            SkipSpaces();
+            int value = 0;
+            ScanInt(value);
+            return value;
+        }
+
+        /**
+         * Parses an OBJ style face vertex token in one pass: `v`, `v/t`, `v//n` or `v/t/n`.
+         * Any trailing garbage up to the next whitespace is skipped.
+         * Indices are returned exactly as written (1-based or negative relative),
+         * missing elements are returned as 0, which is not a valid OBJ index.
+         * @return FALSE if there are no more tokens on this line
+         */
+        bool FaceVertex(int& v, int& t, int& n) noexcept
+        {
+            SkipSpaces();
+            if (ptr >= end)
+                return false;
+            v = t = n = 0;
+            ScanInt(v);
+            if (ptr < end && *ptr == '/')
+            {
+                ++ptr;
+                if (ptr < end && *ptr != '/')
+                    ScanInt(t);
+                if (ptr < end && *ptr == '/')
+                {
+                    ++ptr;
+                    ScanInt(n);
+                }
+            }
+            while (ptr < end && !IsSpace(*ptr))
+                ++ptr;
+            return true;
+        }
+
+        static bool IsSpace(char c) noexcept { return c == ' ' || c == '\t' || c == '\r'; }
+        static bool IsDigit(char c) noexcept { return unsigned(c - '0') <= 9u; }
+
+        // @return Number of consecutive decimal digits starting at `p`, limited by `e`
+        static int CountDigits(const char* p, const char* e) noexcept
+        {
+            const char* start = p;
+        #if NANOMESH_SCANNER_SSE2
+            const __m128i below0 = _mm_set1_epi8('0' - 1);
+            const __m128i above9 = _mm_set1_epi8('9' + 1);
+            while (e - p >= 16)
+            {
+                __m128i chars = _mm_loadu_si128((const __m128i*)p);
+                __m128i digits = _mm_and_si128(_mm_cmpgt_epi8(chars, below0),
+                                               _mm_cmplt_epi8(chars, above9));
+                unsigned nonDigits = ~unsigned(_mm_movemask_epi8(digits)) & 0xFFFFu;
+                if (nonDigits)
+                {
+                #if defined(_MSC_VER) && !defined(__clang__)
+                    unsigned long first; _BitScanForward(&first, nonDigits);
+                    return int(p - start) + int(first);
+                #else
+                    return int(p - start) + __builtin_ctz(nonDigits);
+                #endif
+                }
+                p += 16;
+            }
+        #endif
+            while (p < e && IsDigit(*p))
+                ++p;
+            return int(p - start);
+        }
+
+        // Converts exactly 8 ASCII digits into an integer with SWAR arithmetic
+        static uint32_t Parse8Digits(const char* p) noexcept
+        {
+            uint64_t val; memcpy(&val, p, 8);
+        #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            val = __builtin_bswap64(val);
+        #endif
+            val = (val & 0x0F0F0F0F0F0F0F0Full) * 2561 >> 8;
+            val = (val & 0x00FF00FF00FF00FFull) * 6553601 >> 16;
+            return uint32_t((val & 0x0000FFFF0000FFFFull) * 42949672960001ull >> 32);
+        }
+
+        // Accumulates `count` digits into `mantissa`, only call with count <= 19 total digits
+        static uint64_t AccumulateDigits(uint64_t mantissa, const char* p, int count) noexcept
+        {
+            for (; count >= 8; count -= 8, p += 8)
+                mantissa = mantissa * 100000000ull + Parse8Digits(p);
+            for (; count > 0; --count, ++p)
+                mantissa = mantissa * 10 + uint64_t(*p - '0');
+            return mantissa;
+        }
+
+    private:
+        void SkipSpaces() noexcept
+        {
+            while (ptr < end && IsSpace(*ptr))
+                ++ptr;
+        }
+
+        // parses [+-]digits at the current position, `out` is unchanged if there are no digits
+        void ScanInt(int& out) noexcept
+        {
+            const char* p = ptr;
+            bool negative = false;
+            if (p < end && (*p == '-' || *p == '+'))
+                negative = (*p++ == '-');
+            int numDigits = CountDigits(p, end);
+            if (numDigits == 0)
+                return;
+            // don't care about overflow, but stay well defined
+            int64_t value = (int64_t)AccumulateDigits(0, p, numDigits < 18 ? numDigits : 18);
+            ptr = p + numDigits;
+            out = int(negative ? -value : value);
+        }
+
+        static float ParseFloatSlow(const char* begin, const char* end, bool negative) noexcept;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    inline bool NumberScanner::ParseFloat(float& out) noexcept
+    {
+        SkipSpaces();
+        const char* p = ptr;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = (*p++ == '-');
+        const char* numStart = p;
+
+        // skip leading zeros, they don't count towards the 19 significant digits
+        const char* intStart = p;
+        while (p < end && *p == '0') ++p;
+        int intDigits = CountDigits(p, end);
+        const char* intDigitsStart = p;
+        p += intDigits;
+
+        const char* fracStart = p;
+        int fracDigits = 0;
+        if (p < end && *p == '.')
+        {
+            fracStart = ++p;
+            fracDigits = CountDigits(p, end);
+            p += fracDigits;
+        }
+
+        if (intDigitsStart == intStart && intDigits == 0 && fracDigits == 0)
+            return false; // no digits at all, e.g. "-" or "."
+
+        int exponent = 0;
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            const char* e = p + 1;
+            bool negExp = false;
+            if (e < end && (*e == '-' || *e == '+'))
+                negExp = (*e++ == '-');
+            if (int expDigits = CountDigits(e, end))
+            {
+                p = e + expDigits;
+                while (expDigits > 1 && *e == '0') { ++e; --expDigits; } // 1e00005 is 1e5
+                // absurd exponents only need to miss the fast path, the slow path rounds them
+                exponent = expDigits > 4 ? 99999 : int(AccumulateDigits(0, e, expDigits));
+                if (negExp) exponent = -exponent;
+            }
+        }
+        ptr = p;
+
+        uint64_t mantissa = 0;
+        if (intDigits + fracDigits <= 19)
+        {
+            mantissa = AccumulateDigits(mantissa, intDigitsStart, intDigits);
+            mantissa = AccumulateDigits(mantissa, fracStart, fracDigits);
+            exponent -= fracDigits;
+
+            // Clinger's fast path: mantissa and 10^|exponent| are both exact doubles,
+            // so the division/multiplication is a single correctly rounded operation
+            static constexpr double Pow10[] = {
+                1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+            };
+            if (mantissa <= (1ull << 53) && -22 <= exponent && exponent <= 22)
+            {
+                double d = double(mantissa);
+                d = exponent < 0 ? d / Pow10[-exponent] : d * Pow10[exponent];
+
+                // rounding the correctly rounded double to float is only wrong
+                // if the double landed exactly halfway between two floats
+                uint64_t bits; memcpy(&bits, &d, 8);
+                bool halfway = (bits & 0x1FFFFFFFull) == 0x10000000ull;
+                if (mantissa == 0 || (!halfway && FLT_MIN <= d && d <= FLT_MAX))
+                {
+                    float f = float(d);
+                    out = negative ? -f : f;
+                    return true;
+                }
+            }
+        }
+        out = ParseFloatSlow(numStart, p, negative);
+        return true;
+    }
+
+    inline float NumberScanner::ParseFloatSlow(const char* begin, const char* end, bool negative) noexcept
+    {
+        float f = 0.0f;
+    #if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        if (std::from_chars(begin, end, f).ec == std::errc::result_out_of_range)
+        {
+            double d = 0.0; // let the double conversion saturate to inf or 0
+            if (std::from_chars(begin, end, d).ec == std::errc::result_out_of_range)
+            {
+                // beyond double range too, from_chars leaves d alone, so only the
+                // exponent sign or a non-zero integer part can tell inf from 0
+                const char* e = begin;
+                while (e != end && *e != 'e' && *e != 'E') ++e;
+                const char* intPart = begin;
+                while (intPart != e && *intPart == '0') ++intPart; // 000123 is 123
+                bool huge = e != end ? (e + 1 == end || e[1] != '-') : (intPart != e && *intPart != '.');
+                d = huge ? HUGE_VAL : 0.0;
+            }
+            f = float(d);
+        }
+    #else
+        char buf[128];
+        size_t len = size_t(end - begin);
+        if (len >= sizeof(buf)) len = sizeof(buf) - 1;
+        memcpy(buf, begin, len);
+        buf[len] = '\0';
+        f = strtof(buf, nullptr);
+    #endif
+        return negative ? -f : f;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
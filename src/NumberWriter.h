@@ -0,0 +1,114 @@
+#pragma once
+#include <rpp/strview.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Fast number formatter for the text mesh writers, the counterpart of NumberScanner.
+     * It writes into a caller provided buffer, which must have enough room
+     * for the whole line: at most MaxFixedChars per float and MaxIntChars per int.
+     *
+     * Fixed() produces exactly the same text as printf("%.*f") for floats:
+     * a float times 10^decimals (decimals <= 9) is an exact double, so rounding it
+     * to an integer gives the same correctly rounded result as printf,
+     * anything too big or not finite falls back to snprintf.
+     */
+    class NumberWriter
+    {
+        char* ptr;
+
+    public:
+        static constexpr int MaxFixedChars = 52; // -3.4e38 with 9 decimals
+        static constexpr int MaxIntChars = 11;
+
+        explicit NumberWriter(char* buffer) noexcept : ptr{ buffer } {}
+
+        // @return Current write position, one past the last written character
+        char* End() const noexcept { return ptr; }
+
+        NumberWriter& Char(char c) noexcept { *ptr++ = c; return *this; }
+
+        NumberWriter& Str(rpp::strview s) noexcept
+        {
+            memcpy(ptr, s.str, (size_t)s.len);
+            ptr += s.len;
+            return *this;
+        }
+
+        NumberWriter& Int(int value) noexcept
+        {
+            uint32_t u = (uint32_t)value;
+            if (value < 0) { *ptr++ = '-'; u = 0u - u; }
+            ptr = WriteUInt(ptr, u);
+            return *this;
+        }
+
+        /**
+         * Writes `value` with a fixed number of decimals, same as printf("%.*f", decimals, value)
+         * @param decimals Number of decimals [0, 9]
+         */
+        NumberWriter& Fixed(float value, int decimals) noexcept
+        {
+            static constexpr double Pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+            double d = value;
+            double scaled = fabs(d) * Pow10[decimals]; // exact
+            if (!(scaled < 9.0e18)) // too big for int64 or NaN/Inf
+            {
+                ptr += snprintf(ptr, MaxFixedChars, "%.*f", decimals, d);
+                return *this;
+            }
+
+            uint64_t digits = (uint64_t)llrint(scaled); // round half to even, same as printf
+            uint64_t divisor = (uint64_t)Pow10[decimals];
+            if (std::signbit(d)) *ptr++ = '-'; // printf keeps the sign of -0.0 and tiny negatives
+            ptr = WriteUInt(ptr, digits / divisor);
+            if (decimals > 0)
+            {
+                uint64_t frac = digits % divisor;
+                *ptr = '.';
+                for (int i = decimals; i > 0; --i, frac /= 10)
+                    ptr[i] = char('0' + frac % 10);
+                ptr += decimals + 1;
+            }
+            return *this;
+        }
+
+        static char* WriteUInt(char* out, uint64_t value) noexcept
+        {
+            static constexpr char Digits2[] =
+                "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+                "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+                "8081828384858687888990919293949596979899";
+            char tmp[20];
+            char* p = tmp + sizeof(tmp);
+            while (value >= 100)
+            {
+                const char* two = Digits2 + (value % 100) * 2;
+                value /= 100;
+                *--p = two[1];
+                *--p = two[0];
+            }
+            if (value >= 10)
+            {
+                const char* two = Digits2 + value * 2;
+                *--p = two[1];
+                *--p = two[0];
+            }
+            else
+            {
+                *--p = char('0' + value);
+            }
+            size_t len = size_t(tmp + sizeof(tmp) - p);
+            memcpy(out, p, len);
+            return out + len;
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <Nano/Mesh.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    // @return Number of workers to use for `numTasks` independent tasks, limited by GetMaxThreads()
+    inline int NumWorkers(int numTasks) noexcept
+    {
+        int maxThreads = GetMaxThreads();
+        return numTasks < maxThreads ? numTasks : maxThreads;
+    }
+
+    /**
+     * Runs func(taskIndex, workerIndex) for every task in [0, numTasks)
+     * on up to `numWorkers` threads, including the calling thread.
+     * Tasks are handed out in order, but may complete in any order.
+     * This blocks until all tasks have finished.
+     * @note workerIndex is in [0, numWorkers) and can be used to index per-worker scratch data
+     */
+    template<class Func> void ParallelFor(int numTasks, int numWorkers, const Func& func)
+    {
+        if (numWorkers <= 1 || numTasks <= 1)
+        {
+            for (int i = 0; i < numTasks; ++i)
+                func(i, 0);
+            return;
+        }
+
+        std::atomic<int> nextTask { 0 };
+        auto worker = [&](int workerIndex) {
+            for (int i; (i = nextTask++) < numTasks;)
+                func(i, workerIndex);
+        };
+
+        std::vector<std::thread> threads; threads.reserve(numWorkers - 1);
+        for (int i = 1; i < numWorkers; ++i)
+            threads.emplace_back(worker, i);
+        worker(0);
+        for (std::thread& t : threads)
+            t.join();
+    }
+
+    // Runs func(taskIndex) for every task in [0, numTasks) on NumWorkers(numTasks) threads
+    template<class Func> void ParallelFor(int numTasks, const Func& func)
+    {
+        ParallelFor(numTasks, NumWorkers(numTasks), [&](int task, int) { func(task); });
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
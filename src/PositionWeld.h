@@ -0,0 +1,100 @@
+#pragma once
+#include <Nano/Mesh.h>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace Nano
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * Open addressing hash table which merges identical positions.
+     * With epsilon == 0 positions must be bitwise identical, +0.0 and -0.0 are
+     * treated as the same coordinate. Otherwise positions are snapped to a grid
+     * of `epsilon` sized cells and every position in a cell is merged.
+     */
+    class PositionWeldTable
+    {
+        struct Key
+        {
+            int64_t x, y, z;
+            bool operator==(const Key& k) const noexcept { return x == k.x && y == k.y && z == k.z; }
+        };
+
+        std::vector<rpp::Vector3>& verts;
+        std::vector<int> slots; // vertex index or -1
+        size_t mask = 0;
+        float invEpsilon = 0.0f;
+
+        static int64_t Bits(float f) noexcept
+        {
+            uint32_t u; memcpy(&u, &f, sizeof(u));
+            return u == 0x80000000u ? 0 : int64_t(u); // -0.0 --> +0.0
+        }
+
+        Key MakeKey(const rpp::Vector3& p) const noexcept
+        {
+            if (invEpsilon == 0.0f)
+                return { Bits(p.x), Bits(p.y), Bits(p.z) };
+            return { (int64_t)std::floor(p.x * invEpsilon + 0.5f),
+                     (int64_t)std::floor(p.y * invEpsilon + 0.5f),
+                     (int64_t)std::floor(p.z * invEpsilon + 0.5f) };
+        }
+
+        static size_t Hash(const Key& k) noexcept
+        {
+            uint64_t h = uint64_t(k.x) * 0x9E3779B97F4A7C15ull;
+            h = (h ^ (h >> 32) ^ uint64_t(k.y)) * 0xC2B2AE3D27D4EB4Full;
+            h = (h ^ (h >> 32) ^ uint64_t(k.z)) * 0x165667B19E3779F9ull;
+            return size_t(h ^ (h >> 29));
+        }
+
+        void Rehash(size_t capacity)
+        {
+            slots.assign(capacity, -1);
+            mask = capacity - 1;
+            for (int i = 0; i < (int)verts.size(); ++i)
+            {
+                size_t slot = Hash(MakeKey(verts[i])) & mask;
+                while (slots[slot] != -1)
+                    slot = (slot + 1) & mask;
+                slots[slot] = i;
+            }
+        }
+
+    public:
+        /**
+         * @param verts Output vertices, only positions added through Insert() are welded
+         * @param expectedVerts Initial capacity hint
+         * @param epsilon Grid cell size for merging nearby positions, 0 for exact matches
+         */
+        PositionWeldTable(std::vector<rpp::Vector3>& verts, size_t expectedVerts, float epsilon = 0.0f)
+            : verts{ verts }, invEpsilon{ epsilon > 0.0f ? 1.0f / epsilon : 0.0f }
+        {
+            size_t capacity = 1024;
+            while (capacity < expectedVerts * 2) capacity *= 2;
+            slots.assign(capacity, -1);
+            mask = capacity - 1;
+        }
+
+        // @return Index of the existing vertex at this position, or of the newly added vertex
+        int Insert(const rpp::Vector3& p)
+        {
+            const Key key = MakeKey(p);
+            size_t slot = Hash(key) & mask;
+            for (int existing; (existing = slots[slot]) != -1; slot = (slot + 1) & mask)
+                if (MakeKey(verts[existing]) == key)
+                    return existing;
+
+            int index = (int)verts.size();
+            verts.push_back(p);
+            slots[slot] = index;
+            if (verts.size() * 2 > slots.size()) // keep the load factor below 0.5
+                Rehash(slots.size() * 2);
+            return index;
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,132 @@
+#include <rpp/debugging.h>
+#include <rpp/tests.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../src/Inflate.h"
+using Nano::ZlibDecompress;
+
+TestImpl(test_inflate)
+{
+    TestInit(test_inflate)
+    {
+    }
+
+    // zlib streams written by zlib itself, so they use the same block types as FBX exporters
+    // Z_FIXED strategy, a single fixed Huffman block
+    static const std::string& FixedStream()
+    {
+        static const std::string z {
+            "\x78\x01\xf3\x48\xcd\xc9\xc9\xd7\x51\xf0\x40\xa2\x14\xfc\x12\xf3\xf2\x7d\x53\x8b\x33\x14\xa1\xfc"
+            "\xc4\xf4\xc4\xcc\x3c\x3d\x00\x2f\x92\x0e\x31", 35 };
+        return z;
+    }
+
+    // level 6, a single dynamic Huffman block
+    static const std::string& DynamicStream()
+    {
+        static const std::string z {
+            "\x78\x9c\xa5\xcb\x11\x1a\x02\x61\x14\x85\xe1\x0b\x41\x30\x30\x10\x04\xc1\x40\x10\x04\x03\x71\x73"
+            "\xef\x0e\x66\x09\x2d\xa1\x25\xfc\x18\x86\xe1\x60\x18\x86\x83\x61\x18\x0e\x86\x61\xd8\xd7\x16\xce"
+            "\x3d\xcf\xf3\x1e\xfb\xcc\xfe\x2b\x7b\xae\x33\x73\x14\x0c\x18\x31\xc1\xdc\xac\x46\x83\x16\x8e\x1e"
+            "\x07\x1c\x5d\xef\x0a\x4e\xae\x77\x67\x5c\x5c\xef\x06\x5c\x5d\xef\x6e\xb8\x27\xba\x11\x8f\x44\xf7"
+            "\xc4\x2b\xd1\x4d\x78\x27\xba\x0f\xbe\x89\xce\xc2\x6c\x16\x7a\x37\x47\x15\x7a\x57\x63\x11\x7a\xb7"
+            "\xc4\x2a\xf4\xae\xc1\x3a\xf4\x6e\x83\x6d\xe8\x5d\x8b\x5d\xfc\x00\x96\x9c\xb9\x55", 140 };
+        return z;
+    }
+
+    // level 9, references 30000 bytes back
+    static const std::string& LongStream()
+    {
+        static const std::string z {
+            "\x78\xda\xed\xdd\x21\x0e\x41\x61\x00\x00\x60\xb3\x09\x82\x24\x49\x24\x6e\x21\x19\xd1\xf6\x22\x9b"
+            "\x44\x20\x92\x09\xa2\x60\xd2\x13\x45\x9b\xf2\x8f\x66\x12\xd9\xdb\x6c\x6f\xb3\x71\x00\xc1\x19\x04"
+            "\x87\x20\x7e\xdf\x45\xbe\x74\x7b\x2f\x5c\xea\x49\xa8\x84\x61\x5c\x8d\x06\xb3\xd7\xa9\x71\xdb\x74"
+            "\xba\xd3\xdd\xf1\xd9\x8b\xb3\xfd\xdc\xb5\xdc\x3a\x1f\xd6\x51\xb7\xf6\x79\xef\x9f\xab\xa4\xf9\x98"
+            "\x1c\x46\xed\x79\x58\xb6\x42\xf1\x95\x5f\x94\xc6\x19\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"
+            "\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x80\x3f\x49\x7f\xfc\x56\xbf"
+            "\xfb\x72\x41\x97", 148 };
+        return z;
+    }
+
+    static std::vector<uint8_t> Decompress(const std::string& z, size_t dstSize, bool& ok)
+    {
+        std::vector<uint8_t> out(dstSize);
+        ok = ZlibDecompress((const uint8_t*)z.data(), z.size(), out.data(), out.size());
+        return out;
+    }
+
+    static std::vector<uint8_t> FloatGrid()
+    {
+        std::vector<uint8_t> bytes(256 * sizeof(float));
+        for (int i = 0; i < 256; ++i)
+        {
+            float f = (i % 16) * 0.25f + (i / 16) * 0.5f;
+            memcpy(&bytes[i * sizeof(float)], &f, sizeof(float));
+        }
+        return bytes;
+    }
+
+    // 64 bytes of noise, 30000 zeros and the same noise again
+    static std::vector<uint8_t> NoiseZerosNoise()
+    {
+        std::vector<uint8_t> bytes(64 + 30000 + 64, 0);
+        uint32_t x = 12345;
+        for (int i = 0; i < 64; ++i)
+        {
+            x = x * 1103515245u + 12345u;
+            bytes[i] = bytes[64 + 30000 + i] = uint8_t(x >> 24);
+        }
+        return bytes;
+    }
+
+    TestCase(fixed_huffman_block)
+    {
+        const std::string text = "Hello, Hello, Hello NanoMesh! Hello again.";
+        bool ok;
+        std::vector<uint8_t> out = Decompress(FixedStream(), text.size(), ok);
+        AssertTrue(ok);
+        AssertTrue(std::string(out.begin(), out.end()) == text);
+    }
+
+    TestCase(dynamic_huffman_block)
+    {
+        const std::vector<uint8_t> expected = FloatGrid();
+        bool ok;
+        std::vector<uint8_t> out = Decompress(DynamicStream(), expected.size(), ok);
+        AssertTrue(ok);
+        AssertTrue(out == expected);
+    }
+
+    TestCase(long_back_references)
+    {
+        const std::vector<uint8_t> expected = NoiseZerosNoise();
+        bool ok;
+        std::vector<uint8_t> out = Decompress(LongStream(), expected.size(), ok);
+        AssertTrue(ok);
+        AssertTrue(out == expected);
+    }
+
+    TestCase(truncated_and_mismatched_streams_are_rejected)
+    {
+        const size_t dynamicSize = FloatGrid().size();
+        const size_t longSize = NoiseZerosNoise().size();
+        bool ok;
+        for (size_t len = 0; len < DynamicStream().size(); ++len)
+        {
+            Decompress(DynamicStream().substr(0, len), dynamicSize, ok);
+            if (ok) { AssertFalse(ok); break; }
+        }
+        for (size_t len = 0; len < LongStream().size(); ++len)
+        {
+            Decompress(LongStream().substr(0, len), longSize, ok);
+            if (ok) { AssertFalse(ok); break; }
+        }
+
+        // the decompressed size must match exactly
+        Decompress(DynamicStream(), dynamicSize - 1, ok);
+        AssertFalse(ok);
+        Decompress(DynamicStream(), dynamicSize + 1, ok);
+        AssertFalse(ok);
+    }
+};
@@ -1,10 +1,23 @@
 #include <rpp/debugging.h>
 #include <rpp/tests.h>
+#include <rpp/file_io.h>
 #include <Nano/Mesh.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
 using Nano::Mesh;
 using Nano::Options;
 using Nano::MeshGroup;
 
+static void WriteTextFile(const char* path, const char* text)
+{
+    FILE* f = fopen(path, "wb");
+    fputs(text, f);
+    fclose(f);
+}
+
 TestImpl(test_mesh_api)
 {
     TestInit(test_mesh_api)
@@ -28,7 +41,9 @@ TestImpl(test_mesh_api)
             return;
         Mesh mesh { "head_male.fbx", Options::Log };
         AssertThat(mesh.NumGroups(), 1);
+    #if ENABLE_FBX_MESH_LOADER // saving needs the FBX SDK
         (void)mesh.SaveAs("head_male.saved.fbx", Options::Log);
+    #endif
     }
 
     TestCase(force_single_group)
@@ -144,6 +159,1079 @@ TestImpl(test_mesh_api)
         b[0].PrintVerts("Box.TXT");
     }
 
+    template<class T>
+    bool AreIdentical(const std::vector<T>& a, const std::vector<T>& b)
+    {
+        return a.size() == b.size()
+            && (a.empty() || memcmp(a.data(), b.data(), a.size()*sizeof(T)) == 0);
+    }
+
+    bool AreMeshesIdentical(const Mesh& a, const Mesh& b)
+    {
+        if (a.Name != b.Name || a.NumGroups() != b.NumGroups())
+            return false;
+        for (int i = 0; i < a.NumGroups(); ++i)
+        {
+            const MeshGroup& ga = a[i];
+            const MeshGroup& gb = b[i];
+            if (ga.Name != gb.Name || (ga.Mat ? ga.Mat->Name : "") != (gb.Mat ? gb.Mat->Name : ""))
+                return false;
+            if (!AreIdentical(ga.Verts, gb.Verts) || !AreIdentical(ga.Coords, gb.Coords) ||
+                !AreIdentical(ga.Normals, gb.Normals) || !AreIdentical(ga.Colors, gb.Colors) ||
+                !AreIdentical(ga.Tris, gb.Tris))
+                return false;
+        }
+        return true;
+    }
+
+    TestCase(parallel_load_is_identical)
+    {
+        Mesh serial { "head_male.obj" };
+        for (int threads : { 2, 3, 8 })
+        {
+            Nano::SetMaxThreads(threads);
+            Mesh parallel { "head_male.obj", Options::Parallel };
+            AssertTrue(AreMeshesIdentical(serial, parallel));
+        }
+        Nano::SetMaxThreads(0);
+    }
+
+    TestCase(obj_groups_keep_first_use_vertex_order)
+    {
+        WriteTextFile("multi_group.obj",
+                      "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 2 2 2\n"
+                      "g first\nf 4 2 3\n"
+                      "g second\nf 3 5 1\nf 1 5 4\n");
+
+        Mesh mesh { "multi_group.obj", Options::EmptyGroups };
+        AssertThat(mesh.NumGroups(), 2);
+        const MeshGroup& second = mesh[1];
+        AssertThat(second.NumVerts(), 4);
+        rpp::Vector3 v1 { 0, 0, 0 }, v3 { 1, 1, 0 }, v4 { 0, 1, 0 }, v5 { 2, 2, 2 };
+        AssertThat(second.Verts[0], v3);
+        AssertThat(second.Verts[1], v5);
+        AssertThat(second.Verts[2], v1);
+        AssertThat(second.Verts[3], v4);
+        AssertThat(second.Tris[1].a.v, 2);
+        AssertThat(second.Tris[1].c.v, 3);
+
+        for (int threads : { 1, 2 })
+        {
+            Nano::SetMaxThreads(threads);
+            Mesh parallel { "multi_group.obj", Options::EmptyGroups | Options::Parallel };
+            AssertTrue(AreMeshesIdentical(mesh, parallel));
+        }
+        Nano::SetMaxThreads(0);
+    }
+
+    TestCase(parallel_load_generated_groups)
+    {
+        // revisited groups, material switches and relative indices over several chunks,
+        // so the relative indices and group statements cross chunk boundaries
+        WriteTextFile("generated.mtl", "newmtl Red\nKd 1 0 0\nnewmtl Green\nKd 0 1 0\nnewmtl Blue\nKd 0 0 1\n");
+        const char* materials[] = { "Red", "Green", "Blue" };
+        std::string obj = "mtllib generated.mtl\n";
+        char line[256];
+        const int numQuads = 12000;
+        for (int quad = 0; quad < numQuads; ++quad)
+        {
+            if (quad % 1000 == 0)
+            {
+                snprintf(line, sizeof(line), "g group%d\nusemtl %s\n", (quad / 1000) % 5, materials[(quad / 1000) % 3]);
+                obj += line;
+            }
+            int x = quad % 100, y = quad / 100;
+            snprintf(line, sizeof(line), "v %d %d 0\nv %d %d 0\nv %d %d 1\nv %d %d 1\n", x, y, x+1, y, x+1, y+1, x, y+1);
+            obj += line;
+            obj += "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\nvn 0 0 1\n";
+            obj += "f -4/-4/-1 -3/-3/-1 -2/-2/-1\nf -4/-4/-1 -2/-2/-1 -1/-1/-1\n";
+            if (quad % 7 == 0) // absolute indices mixed with relative ones
+                obj += "f 1/1/1 2/2/1 -1/-1/-1\n";
+        }
+        WriteTextFile("generated_groups.obj", obj.c_str());
+
+        Mesh serial { "generated_groups.obj" };
+        AssertThat(serial.NumGroups(), 5);
+        AssertThat(serial.TotalTris(), numQuads * 2 + (numQuads + 6) / 7);
+        for (int threads : { 2, 3, 8 })
+        {
+            Nano::SetMaxThreads(threads);
+            Mesh parallel { "generated_groups.obj", Options::Parallel };
+            AssertTrue(AreMeshesIdentical(serial, parallel));
+        }
+        Nano::SetMaxThreads(0);
+    }
+
+    TestCase(parallel_save_is_identical)
+    {
+        Mesh mesh { "head_male.obj" };
+        AssertTrue(mesh.SaveAs("head_male.saved.obj"));
+        rpp::load_buffer serial = rpp::file::read_all("head_male.saved.obj");
+
+        Nano::SetMaxThreads(4);
+        AssertTrue(mesh.SaveAs("head_male.saved.obj", Options::Parallel));
+        Nano::SetMaxThreads(0);
+        rpp::load_buffer parallel = rpp::file::read_all("head_male.saved.obj");
+
+        AssertThat(serial.size(), parallel.size());
+        AssertTrue(serial.size() == parallel.size()
+                && memcmp(serial.data(), parallel.data(), serial.size()) == 0);
+    }
+
+    TestCase(stream_obj_groups)
+    {
+        WriteTextFile("stream_groups.obj",
+                      "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 2 2 2\nvt 0 0\nvt 1 1\n"
+                      "g first\nf 4/1 2/2 3/1\n"
+                      "g second\nf 3/2 5/1 1/1\nf 1/1 5/2 4/2\n"
+                      "v 3 3 3\ng third\nf -1/1 1/2 2/2\n");
+        Mesh mesh { "stream_groups.obj" };
+
+        // a tiny window forces lines to be carried over between reads
+        Nano::ObjStreamOptions streamOpt;
+        streamOpt.WindowSize = 8;
+        streamOpt.MaxBatchTris = 0;
+        std::vector<MeshGroup> groups;
+        AssertTrue(Nano::StreamOBJ("stream_groups.obj", [&](MeshGroup& g) {
+            groups.push_back(std::move(g));
+            return true;
+        }, streamOpt));
+
+        AssertThat((int)groups.size(), mesh.NumGroups());
+        for (int i = 0; i < (int)groups.size() && i < mesh.NumGroups(); ++i)
+        {
+            AssertThat(groups[i].Name, mesh[i].Name);
+            AssertThat(groups[i].GroupId, i);
+            AssertTrue(AreIdentical(groups[i].Verts, mesh[i].Verts));
+            AssertTrue(AreIdentical(groups[i].Coords, mesh[i].Coords));
+            AssertTrue(AreIdentical(groups[i].Tris, mesh[i].Tris));
+        }
+
+        // one triangle per batch, and stop after the second one
+        int numBatches = 0;
+        streamOpt.MaxBatchTris = 1;
+        AssertTrue(Nano::StreamOBJ("stream_groups.obj", [&](MeshGroup& g) {
+            AssertThat(g.NumTris(), 1);
+            return ++numBatches < 2;
+        }, streamOpt));
+        AssertThat(numBatches, 2);
+
+        // lines longer than the window limit fail the stream
+        streamOpt.MaxWindowSize = 8;
+        AssertFalse(Nano::StreamOBJ("stream_groups.obj", [&](MeshGroup&) {
+            return true;
+        }, streamOpt, Options::NoThrow));
+    }
+
+    TestCase(obj_materials_are_shared)
+    {
+        WriteTextFile("shared.mtl", "newmtl Red\nKd 1 0 0\nnewmtl Green\nKd 0 1 0\n");
+        WriteTextFile("shared_a.obj", "mtllib shared.mtl\nv 0 0 0\nv 1 0 0\nv 1 1 0\nusemtl green\nf 1 2 3\n");
+        WriteTextFile("shared_b.obj", "mtllib shared.mtl\nv 0 0 0\nv 1 0 0\nv 1 1 0\nusemtl GREEN\nf 1 2 3\n");
+
+        Mesh a { "shared_a.obj" };
+        Mesh b { "shared_b.obj" };
+        AssertTrue(a[0].Mat != nullptr);
+        AssertTrue(a[0].Mat == b[0].Mat);
+        AssertThat(a[0].Mat->Name, std::string{"Green"});
+
+        // a modified library must be reloaded
+        WriteTextFile("shared.mtl", "newmtl Red\nKd 1 0 0\nnewmtl Green\nKd 0 0.5 0\nnewmtl Blue\nKd 0 0 1\n");
+        Mesh c { "shared_a.obj" };
+        AssertTrue(c[0].Mat != a[0].Mat);
+        AssertThat(c[0].Mat->DiffuseColor.g, 0.5f);
+
+        Nano::ClearMaterialCache();
+        Mesh d { "shared_a.obj" };
+        AssertTrue(d[0].Mat != c[0].Mat);
+        AssertThat(a[0].Mat->DiffuseColor.g, 1.0f); // old materials are still alive
+    }
+
+    TestCase(nmesh_roundtrip)
+    {
+        Mesh mesh { "head_male.obj" };
+        mesh.Bones.push_back({ 0, -1, "root", {} });
+        AssertTrue(mesh.SaveAs("head_male.nmesh"));
+
+        Mesh loaded { "head_male.nmesh" };
+        AssertTrue(AreMeshesIdentical(mesh, loaded));
+        AssertThat((int)loaded.Bones.size(), 1);
+        AssertThat(loaded.Bones[0].Name, std::string{"root"});
+
+        // the last byte is missing
+        rpp::load_buffer data = rpp::file::read_all("head_male.nmesh");
+        rpp::file::write_new("truncated.nmesh", data.data(), data.size() - 1);
+        Mesh truncated;
+        AssertFalse(truncated.Load("truncated.nmesh", Options::NoThrow));
+
+        // indices outside of their layers must not load
+        mesh[0].Tris[0].b.v = mesh[0].NumVerts();
+        AssertTrue(mesh.SaveAs("bad_index.nmesh"));
+        Mesh badIndex;
+        AssertFalse(badIndex.Load("bad_index.nmesh", Options::NoThrow));
+    }
+
+    TestCase(nmesh_compressed_roundtrip)
+    {
+        Mesh mesh { "head_male.obj" };
+        AssertTrue(mesh.SaveAs("head_male.nmesh"));
+        int64_t rawSize = rpp::file_sizel("head_male.nmesh");
+        AssertTrue(mesh.SaveAs("head_male.nmesh", Options::Compress | Options::Parallel));
+        AssertLess(rpp::file_sizel("head_male.nmesh"), rawSize / 2);
+
+        Mesh loaded { "head_male.nmesh" };
+        AssertTrue(AreMeshesIdentical(mesh, loaded));
+        Mesh parallel { "head_male.nmesh", Options::Parallel };
+        AssertTrue(AreMeshesIdentical(mesh, parallel));
+    }
+
+    TestCase(mesh_cache_rebuilds_stale_entries)
+    {
+        const char* quad = "mtllib cached.mtl\nv 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+                           "vt 0 0\nvt 1 0\nvt 1 1\nusemtl Red\nf 1/1 2/2 3/3\nf 1/1 3/3 4/2\n";
+        WriteTextFile("cached.mtl", "newmtl Red\nKd 1 0 0\n");
+        WriteTextFile("cached.obj", quad);
+        Mesh source { "cached.obj", Options::SplitSeams };
+
+        rpp::delete_folder("mesh_cache", rpp::delete_mode::recursive);
+        Nano::SetMeshCacheDir("mesh_cache");
+        Mesh miss { "cached.obj", Options::SplitSeams };
+        Mesh hit { "cached.obj", Options::SplitSeams };
+        AssertTrue(AreMeshesIdentical(source, miss));
+        AssertTrue(AreMeshesIdentical(source, hit));
+        AssertTrue(miss[0].Mat == source[0].Mat); // parsed from cached.mtl
+        AssertTrue(hit[0].Mat != source[0].Mat);  // read from the cache entry
+        AssertThat(hit[0].Mat->DiffuseColor.r, 1.0f);
+
+        // different load options get their own entry
+        Mesh clockwise { "cached.obj", Options::SplitSeams | Options::ClockWise };
+        AssertThat(clockwise[0].Winding, Nano::FaceWinding::CW);
+
+        // edits to the mesh or its materials invalidate the entry
+        WriteTextFile("cached.obj", (std::string{quad} + "f 1/1 2/2 4/2\n").c_str());
+        Mesh edited { "cached.obj", Options::SplitSeams };
+        AssertThat(edited.TotalTris(), 3);
+        WriteTextFile("cached.mtl", "newmtl Red\nKd 0.5 0 0\n");
+        Mesh recolored { "cached.obj", Options::SplitSeams };
+        AssertThat(recolored[0].Mat->DiffuseColor.r, 0.5f);
+
+        Nano::SetMeshCacheDir("");
+        rpp::delete_folder("mesh_cache", rpp::delete_mode::recursive);
+    }
+
+    TestCase(memory_mapped_load_is_identical)
+    {
+        for (const char* file : { "box_4x2x1.obj", "box_4x2x1.txt" })
+        {
+            Mesh buffered { file };
+            Mesh mapped { file, Options::MemoryMap };
+            AssertTrue(AreMeshesIdentical(buffered, mapped));
+        }
+    }
+
+    TestCase(memory_mapped_short_last_line)
+    {
+        // the mapping ends exactly at a page boundary and is not NUL terminated,
+        // so reading past a short unterminated last line would fault
+        for (const char* last : { "v", "vn", "u", "m" })
+        {
+            std::string text = "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n#";
+            text.append(4096 - text.size() - strlen(last) - 1, ' ');
+            text += '\n';
+            text += last;
+            WriteTextFile("short_last_line.obj", text.c_str());
+            AssertThat(rpp::file_sizel("short_last_line.obj"), int64_t(4096));
+
+            Mesh mapped { "short_last_line.obj", Options::MemoryMap };
+            AssertThat(mapped.TotalTris(), 1);
+            AssertThat(mapped.TotalVerts(), 3);
+        }
+    }
+
+    TestCase(load_context_reuses_memory)
+    {
+        Mesh expected { "head_male.obj" };
+        Nano::MeshLoadContext ctx;
+        Mesh mesh;
+        for (int i = 0; i < 3; ++i)
+        {
+            AssertTrue(mesh.Load("head_male.obj", Options::None, ctx));
+            AssertTrue(AreMeshesIdentical(expected, mesh));
+        }
+        AssertTrue(ctx.CapacityBytes() > 0);
+
+        // a different file with the same context must not see any stale data
+        Mesh box { "box_4x2x1.obj" };
+        AssertTrue(mesh.Load("box_4x2x1.obj", Options::None, ctx));
+        AssertTrue(AreMeshesIdentical(box, mesh));
+        ctx.Release();
+        AssertThat(ctx.CapacityBytes(), size_t(0));
+    }
+
+    TestCase(load_async)
+    {
+        Mesh expected { "head_male.obj" };
+        Nano::MeshLoadPool pool { 2 };
+        std::vector<Nano::MeshLoadHandle> loads;
+        for (int i = 0; i < 8; ++i)
+            loads.push_back(Mesh::LoadAsync("head_male.obj", Options::None, &pool));
+        Nano::MeshLoadHandle missing = pool.Load("does_not_exist.obj");
+        AssertTrue(pool.NumInFlight() <= 2);
+
+        int numCancelled = loads.back().Cancel() ? 1 : 0;
+        for (Nano::MeshLoadHandle& load : loads)
+        {
+            if (load.Status() == Nano::MeshLoadStatus::Cancelled)
+                continue;
+            AssertTrue(load.Wait());
+            AssertTrue(AreMeshesIdentical(expected, load.Get()));
+        }
+        AssertFalse(missing.Wait());
+        AssertThat(missing.Status(), Nano::MeshLoadStatus::Failed);
+        AssertFalse(missing.Error().empty());
+        AssertThrows(missing.Get(), Nano::MeshIOError);
+        if (numCancelled)
+            AssertThat(loads.back().Status(), Nano::MeshLoadStatus::Cancelled);
+
+        // user-supplied executor which runs each load on a detached thread
+        Nano::MeshLoadPool custom { [](Nano::MeshLoadPool::Task task) { std::thread{ task }.detach(); }, 3 };
+        Nano::MeshLoadHandle load = custom.Load("head_male.obj");
+        custom.WaitAll();
+        AssertThat(load.Status(), Nano::MeshLoadStatus::Loaded);
+        AssertTrue(AreMeshesIdentical(expected, load.Get()));
+
+        // a task run inline drains the queue itself, instead of submitting one nested task per load
+        {
+            std::vector<Nano::MeshLoadPool::Task> held;
+            int numSubmitted = 0;
+            Nano::MeshLoadPool inlinePool { [&](Nano::MeshLoadPool::Task task) {
+                ++numSubmitted;
+                held.push_back(std::move(task));
+            }, 1 };
+            std::vector<Nano::MeshLoadHandle> inlineLoads;
+            for (int i = 0; i < 50; ++i)
+                inlineLoads.push_back(inlinePool.Load("box_4x2x1.obj"));
+            AssertThat((int)held.size(), 1);
+            held.front()();
+            AssertThat(numSubmitted, 1);
+            for (Nano::MeshLoadHandle& load : inlineLoads)
+                AssertThat(load.Status(), Nano::MeshLoadStatus::Loaded);
+        }
+
+        // a load cancelled before its worker wakes up must still release WaitAll()
+        for (int i = 0; i < 100; ++i)
+        {
+            Nano::MeshLoadPool racy { 1 };
+            Nano::MeshLoadHandle queued = racy.Load("box_4x2x1.obj");
+            std::thread waiter { [&racy] { racy.WaitAll(); } };
+            queued.Cancel();
+            waiter.join();
+        }
+    }
+
+    // a UV sphere, so the normals point in every direction
+    static void CreateSphere(MeshGroup& g, int segments, float radius, bool withColors)
+    {
+        for (int y = 0; y <= segments; ++y)
+        {
+            for (int x = 0; x <= segments; ++x)
+            {
+                float u = float(x) / segments, v = float(y) / segments;
+                float theta = u * 6.2831853f, phi = v * 3.1415926f;
+                rpp::Vector3 n { std::cos(theta) * std::sin(phi), std::cos(phi), std::sin(theta) * std::sin(phi) };
+                g.Verts.push_back({ n.x * radius + 10.0f, n.y * radius, n.z * radius - 5.0f });
+                g.Normals.push_back(n);
+                g.Coords.push_back({ u, v * 2.0f });
+                if (withColors) g.Colors.push_back({ u, v, 0.5f });
+            }
+        }
+        for (int y = 0; y < segments; ++y)
+        {
+            for (int x = 0; x < segments; ++x)
+            {
+                int a = y*(segments + 1) + x, b = a + 1, c = a + segments + 2, d = a + segments + 1;
+                auto vd = [&](int i) { return Nano::VertexDescr{ i, i, i, withColors ? i : -1 }; };
+                g.Tris.push_back({ vd(a), vd(b), vd(c) });
+                g.Tris.push_back({ vd(a), vd(c), vd(d) });
+            }
+        }
+        g.CoordsMapping = g.NormalsMapping = Nano::MapMode::PerVertex;
+        if (withColors) g.ColorMapping = Nano::MapMode::PerVertex;
+    }
+
+    TestCase(quantized_vertex_data)
+    {
+        Mesh mesh;
+        CreateSphere(mesh.CreateGroup("plain"), 64, 2.0f, false);
+        CreateSphere(mesh.CreateGroup("colored"), 16, 0.5f, true);
+
+        std::vector<Nano::BasicVertex> vertices;
+        std::vector<int> indices;
+        mesh[0].CreateGameVertexData(vertices, indices);
+
+        Nano::QuantizedVertexData q;
+        mesh[0].CreateQuantizedVertexData(q);
+        AssertThat(q.NumVertices, (int)vertices.size());
+        AssertThat(q.Stride, 16);
+        AssertThat(q.ColorByteOffset, -1);
+        AssertTrue(q.Indices == indices);
+        AssertThat(q.Vertices.size(), size_t(q.NumVertices * q.Stride));
+        AssertLessOrEqual(q.MaxPosError, 4.0f / 65535);
+        AssertLess(q.MaxNormalError, 0.01f);
+        AssertLessOrEqual(q.MaxCoordError, 1.0f / 2048); // 11 bits of half precision in [1,2)
+
+        // dequantize the positions and normals the same way a shader would
+        float maxPosError = 0.0f, maxNormalError = 0.0f;
+        for (int i = 0; i < q.NumVertices; ++i)
+        {
+            const uint8_t* vertex = &q.Vertices[i * q.Stride];
+            uint16_t pos[3]; memcpy(pos, vertex, sizeof(pos));
+            int16_t oct[2]; memcpy(oct, vertex + q.NormalByteOffset, sizeof(oct));
+            const rpp::Vector3& p = vertices[i].pos;
+            const rpp::Vector3& n = vertices[i].norm;
+
+            maxPosError = std::max(maxPosError, std::abs(q.PosOffset.x + q.PosScale.x * (pos[0] / 65535.0f) - p.x));
+            maxPosError = std::max(maxPosError, std::abs(q.PosOffset.y + q.PosScale.y * (pos[1] / 65535.0f) - p.y));
+            maxPosError = std::max(maxPosError, std::abs(q.PosOffset.z + q.PosScale.z * (pos[2] / 65535.0f) - p.z));
+
+            float ex = oct[0] / 32767.0f, ey = oct[1] / 32767.0f;
+            rpp::Vector3 d { ex, ey, 1.0f - std::abs(ex) - std::abs(ey) };
+            if (d.z < 0.0f) {
+                d.x = (1.0f - std::abs(ey)) * (ex >= 0.0f ? 1.0f : -1.0f);
+                d.y = (1.0f - std::abs(ex)) * (ey >= 0.0f ? 1.0f : -1.0f);
+            }
+            double cx = d.y*n.z - d.z*n.y, cy = d.z*n.x - d.x*n.z, cz = d.x*n.y - d.y*n.x;
+            double angle = std::atan2(std::sqrt(cx*cx + cy*cy + cz*cz), d.x*n.x + d.y*n.y + d.z*n.z);
+            maxNormalError = std::max(maxNormalError, float(angle * 57.29578));
+        }
+        AssertLessOrEqual(maxPosError, q.MaxPosError);
+        AssertLess(maxNormalError, q.MaxNormalError + 0.001f); // shader math runs in float
+
+        // smallest layout, 12 bytes per vertex
+        Nano::QuantizedVertexData small;
+        mesh[0].CreateQuantizedVertexData(small, { Nano::NormalQuantization::Snorm8, Nano::CoordQuantization::Unorm16 });
+        AssertThat(small.Stride, 12);
+        AssertLess(small.MaxNormalError, 1.0f);
+        AssertThat(small.CoordScale.y, 2.0f);
+        AssertLessOrEqual(small.MaxCoordError, 2.0f / 65535);
+
+        Nano::QuantizedVertexData colored;
+        mesh[1].CreateQuantizedVertexData(colored);
+        AssertThat(colored.Stride, 20);
+        AssertThat(colored.ColorByteOffset, 16);
+        AssertLessOrEqual(colored.MaxColorError, 0.5f / 255 + 0.0001f);
+        AssertThat(colored.Vertices[colored.ColorByteOffset + 3], (uint8_t)255);
+    }
+
+    static bool AlmostEqual(const rpp::Vector3& a, const rpp::Vector3& b, float epsilon = 0.0001f)
+    {
+        return std::abs(a.x - b.x) <= epsilon && std::abs(a.y - b.y) <= epsilon && std::abs(a.z - b.z) <= epsilon;
+    }
+
+    TestCase(glb_roundtrip)
+    {
+        Mesh mesh { "head_male.obj" };
+        AssertTrue(mesh.SaveAs("head_male.glb"));
+        Mesh loaded { "head_male.glb" };
+        AssertThat(loaded.NumGroups(), mesh.NumGroups());
+        AssertThat(loaded.TotalTris(), mesh.TotalTris());
+
+        // the triangle corners must be the same, V is flipped twice so it can round
+        for (int i = 0; i < mesh.NumGroups(); ++i)
+        {
+            AssertThat(loaded[i].Name, mesh[i].Name);
+            std::vector<Nano::BasicVertex> expected, actual;
+            std::vector<int> expectedIndices, actualIndices;
+            mesh[i].CreateGameVertexData(expected, expectedIndices);
+            loaded[i].CreateGameVertexData(actual, actualIndices);
+            AssertThat(actual.size(), expected.size());
+            bool same = actual.size() == expected.size();
+            for (size_t v = 0; same && v < actual.size(); ++v)
+            {
+                same = AlmostEqual(actual[v].pos, expected[v].pos, 0.0f)
+                    && AlmostEqual(actual[v].norm, expected[v].norm, 0.0f)
+                    && std::abs(actual[v].uv.x - expected[v].uv.x) <= 0.000001f
+                    && std::abs(actual[v].uv.y - expected[v].uv.y) <= 0.000001f;
+            }
+            AssertTrue(same);
+        }
+
+        // load options are applied the same way as for OBJ
+        Mesh unity { "head_male.glb", Options::Unity };
+        AssertThat(unity[0].Winding, Nano::FaceWinding::CW);
+        AssertThat(unity[0].Verts[0].x, -loaded[0].Verts[0].x);
+
+        Mesh missing;
+        AssertFalse(missing.Load("head_male.obj.glb", Options::NoThrow));
+    }
+
+    // a .glb with only a JSON chunk, its buffers are external .bin files
+    static void WriteJsonGlb(const char* path, std::string json)
+    {
+        json.resize((json.size() + 3) & ~size_t(3), ' ');
+        uint32_t header[5] = { 0x46546C67, 2, uint32_t(20 + json.size()), uint32_t(json.size()), 0x4E4F534A };
+        FILE* f = fopen(path, "wb");
+        fwrite(header, sizeof(header), 1, f);
+        fwrite(json.data(), json.size(), 1, f);
+        fclose(f);
+    }
+
+    TestCase(glb_rejects_invalid_accessors)
+    {
+        const float tri[9] = { 0,0,0, 1,0,0, 0,1,0 };
+        rpp::file::write_new("invalid_tri.bin", tri, sizeof(tri));
+
+        // indices without a bufferView are all zeros, positions without one are empty
+        auto load = [](const char* byteOffset, bool emptyPositions, bool zeroIndices) {
+            std::string json = R"({"asset":{"version":"2.0"},"scene":0,"scenes":[{"nodes":[0]}],"nodes":[{"mesh":0}],)";
+            json += R"("meshes":[{"primitives":[{"attributes":{"POSITION":0})";
+            json += zeroIndices ? R"(,"indices":1}]}],)" : R"(}]}],)";
+            json += R"("buffers":[{"uri":"invalid_tri.bin","byteLength":36}],)";
+            json += R"("bufferViews":[{"buffer":0,"byteLength":36,"byteOffset":)" + std::string{ byteOffset } + "}],";
+            json += emptyPositions ? R"("accessors":[{"componentType":5126,"count":0,"type":"VEC3"},)"
+                                   : R"("accessors":[{"bufferView":0,"componentType":5126,"count":3,"type":"VEC3"},)";
+            json += R"({"componentType":5125,"count":3,"type":"SCALAR"}]})";
+            WriteJsonGlb("invalid_tri.glb", json);
+            Mesh mesh;
+            return mesh.Load("invalid_tri.glb", Options::NoThrow) && mesh.TotalTris() == 1;
+        };
+        AssertTrue(load("0", false, false));
+        AssertTrue(load("0", false, true)); // a degenerate triangle, but a valid one
+        AssertFalse(load("-4", false, false));
+        AssertFalse(load("0.5", false, false));
+        AssertFalse(load("1e300", false, false));
+        AssertFalse(load("0", true, true)); // index 0 with no vertices
+    }
+
+    static std::vector<rpp::Vector3> CornerPositions(const Mesh& mesh)
+    {
+        std::vector<rpp::Vector3> corners;
+        for (const MeshGroup& g : mesh.Groups)
+            for (const Nano::Triangle& tri : g.Tris)
+                for (const Nano::VertexDescr& vd : tri)
+                    corners.push_back(g.Verts[vd.v]);
+        return corners;
+    }
+
+    TestCase(ply_and_stl_roundtrip)
+    {
+        Mesh mesh { "head_male.obj" };
+        std::vector<rpp::Vector3> corners = CornerPositions(mesh);
+
+        AssertTrue(mesh.SaveAs("head_male.saved.ply"));
+        Mesh ply { "head_male.saved.ply" };
+        AssertThat(ply.NumGroups(), 1);
+        AssertThat(ply.TotalTris(), mesh.TotalTris());
+        AssertTrue(AreIdentical(CornerPositions(ply), corners));
+        AssertThat(ply[0].NumNormals(), ply[0].NumVerts());
+        Mesh plyFlat { "head_male.saved.ply", Options::SplitSeams }; // already per vertex
+        AssertThat(plyFlat[0].NumVerts(), ply[0].NumVerts());
+
+        AssertTrue(mesh.SaveAs("head_male.saved.stl"));
+        Mesh soup { "head_male.saved.stl" };
+        Mesh welded { "head_male.saved.stl", Options::WeldPositions };
+        AssertThat(soup.TotalTris(), mesh.TotalTris());
+        AssertThat(soup.TotalVerts(), soup.TotalTris() * 3);
+        AssertTrue(AreIdentical(CornerPositions(soup), corners));
+        AssertTrue(AreIdentical(CornerPositions(welded), corners));
+        AssertLessOrEqual(welded.TotalVerts(), mesh.TotalVerts());
+        AssertThat(welded[0].NormalsMapping, Nano::MapMode::PerFace);
+
+        // the last triangle is incomplete
+        rpp::load_buffer data = rpp::file::read_all("head_male.saved.stl");
+        rpp::file::write_new("head_male.saved.stl", data.data(), data.size() - 1);
+        Mesh truncated;
+        AssertFalse(truncated.Load("head_male.saved.stl", Options::NoThrow));
+    }
+
+    TestCase(glb_skin_and_animation)
+    {
+        Mesh mesh;
+        mesh.Name = "skinned";
+        MeshGroup& g = mesh.CreateGroup("body");
+        CreateSphere(g, 8, 1.0f, false);
+        for (const rpp::Vector3& v : g.Verts)
+        {
+            float w = v.y * 0.5f + 0.5f;
+            g.BlendIndices.push_back({ { 0, 1, 0, 0 } });
+            g.BlendWeights.push_back({ { 1.0f - w, w, 0.0f, 0.0f } });
+        }
+        g.BlendMapping = Nano::MapMode::PerVertex;
+
+        Nano::BonePose rootPose { { 0, 1, 0 }, { 0, 0, 0 }, { 1, 1, 1 } };
+        Nano::BonePose armPose { { 1, 0, 0 }, { 10, 20, 30 }, { 1, 2, 1 } };
+        mesh.Bones = { { 0, -1, "root", rootPose }, { 1, 0, "arm", armPose } };
+        mesh.SkinnedBones = { { 0, -1, "root", rootPose, {} }, { 1, 0, "arm", armPose, {} } };
+        for (int i = 0; i < 16; ++i)
+            mesh.SkinnedBones[1].InverseBindPoseTransform.m[i] = float(i);
+
+        Nano::AnimationClip& clip = mesh.AnimationClips.emplace_back();
+        clip.Name = "wave";
+        clip.Duration = 2.0f;
+        Nano::BoneAnimation& anim = clip.Animations.emplace_back();
+        anim.SkinnedBoneIndex = 1;
+        anim.Frames.push_back({ 0.0f, armPose });
+        anim.Frames.push_back({ 2.0f, { { 1, 0, 0 }, { -45, 10, 80 }, { 1, 1, 1 } } });
+
+        AssertTrue(mesh.SaveAs("head_male.skinned.glb"));
+        Mesh loaded { "head_male.skinned.glb" };
+        AssertThat(loaded.NumGroups(), 1);
+        AssertTrue(AreIdentical(loaded[0].BlendIndices, g.BlendIndices));
+        AssertTrue(AreIdentical(loaded[0].BlendWeights, g.BlendWeights));
+
+        AssertThat((int)loaded.SkinnedBones.size(), 2);
+        AssertThat((int)loaded.Bones.size(), 2);
+        AssertThat(loaded.SkinnedBones[1].Name, std::string{"arm"});
+        AssertThat(loaded.SkinnedBones[1].ParentIndex, 0);
+        AssertThat(loaded.Bones[0].ParentIndex, -1);
+        AssertTrue(AlmostEqual(loaded.Bones[1].Pose.Translation, armPose.Translation));
+        AssertTrue(AlmostEqual(loaded.Bones[1].Pose.Rotation, armPose.Rotation, 0.001f));
+        AssertTrue(AlmostEqual(loaded.Bones[1].Pose.Scale, armPose.Scale));
+        AssertTrue(memcmp(&loaded.SkinnedBones[1].InverseBindPoseTransform,
+                          &mesh.SkinnedBones[1].InverseBindPoseTransform, sizeof(rpp::Matrix4)) == 0);
+
+        AssertThat((int)loaded.AnimationClips.size(), 1);
+        const Nano::AnimationClip& loadedClip = loaded.AnimationClips[0];
+        AssertThat(loadedClip.Name, std::string{"wave"});
+        AssertThat(loadedClip.Duration, 2.0f);
+        AssertThat((int)loadedClip.Animations.size(), 1);
+        AssertThat(loadedClip.Animations[0].SkinnedBoneIndex, 1);
+        AssertThat((int)loadedClip.Animations[0].Frames.size(), 2);
+        AssertTrue(AlmostEqual(loadedClip.Animations[0].Frames[1].Pose.Rotation, { -45, 10, 80 }, 0.001f));
+    }
+
+    // minimal FBX 7500 binary node writer for the built-in reader tests
+    struct FbxTestNode
+    {
+        std::string Name;
+        std::string Props;
+        uint64_t NumProps = 0;
+        std::vector<FbxTestNode> Children;
+
+        template<class T> static void Put(std::string& out, const T& value)
+        {
+            out.append((const char*)&value, sizeof(T));
+        }
+        FbxTestNode& L(int64_t v) { Props += 'L'; Put(Props, v); ++NumProps; return *this; }
+        FbxTestNode& D(double v)  { Props += 'D'; Put(Props, v); ++NumProps; return *this; }
+        FbxTestNode& S(rpp::strview s)
+        {
+            Props += 'S'; Put(Props, (uint32_t)s.len); Props.append(s.str, s.len);
+            ++NumProps; return *this;
+        }
+        // arrays are zlib compressed with a single stored deflate block
+        template<class T> FbxTestNode& Array(char type, const std::vector<T>& values, bool compress)
+        {
+            std::string data { (const char*)values.data(), values.size() * sizeof(T) };
+            if (compress)
+            {
+                uint32_t a = 1, b = 0;
+                for (unsigned char c : data) { a = (a + c) % 65521; b = (b + a) % 65521; }
+                std::string z = "\x78\x01\x01";
+                Put(z, (uint16_t)data.size());
+                Put(z, (uint16_t)~data.size());
+                z += data;
+                uint32_t adler = (b << 16) | a;
+                for (int shift = 24; shift >= 0; shift -= 8) z += char(adler >> shift);
+                data = std::move(z);
+            }
+            Props += type;
+            Put(Props, (uint32_t)values.size());
+            Put(Props, (uint32_t)(compress ? 1 : 0));
+            Put(Props, (uint32_t)data.size());
+            Props += data;
+            ++NumProps; return *this;
+        }
+        FbxTestNode& Add(const char* name) { return Children.emplace_back(FbxTestNode{ name }); }
+
+        void Write(std::string& out) const
+        {
+            size_t start = out.size();
+            Put(out, uint64_t(0)); Put(out, NumProps); Put(out, (uint64_t)Props.size());
+            out += char(Name.size());
+            out += Name;
+            out += Props;
+            for (const FbxTestNode& child : Children)
+                child.Write(out);
+            if (!Children.empty())
+                out.append(25, '\0');
+            uint64_t endOffset = out.size();
+            memcpy(&out[start], &endOffset, sizeof(endOffset));
+        }
+    };
+
+    static std::string FbxObjectName(const char* name, const char* cls)
+    {
+        return std::string{name} + '\0' + '\1' + cls;
+    }
+
+    static void WriteBinaryQuadFbx(const char* path)
+    {
+        FbxTestNode objects { "Objects" };
+        FbxTestNode& geom = objects.Add("Geometry").L(100).S(FbxObjectName("Quad", "Geometry")).S("Mesh");
+        geom.Add("Vertices").Array('d', std::vector<double>{ 0,0,0, 1,0,0, 1,1,0, 0,1,0 }, true);
+        geom.Add("PolygonVertexIndex").Array('i', std::vector<int32_t>{ 0, 1, 2, ~3 }, false);
+        FbxTestNode& uv = geom.Add("LayerElementUV").L(0);
+        uv.Add("MappingInformationType").S("ByPolygonVertex");
+        uv.Add("ReferenceInformationType").S("IndexToDirect");
+        uv.Add("UV").Array('d', std::vector<double>{ 0,0, 1,0, 1,1, 0,1 }, true);
+        uv.Add("UVIndex").Array('i', std::vector<int32_t>{ 0, 1, 2, 3 }, true);
+
+        FbxTestNode& quad = objects.Add("Model").L(200).S(FbxObjectName("Quad", "Model")).S("Mesh");
+        quad.Add("Properties70").Add("P").S("Lcl Translation").S("Lcl Translation").S("").S("A").D(1).D(2).D(3);
+        FbxTestNode& red = objects.Add("Material").L(300).S(FbxObjectName("Red", "Material")).S("");
+        red.Add("Properties70").Add("P").S("DiffuseColor").S("Color").S("").S("A").D(1).D(0).D(0);
+        objects.Add("Model").L(400).S(FbxObjectName("Hips", "Model")).S("LimbNode");
+        objects.Add("Model").L(401).S(FbxObjectName("Spine", "Model")).S("LimbNode");
+
+        FbxTestNode connections { "Connections" };
+        connections.Add("C").S("OO").L(100).L(200);
+        connections.Add("C").S("OO").L(200).L(0);
+        connections.Add("C").S("OO").L(300).L(200);
+        connections.Add("C").S("OO").L(401).L(400);
+        connections.Add("C").S("OO").L(400).L(0);
+
+        std::string out { "Kaydara FBX Binary  \0\x1A\0", 23 };
+        FbxTestNode::Put(out, uint32_t(7500));
+        objects.Write(out);
+        connections.Write(out);
+        out.append(25, '\0');
+        rpp::file::write_new(path, out.data(), (int)out.size());
+    }
+
+    TestCase(load_binary_fbx)
+    {
+    #if !ENABLE_FBX_MESH_LOADER // SDK builds load every FBX with the SDK
+        WriteBinaryQuadFbx("binary_quad.fbx");
+        Mesh mesh { "binary_quad.fbx" };
+        AssertThat(mesh.NumGroups(), 1);
+        const MeshGroup& g = mesh[0];
+        AssertThat(g.Name, std::string{"Quad"});
+        AssertThat(g.NumVerts(), 4);
+        AssertThat(g.NumTris(), 2);
+        AssertThat(g.NumCoords(), 4);
+        AssertThat(g.CoordsMapping, Nano::MapMode::PerFaceVertex);
+        AssertTrue(AlmostEqual(g.Verts[2], { 1, 0, -1 })); // Z-up --> Y-up
+        AssertTrue(AlmostEqual(g.Offset, { 1, 3, -2 }));
+        AssertTrue(g.Mat && g.Mat->Name == "Red");
+        AssertTrue(AlmostEqual(g.Mat->DiffuseColor, { 1, 0, 0 }));
+
+        AssertThat((int)mesh.Bones.size(), 2);
+        AssertThat(mesh.Bones[0].Name, std::string{"Hips"});
+        AssertThat(mesh.Bones[1].Name, std::string{"Spine"});
+        AssertThat(mesh.Bones[1].ParentIndex, 0);
+
+        // every load owns its document, so they don't serialize on a shared SDK
+        std::vector<Mesh> meshes(4);
+        std::vector<std::thread> threads;
+        for (Mesh& m : meshes)
+            threads.emplace_back([&m] { m.Load("binary_quad.fbx", Options::Parallel); });
+        for (std::thread& t : threads)
+            t.join();
+        for (const Mesh& m : meshes)
+            AssertTrue(AreMeshesIdentical(mesh, m));
+
+        // a corrupted compressed array fails its checksum
+        rpp::load_buffer data = rpp::file::read_all("binary_quad.fbx");
+        std::string corrupt { data.data(), (size_t)data.size() };
+        size_t vertices = corrupt.find("Vertices");
+        corrupt[vertices + 8 + 1 + 12 + 7 + 8] ^= 0x40; // name, 'd' type, array header, zlib + stored block header
+        rpp::file::write_new("binary_quad.fbx", corrupt.data(), (int)corrupt.size());
+        Mesh corrupted;
+        AssertFalse(corrupted.Load("binary_quad.fbx", Options::NoThrow));
+    #endif
+    }
+
+    TestCase(welded_normals_match_exhaustive_search)
+    {
+        Mesh mesh;
+        MeshGroup& g = mesh.CreateGroup("sphere");
+        CreateSphere(g, 16, 1.0f, false);
+        g.FlattenFaceData(); // every corner has its own vertex
+
+        MeshGroup expected = g;
+        for (rpp::Vector3& n : expected.Normals) n = rpp::Vector3::Zero();
+        for (const Nano::Triangle& tri : expected.Tris)
+        {
+            if (g.Winding == Nano::FaceWinding::CCW) expected.UpdateNormal(tri.a, tri.b, tri.c, true);
+            else                                     expected.UpdateNormal(tri.c, tri.b, tri.a, true);
+        }
+        for (rpp::Vector3& n : expected.Normals) n.normalize();
+
+        g.RecalculateNormals(true);
+        AssertThat(g.NumNormals(), expected.NumNormals());
+        for (int i = 0; i < g.NumNormals(); ++i)
+            AssertTrue(AlmostEqual(g.Normals[i], expected.Normals[i]));
+
+        // a folded quad whose second triangle has slightly displaced copies of the shared edge
+        MeshGroup& fold = mesh.CreateGroup("fold");
+        fold.Verts   = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 1.000001f, 0, 0 }, { 0, 1.000001f, 0 }, { 1, 1, 1 } };
+        fold.Normals = fold.Verts;
+        fold.Tris    = { { { 0, -1, 0, -1 }, { 1, -1, 1, -1 }, { 2, -1, 2, -1 } },
+                         { { 3, -1, 3, -1 }, { 5, -1, 5, -1 }, { 4, -1, 4, -1 } } };
+        fold.RecalculateWeldedNormals();
+        AssertFalse(AlmostEqual(fold.Normals[1], fold.Normals[3]));
+        fold.RecalculateWeldedNormals(0.001f);
+        AssertTrue(AlmostEqual(fold.Normals[1], fold.Normals[3]));
+        AssertTrue(AlmostEqual(fold.Normals[2], fold.Normals[4]));
+        AssertFalse(AlmostEqual(fold.Normals[0], fold.Normals[5]));
+    }
+
+    TestCase(parallel_normals_are_deterministic)
+    {
+        Mesh mesh;
+        MeshGroup& g = mesh.CreateGroup("sphere");
+        CreateSphere(g, 400, 1.0f, false); // several blocks of normals and faces
+        MeshGroup serial = g;
+        serial.RecalculateNormals();
+
+        g.RecalculateNormalsParallel(1);
+        std::vector<rpp::Vector3> single = g.Normals;
+        g.RecalculateNormalsParallel(4);
+        AssertTrue(AreIdentical(g.Normals, single));
+        AssertThat(g.NumNormals(), serial.NumNormals());
+        for (int i = 0; i < g.NumNormals(); ++i)
+            AssertTrue(AlmostEqual(g.Normals[i], serial.Normals[i]));
+    }
+
+    TestCase(parallel_split_seams_is_identical)
+    {
+        Mesh serial { "head_male.obj" };
+        Mesh parallel { "head_male.obj" };
+        // several copies, so the corners are split over multiple shards
+        for (int i = 0; i < 5; ++i)
+        {
+            MeshGroup copy = serial[0];
+            serial[0].AddMeshData(copy);
+            parallel[0].AddMeshData(copy);
+        }
+        serial.SplitSeamVertices();
+        parallel.SplitSeamVertices(4);
+        AssertTrue(AreMeshesIdentical(serial, parallel));
+    }
+
+    TestCase(weld_vertices)
+    {
+        Mesh mesh;
+        CreateSphere(mesh.CreateGroup("sphere"), 16, 1.0f, true);
+        mesh[0].FlattenFaceData(); // every corner has its own position, UV, normal and color
+        std::vector<rpp::Vector3> corners = CornerPositions(mesh);
+
+        Mesh exact = mesh;
+        exact.WeldVertices();
+        AssertLess(exact[0].NumVerts(), 17 * 17);
+        AssertThat(exact[0].NumCoords(), 17 * 17);
+        AssertTrue(AreIdentical(CornerPositions(exact), corners));
+
+        // sin/cos rounding can leave the UV seam and pole positions a few ulps apart
+        Nano::WeldOptions opt;
+        opt.PositionEpsilon = 0.0001f;
+        Mesh welded = mesh;
+        welded.WeldVertices(opt);
+        AssertThat(welded[0].NumVerts(), 16 * 15 + 2);
+        AssertThat(welded[0].NumTris(), mesh[0].NumTris());
+        for (size_t i = 0; i < corners.size(); ++i)
+            AssertTrue(AlmostEqual(CornerPositions(welded)[i], corners[i], 0.0001f));
+
+        // per vertex UVs and colors differ across the seam, which keeps those vertices apart
+        opt.NormalEpsilon = 0.001f;
+        Mesh perVertex;
+        CreateSphere(perVertex.CreateGroup("sphere"), 16, 1.0f, true);
+        Mesh sameAttributes = perVertex;
+        perVertex.WeldVertices(opt);
+        AssertThat(perVertex[0].NumVerts(), 17 * 17);
+
+        sameAttributes[0].Coords.assign(17 * 17, rpp::Vector2::Zero());
+        sameAttributes[0].Colors.assign(17 * 17, rpp::Color3::White());
+        sameAttributes.WeldVertices(opt);
+        AssertThat(sameAttributes[0].NumVerts(), 16 * 15 + 2);
+        AssertThat(sameAttributes[0].NumColors(), sameAttributes[0].NumVerts());
+    }
+
+    TestCase(optimize_vertex_cache)
+    {
+        Mesh original { "head_male.obj" };
+        Mesh optimized { "head_male.obj", Options::OptimizeVertexCache };
+        AssertThat(optimized.TotalTris(), original.TotalTris());
+        AssertTrue(AreIdentical(optimized[0].Verts, original[0].Verts));
+
+        Nano::VertexCacheStats before = original[0].AnalyzeVertexCache();
+        Nano::VertexCacheStats after = optimized[0].AnalyzeVertexCache();
+        AssertLess(after.ACMR, before.ACMR);
+        AssertLess(after.ATVR, before.ATVR);
+
+        Nano::VertexCacheReport report = original[0].OptimizeVertexCache();
+        AssertThat(report.Before.ACMR, before.ACMR);
+        AssertThat(report.After.ACMR, after.ACMR);
+
+        // the same triangles with the same winding, only in a different order
+        auto byCorners = [](const Nano::Triangle& a, const Nano::Triangle& b) {
+            return memcmp(&a, &b, sizeof(a)) < 0;
+        };
+        std::vector<Nano::Triangle> expected = Mesh{ "head_male.obj" }[0].Tris;
+        std::vector<Nano::Triangle> reordered = optimized[0].Tris;
+        std::sort(expected.begin(), expected.end(), byCorners);
+        std::sort(reordered.begin(), reordered.end(), byCorners);
+        AssertTrue(AreIdentical(reordered, expected));
+
+        // optimizing again keeps the order
+        report = optimized[0].OptimizeVertexCache();
+        AssertThat(report.After.ACMR, report.Before.ACMR);
+    }
+
+    TestCase(optimize_overdraw)
+    {
+        // a convex mesh has no overdraw with back face culling, in any order
+        Mesh mesh;
+        MeshGroup& convex = mesh.CreateGroup("convex");
+        CreateSphere(convex, 32, 2.0f, false);
+        AssertThat(convex.AnalyzeOverdraw().Overdraw, 1.0f);
+
+        // a row of overlapping spheres, their inner halves are hidden from most directions
+        Mesh row;
+        MeshGroup& spheres = row.CreateGroup("spheres");
+        for (int i = 0; i < 5; ++i)
+        {
+            Mesh temp;
+            MeshGroup& sphere = temp.CreateGroup("sphere");
+            CreateSphere(sphere, 32, 1.0f, false);
+            const int base = spheres.NumVerts();
+            for (const rpp::Vector3& v : sphere.Verts)
+                spheres.Verts.push_back(v + rpp::Vector3{ i * 1.2f, 0.0f, i * 0.3f });
+            for (Nano::Triangle tri : sphere.Tris)
+            {
+                for (Nano::VertexDescr& vd : tri) vd = { vd.v + base };
+                spheres.Tris.push_back(tri);
+            }
+        }
+        spheres.OptimizeVertexCache();
+
+        Nano::OverdrawStats before = spheres.AnalyzeOverdraw();
+        Nano::VertexCacheReport report = spheres.OptimizeOverdraw(1.05f);
+        Nano::OverdrawStats after = spheres.AnalyzeOverdraw();
+        AssertThat(after.PixelsCovered, before.PixelsCovered);
+        AssertLess(after.Overdraw, before.Overdraw);
+        AssertLessOrEqual(report.After.ACMR, report.Before.ACMR * 1.05f);
+        AssertThat(spheres.AnalyzeVertexCache().ACMR, report.After.ACMR);
+
+        // without any allowed ACMR regression the vertex cache order can't get worse
+        report = spheres.OptimizeOverdraw(1.0f);
+        AssertLessOrEqual(report.After.ACMR, report.Before.ACMR);
+    }
+
+    TestCase(optimize_vertex_fetch)
+    {
+        Mesh original { "head_male.obj", Options::OptimizeVertexCache };
+        Mesh mesh { "head_male.obj", Options::OptimizeVertexCache };
+        MeshGroup& g = mesh[0];
+        const MeshGroup& o = original[0];
+        Nano::VertexCacheStats cache = g.AnalyzeVertexCache();
+
+        std::vector<int> remap = g.OptimizeVertexFetch();
+        AssertThat((int)remap.size(), o.NumVerts());
+        AssertThat(g.NumVerts(), o.NumVerts());
+        for (int i = 0; i < o.NumVerts(); ++i)
+            AssertThat(g.Verts[remap[i]], o.Verts[i]);
+
+        // same triangles in the same order, only the vertices moved
+        AssertTrue(AreIdentical(CornerPositions(mesh), CornerPositions(original)));
+        AssertThat(g.AnalyzeVertexCache().ACMR, cache.ACMR);
+        for (int i = 0; i < g.NumTris(); ++i)
+            for (int k = 0; k < 3; ++k)
+            {
+                const Nano::VertexDescr& vd = g.Tris[i][k];
+                const Nano::VertexDescr& od = o.Tris[i][k];
+                if (vd.t != -1) AssertThat(g.Coords[vd.t], o.Coords[od.t]);
+                if (vd.n != -1) AssertThat(g.Normals[vd.n], o.Normals[od.n]);
+            }
+
+        // every vertexId is first used right after all smaller ones
+        int maxVertexId = -1;
+        for (const Nano::Triangle& tri : g.Tris)
+            for (const Nano::VertexDescr& vd : tri)
+            {
+                AssertLessOrEqual(vd.v, maxVertexId + 1);
+                maxVertexId = std::max(maxVertexId, vd.v);
+            }
+
+        // already in first use order
+        std::vector<int> identity = g.OptimizeVertexFetch();
+        for (int i = 0; i < (int)identity.size(); ++i)
+            AssertThat(identity[i], i);
+    }
+
+    TestCase(simplify_and_lod_chain)
+    {
+        Mesh mesh;
+        MeshGroup& sphere = mesh.CreateGroup("sphere");
+        CreateSphere(sphere, 64, 2.0f, false);
+        sphere.Winding = Nano::FaceWinding::CCW;
+        const int numTris = sphere.NumTris();
+        const rpp::Vector3 center { 10.0f, 0.0f, -5.0f };
+
+        MeshGroup simplified = sphere;
+        Nano::SimplifyOptions opt;
+        opt.TargetRatio = 0.25f;
+        float error = simplified.Simplify(opt);
+        AssertThat(simplified.NumTris(), numTris / 4);
+        AssertLess(0.0f, error);
+        AssertLessOrEqual(error, opt.MaxError);
+        AssertTrue(AreIdentical(simplified.Verts, sphere.Verts)); // vertex data is shared
+
+        // the surface stays close to the sphere and the UV seam is kept in place
+        std::vector<char> used(sphere.NumVerts(), 0);
+        for (const Nano::Triangle& tri : simplified.Tris)
+        {
+            rpp::Vector3 mid = (sphere.Verts[tri.a.v] + sphere.Verts[tri.b.v] + sphere.Verts[tri.c.v]) / 3.0f;
+            AssertLess(2.0f - (mid - center).length(), 0.05f);
+            for (const Nano::VertexDescr& vd : tri) used[vd.v] = 1;
+        }
+        for (int y = 0; y <= 64; ++y)
+        {
+            AssertTrue(used[y * 65]);
+            AssertTrue(used[y * 65 + 64]);
+        }
+
+        // an error budget alone collapses a flat grid down to its locked border
+        Mesh flat;
+        MeshGroup& grid = flat.CreateGroup("grid");
+        for (int y = 0; y <= 20; ++y)
+            for (int x = 0; x <= 20; ++x)
+                grid.Verts.push_back({ float(x), float(y), 0.0f });
+        for (int y = 0; y < 20; ++y)
+            for (int x = 0; x < 20; ++x)
+            {
+                int a = y*21 + x, b = a + 1, c = a + 22, d = a + 21;
+                grid.Tris.push_back({ { a }, { b }, { c } });
+                grid.Tris.push_back({ { a }, { c }, { d } });
+            }
+        grid.Winding = Nano::FaceWinding::CCW;
+        opt.TargetRatio = 0.0f;
+        opt.MaxError = 0.0001f;
+        AssertThat(grid.Simplify(opt), 0.0f);
+        AssertLess(grid.NumTris(), 100);
+        float area = 0.0f;
+        for (const Nano::Triangle& tri : grid.Tris)
+        {
+            rpp::Vector3 n = (grid.Verts[tri.b.v] - grid.Verts[tri.a.v]).cross(grid.Verts[tri.c.v] - grid.Verts[tri.a.v]);
+            AssertLess(0.0f, n.z); // no flipped triangles
+            area += n.z * 0.5f;
+        }
+        AssertThat(area, 400.0f);
+
+        std::vector<Nano::MeshLod> lods = sphere.CreateLodChain(4, 0.5f, 0.05f);
+        AssertThat(lods.size(), size_t(4));
+        AssertTrue(AreIdentical(lods[0].Tris, sphere.Tris));
+        for (size_t i = 1; i < lods.size(); ++i)
+        {
+            AssertThat((int)lods[i].Tris.size(), numTris >> i);
+            AssertLessOrEqual(lods[i - 1].Error, lods[i].Error);
+            for (const Nano::Triangle& tri : lods[i].Tris)
+                for (const Nano::VertexDescr& vd : tri)
+                    AssertLess(vd.v, sphere.NumVerts());
+        }
+    }
+
     TestCase(validate_options_unity)
     {
         Mesh a { "box_4x2x1.obj", Options::Log };
@@ -0,0 +1,138 @@
+#include <rpp/debugging.h>
+#include <rpp/tests.h>
+#include <Nano/MeshCodec.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+using Nano::Triangle;
+
+TestImpl(test_mesh_codec)
+{
+    TestInit(test_mesh_codec)
+    {
+    }
+
+    template<class T>
+    static bool BitwiseEqual(const std::vector<T>& a, const std::vector<T>& b)
+    {
+        return a.size() == b.size()
+            && (a.empty() || memcmp(a.data(), b.data(), a.size()*sizeof(T)) == 0);
+    }
+
+    // a smooth grid with a few special values mixed in
+    static std::vector<float> GridPositions(int size)
+    {
+        std::vector<float> values;
+        for (int y = 0; y < size; ++y)
+            for (int x = 0; x < size; ++x)
+                values.insert(values.end(), { x * 0.1f, y * 0.1f, std::sin(x * 0.3f) * std::cos(y * 0.2f) });
+        values[4] = -0.0f;
+        values[7] = std::numeric_limits<float>::infinity();
+        values[8] = -std::numeric_limits<float>::max();
+        values[10] = std::numeric_limits<float>::quiet_NaN();
+        values[11] = std::numeric_limits<float>::denorm_min();
+        return values;
+    }
+
+    // two triangles per grid quad, in the order a mesh exporter would write them
+    static std::vector<Triangle> GridTriangles(int size, bool withCoords)
+    {
+        std::vector<Triangle> tris;
+        auto corner = [&](int x, int y) {
+            Nano::VertexDescr d;
+            d.v = y*size + x;
+            d.t = withCoords ? d.v : -1;
+            return d;
+        };
+        for (int y = 0; y + 1 < size; ++y)
+        {
+            for (int x = 0; x + 1 < size; ++x)
+            {
+                tris.push_back({ corner(x, y), corner(x+1, y), corner(x+1, y+1) });
+                tris.push_back({ corner(x, y), corner(x+1, y+1), corner(x, y+1) });
+            }
+        }
+        return tris;
+    }
+
+    TestCase(vertex_layers_are_lossless)
+    {
+        std::vector<float> values = GridPositions(64);
+        for (bool entropy : { false, true })
+        {
+            for (int numComponents : { 1, 2, 3, 4 })
+            {
+                size_t numElements = values.size() / numComponents;
+                std::vector<uint8_t> encoded;
+                Nano::EncodeVertexLayer(values.data(), numElements, numComponents, encoded, entropy);
+                if (numComponents == 3) // other strides mix up x/y/z, so they don't predict well
+                    AssertLess(encoded.size(), numElements*numComponents*sizeof(float) * 3 / 4);
+
+                std::vector<float> decoded(numElements * numComponents);
+                AssertTrue(Nano::DecodeVertexLayer(encoded.data(), encoded.size(), decoded.data(),
+                                                   numElements, numComponents));
+                AssertTrue(BitwiseEqual(decoded, values));
+
+                // wrong element counts must not be accepted
+                AssertFalse(Nano::DecodeVertexLayer(encoded.data(), encoded.size(), decoded.data(),
+                                                    numElements - 1, numComponents));
+            }
+        }
+
+        std::vector<uint8_t> empty;
+        Nano::EncodeVertexLayer(nullptr, 0, 3, empty);
+        AssertTrue(Nano::DecodeVertexLayer(empty.data(), empty.size(), nullptr, 0, 3));
+    }
+
+    TestCase(triangles_are_lossless)
+    {
+        for (bool withCoords : { false, true })
+        {
+            std::vector<Triangle> tris = GridTriangles(64, withCoords);
+            tris[10].c.n = 7; // a sparse component
+            for (bool entropy : { false, true })
+            {
+                std::vector<uint8_t> encoded;
+                Nano::EncodeTriangles(tris.data(), tris.size(), encoded, entropy);
+                // shared edges leave at most one new corner per triangle
+                AssertLess(encoded.size(), tris.size() * 6);
+
+                std::vector<Triangle> decoded(tris.size());
+                AssertTrue(Nano::DecodeTriangles(encoded.data(), encoded.size(), decoded.data(), decoded.size()));
+                AssertTrue(BitwiseEqual(decoded, tris));
+            }
+        }
+    }
+
+    TestCase(corrupted_data_is_rejected)
+    {
+        std::vector<Triangle> tris = GridTriangles(32, true);
+        std::vector<float> values = GridPositions(32);
+        for (bool entropy : { false, true })
+        {
+            std::vector<uint8_t> encodedTris, encodedVerts;
+            Nano::EncodeTriangles(tris.data(), tris.size(), encodedTris, entropy);
+            Nano::EncodeVertexLayer(values.data(), values.size() / 3, 3, encodedVerts, entropy);
+
+            std::vector<Triangle> decodedTris(tris.size());
+            std::vector<float> decodedVerts(values.size());
+            AssertFalse(Nano::DecodeTriangles(encodedTris.data(), encodedTris.size() / 2,
+                                              decodedTris.data(), decodedTris.size()));
+            AssertFalse(Nano::DecodeVertexLayer(encodedVerts.data(), encodedVerts.size() - 1,
+                                                decodedVerts.data(), values.size() / 3, 3));
+            // the decoders must stay in bounds for any input, even if they can't detect the damage
+            for (size_t i = 0; i < encodedTris.size(); i += 7)
+            {
+                std::vector<uint8_t> damaged = encodedTris;
+                damaged[i] ^= 0x5a;
+                (void)Nano::DecodeTriangles(damaged.data(), damaged.size(), decodedTris.data(), decodedTris.size());
+            }
+            for (size_t i = 0; i < encodedVerts.size(); i += 7)
+            {
+                std::vector<uint8_t> damaged = encodedVerts;
+                damaged[i] ^= 0x5a;
+                (void)Nano::DecodeVertexLayer(damaged.data(), damaged.size(), decodedVerts.data(), values.size() / 3, 3);
+            }
+        }
+    }
+};
@@ -42,6 +42,18 @@ TestImpl(test_mesh_loader_api)
 
         AssertThat(NanoMeshSave(nanoMesh, "head_male.saved.obj"), true);
 
+        NanoQuantizedVertices* q = NanoMeshGroupQuantize(g, Nano::NormalQuantization::Snorm8,
+                                                            Nano::CoordQuantization::Half);
+        AssertNotEqual(q, nullptr);
+        if (q)
+        {
+            AssertThat(q->Stride, g->Group.Colors.empty() ? 12 : 16);
+            AssertThat(q->NumVertices, g->Group.NumTris() * 3);
+            AssertThat(q->Vertices.Size, q->NumVertices * q->Stride);
+            AssertThat(q->Indices.Size, q->NumVertices);
+            NanoQuantizedVerticesClose(q);
+        }
+
         NanoMeshClose(nanoMesh);
     }
 };
@@ -0,0 +1,181 @@
+#include <rpp/debugging.h>
+#include <rpp/tests.h>
+#include <rpp/timer.h>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include "../src/NumberScanner.h"
+#include "../src/NumberWriter.h"
+using Nano::NumberScanner;
+using Nano::NumberWriter;
+
+TestImpl(test_number_scanner)
+{
+    TestInit(test_number_scanner)
+    {
+    }
+
+    static uint32_t FloatBits(float f)
+    {
+        uint32_t bits; memcpy(&bits, &f, sizeof(bits));
+        return bits;
+    }
+
+    // strtof is correctly rounded, so the scanner must match it bit for bit
+    bool MatchesStrtof(const char* text)
+    {
+        float expected = strtof(text, nullptr);
+        float actual = NumberScanner{ rpp::strview{text} }.Float();
+        if (FloatBits(expected) != FloatBits(actual))
+        {
+            LogWarning("'%s' parsed as %.9g, expected %.9g", text, actual, expected);
+            return false;
+        }
+        return true;
+    }
+
+    TestCase(floats_are_correctly_rounded)
+    {
+        const char* special[] = {
+            "0", "-0", "1", "-1", "0.5", ".5", "-.5", "1.", "+2.25", "3e-4", "1E5", "-2.5e+3",
+            "0.1", "0.2", "0.3", "123.456789", "-0.000001", "16777217", "9007199254740993",
+            "0.000000000000000000000000000000000000011754943", // FLT_MIN
+            "1e-45", "3.4028235e38", "3.4028236e38", "1e39", "-1e39",
+            "1.00000005960464477539062500", // halfway between 1 and nextafter(1)
+            "1.00000005960464477539062501",
+            "12345678901234567890.5", "0.000000000000000000000000123",
+            "1e00005", "-2.5E-000003", "1e0000000038", "1e99999", "1e-99999", "0e99999",
+        };
+        for (const char* text : special)
+            AssertTrue(MatchesStrtof(text));
+
+        // beyond double range without an exponent, leading zeros must not hide the integer part
+        const std::string digits(400, '7');
+        const std::string zeros(400, '0');
+        const std::string beyondDouble[] = {
+            digits, "000" + digits, "-00" + digits + ".5", "000.0" + digits,
+            "0." + zeros + "1", "00." + zeros + digits, zeros + digits,
+        };
+        for (const std::string& text : beyondDouble)
+            AssertTrue(MatchesStrtof(text.c_str()));
+
+        char buf[64];
+        srand(1337);
+        for (int i = 0; i < 100000; ++i)
+        {
+            double value = (rand() - RAND_MAX/2) * (1.0 / (1 + rand() % 10000));
+            const char* format = i % 3 == 0 ? "%.6f" : i % 3 == 1 ? "%.9g" : "%.4e";
+            snprintf(buf, sizeof(buf), format, value);
+            if (!MatchesStrtof(buf)) { AssertTrue(false); break; }
+        }
+    }
+
+    TestCase(floats_stop_at_line_end)
+    {
+        NumberScanner scanner { rpp::strview{"1.5 -2\t3.25e1  "} };
+        AssertThat(scanner.Float(), 1.5f);
+        AssertThat(scanner.Float(), -2.0f);
+        AssertThat(scanner.Float(), 32.5f);
+        AssertFalse(scanner.HasMore());
+        float untouched = 7.0f;
+        AssertFalse(scanner.ParseFloat(untouched));
+        AssertThat(untouched, 7.0f);
+
+        // the line must not be read past its end, even if more digits follow in memory
+        const char* text = "0.1234567890123456789";
+        NumberScanner partial { rpp::strview{text, 5} };
+        AssertThat(partial.Float(), 0.123f);
+    }
+
+    TestCase(face_vertex_tokens)
+    {
+        NumberScanner scanner { rpp::strview{"1 2/3 4//5 6/7/8 -1/-2/-3 9/10/11garbage 12"} };
+        int v, t, n;
+        AssertTrue(scanner.FaceVertex(v, t, n)); AssertThat(v, 1);  AssertThat(t, 0);  AssertThat(n, 0);
+        AssertTrue(scanner.FaceVertex(v, t, n)); AssertThat(v, 2);  AssertThat(t, 3);  AssertThat(n, 0);
+        AssertTrue(scanner.FaceVertex(v, t, n)); AssertThat(v, 4);  AssertThat(t, 0);  AssertThat(n, 5);
+        AssertTrue(scanner.FaceVertex(v, t, n)); AssertThat(v, 6);  AssertThat(t, 7);  AssertThat(n, 8);
+        AssertTrue(scanner.FaceVertex(v, t, n)); AssertThat(v, -1); AssertThat(t, -2); AssertThat(n, -3);
+        AssertTrue(scanner.FaceVertex(v, t, n)); AssertThat(v, 9);  AssertThat(t, 10); AssertThat(n, 11);
+        AssertTrue(scanner.FaceVertex(v, t, n)); AssertThat(v, 12); AssertThat(t, 0);  AssertThat(n, 0);
+        AssertFalse(scanner.FaceVertex(v, t, n));
+    }
+
+    // NumberWriter::Fixed must produce exactly the same text as printf
+    bool MatchesPrintf(float value, int decimals)
+    {
+        char expected[128], actual[128];
+        snprintf(expected, sizeof(expected), "%.*f", decimals, value);
+        *NumberWriter{ actual }.Fixed(value, decimals).End() = '\0';
+        if (strcmp(expected, actual) != 0)
+        {
+            LogWarning("%.9g formatted as '%s', expected '%s'", value, actual, expected);
+            return false;
+        }
+        return true;
+    }
+
+    TestCase(fixed_floats_match_printf)
+    {
+        const float special[] = {
+            0.0f, -0.0f, 1.0f, -1.0f, 0.5e-6f, 1.5e-6f, 2.5e-6f, -1e-7f, 0.00005f, 0.00015f,
+            123456.789f, 16777216.0f, 9.2e12f, 1e13f, 3e20f, 3.4028235e38f, -3.4028235e38f,
+        };
+        for (float value : special)
+            for (int decimals : { 0, 4, 6, 9 })
+                AssertTrue(MatchesPrintf(value, decimals));
+
+        srand(1337);
+        for (int i = 0; i < 100000; ++i)
+        {
+            float value = float((rand() - RAND_MAX/2) * (1.0 / (1 + rand() % 10000)));
+            if (!MatchesPrintf(value, i % 2 ? 6 : 4)) { AssertTrue(false); break; }
+        }
+
+        char buf[32];
+        *NumberWriter{ buf }.Int(-2147483647 - 1).Char(' ').Int(0).Char(' ').Int(1234567).End() = '\0';
+        AssertThat(std::string{buf}, std::string{"-2147483648 0 1234567"});
+    }
+
+    TestCase(benchmark_vs_strview_operators)
+    {
+        constexpr int NumLines = 200000;
+        std::string text;
+        text.reserve(NumLines * 32);
+        char buf[96];
+        srand(42);
+        for (int i = 0; i < NumLines; ++i)
+        {
+            float x = (rand() % 20000 - 10000) * 0.001f;
+            float y = (rand() % 20000 - 10000) * 0.0001f;
+            float z = (rand() % 20000 - 10000) * 0.01f;
+            text.append(buf, snprintf(buf, sizeof(buf), "%.6f %.6f %.6f\n", x, y, z));
+        }
+
+        auto benchmark = [&](const char* name, auto parseLine)
+        {
+            float sum = 0.0f;
+            rpp::Timer timer;
+            rpp::line_parser parser { text.data(), (int)text.size() };
+            rpp::strview line;
+            while (parser.read_line(line))
+                sum += parseLine(line);
+            double elapsed = timer.elapsed();
+            LogInfo("%-20s %6.2f ms  %6.1f MB/s  (checksum %g)", name,
+                    elapsed*1000.0, (text.size() / (1024.0*1024.0)) / elapsed, sum);
+            return elapsed;
+        };
+
+        double rppTime = benchmark("rpp::strview >>", [](rpp::strview line) {
+            float x, y, z;
+            line >> x >> y >> z;
+            return x + y + z;
+        });
+        double scannerTime = benchmark("Nano::NumberScanner", [](rpp::strview line) {
+            float x, y, z;
+            NumberScanner{line} >> x >> y >> z;
+            return x + y + z;
+        });
+        LogInfo("NumberScanner speedup: %.2fx", rppTime / scannerTime);
+    }
+};